@@ -6,58 +6,19 @@
 
 @import UIKit;
 
+#import "FSQCellManifestChangeset.h"
+#import "FSQCellManifestCollectionViewLayout.h"
+#import "FSQCellManifestCore.h"
+#import "FSQCellManifestPaginationPlugin.h"
 #import "FSQCellManifestProtocols.h"
+#import "FSQCellManifestProfilerPlugin.h"
 #import "FSQCellRecord.h"
 #import "FSQSectionRecord.h"
+#import "FSQVirtualSectionRecord.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
-/**
- You can pass one of the following selection strategies to the manifest when fully replacing the existing
- set of section records. It is used to determine what it should do about any already selected cells.
- 
- If there are no selected cells when you set new section records, then the strategy is not used.
- */
-typedef NS_ENUM(NSInteger, FSQViewReloadCellSelectionStrategy) {
-    
-    /**
-     All existing selected cells will be deselected.
-     */
-    FSQViewReloadCellSelectionStrategyDeselectAll,
-    
-    /**
-     The manifest will attempt to re-select the new cell records at the index paths that were previously selected.
-     Selection blocks and delegate callbacks will not be called.
-     */
-    FSQViewReloadCellSelectionStrategyMaintainSelectedIndexPaths,
-    
-    /**
-     The manifest will attempt to re-select the same cell records that were previously selected, even if they have
-     changed positions in the table. Records are compared using isEqualToCellRecord:
-     
-     Selection blocks and delegate callbacks will not be called.
-     
-     @note This strategy is more expensive than the other ones. It you need this, it is recommended you
-     use insert/move/replace/remove methods instead of replacing the entire array of section records when possible.
-     */
-    FSQViewReloadCellSelectionStrategyMaintainSelectedRecords,
-};
-
-/**
- Methods about headers which include an indexPath will use this value for the row index.
- 
- You can use this to distinguish header index paths from footer or normal cell paths.
- */
-extern const NSInteger kRowIndexForHeaderIndexPaths;
-
-/**
- Methods about footers which include an indexPath will use this value for the row index.
- 
- You can use this to distinguish footer index paths from header or normal cell paths.
- */
-extern const NSInteger kRowIndexForFooterIndexPaths;
-
-@interface FSQCellManifest : NSObject <NSFastEnumeration, UIScrollViewDelegate>
+@interface FSQCellManifest : FSQCellManifestCore <UIScrollViewDelegate>
 
 /**
  Will be either the table or collection view managed by this manifest if you are using one of those subclasses.
@@ -69,27 +30,6 @@ extern const NSInteger kRowIndexForFooterIndexPaths;
  */
 @property (nonatomic, weak, readonly, nullable) UIScrollView *managedView;
 
-/**
- An optional delegate that can receive callbacks from the manifest. The callbacks will be received after any plugins.
- 
- The delegate can implement methods from any of the following protocols to get the corresponding callbacks:
- * FSQCellManifestRecordModificationDelegate
- * FSQCellManifestRecordSizingDelegate
- * FSQCellManifestRecordConfigurationDelegate
- * FSQCellManifestRecordSelectionDelegate
- * UIScrollViewDelegate
- * UITableViewDelegate (only for FSQTableViewCellManifest)
- * UITableViewDataSource (only for FSQTableViewCellManifest)
- * UICollectionViewDelegate (only for FSQCollectionViewCellManifest)
- * UICollectionViewDelegateFlowLayout (only for FSQCollectionViewCellManifest)
- * UICollectionViewDataSource (only for FSQCollectionViewCellManifest)
- 
- If the methods have a return value and the message is not implemented by the manifest, the return value of the first
- delegate or plugin to respond will be used. Delegates who wish to have their return values
- override this behavior should implement FSQMessageForwardee's shouldUseResponseForInvocation:
- */
-@property (nonatomic, weak, nullable) id delegate;
-
 /**
  An array of plugins to receive callbacks from the manifest.
  
@@ -107,12 +47,16 @@ extern const NSInteger kRowIndexForFooterIndexPaths;
  * FSQCellManifestRecordModificationDelegate
  * FSQCellManifestRecordConfigurationDelegate
  * FSQCellManifestRecordSelectionDelegate
+ * FSQCellManifestRecordPrefetchingDelegate
+ * FSQCellManifestProfilingDelegate
  * UIScrollViewDelegate
  * UITableViewDelegate (only for FSQTableViewCellManifest)
  * UITableViewDataSource (only for FSQTableViewCellManifest)
+ * UITableViewDataSourcePrefetching (only for FSQTableViewCellManifest)
  * UICollectionViewDelegate (only for FSQCollectionViewCellManifest)
  * UICollectionViewDelegateFlowLayout (only for FSQCollectionViewCellManifest)
  * UICollectionViewDataSource (only for FSQCollectionViewCellManifest)
+ * UICollectionViewDataSourcePrefetching (only for FSQCollectionViewCellManifest)
  
  If the methods have a return value and the message is not implemented by the manifest, the return value of the first
  delegate or plugin to respond will be used. Plugins who wish to have their return values
@@ -120,35 +64,60 @@ extern const NSInteger kRowIndexForFooterIndexPaths;
  
  To alter the items in this array, pass them into the manifest's init method, or use addPlugins: and/or removePlugins:
  
+ The manifest remembers which plugins and delegate respond to each of its own callbacks. The lists are rebuilt whenever
+ plugins are added or removed or the delegate changes, so plugins and delegates should not change which methods they
+ respond to while attached.
+ 
  @note A strong reference is retained to the objects.
  */
 @property (nonatomic, readonly) NSArray<id<FSQCellManifestPlugin>> *plugins;
 
 /**
- An array of FSQSectionRecord objects that represent the invididual sections in a table view or collection view.
- Setting this property is equivalent to calling `setSectionRecords:selectionStrategy:`
- with a selection strategy of FSQViewReloadCellSelectionStrategyDeselectAll.
+ Controls whether or not cells should be selectable and highlightable if there is
+ no selectBlock and allows[Highlighting/Selection] hasn't been manually overwritten.
  */
-@property (nonatomic, null_resettable) NSArray<FSQSectionRecord *> *sectionRecords;
+@property (nonatomic, assign) BOOL cellSelectionEnabledByDefault;
 
 /**
- Controls whether the manifest methods that alter its records will automatically call through to the
- appropriate methods on its managed table or collection view to render the update.
+ Controls whether the manifest caches the cell, header and footer sizes it gets from your cell classes (or from the
+ delegate's sizeForCellAtIndexPath:withManifest:record:maximumSize: method).
  
- You can set this to NO if you intend to immediately update the managed view yourself after calling the
- manifest's methods.
+ Sizes are cached per record instance and maximum size, so a record is only measured again if its maximum size
+ changes. Cached sizes are discarded automatically when their records are moved, replaced, removed or reloaded
+ through the manifest, and when the managed view is reloaded with `reloadManagedView` or `setSectionRecords:`.
+ If a record's size changes for any other reason, call `invalidateSizesForRecords:`.
  
- Defaults to YES.
- 
- @note Also see: performRecordModificationUpdatesWithoutUpdatingManagedView:
+ Defaults to NO. Setting this to NO discards all cached sizes.
  */
-@property (nonatomic, assign) BOOL automaticallyUpdateManagedView;
+@property (nonatomic, assign) BOOL cachesRecordSizes;
 
 /**
- Controls whether or not cells should be selectable and highlightable if there is
- no selectBlock and allows[Highlighting/Selection] hasn't been manually overwritten.
+ The number of size requests that were answered from the size cache since it was last enabled.
  */
-@property (nonatomic, assign) BOOL cellSelectionEnabledByDefault;
+@property (nonatomic, readonly) NSUInteger recordSizeCacheHitCount;
+
+/**
+ The number of size requests that had to measure their record since the size cache was last enabled.
+ */
+@property (nonatomic, readonly) NSUInteger recordSizeCacheMissCount;
+
+/**
+ Controls whether the manifest automatically measures records in the background after its records change.
+ 
+ When this is YES, inserting or replacing records schedules a background pass that measures every record whose cell
+ class adopts FSQCellManifestThreadSafeTableViewCellProtocol or FSQCellManifestThreadSafeCollectionViewCellProtocol
+ and is not currently visible, then stores the results in the size cache. Records are gathered a batch at a time on the
+ main thread and measured concurrently across all available cores. Results for records that were invalidated while
+ being measured are discarded, and those records are picked up by the next pass.
+ 
+ Background measurement is skipped if the delegate implements sizeForCellAtIndexPath:withManifest:record:maximumSize:,
+ since delegate methods are not expected to be thread safe.
+ 
+ Defaults to NO. Setting this to YES also sets cachesRecordSizes to YES.
+ 
+ @note Records must not be modified in place while they are being measured in the background.
+ */
+@property (nonatomic, assign) BOOL precomputesSizesInBackground;
 
 /**
  Add plugins to the plugins array in order, after any existing plugins.
@@ -175,284 +144,239 @@ extern const NSInteger kRowIndexForFooterIndexPaths;
                          plugins:(nullable NSArray<id<FSQCellManifestPlugin>> *)plugins;
 
 /**
- Allows you to do batch updates on the manifest's managed view.
- 
- If this is a table view manifest, your updates block will be wrapped in beginUpdates and endUpdates calls.
+ The index paths of the rows or items currently visible in the managed view, in no particular order.
+ Headers and footers are not included.
  
- If this is a collection view manifest, your updates block will be passed to performBatchUpdates:completion:
+ @return An array of NSIndexPaths. Empty if there is no managed view.
  */
-- (void)performBatchRecordModificationUpdates:(nullable void (^)(void))updates;
+- (NSArray<NSIndexPath *> *)indexPathsForVisibleRecords;
 
 /**
- Allows you to do make record modification calls without the manifest calling through to its managed view
- to render the updates.
+ Runs configuration again on the cells currently displayed at the specified index paths, without dequeuing new cells
+ and without changing their sizes.
  
- If you use this method, you are responsible for updating the managed view properly.
+ Use this after changing a record's model or onConfigure block in a way that does not affect its size. It is much
+ cheaper than reloadCellsAtIndexPaths:, and the cells keep their state (such as selection, scroll position or running
+ animations) and are not animated.
  
- @note If you change the value of the automaticallyUpdateManagedView property in the updates block, the behavior
- of this method is undefined.
- */
-- (void)performRecordModificationUpdatesWithoutUpdatingManagedView:(nullable void (^)(void))updates;
-
-/**
- Replace the existing array of section records with the passed in array.
+ Each visible cell goes through the same steps as when it is first displayed, including the delegate and plugin
+ will and did configure callbacks. Index paths that are not visible are skipped, since they will be configured as
+ usual when they are next displayed. If a record now uses a different reuse identifier than its cell, that cell is
+ reloaded instead.
  
- This method will automatically call reloadData on the table or collection view it is managing after applying
- the new records. If you do not want this behavior, see `performRecordModificationUpdatesWithoutUpdatingManagedView`.
+ Does not update any records. During a transaction, the cells are reconfigured once it is committed.
  
- @param sectionRecords    An array of FSQSectionRecord objects. The array will be copied.
- @param selectionStrategy A hint to the manifest on what to do with any existing selected rows.
+ @param indexPaths Index paths of cells to reconfigure.
  */
-- (void)setSectionRecords:(nullable NSArray<FSQSectionRecord *> *)sectionRecords
-        selectionStrategy:(FSQViewReloadCellSelectionStrategy)selectionStrategy;
+- (void)reconfigureCellsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths;
 
 /**
- Accessor for getting individual section records.
- 
- @param index The index of the record you want.
+ Identical to reconfigureCellsAtIndexPaths:, but optionally also updates the cells' sizes.
  
- @return The section record at that index, or nil if the index is out of bounds.
+ @param indexPaths Index paths of cells to reconfigure.
+ @param resizing   If YES, any cached sizes for the records are discarded and the managed view's layout is updated to
+                   their new sizes. Table views animate the height changes. If NO, the layout is left alone.
  */
-- (nullable FSQSectionRecord *)sectionRecordAtIndex:(NSInteger)index;
+- (void)reconfigureCellsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths resizing:(BOOL)resizing;
 
 /**
- Accessor for getting individual cell records.
+ Identical to reconfigureCellsAtIndexPaths:, but finds the cells to reconfigure by record instead of by index path.
  
- @param indexPath The index path of the record you want.
+ Only the visible index paths are searched for the records, so this does not depend on the number of records in
+ the manifest. Records are matched by identity, not by isEqual:.
  
- @return The section record at that index, or nil if the index path is out of bounds.
+ @param cellRecords Records whose cells should be reconfigured.
  */
-- (nullable FSQCellRecord *)cellRecordAtIndexPath:(NSIndexPath *)indexPath;
+- (void)reconfigureCellRecords:(NSArray<FSQCellRecord *> *)cellRecords;
 
 /**
- Accessor for the getting the current number of sections.
+ Identical to reconfigureCellRecords:, but optionally also updates the cells' sizes.
  
- @return Current number of section records managed by this manifest.
+ @param cellRecords Records whose cells should be reconfigured.
+ @param resizing    If YES, any cached sizes for the records are discarded, including those of records that are not
+                    visible, and the managed view's layout is updated to their new sizes.
  */
-- (NSInteger)numberOfSectionRecords;
+- (void)reconfigureCellRecords:(NSArray<FSQCellRecord *> *)cellRecords resizing:(BOOL)resizing;
 
 /**
- Accessor for the getting the current number of cell records in a section.
+ Discards any cached sizes for the specified records, so they will be measured again the next time the managed view
+ asks for their size.
  
- @param index The index of the section you are interested in.
+ This does not reload the managed view, but plugins that keep their own copies of record sizes (such as
+ FSQCellManifestCollectionViewLayout) are told to discard them. It has no effect if cachesRecordSizes is NO.
  
- @return The number of cell records in the specified section.
+ @param records Cell, header or footer records whose sizes have changed.
  */
-- (NSInteger)numberOfCellRecordsInSectionAtIndex:(NSInteger)index;
+- (void)invalidateSizesForRecords:(NSArray<FSQCellRecord *> *)records;
 
 /**
- Insert new cell records in order starting at the given index path without animation.
- 
- This method will automatically call the appropriate methods on its table or collection view to show the new cells.
- If you do not want this behavior, see `performRecordModificationUpdatesWithoutUpdatingManagedView`.
- 
- @param cellRecords An array of FSQCellRecord objects.
- @param indexPath   The index path that the first new record should be inserted at.
- The section index of this index path must  be less than numberOfSectionRecords (i.e. an existing section).
- and the row or item index must be less than or equal to the number of cell records in that section.
- 
- @return An array of NSIndexPaths of the newly inserted cellRecords.
+ Discards all cached sizes. This does not reload the managed view.
  */
-- (NSArray<NSIndexPath *> *)insertCellRecords:(NSArray<FSQCellRecord *> *)cellRecords
-                                  atIndexPath:(NSIndexPath *)indexPath;
+- (void)invalidateAllRecordSizes;
 
 /**
- Insert new section records in order starting at the given index without animation.
+ Measures every record that does not have a cached size yet on background threads, including the visible ones.
  
- This method will automatically call the appropriate methods on its table or collection view to show the new sections.
- If you do not want this behavior, see `performRecordModificationUpdatesWithoutUpdatingManagedView`.
+ Only records whose cell classes adopt one of the thread safe sizing protocols are measured. Call this after setting
+ your records but before the managed view is first displayed to avoid measuring them on the main thread.
  
- @param sectionRecords An array of FSQSectionRecord objects.
- @param index          The index that the first new record should be inserted at.
- This index must be less than or equal to the number of section records.
+ If cachesRecordSizes is NO, this sets it to YES.
  
- @return An index set containing the indexes of the newly inserted sectionRecords.
+ Records whose sizes are invalidated while they are being measured are measured again before completion is called.
+ 
+ @param completion Optional block called on the main thread once the results are in the size cache.
  */
-- (NSIndexSet *)insertSectionRecords:(NSArray<FSQSectionRecord *> *)sectionRecords
-                             atIndex:(NSInteger)index;
+- (void)precomputeSizesWithCompletion:(nullable void (^)(void))completion;
 
 /**
- Move a cell record at one index path to another.
+ Builds cells for the current records ahead of time, whenever the main run loop is about to go idle, so that the first
+ scroll through the managed view does not have to create them from scratch.
+ 
+ The work is split into slices of at most roughly sliceBudget seconds (a slice always builds at least one cell), each
+ done just before the main run loop would otherwise sleep in its default mode. Nothing is built while the run loop is
+ tracking a scroll. Cells are built round robin across reuse identifiers, so every cell class gets its first cell as
+ early as possible.
  
- This method will automatically call the appropriate methods on its table or collection view to show the move.
- If you do not want this behavior, see `performRecordModificationUpdatesWithoutUpdatingManagedView`.
+ FSQTableViewCellManifest dequeues cells from its table view and keeps them in a pool that cellForRowAtIndexPath:
+ draws from before asking the table view for a cell. The pool never holds more than countPerCellClass cells for a
+ reuse identifier, and is discarded when the app receives a memory warning. UICollectionView only accepts cells from its own dequeue method
+ at display time, so FSQCollectionViewCellManifest instead builds and throws away a single instance of each cell
+ class, which only pays one-time costs such as class initialization and loading shared resources.
  
- @param initialIndexPath The index path of the cell to move. This must be a valid existing index path.
- @param targetIndexPath  The index path that the cell should end up at. The section index of the index path must
- reference a valid existing section. The row or item index must be no greater than the number of cell records in
- the section AFTER the record at initialIndexPath is removed.
+ Starting again cancels any prewarming that is still in progress. Must be called from the main thread, after setting
+ the managed view and records.
  
- @return YES if the records were successfully moved, NO if one or both of the index paths were invalid.
+ @param countPerCellClass How many cells to build for each reuse identifier. Usually the number of cells of that kind
+                          that fit on screen.
+ @param sliceBudget       How long each idle slice may spend building cells, in seconds.
+ @param completion        Optional block called on the main thread once every cell has been built. Not called if
+                          prewarming is cancelled.
  */
-- (BOOL)moveCellRecordAtIndexPath:(NSIndexPath *)initialIndexPath
-                      toIndexPath:(NSIndexPath *)targetIndexPath;
+- (void)prewarmCellsWithCount:(NSUInteger)countPerCellClass sliceBudget:(CFTimeInterval)sliceBudget completion:(nullable void (^)(void))completion;
 
 /**
- Move a section record at one index to another.
- 
- This method will automatically call the appropriate methods on its table or collection view to show the move.
- If you do not want this behavior, see `performRecordModificationUpdatesWithoutUpdatingManagedView`.
- 
- @param initialIndex The index of the section to move. This must be a valid existing section index.
- @param targetIndex  The index that the section should end up at. This must be a valid existing index.
- 
- @return YES if the records were successfully moved, NO if one or both of the indexes were invalid.
+ Stops any prewarming in progress. Cells that were already built are kept.
  */
-- (BOOL)moveSectionRecordAtIndex:(NSInteger)initialIndex
-                         toIndex:(NSInteger)targetIndex;
+- (void)cancelPrewarming;
 
 /**
- Remove cell records at the specified index paths.
+ Will tell you whether the record at the specified index path is able to be highlighted, based on the
+ current manifest configuration
  
- This method will automatically call the appropriate methods on its table or collection view to show the removals.
- If you do not want this behavior, see `performRecordModificationUpdatesWithoutUpdatingManagedView`.
+ The corresponding UIKit delegate callback for this method is handled for you, but if you would like to know this
+ data for your own purposes you can call this method.
  
- @param indexPaths                  An array of NSIndexPath objects of rows to remove.
- Any invalid index paths will be ignored.
- @param shouldRemoveEmptySections   If YES, when all cells in a section would be removed, than that section is
- removed instead.
+ @param indexPath Index path which you would like to know about.
  
- @return An array of NSIndexPath objects that were actually removed. It does not include any invalid index paths.
- It also does not include any index paths in a section that was entirely removed if shouldRemoveEmptySections is YES.
+ @return YES if the record can highlight, NO if it cannot.
  */
-- (NSArray<NSIndexPath *> *)removeCellRecordsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths
-                                      removeEmptySections:(BOOL)shouldRemoveEmptySections;
+- (BOOL)recordShouldHighlightAtIndexPath:(NSIndexPath *)indexPath;
 
 /**
- Remove sections at the specified indexes.
+ Will tell you whether the record at the specified index path is able to be selected, based on the
+ current manifest configuration
  
- This method will automatically call the appropriate methods on its table or collection view to show the removals.
- If you do not want this behavior, see `performRecordModificationUpdatesWithoutUpdatingManagedView`.
+ The corresponding UIKit delegate callback for this method is handled for you, but if you would like to know this
+ data for your own purposes you can call this method.
  
- @param indexes An set of indexes to remove. All indexes must be valid section indexes or none will be removed.
+ @param indexPath Index path which you would like to know about.
  
- @return YES if sections were removed. NO if any of the indexes were invalid.
+ @return YES if the record can be selected, NO if it cannot.
  */
-- (BOOL)removeSectionRecordsAtIndexes:(NSIndexSet *)indexes;
+- (BOOL)recordShouldSelectAtIndexPath:(NSIndexPath *)indexPath;
+
+@end
+
+@interface FSQTableViewCellManifest : FSQCellManifest <UITableViewDataSource, UITableViewDataSourcePrefetching, UITableViewDelegate>
 
 /**
- Replace cell records with a different records.
- 
- This method will automatically call the appropriate methods on its table or collection view to show the replacement.
- If you do not want this behavior, see `performRecordModificationUpdatesWithoutUpdatingManagedView`.
- 
- @param indexPaths     An array of NSIndexPaths to existing cell records to replace.
- Any invalid index paths will not be replaced.
- @param newCellRecords An array of cell records to replace the existing records with. The size of this array must
- be equal to the size of indexPaths
- 
+ The table view this manifest is managing.
  */
-- (void)replaceCellRecordsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths
-                       withCellRecords:(NSArray<FSQCellRecord *> *)newCellRecords;
+@property (nonatomic, weak, nullable) UITableView *tableView;
 
 /**
- Replace section records with different records.
- 
- This method will automatically call the appropriate methods on its table or collection view to show the replacement.
- If you do not want this behavior, see `performRecordModificationUpdatesWithoutUpdatingManagedView`.
+ Create a new manifest meant to manage a table view.
  
- @param indexes           An array of NSNumber-boxed NSIntegers of existing section record indexes to replace.
- Any invalid indexes will not be replaced.
- @param newSectionRecords An array of section records to replace the existing records with. The size of this array
- must be equal to the number of indexes.
+ @param delegate  Optional delegate to receive callbacks.
+ @param plugins   Optional array of plugin delegates.
+ @param tableView Optional table view to manage. You may assign or change the table view later through the
+ exposed property if it is not available when creating the manifest.
  
- @return A set of indexes that were actually replaced, not including any invalid indexes.
+ @return A new table view cell manifest.
  */
-- (NSIndexSet *)replaceSectionRecordsAtIndexes:(NSArray<NSNumber *> *)indexes
-                            withSectionRecords:(NSArray<FSQSectionRecord *> *)newSectionRecords;
+- (instancetype)initWithDelegate:(nullable id)delegate
+                         plugins:(nullable NSArray<id<FSQCellManifestPlugin>> *)plugins
+                       tableView:(UITableView *)tableView;
 
 /**
- Does either tableView or collectionView reload data method as appropriate and informs manifest delegates and plugins.
+ Controls whether the manifest gives the table view estimated heights, so that it only has to measure the rows it
+ actually displays instead of every row when it reloads.
  
- Does not update any records.
+ Estimates come from the size cache if the record has already been measured, and otherwise from the average height
+ measured so far for the record's cell class. Before any row of a class has been measured, the table view's
+ estimatedRowHeight (or estimatedSectionHeaderHeight/estimatedSectionFooterHeight) is used if it is set.
  
- You should use this method instead of calling reload on your managed view directly.
+ Defaults to NO.
  */
-- (void)reloadManagedView;
+@property (nonatomic, assign) BOOL usesEstimatedHeights;
 
 /**
- Calls appropriate method on managed view to reload the specified index paths and informs manifest
- delegates and plugins.
+ Find the row, header or footer at a vertical content offset in O(log n) time.
  
- Does not update any records.
+ Offsets are computed from the table header view and the height of every row, header and footer. Heights of records
+ that have not been measured (or are not in the size cache) are estimated as described in usesEstimatedHeights.
  
- You should use this method instead of calling reload on your managed view directly.
+ @param contentOffset A content offset in the table view's coordinates.
  
- @param indexPaths Index paths of cells to reload.
+ @return The index path of the row at that offset. Headers and footers use kRowIndexForHeaderIndexPaths and
+ kRowIndexForFooterIndexPaths as their row. Offsets outside of the content return the first or last index path.
+ Returns nil if there are no sections.
  */
-- (void)reloadCellsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths;
+- (nullable NSIndexPath *)indexPathForContentOffset:(CGPoint)contentOffset;
 
 /**
- Calls appropriate method on managed view to reload the specified indexes and informs manifest delegates and plugins.
+ Find the content offset at which a row, header or footer starts in O(log n) time.
  
- Does not update any records.
+ Offsets are computed the same way as in indexPathForContentOffset:.
  
- You should use this method instead of calling reload on your managed view directly.
+ @param indexPath The index path of a row. Headers and footers use kRowIndexForHeaderIndexPaths and
+ kRowIndexForFooterIndexPaths as their row.
  
- @param indexes Indexes of sections to reload.
- */
-- (void)reloadSectionsAtIndexes:(NSIndexSet *)indexes;
-
-/**
- Will return you either indexPath.row or indexPath.item depending on whether this is a table or collection
- view manifest.
+ @return The content offset of the top of that row, or CGPointZero if the index path is invalid.
  */
-- (NSInteger)rowOrItemIndexForIndexPath:(NSIndexPath *)indexPath;
+- (CGPoint)contentOffsetForIndexPath:(NSIndexPath *)indexPath;
 
 /**
- Creates an indexPath using either indexPathForRow:inSection: or indexPathForItem:inSection: depending on whether this
- is a table or collection view manifest.
- */
-- (NSIndexPath *)indexPathForRowOrItem:(NSInteger)rowOrItem inSection:(NSInteger)section;
-
-/**
- Will tell you whether the record at the specified index path is able to be highlighted, based on the
- current manifest configuration
- 
- The corresponding UIKit delegate callback for this method is handled for you, but if you would like to know this
- data for your own purposes you can call this method.
+ Throws away any cells built by prewarmCellsWithCount:sliceBudget:completion: that have not been displayed yet.
  
- @param indexPath Index path which you would like to know about.
- 
- @return YES if the record can highlight, NO if it cannot.
+ This happens automatically when the table view changes, and when the app receives a memory warning.
  */
-- (BOOL)recordShouldHighlightAtIndexPath:(NSIndexPath *)indexPath;
+- (void)discardPrewarmedCells;
 
 /**
- Will tell you whether the record at the specified index path is able to be selected, based on the
- current manifest configuration
+ Perform record updates without moving the first visible row on screen, even if rows above it are inserted,
+ removed, or change height.
  
- The corresponding UIKit delegate callback for this method is handled for you, but if you would like to know this
- data for your own purposes you can call this method.
- 
- @param indexPath Index path which you would like to know about.
+ The first visible row's record is found again after the updates (it may have moved) and the table view's content
+ offset is adjusted so that it stays at the same distance from the top of the table view. Finding a row that moved
+ is fastest when maintainsRecordIndex is YES.
  
- @return YES if the record can be selected, NO if it cannot.
+ @param updates A block that modifies the manifest's records.
  */
-- (BOOL)recordShouldSelectAtIndexPath:(NSIndexPath *)indexPath;
-
-@end
-
-@interface FSQTableViewCellManifest : FSQCellManifest <UITableViewDataSource, UITableViewDelegate>
+- (void)performUpdatesMaintainingScrollPosition:(void (^)(void))updates;
 
 /**
- The table view this manifest is managing.
- */
-@property (nonatomic, weak, nullable) UITableView *tableView;
-
-/**
- Create a new manifest meant to manage a table view.
+ Replace the existing array of section records with the passed in array, updating the table view with only the
+ sections and rows that actually changed.
  
- @param delegate  Optional delegate to receive callbacks.
- @param plugins   Optional array of plugin delegates.
- @param tableView Optional table view to manage. You may assign or change the table view later through the
- exposed property if it is not available when creating the manifest.
+ This method is identical to setSectionRecords:animated: except that the changes will be applied
+ with the given animation.
  
- @return A new table view cell manifest.
+ @param sectionRecords An array of FSQSectionRecord objects. The array will be copied.
+ @param animation      The animation to use for inserting, removing and reloading sections and rows.
  */
-- (instancetype)initWithDelegate:(nullable id)delegate
-                         plugins:(nullable NSArray<id<FSQCellManifestPlugin>> *)plugins
-                       tableView:(UITableView *)tableView;
+- (void)setSectionRecords:(nullable NSArray<FSQSectionRecord *> *)sectionRecords
+            withAnimation:(UITableViewRowAnimation)animation;
 
 /**
  Insert new cell records in order at the given index path with a table view row animation.
@@ -536,6 +460,28 @@ extern const NSInteger kRowIndexForFooterIndexPaths;
                        withCellRecords:(NSArray<FSQCellRecord *> *)newCellRecords
                          withAnimation:(UITableViewRowAnimation)animation;
 
+/**
+ Remove every cell record that passes a test with a table view row animation.
+ 
+ This method is identical to removeCellRecordsWithOptions:passingTest:removeEmptySections: except that the rows will
+ be removed with the given animation.
+ */
+- (NSArray<NSIndexPath *> *)removeCellRecordsWithOptions:(NSEnumerationOptions)options
+                                             passingTest:(FSQCellRecordTestBlock)predicate
+                                           withAnimation:(UITableViewRowAnimation)animation
+                                     removeEmptySections:(BOOL)shouldRemoveEmptySections;
+
+/**
+ Replace every cell record that passes a test with a table view row animation.
+ 
+ This method is identical to replaceCellRecordsWithOptions:passingTest:withBlock: except that the rows will be
+ replaced with the given animation.
+ */
+- (NSArray<NSIndexPath *> *)replaceCellRecordsWithOptions:(NSEnumerationOptions)options
+                                              passingTest:(FSQCellRecordTestBlock)predicate
+                                                withBlock:(FSQCellRecordReplacementBlock)replacement
+                                            withAnimation:(UITableViewRowAnimation)animation;
+
 /**
  Replace section records with different records with a table view row animation.
  
@@ -602,7 +548,7 @@ extern const NSInteger kRowIndexForFooterIndexPaths;
 
 @end
 
-@interface FSQCollectionViewCellManifest : FSQCellManifest <UICollectionViewDataSource, UICollectionViewDelegate, UICollectionViewDelegateFlowLayout>
+@interface FSQCollectionViewCellManifest : FSQCellManifest <UICollectionViewDataSource, UICollectionViewDataSourcePrefetching, UICollectionViewDelegate, UICollectionViewDelegateFlowLayout>
 
 /**
  The collection view this manifest is managing.
@@ -622,6 +568,34 @@ extern const NSInteger kRowIndexForFooterIndexPaths;
                          plugins:(nullable NSArray<id<FSQCellManifestPlugin>> *)plugins
                   collectionView:(UICollectionView *)collectionView;
 
+/**
+ The size of the item at the specified index path, from the size cache if there is one.
+ 
+ This is the size the manifest gives UICollectionViewFlowLayout, for layouts that ask the manifest directly.
+ */
+- (CGSize)sizeForItemAtIndexPath:(NSIndexPath *)indexPath;
+
+/**
+ The size of the specified section's header record, from the size cache if there is one.
+ 
+ @param section       Index of the section.
+ @param referenceSize Returned if the section has no header record, or its cell class cannot measure it.
+ */
+- (CGSize)sizeForHeaderInSection:(NSInteger)section referenceSize:(CGSize)referenceSize;
+
+/**
+ The size of the specified section's footer record, from the size cache if there is one.
+ 
+ @param section       Index of the section.
+ @param referenceSize Returned if the section has no footer record, or its cell class cannot measure it.
+ */
+- (CGSize)sizeForFooterInSection:(NSInteger)section referenceSize:(CGSize)referenceSize;
+
+/**
+ The specified section's collectionViewSectionInset, or defaultInset if the section record does not set one.
+ */
+- (UIEdgeInsets)insetForSectionAtIndex:(NSInteger)section defaultInset:(UIEdgeInsets)defaultInset;
+
 
 // The following collection view delegate and data source methods are implemented by the manifest
 // and so any subclasses must call super on these to get correct behavior.
@@ -5,6 +5,10 @@
 //
 
 #import "FSQCellManifest.h"
+#import "FSQCellManifestCoreSubclass.h"
+
+#import "FSQCellManifestIndexPaths.h"
+#import "FSQCellManifestOffsetIndex.h"
 
 @import FSQMessageForwarder;
 
@@ -12,12 +16,15 @@ NS_ASSUME_NONNULL_BEGIN
 
 #pragma mark - Begin Private Headers, Types, and Constants
 
-const NSInteger kRowIndexForHeaderIndexPaths = -1;
-const NSInteger kRowIndexForFooterIndexPaths = -2;
-
 static NSString *const kFSQIdentifierClassMismatchException = @"FSQIdentifierClassMismatchException";
 static NSString *const kFSQIdentifierCellDequeueException = @"FSQIdentifierCellDequeueException";
 
+// Used for rows, headers and footers when there is no better estimate available
+static const CGFloat kFSQDefaultEstimatedHeight = 44;
+
+// Number of records size precomputation looks at per main run loop pass
+static const NSUInteger kFSQCellManifestSizePrecomputationBatchSize = 512;
+
 typedef NS_ENUM(NSInteger, FSQIdentifierRegistrationResult) {
     FSQIdentifierRegistrationResultAdded,
     FSQIdentifierRegistrationResultAlreadyExists,
@@ -40,42 +47,192 @@ typedef NS_ENUM(NSInteger, FSQCellRecordType) {
 @property (nonatomic, weak) id manifestDelegate;
 @property (nonatomic, readonly) NSUInteger currentIndex;
 
+/**
+ The selector currently being forwarded. While this is set, the enumerator only returns the children that respond
+ to it, in their usual order.
+ */
+@property (nonatomic, nullable) SEL forwardingSelector;
+
 - (void)addPlugins:(nullable NSArray<id<FSQCellManifestPlugin>> *)newPlugins;
 - (void)removePlugins:(nullable NSArray<id<FSQCellManifestPlugin>> *)pluginsToRemove;
 
-@end
+- (BOOL)hasRespondersToSelector:(SEL)selector;
 
-// These methods all already exist in FSQSectionRecord.m but are not exposed.
-// Define them here so that FSQCellManfiest can know about them.
-// They are for internal manifest use only and should not be used outside of the framework
-@interface FSQSectionRecord (FSQCellManifestPrivateMethods)
+/**
+ @return The only child that responds to selector, if there is exactly one and it does not want a say in which
+ responses the forwarder uses. Otherwise nil.
+ */
+- (nullable id)soleResponderToSelector:(SEL)selector;
 
-- (NSValue *)collectionViewSectionInsetPrivate;
+/**
+ Forget which children respond to which selectors. Call this if a child changes the selectors it responds to.
+ */
+- (void)invalidateResponderCache;
+
+@end
 
+/**
+ Message forwarder that uses its enumerator's responder cache.
+ 
+ Messages with exactly one responding child are handed straight to that child through forwardingTargetForSelector:,
+ which skips creating an NSInvocation. Other messages are forwarded as usual, but only to the children that respond.
+ */
+@interface FSQCellManifestMessageForwarder : FSQMessageForwarderWithEnumerator
 @end
 
 @interface FSQCellRecord (FSQCellManifestPrivateMethods)
 
 - (BOOL)allowsHighlightingWasSet;
 - (BOOL)allowsSelectionWasSet;
+- (nullable NSString *)explicitReuseIdentifier;
+
+@end
+
+/**
+ Value type for the manifest's record size cache.
+ Only the most recent maximum size is stored for each record.
+ */
+@interface FSQCellManifestCachedSize : NSObject {
+    @public
+    CGSize _maximumSize;
+    CGSize _size;
+}
+@end
+
+@implementation FSQCellManifestCachedSize
+@end
+
+/**
+ A single record to be measured off the main thread by precomputeSizes.
+ Everything except _size is filled in on the main thread before measurement starts. The record's model and cell class
+ are copied into the job, since the main thread may set them on the record while it is being measured.
+ */
+@interface FSQCellManifestSizingJob : NSObject {
+    @public
+    FSQCellRecord *_record;
+    id _model;
+    Class _cellClass;
+    NSIndexPath *_indexPath;
+    CGSize _maximumSize;
+    CGSize _size;
+}
+@end
+
+@implementation FSQCellManifestSizingJob
+@end
+
+/**
+ State of one call to precomputeSizes, whose records are snapshotted a batch at a time on the main thread.
+ */
+@interface FSQCellManifestSizePrecomputation : NSObject {
+    @public
+    BOOL _includesVisibleRecords;
+    NSSet<NSIndexPath *> *_Nullable _visibleIndexPaths;
+    void (^_Nullable _completion)(void);
+    
+    // The next record to snapshot. A cell index of kRowIndexForHeaderIndexPaths is the section's header and a cell
+    // index equal to the section's cell count is its footer.
+    NSUInteger _recordsChangeCount;
+    NSInteger _sectionIndex;
+    NSInteger _cellIndex;
+    BOOL _scanFinished;
+    
+    NSUInteger _batchesInFlight;
+    BOOL _needsRetry;
+}
+@end
+
+@implementation FSQCellManifestSizePrecomputation
+@end
+
+/**
+ Running average of the heights measured for a single cell class, used for estimated heights.
+ */
+@interface FSQCellManifestHeightAverage : NSObject {
+    @public
+    double _totalHeight;
+    NSUInteger _count;
+}
+@end
+
+@implementation FSQCellManifestHeightAverage
+@end
+
+typedef void (*FSQCellManifestConfigureIMP)(id, SEL, FSQCellManifest *, id, NSIndexPath *, FSQCellRecord *);
+typedef CGFloat (*FSQCellManifestHeightIMP)(id, SEL, FSQTableViewCellManifest *, id, CGSize, NSIndexPath *, FSQCellRecord *);
+typedef CGSize (*FSQCellManifestSizeIMP)(id, SEL, FSQCollectionViewCellManifest *, id, CGSize, NSIndexPath *, FSQCellRecord *);
+
+/**
+ What the manifest has learned about a single cell class, filled in the first time the class is seen.
+ 
+ _reuseIdentifier is created once and used for every record of the class without its own reuseIdentifier.
+ _registeredRecordTypes has a (1 << FSQCellRecordType) bit set once that identifier has been registered
+ with the managed view for that record type.
+ 
+ Each IMP is only set if the class conforms to the protocol declaring that method, so they double as the result of
+ conformsToProtocol: for FSQCellManifestCellProtocol, FSQCellManifestTableViewCellProtocol and
+ FSQCellManifestCollectionViewCellProtocol.
+ 
+ _prefetches and _cancelsPrefetching are set if the class implements the matching
+ FSQCellManifestPrefetchingCellProtocol method.
+ 
+ _prewarmed is set once the collection view manifest has paid the class's one-time setup costs while prewarming.
+ */
+@interface FSQCellManifestCellClassInfo : NSObject {
+    @public
+    NSString *_reuseIdentifier;
+    NSUInteger _registeredRecordTypes;
+    FSQCellManifestConfigureIMP _Nullable _configureIMP;
+    FSQCellManifestHeightIMP _Nullable _heightIMP;
+    FSQCellManifestSizeIMP _Nullable _sizeIMP;
+    BOOL _threadSafeTableViewSizing;
+    BOOL _threadSafeCollectionViewSizing;
+    BOOL _prefetches;
+    BOOL _cancelsPrefetching;
+    BOOL _prewarmed;
+}
+@end
 
+@implementation FSQCellManifestCellClassInfo
 @end
 
 #pragma mark End Private Headers, Types, and Constants -
 
-#pragma mark - Begin Core Manifest
+#pragma mark - Begin Base Manifest
 
 @implementation FSQCellManifest {
     NSMutableDictionary *_identifierCellClassMap;
+    NSMapTable *_cellClassInfoByClass;
+    __unsafe_unretained Class _Nullable _lastCellClass;
+    FSQCellManifestCellClassInfo *_Nullable _lastCellClassInfo;
     FSQCellManifestMessageForwarderEnumerator *_scrollViewDelegateForwarderEnumerator;
+    BOOL _profiling;
+    NSMapTable<FSQCellRecord *, FSQCellManifestCachedSize *> *_recordSizeCache;
+    NSUInteger _recordSizeCacheGeneration;
+    NSUInteger _recordSizeCacheClearGeneration;
+    NSMapTable<FSQCellRecord *, NSNumber *> *_Nullable _recordSizeInvalidationGenerations;
+    NSUInteger _sizePrecomputationBatchesInFlight;
+    NSUInteger _recordsChangeCount;
+    BOOL _automaticSizePrecomputationScheduled;
+    CFRunLoopObserverRef _Nullable _prewarmingObserver;
+    NSArray<FSQCellRecord *> *_Nullable _prewarmingQueue;
+    NSUInteger _prewarmingQueueIndex;
+    CFTimeInterval _prewarmingSliceBudget;
+    NSUInteger _prewarmingCountPerCellClass;
+    void (^_Nullable _prewarmingCompletion)(void);
+}
+
+- (instancetype)initWithDelegate:(nullable id)delegate {
+    return [self initWithDelegate:delegate plugins:nil];
 }
 
 - (instancetype)initWithDelegate:(nullable id)delegate
                          plugins:(nullable NSArray<id<FSQCellManifestPlugin>> *)plugins {
-    if ((self = [super init])) {
-        _sectionRecords = @[];
+    if ((self = [super initWithDelegate:nil])) {
         _identifierCellClassMap = [NSMutableDictionary new];
-        _automaticallyUpdateManagedView = YES;
+        _cellClassInfoByClass = [[NSMapTable alloc] initWithKeyOptions:(NSPointerFunctionsOpaqueMemory | NSPointerFunctionsOpaquePersonality)
+                                                          valueOptions:NSPointerFunctionsStrongMemory
+                                                              capacity:0];
         [self createForwarders];
         [self addPlugins:plugins];
         self.delegate = delegate;
@@ -120,6 +277,8 @@ typedef NS_ENUM(NSInteger, FSQCellRecordType) {
     
     // After self, before any delegates
     [self addPluginsToForwarders:plugins];
+    
+    [self invalidateResponderLists];
 }
 
 - (void)removePlugins:(NSArray<id<FSQCellManifestPlugin>> *)plugins {
@@ -134,6 +293,8 @@ typedef NS_ENUM(NSInteger, FSQCellRecordType) {
     }
     
     [self removePluginsFromForwarders:plugins];
+    
+    [self invalidateResponderLists];
 }
 
 - (void)setManagedView:(UIScrollView *)managedView {
@@ -150,10 +311,10 @@ typedef NS_ENUM(NSInteger, FSQCellRecordType) {
 }
 
 - (void)setDelegate:(nullable id)delegate {
-    if (_delegate == delegate) {
+    if (self.delegate == delegate) {
         return;
     }
-    _delegate = delegate;
+    [super setDelegate:delegate];
     
     for (FSQCellManifestMessageForwarderEnumerator *enumerator in [self messageForwarderEnumerators]) {
         enumerator.manifestDelegate = delegate;
@@ -178,72 +339,13 @@ typedef NS_ENUM(NSInteger, FSQCellRecordType) {
     }
 }
 
-- (void)performBatchRecordModificationUpdates:(nullable void (^)(void))updates {
-    // Subclasses should override
-    if (updates) {
-        updates();
-    }
-}
-
-- (void)performRecordModificationUpdatesWithoutUpdatingManagedView:(nullable void (^)(void))updates {
-    if (updates) {
-        if (self.automaticallyUpdateManagedView) {
-            self.automaticallyUpdateManagedView = NO;
-            updates();
-            self.automaticallyUpdateManagedView = YES;
-        }
-        else {
-            updates();
-        }
-    }
-}
-
-- (nullable FSQSectionRecord *)sectionRecordAtIndex:(NSInteger)index {
-    if (index < [_sectionRecords count]
-        && index >= 0) {
-        return _sectionRecords[index];
-    }
-    else {
-        return nil;
-    }
-}
-
-- (nullable FSQCellRecord *)cellRecordAtIndexPath:(NSIndexPath *)indexPath {
-    return [[self sectionRecordAtIndex:indexPath.section] cellRecordAtIndex:[self rowOrItemIndexForIndexPath:indexPath]];
-}
-
-- (NSInteger)numberOfSectionRecords {
-    return [_sectionRecords count];
-}
-
-- (NSInteger)numberOfCellRecordsInSectionAtIndex:(NSInteger)index {
-    return [[self sectionRecordAtIndex:index] numberOfCellRecords];
-}
-
-- (NSInteger)rowOrItemIndexForIndexPath:(NSIndexPath *)indexPath {
-    // Subclasses override
-    NSAssert(0, @"rowOrItemIndexForIndexPath: should be overriden by subclass");
-    return 0;
-}
-
-- (NSIndexPath *)indexPathForRowOrItem:(NSInteger)rowOrItem inSection:(NSInteger)section {
-    // Subclasses override
-    NSAssert(0, @"indexPathForRowOrItem:inSection: should be overriden by subclass");
-    return nil;
-}
-
-- (NSUInteger)countByEnumeratingWithState:(NSFastEnumerationState *)state objects:(id _Nonnull __unsafe_unretained [])buffer count:(NSUInteger)len {
-    return [_sectionRecords countByEnumeratingWithState:state objects:buffer count:len];
-}
-
-
 - (CGSize)maxSizeForRecord:(FSQCellRecord *)record atIndexPath:(nullable NSIndexPath *)indexPath defaultWidth:(CGFloat)defaultWidth defaultHeight:(CGFloat)defaultHeight {
     if (indexPath // nil means its a header or footer
-        && [self.delegate respondsToSelector:@selector(maximumSizeForCellAtIndexPath:withManifest:record:)]) {
+        && [self delegateRespondsToSelector:@selector(maximumSizeForCellAtIndexPath:withManifest:record:)]) {
         return [self.delegate maximumSizeForCellAtIndexPath:indexPath withManifest:self record:record];
     }
     else {
-        if ([self.delegate respondsToSelector:@selector(defaultMaximumCellSizeForManifest:)]) {
+        if ([self delegateRespondsToSelector:@selector(defaultMaximumCellSizeForManifest:)]) {
             CGSize defaultSize = [self.delegate defaultMaximumCellSizeForManifest:self];
             defaultWidth = defaultSize.width;
             defaultHeight = defaultSize.height;
@@ -252,758 +354,1038 @@ typedef NS_ENUM(NSInteger, FSQCellRecordType) {
     }
 }
 
-#pragma mark - Insertion and Removal
-
-// The managedViewUpdates versions should not be directly overridden.
-// Subclasses should override public methods, then call through to these with managedViewUpdates set to
-// do any additional work they need to support their use case (ie table or collection updating)
+#pragma mark - Responder Lists
 
-- (void)replaceSectionRecords:(nullable NSArray<FSQSectionRecord *> *)sectionRecords
-            selectionStrategy:(FSQViewReloadCellSelectionStrategy)selectionStrategy
-           managedViewUpdates:(nullable void(^)(NSArray<FSQSectionRecord *> *originalRecords))managedViewUpdates {
+- (void)invalidateResponderLists {
+    [super invalidateResponderLists];
     
-    NSArray *originalRecords = _sectionRecords;
-    
-    /**  Inform delegates  **/
+    FSQCellManifestResponderList *profilers = [self responderListForSelector:@selector(manifest:didProfileEvent:cellClass:duration:)];
+    _profiling = ([profilers->_plugins count] > 0 || profilers->_delegateResponds);
+}
+
+#pragma mark - Profiling
+
+// These are called from the hottest paths in the manifest, so they do nothing more than check a flag unless a
+// profiling plugin or delegate is attached.
+
+- (CFTimeInterval)profilingStartTime {
+    return (_profiling ? CACurrentMediaTime() : 0);
+}
+
+- (void)reportProfilingEvent:(FSQCellManifestProfilingEvent)event cellClass:(nullable Class)cellClass startTime:(CFTimeInterval)startTime {
+    if (!_profiling) {
+        return;
+    }
     
-    [self withEachPluginAndDelegate:^(id delegate) {
-        if ([delegate respondsToSelector:@selector(manifest:willReplaceSectionRecords:withRecords:)]) {
-            [delegate manifest:self willReplaceSectionRecords:originalRecords withRecords:sectionRecords];
-        }
+    CFTimeInterval duration = CACurrentMediaTime() - startTime;
+    [self withEachPluginAndDelegateRespondingToSelector:@selector(manifest:didProfileEvent:cellClass:duration:) block:^(id delegate) {
+        [delegate manifest:self didProfileEvent:event cellClass:cellClass duration:duration];
     }];
+}
+
+#pragma mark - Size Caching
+
+- (void)setCachesRecordSizes:(BOOL)cachesRecordSizes {
+    if (_cachesRecordSizes == cachesRecordSizes) {
+        return;
+    }
+    _cachesRecordSizes = cachesRecordSizes;
     
-    /**  Do work  **/
-    
-    if (!sectionRecords) {
-        _sectionRecords = @[];
+    if (cachesRecordSizes) {
+        // Records are keyed by identity and not retained, so the cache never outlives the records it describes
+        _recordSizeCache = [NSMapTable mapTableWithKeyOptions:(NSPointerFunctionsWeakMemory | NSPointerFunctionsObjectPointerPersonality)
+                                                 valueOptions:NSPointerFunctionsStrongMemory];
+        _recordSizeCacheHitCount = 0;
+        _recordSizeCacheMissCount = 0;
     }
     else {
-        _sectionRecords = [sectionRecords copy];
+        _recordSizeCache = nil;
+        self.precomputesSizesInBackground = NO;
     }
     
-    if (managedViewUpdates && _automaticallyUpdateManagedView) {
-        managedViewUpdates(originalRecords);
-    }
-    
-    /**  Inform delegates  **/
-    
-    [self withEachPluginAndDelegate:^(id delegate) {
-        if ([delegate respondsToSelector:@selector(manifest:didReplaceSectionRecords:withRecords:)]) {
-            [delegate manifest:self didReplaceSectionRecords:originalRecords withRecords:sectionRecords];
-        }
-    }];
+    ++_recordSizeCacheGeneration;
+    _recordSizeCacheClearGeneration = _recordSizeCacheGeneration;
+    [self recordSizesDidChange];
 }
 
-- (void)setSectionRecords:(nullable NSArray<FSQSectionRecord *> *)sectionRecords selectionStrategy:(FSQViewReloadCellSelectionStrategy)selectionStrategy {
-    [self replaceSectionRecords:sectionRecords selectionStrategy:selectionStrategy managedViewUpdates:nil];
+- (BOOL)getCachedSize:(CGSize *)size forRecord:(FSQCellRecord *)record {
+    FSQCellManifestCachedSize *cachedSize = [_recordSizeCache objectForKey:record];
+    if (cachedSize) {
+        *size = cachedSize->_size;
+        return YES;
+    }
+    else {
+        return NO;
+    }
 }
 
-- (void)setSectionRecords:(nullable NSArray<FSQSectionRecord *> *)sectionRecords {
-    [self setSectionRecords:sectionRecords selectionStrategy:FSQViewReloadCellSelectionStrategyDeselectAll];
+- (CGSize)measureRecord:(nullable FSQCellRecord *)record usingBlock:(CGSize (^)(void))sizeBlock {
+    CFTimeInterval startTime = [self profilingStartTime];
+    CGSize size = sizeBlock();
+    [self reportProfilingEvent:FSQCellManifestProfilingEventSize cellClass:record.cellClass startTime:startTime];
+    return size;
 }
 
-- (nullable NSArray *)insertCellRecords:(NSArray *)cellRecordsToInsert
-                            atIndexPath:(NSIndexPath *)indexPath
-                     managedViewUpdates:(nullable void(^)(NSArray *insertedIndexPaths))managedViewUpdates {
-    
-    /**  Check parameters  **/
-    
-    if ([cellRecordsToInsert count] <= 0) {
-        return nil;
+- (CGSize)sizeForRecord:(nullable FSQCellRecord *)record maximumSize:(CGSize)maximumSize usingBlock:(CGSize (^)(void))sizeBlock {
+    if (!_recordSizeCache || !record) {
+        return [self measureRecord:record usingBlock:sizeBlock];
     }
     
-    FSQSectionRecord *sectionRecord = [self sectionRecordAtIndex:indexPath.section];
-    if (!sectionRecord) {
-        return nil;
+    FSQCellManifestCachedSize *cachedSize = [_recordSizeCache objectForKey:record];
+    if (cachedSize && CGSizeEqualToSize(cachedSize->_maximumSize, maximumSize)) {
+        ++_recordSizeCacheHitCount;
+        return cachedSize->_size;
     }
     
-    NSInteger row = [self rowOrItemIndexForIndexPath:indexPath];
-    NSInteger numberOfCellRecords = [sectionRecord numberOfCellRecords];
+    ++_recordSizeCacheMissCount;
+    CGSize size = [self measureRecord:record usingBlock:sizeBlock];
     
-    if (row > numberOfCellRecords || row < 0) {
-        return nil;
+    if (!cachedSize) {
+        cachedSize = [FSQCellManifestCachedSize new];
+        [_recordSizeCache setObject:cachedSize forKey:record];
     }
+    cachedSize->_maximumSize = maximumSize;
+    cachedSize->_size = size;
     
-    /**  Inform delegates  **/
-    
-    [self withEachPluginAndDelegate:^(id delegate) {
-        if ([delegate respondsToSelector:@selector(manifest:willInsertCellRecords:atIndexPath:)]) {
-            [delegate manifest:self willInsertCellRecords:cellRecordsToInsert atIndexPath:indexPath];
-        }
-    }];
-    
-    /**  Do work  **/
-    
-    NSIndexSet *insertedIndexes = [NSIndexSet indexSetWithIndexesInRange:NSMakeRange(row, [cellRecordsToInsert count])];
-    NSMutableArray *updatedCellRecords = [sectionRecord.cellRecords mutableCopy];
-    [updatedCellRecords insertObjects:cellRecordsToInsert atIndexes:insertedIndexes];
-    [sectionRecord setCellRecords:updatedCellRecords];
-    NSMutableArray *insertedIndexPathsMutable = [NSMutableArray new];
-    [insertedIndexes enumerateIndexesUsingBlock:^(NSUInteger idx, BOOL *stop) {
-        [insertedIndexPathsMutable addObject:[self indexPathForRowOrItem:idx inSection:indexPath.section]];
-    }];
-    
-    NSArray *insertedIndexPaths = [insertedIndexPathsMutable copy];
-    
-    if (managedViewUpdates && _automaticallyUpdateManagedView) {
-        managedViewUpdates(insertedIndexPaths);
+    return size;
+}
+
+- (void)invalidateSizesForRecords:(NSArray<FSQCellRecord *> *)records {
+    NSArray<NSIndexPath *> *indexPaths = [self removeCachedSizesForRecords:records];
+    if (!_recordSizeCache) {
+        return;
     }
     
-    /**  Inform delegates  **/
+    /**  Inform plugins  **/
     
-    [self withEachPluginAndDelegate:^(id delegate) {
-        if ([delegate respondsToSelector:@selector(manifest:didInsertCellRecords:atIndexPaths:)]) {
-            [delegate manifest:self didInsertCellRecords:cellRecordsToInsert atIndexPaths:insertedIndexPaths];
+    // Plugins such as FSQCellManifestCollectionViewLayout keep their own copies of record sizes
+    [self withEachPlugin:^(id<FSQCellManifestPlugin> plugin) {
+        if ([plugin respondsToSelector:@selector(manifest:didInvalidateSizesForRecordsAtIndexPaths:)]) {
+            [plugin manifest:self didInvalidateSizesForRecordsAtIndexPaths:indexPaths];
         }
     }];
-    
-    return insertedIndexPaths;
-    
 }
 
-- (NSArray *)insertCellRecords:(NSArray *)cellRecordsToInsert
-                   atIndexPath:(NSIndexPath *)indexPath {
-    return [self insertCellRecords:cellRecordsToInsert atIndexPath:indexPath managedViewUpdates:nil];
+- (void)invalidateSizesForReplacedCellRecords:(NSArray<FSQCellRecord *> *)records atIndexPaths:(NSArray<NSIndexPath *> *)indexPaths {
+    if (_recordSizeCache) {
+        ++_recordSizeCacheGeneration;
+        for (FSQCellRecord *record in records) {
+            [self removeCachedSizeForRecord:record];
+        }
+    }
+    
+    // The replacements are already at these index paths, and need not be the same size as the records they replaced
+    [self recordSizesDidChangeAtIndexPaths:indexPaths];
 }
 
-- (nullable NSIndexSet *)insertSectionRecords:(NSArray *)sectionRecordsToInsert
-                                      atIndex:(NSInteger)index
-                           managedViewUpdates:(nullable void(^)(NSIndexSet *insertedIndexes))managedViewUpdates {
-    
-    /**  Check parameters  **/
-    
-    NSInteger numberOfSectionRecords = [self numberOfSectionRecords];
-    if ([sectionRecordsToInsert count] <= 0 || index > numberOfSectionRecords || index < 0) {
+// Returns the index paths of the records if they are all known, or nil otherwise.
+- (nullable NSArray<NSIndexPath *> *)removeCachedSizesForRecords:(NSArray<FSQCellRecord *> *)records {
+    if (!_recordSizeCache) {
         return nil;
     }
     
-    /**  Inform delegates  **/
+    // Any background measurements that started before now may be based on outdated records
+    ++_recordSizeCacheGeneration;
     
-    [self withEachPluginAndDelegate:^(id delegate) {
-        if ([delegate respondsToSelector:@selector(manifest:willInsertSectionRecords:atIndex:)]) {
-            [delegate manifest:self willInsertSectionRecords:sectionRecordsToInsert atIndex:index];
+    NSMutableArray<NSIndexPath *> *indexPaths = (self.maintainsRecordIndex ? [NSMutableArray new] : nil);
+    for (FSQCellRecord *record in records) {
+        [self removeCachedSizeForRecord:record];
+        
+        if (indexPaths) {
+            NSIndexPath *indexPath = [self indexPathForCellRecord:record];
+            if (indexPath) {
+                [indexPaths addObject:indexPath];
+            }
+            else {
+                // Headers, footers and records that are not in the manifest can't be located cheaply
+                indexPaths = nil;
+            }
         }
-    }];
-    
-    /**  Do work  **/
-    
-    NSIndexSet *insertedIndexes = [NSIndexSet indexSetWithIndexesInRange:NSMakeRange(index, [sectionRecordsToInsert count])];
-    
-    NSMutableArray *updatedSectionRecords = [_sectionRecords mutableCopy];
-    [updatedSectionRecords insertObjects:sectionRecordsToInsert atIndexes:insertedIndexes];
-    
-    // Don't use setSectionRecords as that will trigger a view reload and all sorts of delegate callbacks
-    _sectionRecords = [updatedSectionRecords copy];
-    
-    if (managedViewUpdates && _automaticallyUpdateManagedView) {
-        managedViewUpdates(insertedIndexes);
     }
     
-    /**  Inform delegates  **/
-    
-    [self withEachPluginAndDelegate:^(id delegate) {
-        if ([delegate respondsToSelector:@selector(manifest:didInsertSectionRecords:atIndexes:)]) {
-            [delegate manifest:self didInsertSectionRecords:sectionRecordsToInsert atIndexes:insertedIndexes];
-        }
-    }];
+    if (indexPaths) {
+        [self recordSizesDidChangeAtIndexPaths:indexPaths];
+    }
+    else {
+        [self recordSizesDidChange];
+    }
     
-    return insertedIndexes;
+    return [indexPaths copy];
 }
 
-- (NSIndexSet *)insertSectionRecords:(NSArray *)sectionRecordsToInsert atIndex:(NSInteger)index {
-    return [self insertSectionRecords:sectionRecordsToInsert atIndex:index managedViewUpdates:nil];
+- (void)removeCachedSizeForRecord:(FSQCellRecord *)record {
+    [_recordSizeCache removeObjectForKey:record];
+    
+    // Background measurements in flight must not put back a size for this record
+    if (_recordSizeInvalidationGenerations) {
+        [_recordSizeInvalidationGenerations setObject:@(_recordSizeCacheGeneration) forKey:record];
+    }
 }
 
-- (BOOL)moveCellRecordAtIndexPath:(NSIndexPath *)initialIndexPath
-                      toIndexPath:(NSIndexPath *)targetIndexPath
-               managedViewUpdates:(nullable void(^)(void))managedViewUpdates {
-    
-    /**  Check parameters  **/
-    
-    if (initialIndexPath.section >= [self numberOfSectionRecords]
-        || targetIndexPath.section >= [self numberOfSectionRecords]
-        || initialIndexPath.section < 0
-        || targetIndexPath.section < 0
-        ) {
-        return NO;
+- (void)invalidateSizesForSectionRecords:(NSArray<FSQSectionRecord *> *)sectionRecords {
+    if (!_recordSizeCache) {
+        return;
     }
     
-    FSQSectionRecord *initialSectionRecord = [self sectionRecordAtIndex:initialIndexPath.section];
-    FSQSectionRecord *targetSectionRecord = [self sectionRecordAtIndex:targetIndexPath.section];
-    NSInteger intitialCellIndex = [self rowOrItemIndexForIndexPath:initialIndexPath];
-    NSInteger targetCellIndex = [self rowOrItemIndexForIndexPath:targetIndexPath];
-    NSInteger numberofTargetSectionRecordsAfterMove;
-    
-    if (initialIndexPath.section == targetIndexPath.section) {
-        numberofTargetSectionRecordsAfterMove = [targetSectionRecord numberOfCellRecords];
+    // These sections are leaving the manifest, and recordsDidChange already accounts for the layout change
+    ++_recordSizeCacheGeneration;
+    for (FSQSectionRecord *sectionRecord in sectionRecords) {
+        [self removeCachedSizesForSectionRecord:sectionRecord atIndex:NSNotFound indexPaths:nil];
     }
-    else {
-        numberofTargetSectionRecordsAfterMove = [targetSectionRecord numberOfCellRecords] + 1;
-    }
-    
-    if (!(intitialCellIndex < [initialSectionRecord numberOfCellRecords])
-        || targetCellIndex > numberofTargetSectionRecordsAfterMove) {
-        return NO;
+}
+
+- (void)invalidateSizesForReloadedSectionsAtIndexes:(NSIndexSet *)indexes {
+    if (!_recordSizeCache) {
+        return;
     }
     
-    /**  Inform delegates  **/
-    
-    [self withEachPluginAndDelegate:^(id delegate) {
-        if ([delegate respondsToSelector:@selector(manifest:willMoveCellRecordAtIndexPath:toIndexPath:)]) {
-            [delegate manifest:self willMoveCellRecordAtIndexPath:initialIndexPath toIndexPath:targetIndexPath];
+    ++_recordSizeCacheGeneration;
+    NSMutableArray<NSIndexPath *> *indexPaths = [NSMutableArray new];
+    [indexes enumerateIndexesUsingBlock:^(NSUInteger idx, BOOL *stop) {
+        FSQSectionRecord *sectionRecord = [self sectionRecordAtIndex:(NSInteger)idx];
+        if (sectionRecord) {
+            [self removeCachedSizesForSectionRecord:sectionRecord atIndex:(NSInteger)idx indexPaths:indexPaths];
         }
     }];
     
-    /**  Do work  **/
-    
-    NSMutableArray *mutableInitialRecords = [initialSectionRecord.cellRecords mutableCopy];
-    NSMutableArray *mutableTargetRecords;
-    if (initialSectionRecord == targetSectionRecord) {
-        mutableTargetRecords = mutableInitialRecords;
+    [self recordSizesDidChangeAtIndexPaths:indexPaths];
+}
+
+// Adds the index paths of the removed sizes to indexPaths, if given, using sectionIndex as their section.
+- (void)removeCachedSizesForSectionRecord:(FSQSectionRecord *)sectionRecord
+                                  atIndex:(NSInteger)sectionIndex
+                               indexPaths:(nullable NSMutableArray<NSIndexPath *> *)indexPaths {
+    if (sectionRecord.header) {
+        [self removeCachedSizeForRecord:sectionRecord.header];
+        if (indexPaths) {
+            [indexPaths addObject:FSQIndexPathMake(sectionIndex, kRowIndexForHeaderIndexPaths)];
+        }
     }
-    else {
-        mutableTargetRecords = [targetSectionRecord.cellRecords mutableCopy];
+    if (sectionRecord.footer) {
+        [self removeCachedSizeForRecord:sectionRecord.footer];
+        if (indexPaths) {
+            [indexPaths addObject:FSQIndexPathMake(sectionIndex, kRowIndexForFooterIndexPaths)];
+        }
     }
     
-    FSQCellRecord *record = mutableInitialRecords[intitialCellIndex];
-    [mutableInitialRecords removeObjectAtIndex:intitialCellIndex];
-    
-    // Record will always exist because we check numberOfCellRecords above and return NO if there are not enough.
-    // But if you do not include this check, the Xcode analyzer warns about possible nil insertion.
-    if (record) {
-        [mutableTargetRecords insertObject:record atIndex:targetCellIndex];
+    // Records that do not exist in a virtual section have no cached sizes, so there is no need to create them
+    [sectionRecord enumerateMaterializedCellRecordsUsingBlock:^(FSQCellRecord *cellRecord, NSUInteger index, BOOL *stop) {
+        [self removeCachedSizeForRecord:cellRecord];
+        if (indexPaths) {
+            [indexPaths addObject:FSQIndexPathMake(sectionIndex, (NSInteger)index)];
+        }
+    }];
+}
+
+- (void)invalidateSizesForRecordsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths {
+    if (!_recordSizeCache) {
+        return;
     }
     
-    [initialSectionRecord setCellRecords:mutableInitialRecords];
+    ++_recordSizeCacheGeneration;
     
-    if (initialSectionRecord != targetSectionRecord) {
-        [targetSectionRecord setCellRecords:mutableTargetRecords];
+    for (NSIndexPath *indexPath in indexPaths) {
+        FSQCellRecord *record = [self cellRecordAtIndexPath:indexPath];
+        if (record) {
+            [self removeCachedSizeForRecord:record];
+        }
     }
     
-    if (managedViewUpdates && _automaticallyUpdateManagedView) {
-        managedViewUpdates();
+    [self recordSizesDidChangeAtIndexPaths:indexPaths];
+}
+
+- (void)invalidateAllRecordSizes {
+    if (!_recordSizeCache) {
+        return;
     }
     
-    /**  Inform delegates  **/
+    ++_recordSizeCacheGeneration;
+    _recordSizeCacheClearGeneration = _recordSizeCacheGeneration;
+    [_recordSizeCache removeAllObjects];
+    [_recordSizeInvalidationGenerations removeAllObjects];
+    [self recordSizesDidChange];
     
-    [self withEachPluginAndDelegate:^(id delegate) {
-        if ([delegate respondsToSelector:@selector(manifest:didMoveCellRecordAtIndexPath:toIndexPath:)]) {
-            [delegate manifest:self didMoveCellRecordAtIndexPath:initialIndexPath toIndexPath:targetIndexPath];
+    /**  Inform plugins  **/
+    
+    [self withEachPlugin:^(id<FSQCellManifestPlugin> plugin) {
+        if ([plugin respondsToSelector:@selector(manifest:didInvalidateSizesForRecordsAtIndexPaths:)]) {
+            [plugin manifest:self didInvalidateSizesForRecordsAtIndexPaths:nil];
         }
     }];
-    
-    return YES;
-}
-
-- (BOOL)moveCellRecordAtIndexPath:(NSIndexPath *)initialIndexPath toIndexPath:(NSIndexPath *)targetIndexPath {
-    return [self moveCellRecordAtIndexPath:initialIndexPath toIndexPath:targetIndexPath managedViewUpdates:nil];
 }
 
-- (BOOL)moveSectionRecordAtIndex:(NSInteger)initialIndex
-                         toIndex:(NSInteger)targetIndex
-              managedViewUpdates:(nullable void(^)(void))managedViewUpdates {
-    
-    /**  Check parameters  **/
-    
-    if (initialIndex >= [self numberOfSectionRecords]
-        || targetIndex >= [self numberOfSectionRecords]
-        || initialIndex < 0
-        || targetIndex < 0) {
-        return NO;
+- (void)updateCachedSizesForChangeset:(FSQCellManifestChangeset *)changeset {
+    if (!_recordSizeCache) {
+        return;
     }
     
-    /**  Inform delegates  **/
+    if ([changeset hasChanges]) {
+        NSArray<FSQSectionRecord *> *originalSectionRecords = changeset.originalSectionRecords;
+        [self invalidateSizesForSectionRecords:[originalSectionRecords objectsAtIndexes:changeset.deletedSectionIndexes]];
+        [self invalidateSizesForSectionRecords:[originalSectionRecords objectsAtIndexes:changeset.reloadedSectionIndexes]];
+        [self invalidateSizesForRecordsAtIndexPaths:changeset.deletedIndexPaths];
+        [self invalidateSizesForRecordsAtIndexPaths:changeset.reloadedIndexPaths];
+        [self invalidateSizesForRecordsAtIndexPaths:changeset.movedInitialIndexPaths];
+    }
     
-    [self withEachPluginAndDelegate:^(id delegate) {
-        if ([delegate respondsToSelector:@selector(manifest:willMoveSectionRecordAtIndex:toIndex:)]) {
-            [delegate manifest:self willMoveSectionRecordAtIndex:initialIndex toIndex:targetIndex];
+    // Sizes are cached by record identity, so equal records built fresh for setSectionRecords:animated: would
+    // otherwise all be measured again
+    [changeset enumerateUnchangedRecordsUsingBlock:^(FSQCellRecord *originalRecord, FSQCellRecord *record) {
+        FSQCellManifestCachedSize *originalCachedSize = [self->_recordSizeCache objectForKey:originalRecord];
+        if (originalCachedSize && ![self->_recordSizeCache objectForKey:record]) {
+            FSQCellManifestCachedSize *cachedSize = [FSQCellManifestCachedSize new];
+            cachedSize->_maximumSize = originalCachedSize->_maximumSize;
+            cachedSize->_size = originalCachedSize->_size;
+            [self->_recordSizeCache setObject:cachedSize forKey:record];
         }
     }];
+}
+
+// Called after records are added to or removed from the size cache in bulk.
+// Not called for the individual sizes measured when the managed view asks for them.
+- (void)recordSizesDidChange {
+    // Subclasses can override
+}
+
+// Called instead of recordSizesDidChange when the records whose sizes changed are known to be at these index paths.
+// Header and footer index paths use kRowIndexForHeaderIndexPaths and kRowIndexForFooterIndexPaths.
+- (void)recordSizesDidChangeAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths {
+    [self recordSizesDidChange];
+}
+
+#pragma mark - Background Size Precomputation
+
+// Subclasses override these four methods to describe how their records are measured.
+// Only threadSafeSizeForModel:cellClass:record:maximumSize:indexPath: is called off the main thread, and it must not
+// read the record's properties, which may be set on the main thread at the same time.
+
+- (BOOL)recordSupportsThreadSafeSizing:(FSQCellRecord *)record {
+    return NO;
+}
+
+- (CGSize)maximumSizeForPrecomputingRecord:(FSQCellRecord *)record atIndexPath:(nullable NSIndexPath *)indexPath {
+    return CGSizeZero;
+}
+
+- (CGSize)threadSafeSizeForModel:(id)model cellClass:(Class)cellClass record:(FSQCellRecord *)record maximumSize:(CGSize)maximumSize indexPath:(NSIndexPath *)indexPath {
+    return CGSizeZero;
+}
+
+- (NSArray<NSIndexPath *> *)indexPathsForVisibleRecords {
+    return @[];
+}
+
+- (void)setPrecomputesSizesInBackground:(BOOL)precomputesSizesInBackground {
+    _precomputesSizesInBackground = precomputesSizesInBackground;
     
-    /**  Do work  **/
-    
-    NSMutableArray *mutableSectionRecords = [_sectionRecords mutableCopy];
-    FSQSectionRecord *record = [mutableSectionRecords objectAtIndex:initialIndex];
-    [mutableSectionRecords removeObjectAtIndex:initialIndex];
-    [mutableSectionRecords insertObject:record atIndex:targetIndex];
-    
-    // Don't use setSectionRecords as that will trigger a view reload
-    _sectionRecords = [mutableSectionRecords copy];
-    
-    if (managedViewUpdates && _automaticallyUpdateManagedView) {
-        managedViewUpdates();
+    if (precomputesSizesInBackground) {
+        self.cachesRecordSizes = YES;
+        [self scheduleAutomaticSizePrecomputation];
+    }
+}
+
+// Subclasses overriding this must call super.
+- (void)recordsDidChange {
+    [super recordsDidChange];
+    ++_recordsChangeCount;
+    [self scheduleAutomaticSizePrecomputation];
+}
+
+- (void)scheduleAutomaticSizePrecomputation {
+    if (!_precomputesSizesInBackground || _automaticSizePrecomputationScheduled) {
+        return;
     }
     
-    /**  Inform delegates  **/
-    
-    [self withEachPluginAndDelegate:^(id delegate) {
-        if ([delegate respondsToSelector:@selector(manifest:didMoveSectionRecordAtIndex:toIndex:)]) {
-            [delegate manifest:self didMoveSectionRecordAtIndex:initialIndex toIndex:targetIndex];
+    // Wait for the current run loop pass so that several mutations in a row only trigger one pass,
+    // and so that the managed view has laid out its visible cells (which it measures itself).
+    _automaticSizePrecomputationScheduled = YES;
+    __weak typeof(self) weakSelf = self;
+    dispatch_async(dispatch_get_main_queue(), ^{
+        __strong typeof(weakSelf) strongSelf = weakSelf;
+        if (strongSelf) {
+            strongSelf->_automaticSizePrecomputationScheduled = NO;
+            if (strongSelf->_precomputesSizesInBackground) {
+                [strongSelf precomputeSizesIncludingVisibleRecords:NO completion:nil];
+            }
         }
-    }];
-    
-    return YES;
+    });
 }
 
-- (BOOL)moveSectionRecordAtIndex:(NSInteger)initialIndex toIndex:(NSInteger)targetIndex {
-    return [self moveSectionRecordAtIndex:initialIndex toIndex:targetIndex managedViewUpdates:nil];
+- (void)precomputeSizesWithCompletion:(nullable void (^)(void))completion {
+    self.cachesRecordSizes = YES;
+    [self precomputeSizesIncludingVisibleRecords:YES completion:completion];
 }
 
-- (nullable NSArray *)removeCellRecordsAtIndexPaths:(NSArray *)indexPaths
-                                removeEmptySections:(BOOL)shouldRemoveEmptySections
-                                 managedViewUpdates:(nullable void(^)(NSArray *removedIndexPaths, NSIndexSet *removedSectionIndexes))managedViewUpdates {
+- (void)precomputeSizesIncludingVisibleRecords:(BOOL)includeVisibleRecords completion:(nullable void (^)(void))completion {
+    NSAssert([NSThread isMainThread], @"Size precomputation must be started from the main thread");
     
     /**  Check parameters  **/
     
-    if ([indexPaths count] <= 0) {
-        return nil;
-    }
-    
-    /**  Inform delegates  **/
-    
-    [self withEachPluginAndDelegate:^(id delegate) {
-        if ([delegate respondsToSelector:@selector(manifest:willRemoveCellRecordsAtIndexPaths:removingEmptySections:)]) {
-            [delegate manifest:self willRemoveCellRecordsAtIndexPaths:indexPaths removingEmptySections:shouldRemoveEmptySections];
+    if (!_recordSizeCache
+        || [self delegateRespondsToSelector:@selector(sizeForCellAtIndexPath:withManifest:record:maximumSize:)]) {
+        if (completion) {
+            completion();
         }
-    }];
+        return;
+    }
     
     /**  Do work  **/
     
-    NSMutableDictionary *cellIndexesToRemoveBySection = [NSMutableDictionary new];
-    
-    NSInteger numberOfSections = [self numberOfSectionRecords];
+    FSQCellManifestSizePrecomputation *precomputation = [FSQCellManifestSizePrecomputation new];
+    precomputation->_includesVisibleRecords = includeVisibleRecords;
+    precomputation->_visibleIndexPaths = (includeVisibleRecords ? nil : [NSSet setWithArray:[self indexPathsForVisibleRecords]]);
+    precomputation->_completion = [completion copy];
+    precomputation->_recordsChangeCount = _recordsChangeCount;
+    precomputation->_cellIndex = kRowIndexForHeaderIndexPaths;
     
-    // Store index data in a more useful structure
-    for (NSIndexPath *indexPath in indexPaths) {
-        if (indexPath.section < numberOfSections && indexPath.section >= 0) {
-            NSInteger cellIndexToRemove = [self rowOrItemIndexForIndexPath:indexPath];
-            if (cellIndexToRemove < [self numberOfCellRecordsInSectionAtIndex:indexPath.section]
-                && cellIndexToRemove >= 0) {
-                NSMutableIndexSet *cellIndexesToRemoveForSection = cellIndexesToRemoveBySection[@(indexPath.section)];
-                if (!cellIndexesToRemoveForSection) {
-                    cellIndexesToRemoveForSection = [NSMutableIndexSet new];
-                    cellIndexesToRemoveBySection[@(indexPath.section)] = cellIndexesToRemoveForSection;
-                }
-                
-                [cellIndexesToRemoveForSection addIndex:cellIndexToRemove];
-            }
-        }
+    [self continueSizePrecomputation:precomputation];
+}
+
+// Snapshots the next batch of records that need measuring and hands it to the background queue.
+// Only one batch is snapshotted per main run loop pass, so very large manifests never block the main thread
+// for a full walk of their records.
+- (void)continueSizePrecomputation:(FSQCellManifestSizePrecomputation *)precomputation {
+    if (!_recordSizeCache) {
+        precomputation->_scanFinished = YES;
+        [self finishSizePrecomputationIfDone:precomputation];
+        return;
     }
     
-    NSMutableArray *removedCellIndexPathsMutable = [NSMutableArray new];
-    
-    NSMutableIndexSet *sectionIndexesToRemoveMutable = nil;
-    if (shouldRemoveEmptySections) {
-        sectionIndexesToRemoveMutable = [NSMutableIndexSet new];
+    if (precomputation->_recordsChangeCount != _recordsChangeCount) {
+        // The cursor no longer points at the same records, so start again. Records measured so far are in the cache
+        // and are skipped cheaply.
+        precomputation->_recordsChangeCount = _recordsChangeCount;
+        precomputation->_sectionIndex = 0;
+        precomputation->_cellIndex = kRowIndexForHeaderIndexPaths;
     }
     
-    for (NSNumber *sectionIndexNumber in [cellIndexesToRemoveBySection allKeys]) {
-        NSInteger sectionIndex = [sectionIndexNumber integerValue];
-        NSIndexSet *cellIndexesToRemove = cellIndexesToRemoveBySection[sectionIndexNumber];
-        FSQSectionRecord *sectionRecord = [self sectionRecordAtIndex:sectionIndex];
+    NSMutableArray<FSQCellManifestSizingJob *> *jobsMutable = [NSMutableArray new];
+    
+    void (^addJob)(FSQCellRecord *, NSIndexPath *, BOOL) = ^(FSQCellRecord *record, NSIndexPath *indexPath, BOOL isHeaderOrFooter) {
+        if (![self recordSupportsThreadSafeSizing:record]) {
+            return;
+        }
         
-        // If all cells in this section are to be removed
-        if ([cellIndexesToRemove containsIndexesInRange:NSMakeRange(0, [sectionRecord numberOfCellRecords])]) {
-            if (sectionIndexesToRemoveMutable) {
-                [sectionIndexesToRemoveMutable addIndex:sectionIndex];
-                continue;
-            }
-            else {
-                [sectionRecord setCellRecords:nil];
-            }
+        CGSize maximumSize = [self maximumSizeForPrecomputingRecord:record atIndexPath:(isHeaderOrFooter ? nil : indexPath)];
+        FSQCellManifestCachedSize *cachedSize = [self->_recordSizeCache objectForKey:record];
+        if (cachedSize && CGSizeEqualToSize(cachedSize->_maximumSize, maximumSize)) {
+            return;
+        }
+        
+        FSQCellManifestSizingJob *job = [FSQCellManifestSizingJob new];
+        job->_record = record;
+        job->_model = record.model;
+        job->_cellClass = record.cellClass;
+        job->_indexPath = indexPath;
+        job->_maximumSize = maximumSize;
+        [jobsMutable addObject:job];
+    };
+    
+    NSArray<FSQSectionRecord *> *sectionRecords = self.sectionRecords;
+    NSInteger sectionCount = (NSInteger)[sectionRecords count];
+    NSUInteger scannedCount = 0;
+    while (precomputation->_sectionIndex < sectionCount
+           && scannedCount < kFSQCellManifestSizePrecomputationBatchSize) {
+        NSInteger sectionIndex = precomputation->_sectionIndex;
+        FSQSectionRecord *sectionRecord = sectionRecords[sectionIndex];
+        NSInteger cellCount = [sectionRecord numberOfCellRecords];
+        
+        if (precomputation->_cellIndex == kRowIndexForHeaderIndexPaths) {
+            if (sectionRecord.header) {
+                addJob(sectionRecord.header, FSQIndexPathMake(sectionIndex, kRowIndexForHeaderIndexPaths), YES);
+            }
+            precomputation->_cellIndex = 0;
+        }
+        else if (precomputation->_cellIndex == 0
+                 && cellCount > 0
+                 && [sectionRecord isKindOfClass:[FSQVirtualSectionRecord class]]) {
+            // Only the records of a virtual section that already exist are measured, so that precomputation never
+            // creates every page. There are only about materializedCellRecordLimit of them.
+            [sectionRecord enumerateMaterializedCellRecordsUsingBlock:^(FSQCellRecord *cellRecord, NSUInteger index, BOOL *stop) {
+                NSIndexPath *indexPath = FSQIndexPathMake(sectionIndex, (NSInteger)index);
+                if (![precomputation->_visibleIndexPaths containsObject:indexPath]) {
+                    addJob(cellRecord, indexPath, NO);
+                }
+            }];
+            precomputation->_cellIndex = cellCount;
+        }
+        else if (precomputation->_cellIndex < cellCount) {
+            NSIndexPath *indexPath = FSQIndexPathMake(sectionIndex, precomputation->_cellIndex);
+            if (![precomputation->_visibleIndexPaths containsObject:indexPath]) {
+                addJob([sectionRecord cellRecordAtIndex:precomputation->_cellIndex], indexPath, NO);
+            }
+            ++precomputation->_cellIndex;
         }
         else {
-            NSMutableArray *mutableCellRecords = [sectionRecord.cellRecords mutableCopy];
-            [mutableCellRecords removeObjectsAtIndexes:cellIndexesToRemove];
-            [sectionRecord setCellRecords:mutableCellRecords];
+            if (sectionRecord.footer) {
+                addJob(sectionRecord.footer, FSQIndexPathMake(sectionIndex, kRowIndexForFooterIndexPaths), YES);
+            }
+            ++precomputation->_sectionIndex;
+            precomputation->_cellIndex = kRowIndexForHeaderIndexPaths;
         }
-        
-        [cellIndexesToRemove enumerateIndexesUsingBlock:^(NSUInteger idx, BOOL *stop) {
-            [removedCellIndexPathsMutable addObject:[self indexPathForRowOrItem:idx inSection:sectionIndex]];
-        }];
+        ++scannedCount;
     }
-    // NOTE: We have to make sure sectionIndexesToRemove is not nil
-    // because we must let sectionIndexesToRemove pass nil check so
-    // that managedViewUpdates will be executed, otherwise UI won't be updated
-    NSIndexSet *sectionIndexesToRemove = [sectionIndexesToRemoveMutable copy] ?: [NSIndexSet new];
-    NSArray *removedCellIndexPaths = [removedCellIndexPathsMutable copy];
     
-    if (sectionIndexesToRemove) {
-        [self removeSectionRecordsAtIndexes:sectionIndexesToRemove shouldInformDelegates:NO managedViewUpdates:nil];
-        
-        if (managedViewUpdates && _automaticallyUpdateManagedView) {
-            managedViewUpdates(removedCellIndexPaths, sectionIndexesToRemove);
+    NSArray<FSQCellManifestSizingJob *> *jobs = [jobsMutable copy];
+    
+    if ([jobs count] > 0) {
+        ++precomputation->_batchesInFlight;
+        ++_sizePrecomputationBatchesInFlight;
+        if (!_recordSizeInvalidationGenerations) {
+            _recordSizeInvalidationGenerations = [NSMapTable mapTableWithKeyOptions:(NSPointerFunctionsWeakMemory | NSPointerFunctionsObjectPointerPersonality)
+                                                                      valueOptions:NSPointerFunctionsStrongMemory];
         }
+        
+        NSUInteger generation = _recordSizeCacheGeneration;
+        NSUInteger recordsChangeCount = _recordsChangeCount;
+        dispatch_queue_t measurementQueue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+        
+        dispatch_async(measurementQueue, ^{
+            dispatch_apply([jobs count], measurementQueue, ^(size_t jobIndex) {
+                FSQCellManifestSizingJob *job = jobs[jobIndex];
+                job->_size = [self threadSafeSizeForModel:job->_model cellClass:job->_cellClass record:job->_record maximumSize:job->_maximumSize indexPath:job->_indexPath];
+            });
+            
+            dispatch_async(dispatch_get_main_queue(), ^{
+                if (![self publishSizingJobs:jobs generation:generation recordsChangeCount:recordsChangeCount]) {
+                    precomputation->_needsRetry = YES;
+                }
+                
+                --precomputation->_batchesInFlight;
+                if (--self->_sizePrecomputationBatchesInFlight == 0) {
+                    self->_recordSizeInvalidationGenerations = nil;
+                }
+                [self finishSizePrecomputationIfDone:precomputation];
+            });
+        });
     }
     
-    /**  Inform delegates  **/
+    if (precomputation->_sectionIndex < sectionCount) {
+        dispatch_async(dispatch_get_main_queue(), ^{
+            [self continueSizePrecomputation:precomputation];
+        });
+    }
+    else {
+        precomputation->_scanFinished = YES;
+        [self finishSizePrecomputationIfDone:precomputation];
+    }
+}
+
+- (void)finishSizePrecomputationIfDone:(FSQCellManifestSizePrecomputation *)precomputation {
+    if (!precomputation->_scanFinished
+        || precomputation->_batchesInFlight > 0) {
+        return;
+    }
     
-    [self withEachPluginAndDelegate:^(id delegate) {
-        if ([delegate respondsToSelector:@selector(manifest:didRemoveCellRecordsAtIndexPaths:removedEmptySectionsAtIndexes:)]) {
-            [delegate manifest:self didRemoveCellRecordsAtIndexPaths:removedCellIndexPaths removedEmptySectionsAtIndexes:sectionIndexesToRemove];
+    if (precomputation->_needsRetry && _recordSizeCache) {
+        if (precomputation->_includesVisibleRecords) {
+            // Explicit requests promise that everything has been measured when the completion block is called,
+            // so the records whose results were thrown away are measured again
+            precomputation->_needsRetry = NO;
+            precomputation->_scanFinished = NO;
+            precomputation->_sectionIndex = 0;
+            precomputation->_cellIndex = kRowIndexForHeaderIndexPaths;
+            [self continueSizePrecomputation:precomputation];
+            return;
         }
-    }];
+        else {
+            [self scheduleAutomaticSizePrecomputation];
+        }
+    }
     
-    return [removedCellIndexPaths copy];
+    void (^completion)(void) = precomputation->_completion;
+    precomputation->_completion = nil;
+    if (completion) {
+        completion();
+    }
 }
 
-- (NSArray *)removeCellRecordsAtIndexPaths:(NSArray *)indexPaths
-                       removeEmptySections:(BOOL)shouldRemoveEmptySections {
-    return [self removeCellRecordsAtIndexPaths:indexPaths removeEmptySections:shouldRemoveEmptySections managedViewUpdates:nil];
+// Returns NO if any of the results were thrown away because their records were invalidated while being measured.
+- (BOOL)publishSizingJobs:(NSArray<FSQCellManifestSizingJob *> *)jobs generation:(NSUInteger)generation recordsChangeCount:(NSUInteger)recordsChangeCount {
+    if (!_recordSizeCache) {
+        return YES;
+    }
+    
+    if (_recordSizeCacheClearGeneration > generation) {
+        // The whole cache was invalidated while we were measuring, so all of these results may be stale
+        return NO;
+    }
+    
+    BOOL publishedAllJobs = YES;
+    NSMutableArray<NSIndexPath *> *publishedIndexPaths = [NSMutableArray new];
+    for (FSQCellManifestSizingJob *job in jobs) {
+        NSNumber *invalidationGeneration = [_recordSizeInvalidationGenerations objectForKey:job->_record];
+        if ((invalidationGeneration && [invalidationGeneration unsignedIntegerValue] > generation)
+            || job->_record.model != job->_model
+            || job->_record.cellClass != job->_cellClass) {
+            publishedAllJobs = NO;
+            continue;
+        }
+        
+        // Never overwrite a size that was measured on the main thread in the meantime
+        if (![_recordSizeCache objectForKey:job->_record]) {
+            FSQCellManifestCachedSize *cachedSize = [FSQCellManifestCachedSize new];
+            cachedSize->_maximumSize = job->_maximumSize;
+            cachedSize->_size = job->_size;
+            [_recordSizeCache setObject:cachedSize forKey:job->_record];
+            [publishedIndexPaths addObject:job->_indexPath];
+        }
+    }
+    
+    if ([publishedIndexPaths count] > 0) {
+        // The jobs' index paths are only still correct if the records have not been rearranged since
+        if (recordsChangeCount == _recordsChangeCount) {
+            [self recordSizesDidChangeAtIndexPaths:publishedIndexPaths];
+        }
+        else {
+            [self recordSizesDidChange];
+        }
+    }
     
+    return publishedAllJobs;
 }
 
-- (BOOL)removeSectionRecordsAtIndexes:(NSIndexSet *)indexes
-                   managedViewUpdates:(nullable void(^)(void))managedViewUpdates {
-    return [self removeSectionRecordsAtIndexes:indexes shouldInformDelegates:YES managedViewUpdates:managedViewUpdates];
+#pragma mark - Prewarming
+
+// Subclasses override this to build (or otherwise warm up) one view for a record ahead of time.
+// Subclasses that keep the views they build should keep no more than limit of them per reuse identifier.
+- (void)prewarmViewForRecord:(FSQCellRecord *)record reuseIdentifier:(NSString *)reuseIdentifier limit:(NSUInteger)limit {
 }
 
-- (BOOL)removeSectionRecordsAtIndexes:(NSIndexSet *)indexes
-                shouldInformDelegates:(BOOL)shouldInformDelegates
-                   managedViewUpdates:(nullable void(^)(void))managedViewUpdates {
-    
-    /**  Check parameters  **/
+- (void)prewarmCellsWithCount:(NSUInteger)countPerCellClass sliceBudget:(CFTimeInterval)sliceBudget completion:(nullable void (^)(void))completion {
+    NSAssert([NSThread isMainThread], @"Prewarming must be started from the main thread");
     
-    NSInteger numberOfSections = [self numberOfSectionRecords];
+    [self cancelPrewarming];
     
-    if (numberOfSections <= 0
-        || [indexes count] <= 0
-        || [indexes lastIndex] >= numberOfSections) {
-        return NO;
-    }
+    /**  Do work  **/
     
-    /**  Inform delegates  **/
-    if (shouldInformDelegates) {
-        [self withEachPluginAndDelegate:^(id delegate) {
-            if ([delegate respondsToSelector:@selector(manifest:willRemoveSectionRecordsAtIndexes:)]) {
-                [delegate manifest:self willRemoveSectionRecordsAtIndexes:indexes];
+    // One representative record per reuse identifier, in the order they first appear
+    NSMutableArray<FSQCellRecord *> *representativeRecords = [NSMutableArray new];
+    NSMutableSet<NSString *> *seenIdentifiers = [NSMutableSet new];
+    // Virtual sections only offer the records that already exist, so that prewarming never creates every page
+    for (FSQSectionRecord *sectionRecord in self.sectionRecords) {
+        [sectionRecord enumerateMaterializedCellRecordsUsingBlock:^(FSQCellRecord *record, NSUInteger index, BOOL *stop) {
+            NSString *identifier = [self reuseIdentifierForRecord:record];
+            if (identifier && ![seenIdentifiers containsObject:identifier]) {
+                [seenIdentifiers addObject:identifier];
+                [representativeRecords addObject:record];
             }
         }];
     }
     
-    /**  Do work  **/
-    
-    NSMutableArray *mutableSectionRecords = [_sectionRecords mutableCopy];
-    [mutableSectionRecords removeObjectsAtIndexes:indexes];
-    _sectionRecords = [mutableSectionRecords copy];
+    // Round robin, so that every class gets its first warm cell as early as possible
+    NSMutableArray<FSQCellRecord *> *queue = [[NSMutableArray alloc] initWithCapacity:([representativeRecords count] * countPerCellClass)];
+    for (NSUInteger i = 0; i < countPerCellClass; ++i) {
+        [queue addObjectsFromArray:representativeRecords];
+    }
     
-    if (managedViewUpdates && _automaticallyUpdateManagedView) {
-        managedViewUpdates();
+    if ([queue count] == 0) {
+        if (completion) {
+            completion();
+        }
+        return;
     }
     
-    /**  Inform delegates  **/
-    if (shouldInformDelegates) {
-        [self withEachPluginAndDelegate:^(id delegate) {
-            if ([delegate respondsToSelector:@selector(manifest:didRemoveSectionRecordsAtIndexes:)]) {
-                [delegate manifest:self didRemoveSectionRecordsAtIndexes:indexes];
-            }
-        }];
+    _prewarmingQueue = queue;
+    _prewarmingQueueIndex = 0;
+    _prewarmingSliceBudget = sliceBudget;
+    _prewarmingCountPerCellClass = countPerCellClass;
+    _prewarmingCompletion = [completion copy];
+    
+    // Work only when the main run loop is about to go idle, so prewarming never delays a frame that has work to do.
+    // Only in the default mode, so that nothing is built while the user is scrolling (UITrackingRunLoopMode).
+    __weak typeof(self) weakSelf = self;
+    _prewarmingObserver = CFRunLoopObserverCreateWithHandler(kCFAllocatorDefault, kCFRunLoopBeforeWaiting, true, 0, ^(CFRunLoopObserverRef observer, CFRunLoopActivity activity) {
+        [weakSelf prewarmNextSlice];
+    });
+    CFRunLoopAddObserver(CFRunLoopGetMain(), _prewarmingObserver, kCFRunLoopDefaultMode);
+    CFRunLoopWakeUp(CFRunLoopGetMain());
+}
+
+- (void)prewarmNextSlice {
+    CFTimeInterval deadline = CACurrentMediaTime() + _prewarmingSliceBudget;
+    NSUInteger count = [_prewarmingQueue count];
+    
+    // Always make progress, even if a single view takes longer than the budget
+    do {
+        FSQCellRecord *record = _prewarmingQueue[_prewarmingQueueIndex++];
+        NSString *identifier = [self reuseIdentifierForRecord:record];
+        if (identifier) {
+            [self prewarmViewForRecord:record reuseIdentifier:identifier limit:_prewarmingCountPerCellClass];
+        }
+    } while (_prewarmingQueueIndex < count && CACurrentMediaTime() < deadline);
+    
+    if (_prewarmingQueueIndex < count) {
+        // Doing work does not wake the run loop back up by itself, so make sure there is another idle pass
+        CFRunLoopWakeUp(CFRunLoopGetMain());
+    }
+    else {
+        void (^completion)(void) = _prewarmingCompletion;
+        [self cancelPrewarming];
+        if (completion) {
+            completion();
+        }
+    }
+}
+
+- (void)cancelPrewarming {
+    if (_prewarmingObserver) {
+        CFRunLoopObserverInvalidate(_prewarmingObserver);
+        CFRelease(_prewarmingObserver);
+        _prewarmingObserver = NULL;
     }
     
-    return YES;
+    _prewarmingQueue = nil;
+    _prewarmingQueueIndex = 0;
+    _prewarmingCompletion = nil;
 }
 
-- (BOOL)removeSectionRecordsAtIndexes:(NSIndexSet *)indexes {
-    return [self removeSectionRecordsAtIndexes:indexes managedViewUpdates:nil];
+- (void)dealloc {
+    [self cancelPrewarming];
 }
 
-- (void)replaceCellRecordsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths
-                       withCellRecords:(NSArray<FSQCellRecord *> *)newCellRecords
-                    managedViewUpdates:(nullable void(^)(NSArray<NSIndexPath *> *replacedIndexPaths))managedViewUpdates {
-    /**  Check parameters  **/
+#pragma mark - Prefetching
+
+- (void)prefetchRecordsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths {
+    [self prefetchRecordsAtIndexPaths:indexPaths cancelling:NO];
+}
+
+- (void)cancelPrefetchingRecordsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths {
+    [self prefetchRecordsAtIndexPaths:indexPaths cancelling:YES];
+}
+
+- (void)prefetchRecordsAtIndexPaths:(NSArray<NSIndexPath *> *)requestedIndexPaths cancelling:(BOOL)cancelling {
+    // Prefetch requests can arrive after the records they were made for have been removed
+    NSMutableArray<NSIndexPath *> *indexPathsMutable = [[NSMutableArray alloc] initWithCapacity:[requestedIndexPaths count]];
+    NSMutableArray<FSQCellRecord *> *recordsMutable = [[NSMutableArray alloc] initWithCapacity:[requestedIndexPaths count]];
+    for (NSIndexPath *indexPath in requestedIndexPaths) {
+        FSQCellRecord *record = [self cellRecordAtIndexPath:indexPath];
+        if (record) {
+            [indexPathsMutable addObject:indexPath];
+            [recordsMutable addObject:record];
+        }
+    }
     
-    if (!indexPaths
-        || !newCellRecords
-        || [indexPaths count] == 0
-        || [indexPaths count] != [newCellRecords count]) {
+    if ([recordsMutable count] == 0) {
         return;
     }
     
-    /**  Inform delegates  **/
-    
-    [self withEachPluginAndDelegate:^(id delegate) {
-        if ([delegate respondsToSelector:@selector(manifest:willReplaceCellRecordsAtIndexPaths:withRecords:)]) {
-            [delegate manifest:self willReplaceCellRecordsAtIndexPaths:indexPaths withRecords:newCellRecords];
-        }
-    }];
+    NSArray<NSIndexPath *> *indexPaths = [indexPathsMutable copy];
+    NSArray<FSQCellRecord *> *records = [recordsMutable copy];
     
     /**  Do work  **/
     
-    NSMutableArray<NSIndexPath *> *replacedIndexPathsMutable = [NSMutableArray new];
-    NSMutableArray<FSQCellRecord *> *replacedCellRecordsMutable = [NSMutableArray new];
-    NSMutableArray<FSQCellRecord *> *insertedCellRecordsMutable = [NSMutableArray new];
-    
-    [indexPaths enumerateObjectsUsingBlock:^(NSIndexPath *indexPath, NSUInteger parameterIndex, BOOL *stop) {
-        NSInteger sectionIndex = indexPath.section;
-        
-        if (sectionIndex >= [self numberOfSectionRecords]
-            || sectionIndex < 0) {
+    // Cell classes get one call each for the whole batch, in the order they first appear in it
+    NSMutableArray<Class> *cellClasses = [NSMutableArray new];
+    NSMapTable *indexesByCellClass = [[NSMapTable alloc] initWithKeyOptions:(NSPointerFunctionsOpaqueMemory | NSPointerFunctionsOpaquePersonality)
+                                                               valueOptions:NSPointerFunctionsStrongMemory
+                                                                   capacity:0];
+    [records enumerateObjectsUsingBlock:^(FSQCellRecord *record, NSUInteger index, BOOL *stop) {
+        FSQCellManifestCellClassInfo *info = [self infoForCellClass:record.cellClass];
+        if (!info || !(cancelling ? info->_cancelsPrefetching : info->_prefetches)) {
             return;
         }
         
-        NSInteger cellIndex = [self rowOrItemIndexForIndexPath:indexPath];
-        FSQSectionRecord *sectionRecord = [self sectionRecordAtIndex:indexPath.section];
-        
-        if (cellIndex >= [sectionRecord numberOfCellRecords]
-            || cellIndex < 0) {
-            return;
+        NSMutableIndexSet *indexes = [indexesByCellClass objectForKey:record.cellClass];
+        if (!indexes) {
+            indexes = [NSMutableIndexSet new];
+            [indexesByCellClass setObject:indexes forKey:record.cellClass];
+            [cellClasses addObject:record.cellClass];
         }
-        
-        NSMutableArray<FSQCellRecord *> *cellRecords = [sectionRecord.cellRecords mutableCopy];
-        
-        [replacedIndexPathsMutable addObject:indexPath];
-        [replacedCellRecordsMutable addObject:cellRecords[cellIndex]];
-        [insertedCellRecordsMutable addObject:newCellRecords[parameterIndex]];
-        
-        cellRecords[cellIndex] = newCellRecords[parameterIndex];
-        
-        [sectionRecord setCellRecords:cellRecords];
+        [indexes addIndex:index];
     }];
     
-    NSArray<NSIndexPath *> *replacedIndexPaths = [replacedIndexPathsMutable copy];
-    NSArray<FSQCellRecord *> *replacedCellRecords = [replacedCellRecordsMutable copy];
-    NSArray<FSQCellRecord *> *insertedCellRecords = [insertedCellRecordsMutable copy];
-    
-    if (managedViewUpdates && _automaticallyUpdateManagedView) {
-        managedViewUpdates(replacedIndexPaths);
+    for (Class<FSQCellManifestPrefetchingCellProtocol> cellClass in cellClasses) {
+        NSIndexSet *indexes = [indexesByCellClass objectForKey:cellClass];
+        NSArray<FSQCellRecord *> *classRecords = [records objectsAtIndexes:indexes];
+        NSArray<NSIndexPath *> *classIndexPaths = [indexPaths objectsAtIndexes:indexes];
+        if (cancelling) {
+            [cellClass manifest:self cancelPrefetchingForRecords:classRecords atIndexPaths:classIndexPaths];
+        }
+        else {
+            [cellClass manifest:self prefetchForRecords:classRecords atIndexPaths:classIndexPaths];
+        }
     }
     
-    /**  Inform delegates  **/
-    
-    [self withEachPluginAndDelegate:^(id delegate) {
-        if ([delegate respondsToSelector:@selector(manifest:didReplaceCellRecordsAtIndexPaths:withRecords:replacedRecords:)]) {
-            [delegate manifest:self didReplaceCellRecordsAtIndexPaths:replacedIndexPaths withRecords:insertedCellRecords replacedRecords:replacedCellRecords];
+    [records enumerateObjectsUsingBlock:^(FSQCellRecord *record, NSUInteger index, BOOL *stop) {
+        FSQCellRecordPrefetchBlock block = (cancelling ? record.onCancelPrefetch : record.onPrefetch);
+        if (block) {
+            block(indexPaths[index], self, record);
         }
     }];
+    
+    /**  Inform delegates  **/
+    
+    if (cancelling) {
+        [self withEachPluginAndDelegateRespondingToSelector:@selector(manifest:cancelPrefetchingCellsAtIndexPaths:withRecords:) block:^(id delegate) {
+            [delegate manifest:self cancelPrefetchingCellsAtIndexPaths:indexPaths withRecords:records];
+        }];
+    }
+    else {
+        [self withEachPluginAndDelegateRespondingToSelector:@selector(manifest:prefetchCellsAtIndexPaths:withRecords:) block:^(id delegate) {
+            [delegate manifest:self prefetchCellsAtIndexPaths:indexPaths withRecords:records];
+        }];
+    }
 }
 
-- (void)replaceCellRecordsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths withCellRecords:(NSArray<FSQCellRecord *> *)newCellRecords {
-    [self replaceCellRecordsAtIndexPaths:indexPaths withCellRecords:newCellRecords managedViewUpdates:nil];
+#pragma mark - Reconfiguration
+
+// Subclasses override this to return the cell the managed view is currently displaying at indexPath, if any.
+// It must not cause a new cell to be dequeued.
+- (nullable id)visibleCellAtIndexPath:(NSIndexPath *)indexPath {
+    return nil;
 }
 
-- (nullable NSIndexSet *)replaceSectionRecordsAtIndexes:(NSArray<NSNumber *> *)indexes
-                                     withSectionRecords:(NSArray<FSQSectionRecord *> *)newSectionRecords
-                                     managedViewUpdates:(nullable void(^)(NSIndexSet *replacedIndexes))managedViewUpdates {
+- (void)reconfigureCellsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths resizing:(BOOL)resizing managedViewUpdates:(nullable void(^)(NSArray<NSIndexPath *> *indexPaths))managedViewUpdates {
     
     /**  Check parameters  **/
     
-    if (!indexes
-        || !newSectionRecords
-        || [indexes count] == 0
-        || [indexes count] != [newSectionRecords count]) {
-        return nil;
-    }
-    
-    /**  Inform delegates  **/
-    
-    [self withEachPluginAndDelegate:^(id delegate) {
-        if ([delegate respondsToSelector:@selector(manifest:willReplaceSectionRecordsAtIndexes:withRecords:)]) {
-            [delegate manifest:self willReplaceSectionRecordsAtIndexes:indexes withRecords:newSectionRecords];
+    if (self.inTransaction) {
+        // Reconfigure wherever these cells end up once the transaction is committed
+        NSMutableArray<FSQCellRecord *> *cellRecords = [NSMutableArray new];
+        for (NSIndexPath *indexPath in indexPaths) {
+            FSQCellRecord *cellRecord = [self cellRecordAtIndexPath:indexPath];
+            if (cellRecord) {
+                [cellRecords addObject:cellRecord];
+            }
         }
-    }];
+        [self deferReconfigurationOfCellRecords:cellRecords resizing:resizing];
+        return;
+    }
     
     /**  Do work  **/
     
-    NSMutableArray<NSNumber *> *replacedIndexesMutable = [NSMutableArray new];
-    NSMutableIndexSet *replacedIndexSetMutable = [NSMutableIndexSet new];
-    NSMutableArray<FSQSectionRecord *> *replacedSectionRecordsMutable = [NSMutableArray new];
-    NSMutableArray<FSQSectionRecord *> *insertedSectionRecordsMutable = [NSMutableArray new];
+    NSMutableArray<NSIndexPath *> *reloadedIndexPaths = nil;
     
-    NSMutableArray<FSQSectionRecord *> *sectionRecordsMutable = [_sectionRecords mutableCopy];
-    
-    [indexes enumerateObjectsUsingBlock:^(NSNumber *sectionIndexNumber, NSUInteger parameterIndex, BOOL *stop) {
-        NSInteger sectionIndex = [sectionIndexNumber integerValue];
-        
-        if (sectionIndex >= [self numberOfSectionRecords]
-            || sectionIndex < 0) {
-            return;
+    for (NSIndexPath *indexPath in indexPaths) {
+        FSQCellRecord *record = [self cellRecordAtIndexPath:indexPath];
+        id cell = (record ? [self visibleCellAtIndexPath:indexPath] : nil);
+        if (!cell) {
+            // Cells that are not on screen are configured as usual when they are next displayed
+            continue;
         }
         
-        [replacedIndexesMutable addObject:sectionIndexNumber];
-        [replacedIndexSetMutable addIndex:sectionIndex];
-        [replacedSectionRecordsMutable addObject:sectionRecordsMutable[sectionIndex]];
-        [insertedSectionRecordsMutable addObject:newSectionRecords[parameterIndex]];
+        if (![[cell reuseIdentifier] isEqualToString:[self reuseIdentifierForRecord:record]]) {
+            // The record now needs a different kind of cell, so this one cannot be reused
+            if (!reloadedIndexPaths) {
+                reloadedIndexPaths = [NSMutableArray new];
+            }
+            [reloadedIndexPaths addObject:indexPath];
+            continue;
+        }
         
-        sectionRecordsMutable[sectionIndex] = newSectionRecords[parameterIndex];
-    }];
-    
-    _sectionRecords = [sectionRecordsMutable copy];
-    
-    NSArray<NSNumber *> *replacedIndexes = [replacedIndexesMutable copy];
-    NSIndexSet *replacedIndexSet = [replacedIndexSetMutable copy];
-    NSArray<FSQSectionRecord *> *replacedSectionRecords = [replacedSectionRecordsMutable copy];
-    NSArray<FSQSectionRecord *> *insertedSectionRecords = [insertedSectionRecordsMutable copy];
-    
-    if (managedViewUpdates && _automaticallyUpdateManagedView) {
-        managedViewUpdates(replacedIndexSet);
+        [self configureView:cell withRecord:record recordType:FSQCellRecordTypeBody atIndexPath:indexPath];
     }
     
-    /**  Inform delegates  **/
+    if (reloadedIndexPaths) {
+        [self reloadCellsAtIndexPaths:reloadedIndexPaths];
+    }
     
-    [self withEachPluginAndDelegate:^(id delegate) {
-        if ([delegate respondsToSelector:@selector(manifest:didReplaceSectionRecordsAtIndexes:withRecords:replacedRecords:)]) {
-            [delegate manifest:self didReplaceSectionRecordsAtIndexes:replacedIndexes withRecords:insertedSectionRecords replacedRecords:replacedSectionRecords];
+    if (resizing) {
+        [self invalidateSizesForRecordsAtIndexPaths:indexPaths];
+        
+        if (managedViewUpdates) {
+            managedViewUpdates(indexPaths);
         }
-    }];
-    
-    return replacedIndexSet;
+    }
+}
+
+- (void)reconfigureCellsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths resizing:(BOOL)resizing {
+    [self reconfigureCellsAtIndexPaths:indexPaths resizing:resizing managedViewUpdates:nil];
 }
 
-- (NSIndexSet *)replaceSectionRecordsAtIndexes:(NSArray<NSNumber *> *)indexes withSectionRecords:(NSArray *)newSectionRecords {
-    return [self replaceSectionRecordsAtIndexes:indexes withSectionRecords:newSectionRecords managedViewUpdates:nil];
+- (void)reconfigureCellsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths {
+    [self reconfigureCellsAtIndexPaths:indexPaths resizing:NO];
 }
 
-- (void)reloadManagedViewWithUpdates:(nullable void(^)(void))managedViewUpdates {
+- (void)reconfigureCellRecords:(NSArray<FSQCellRecord *> *)cellRecords resizing:(BOOL)resizing {
     
-    /**  Inform delegates  **/
+    /**  Check parameters  **/
     
-    [self withEachPluginAndDelegate:^(id delegate) {
-        if ([delegate respondsToSelector:@selector(manifestWillReloadManagedView:)]) {
-            [delegate manifestWillReloadManagedView:self];
-        }
-    }];
+    if ([cellRecords count] == 0) {
+        return;
+    }
+    
+    if (self.inTransaction) {
+        [self deferReconfigurationOfCellRecords:cellRecords resizing:resizing];
+        return;
+    }
     
     /**  Do work  **/
     
-    if (managedViewUpdates) {
-        managedViewUpdates();
+    // Only visible cells need configuring, so there is no need to search every section for the records
+    NSHashTable<FSQCellRecord *> *recordTable = [NSHashTable hashTableWithOptions:(NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality)];
+    for (FSQCellRecord *cellRecord in cellRecords) {
+        [recordTable addObject:cellRecord];
     }
     
-    /**  Inform delegates  **/
-    
-    [self withEachPluginAndDelegate:^(id delegate) {
-        if ([delegate respondsToSelector:@selector(manifestDidReloadManagedView:)]) {
-            [delegate manifestDidReloadManagedView:self];
+    NSMutableArray<NSIndexPath *> *indexPaths = [NSMutableArray new];
+    for (NSIndexPath *indexPath in [self indexPathsForVisibleRecords]) {
+        FSQCellRecord *cellRecord = [self cellRecordAtIndexPath:indexPath];
+        if (cellRecord && [recordTable containsObject:cellRecord]) {
+            [indexPaths addObject:indexPath];
         }
-    }];
+    }
+    
+    if (resizing) {
+        // Records that are not visible may still have a cached size
+        [self invalidateSizesForRecords:cellRecords];
+    }
+    
+    [self reconfigureCellsAtIndexPaths:indexPaths resizing:resizing];
 }
 
-- (void)reloadManagedView {
-    [self reloadManagedViewWithUpdates:nil];
+- (void)reconfigureCellRecords:(NSArray<FSQCellRecord *> *)cellRecords {
+    [self reconfigureCellRecords:cellRecords resizing:NO];
 }
 
-- (void)reloadSectionsAtIndexes:(NSIndexSet *)indexes managedViewUpdates:(nullable void(^)(NSIndexSet *indexes))managedViewUpdates {
-    
-    /**  Inform delegates  **/
-    
-    [self withEachPluginAndDelegate:^(id delegate) {
-        if ([delegate respondsToSelector:@selector(manifest:willReloadSectionsAtIndexes:)]) {
-            [delegate manifest:self willReloadSectionsAtIndexes:indexes];
-        }
-    }];
-    
-    /**  Do work  **/
+#pragma mark - Reuse Identifiers
+
+// Cells are requested constantly while scrolling, and the vast majority of records use their cell class's name as
+// their reuse identifier. Rather than build that name and look it up in the registration maps for every cell, the
+// manifest keeps one interned identifier per class and remembers once it has been registered.
+//
+// The same per-class info holds the protocol conformances and sizing/configure IMPs needed on every layout pass,
+// since conformsToProtocol: walks the class hierarchy each time it is called.
+
+- (nullable FSQCellManifestCellClassInfo *)infoForCellClass:(nullable Class)cellClass {
+    if (!cellClass) {
+        return nil;
+    }
     
-    if (managedViewUpdates) {
-        managedViewUpdates(indexes);
+    // Consecutive cells are usually of the same class
+    if (cellClass == _lastCellClass) {
+        return _lastCellClassInfo;
     }
     
-    /**  Inform delegates  **/
+    FSQCellManifestCellClassInfo *info = (__bridge FSQCellManifestCellClassInfo *)NSMapGet(_cellClassInfoByClass, (__bridge const void *)cellClass);
     
-    [self withEachPluginAndDelegate:^(id delegate) {
-        if ([delegate respondsToSelector:@selector(manifest:didReloadSectionsAtIndexes:)]) {
-            [delegate manifest:self didReloadSectionsAtIndexes:indexes];
+    if (!info) {
+        info = [FSQCellManifestCellClassInfo new];
+        info->_reuseIdentifier = NSStringFromClass(cellClass);
+        
+        if ([cellClass conformsToProtocol:@protocol(FSQCellManifestCellProtocol)]) {
+            info->_configureIMP = (FSQCellManifestConfigureIMP)[cellClass instanceMethodForSelector:@selector(manifest:configureWithModel:indexPath:record:)];
         }
-    }];
+        
+        if ([cellClass conformsToProtocol:@protocol(FSQCellManifestTableViewCellProtocol)]) {
+            info->_heightIMP = (FSQCellManifestHeightIMP)[cellClass methodForSelector:@selector(manifest:heightForModel:maximumSize:indexPath:record:)];
+            info->_threadSafeTableViewSizing = [cellClass conformsToProtocol:@protocol(FSQCellManifestThreadSafeTableViewCellProtocol)];
+        }
+        
+        if ([cellClass conformsToProtocol:@protocol(FSQCellManifestCollectionViewCellProtocol)]) {
+            info->_sizeIMP = (FSQCellManifestSizeIMP)[cellClass methodForSelector:@selector(manifest:sizeForModel:maximumSize:indexPath:record:)];
+            info->_threadSafeCollectionViewSizing = [cellClass conformsToProtocol:@protocol(FSQCellManifestThreadSafeCollectionViewCellProtocol)];
+        }
+        
+        if ([cellClass conformsToProtocol:@protocol(FSQCellManifestPrefetchingCellProtocol)]) {
+            info->_prefetches = [cellClass respondsToSelector:@selector(manifest:prefetchForRecords:atIndexPaths:)];
+            info->_cancelsPrefetching = [cellClass respondsToSelector:@selector(manifest:cancelPrefetchingForRecords:atIndexPaths:)];
+        }
+        
+        NSMapInsertKnownAbsent(_cellClassInfoByClass, (__bridge const void *)cellClass, (__bridge void *)info);
+    }
+    
+    _lastCellClass = cellClass;
+    _lastCellClassInfo = info;
+    return info;
 }
 
-- (void)reloadSectionsAtIndexes:(NSIndexSet *)indexes {
-    [self reloadSectionsAtIndexes:indexes managedViewUpdates:nil];
+- (nullable NSString *)reuseIdentifierForRecord:(nullable FSQCellRecord *)record {
+    NSString *identifier = [record explicitReuseIdentifier];
+    if (identifier) {
+        return identifier;
+    }
+    
+    FSQCellManifestCellClassInfo *info = [self infoForCellClass:record.cellClass];
+    return (info ? info->_reuseIdentifier : nil);
 }
 
-- (void)reloadCellsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths managedViewUpdates:(nullable void(^)(NSArray *indexPaths))managedViewUpdates {
-    
-    /**  Inform delegates  **/
+- (void)registerReuseIdentifier:(NSString *)identifier forRecord:(FSQCellRecord *)record recordType:(FSQCellRecordType)recordType {
+    Class cellClass = record.cellClass;
+    if (!cellClass) {
+        @throw ([NSException exceptionWithName:NSInvalidArgumentException
+                                        reason:[NSString stringWithFormat:@"Tried to register identifier %@ for a record without a cellClass. Delegate: %@", identifier, self.delegate]
+                                      userInfo:nil]);
+    }
     
-    [self withEachPluginAndDelegate:^(id delegate) {
-        if ([delegate respondsToSelector:@selector(manifest:willReloadCellsAtIndexPaths:)]) {
-            [delegate manifest:self willReloadCellsAtIndexPaths:indexPaths];
-        }
-    }];
+    FSQCellManifestCellClassInfo *info = [self infoForCellClass:cellClass];
+    NSUInteger recordTypeBit = ((NSUInteger)1 << recordType);
     
-    /**  Do work  **/
+    // Records with their own identifiers are rare enough to always go through the registration maps
+    BOOL usesClassIdentifier = (identifier == info->_reuseIdentifier);
     
-    if (managedViewUpdates) {
-        managedViewUpdates(indexPaths);
+    if (usesClassIdentifier && (info->_registeredRecordTypes & recordTypeBit)) {
+        return;
     }
     
-    /**  Inform delegates  **/
+    // Throws if a different class was already registered for this identifier
+    [self registerIdentifier:identifier forCellClass:cellClass recordType:recordType];
     
-    [self withEachPluginAndDelegate:^(id delegate) {
-        if ([delegate respondsToSelector:@selector(manifest:didReloadCellsAtIndexPaths:)]) {
-            [delegate manifest:self didReloadCellsAtIndexPaths:indexPaths];
-        }
-    }];
-}
-
-- (void)reloadCellsAtIndexPaths:(NSArray *)indexPaths {
-    [self reloadCellsAtIndexPaths:indexPaths managedViewUpdates:nil];
+    if (usesClassIdentifier) {
+        info->_registeredRecordTypes |= recordTypeBit;
+    }
 }
 
 #pragma mark - Shared configuration
 
 - (void)configureView:(id)view withRecord:(FSQCellRecord *)record recordType:(FSQCellRecordType)recordType atIndexPath:(NSIndexPath *)indexPath {
+    CFTimeInterval startTime = [self profilingStartTime];
+    
     switch (recordType) {
         case FSQCellRecordTypeBody: {
-            [self withEachPluginAndDelegate:^(id delegate) {
-                if ([delegate respondsToSelector:@selector(manifest:willConfigureCell:withModel:atIndexPath:record:)]) {
-                    [delegate manifest:self willConfigureCell:view withModel:record.model atIndexPath:indexPath  record:record];
-                }
+            [self withEachPluginAndDelegateRespondingToSelector:@selector(manifest:willConfigureCell:withModel:atIndexPath:record:) block:^(id delegate) {
+                [delegate manifest:self willConfigureCell:view withModel:record.model atIndexPath:indexPath  record:record];
             }];
         }
             break;
         case FSQCellRecordTypeHeader: {
-            [self withEachPluginAndDelegate:^(id delegate) {
-                if ([delegate respondsToSelector:@selector(manifest:willConfigureHeader:withModel:atIndex:record:)]) {
-                    [delegate manifest:self willConfigureHeader:view withModel:record.model atIndex:indexPath.section record:record];
-                }
+            [self withEachPluginAndDelegateRespondingToSelector:@selector(manifest:willConfigureHeader:withModel:atIndex:record:) block:^(id delegate) {
+                [delegate manifest:self willConfigureHeader:view withModel:record.model atIndex:FSQIndexPathSection(indexPath) record:record];
             }];
         }
             break;
         case FSQCellRecordTypeFooter: {
-            [self withEachPluginAndDelegate:^(id delegate) {
-                if ([delegate respondsToSelector:@selector(manifest:willConfigureFooter:withModel:atIndex:record:)]) {
-                    [delegate manifest:self willConfigureFooter:view withModel:record.model atIndex:indexPath.section record:record];
-                }
+            [self withEachPluginAndDelegateRespondingToSelector:@selector(manifest:willConfigureFooter:withModel:atIndex:record:) block:^(id delegate) {
+                [delegate manifest:self willConfigureFooter:view withModel:record.model atIndex:FSQIndexPathSection(indexPath) record:record];
             }];
         }
             break;
     }
     
-    if ([view conformsToProtocol:@protocol(FSQCellManifestCellProtocol)]) {
-        [(id<FSQCellManifestCellProtocol>)view manifest:self configureWithModel:record.model indexPath:indexPath record:record];
+    FSQCellManifestCellClassInfo *viewInfo = [self infoForCellClass:[view class]];
+    if (viewInfo && viewInfo->_configureIMP) {
+        viewInfo->_configureIMP(view, @selector(manifest:configureWithModel:indexPath:record:), self, record.model, indexPath, record);
     }
     
     if (record.onConfigure) {
+        CFTimeInterval blockStartTime = [self profilingStartTime];
         record.onConfigure(view, indexPath, self, record);
+        [self reportProfilingEvent:FSQCellManifestProfilingEventConfigureBlock cellClass:record.cellClass startTime:blockStartTime];
     }
     
     switch (recordType) {
         case FSQCellRecordTypeBody: {
-            [self withEachPluginAndDelegate:^(id delegate) {
-                if ([delegate respondsToSelector:@selector(manifest:didConfigureCell:withModel:atIndexPath:record:)]) {
-                    [delegate manifest:self didConfigureCell:view withModel:record.model atIndexPath:indexPath record:record];
-                }
+            [self withEachPluginAndDelegateRespondingToSelector:@selector(manifest:didConfigureCell:withModel:atIndexPath:record:) block:^(id delegate) {
+                [delegate manifest:self didConfigureCell:view withModel:record.model atIndexPath:indexPath record:record];
             }];
         }
             break;
         case FSQCellRecordTypeHeader: {
-            [self withEachPluginAndDelegate:^(id delegate) {
-                if ([delegate respondsToSelector:@selector(manifest:didConfigureHeader:withModel:atIndex:record:)]) {
-                    [delegate manifest:self didConfigureHeader:view withModel:record.model atIndex:indexPath.section record:record];
-                }
+            [self withEachPluginAndDelegateRespondingToSelector:@selector(manifest:didConfigureHeader:withModel:atIndex:record:) block:^(id delegate) {
+                [delegate manifest:self didConfigureHeader:view withModel:record.model atIndex:FSQIndexPathSection(indexPath) record:record];
             }];
         }
             break;
         case FSQCellRecordTypeFooter: {
-            [self withEachPluginAndDelegate:^(id delegate) {
-                if ([delegate respondsToSelector:@selector(manifest:didConfigureFooter:withModel:atIndex:record:)]) {
-                    [delegate manifest:self didConfigureFooter:view withModel:record.model atIndex:indexPath.section record:record];
-                }
+            [self withEachPluginAndDelegateRespondingToSelector:@selector(manifest:didConfigureFooter:withModel:atIndex:record:) block:^(id delegate) {
+                [delegate manifest:self didConfigureFooter:view withModel:record.model atIndex:FSQIndexPathSection(indexPath) record:record];
             }];
         }
             break;
     }
+    
+    [self reportProfilingEvent:FSQCellManifestProfilingEventConfigure cellClass:record.cellClass startTime:startTime];
 }
 
 - (FSQIdentifierRegistrationResult)registerIdentifier:(NSString *)identifier forCellClass:(Class)cellClass recordType:(FSQCellRecordType)recordType {
@@ -1033,36 +1415,6 @@ typedef NS_ENUM(NSInteger, FSQCellRecordType) {
     }
 }
 
-
-- (NSSet *)matchingIndexPathsForCurrentlySelectedIndexPaths:(NSArray<NSIndexPath *> *)currentlySelectedIndexPaths
-                                          newSectionRecords:(NSArray<FSQSectionRecord *> *)newSectionRecords {
-    
-    NSMutableSet *currentlySelectedRecords = [NSMutableSet new];
-    
-    for (NSIndexPath *selectedPath in currentlySelectedIndexPaths) {
-        [currentlySelectedRecords addObject:[self cellRecordAtIndexPath:selectedPath]];
-    }
-    
-    NSMutableSet *newIndexPathsToSelect = [NSMutableSet new];
-    
-    NSInteger sectionIndex = 0;
-    for (FSQSectionRecord *newSectionRecord in newSectionRecords) {
-        NSInteger cellIndex = 0;
-        for (FSQCellRecord *newCellRecord in newSectionRecord) {
-            for (FSQCellRecord *currentCellRecord in currentlySelectedRecords) {
-                if ([newCellRecord isEqualToCellRecord:currentCellRecord]) {
-                    [newIndexPathsToSelect addObject:[self indexPathForRowOrItem:cellIndex inSection:sectionIndex]];
-                    break;
-                }
-            }
-            ++cellIndex;
-        }
-        ++sectionIndex;
-    }
-    
-    return newIndexPathsToSelect;
-}
-
 - (BOOL)recordShouldHighlightAtIndexPath:(NSIndexPath *)indexPath {
     FSQCellRecord *record = [self cellRecordAtIndexPath:indexPath];
     BOOL shouldHighlight = record.allowsHighlighting;
@@ -1089,20 +1441,45 @@ typedef NS_ENUM(NSInteger, FSQCellRecordType) {
 
 @end
 
-#pragma mark End Core Manifest -
+#pragma mark End Base Manifest -
 
 #pragma mark - Begin Table View Manifest
 
 @implementation FSQTableViewCellManifest {
     NSMutableDictionary *_headerFooterIdentifierCellClassMap;
     FSQCellManifestMessageForwarderEnumerator *_tableViewDatasourceForwarderEnumerator;
+    NSMapTable *_measuredHeightAveragesByClass;
+    
+    // The offset index holds a header, the rows, and a footer for every section, in order.
+    // _offsetIndexSectionStarts[i] is the flat index of section i's header; it has one extra entry at the end.
+    // Inserted and removed rows and individually resized records are updated in place. The index is rebuilt lazily
+    // after any other change to the records or the size cache.
+    FSQCellManifestOffsetIndex *_offsetIndex;
+    NSUInteger *_offsetIndexSectionStarts;
+    NSUInteger _offsetIndexSectionCount;
+    BOOL _offsetIndexUpdatedInPlace;
+    
+    NSMutableDictionary<NSString *, NSMutableArray<UITableViewCell *> *> *_Nullable _prewarmedCellsByIdentifier;
+    NSUInteger _prewarmedCellCount;
 }
 
 - (void)setTableView:(nullable UITableView *)tableView {
     self.tableView.dataSource = nil;
+    if ([self.tableView respondsToSelector:@selector(setPrefetchDataSource:)]) {
+        self.tableView.prefetchDataSource = nil;
+    }
+    
+    if (tableView != self.tableView) {
+        [self discardPrewarmedCells];
+    }
     
     [self setManagedView:tableView];
     tableView.dataSource = _tableViewDatasourceForwarderEnumerator.messageForwarder;
+    
+    // Prefetching is only available on iOS 10 and later
+    if ([tableView respondsToSelector:@selector(setPrefetchDataSource:)]) {
+        tableView.prefetchDataSource = _tableViewDatasourceForwarderEnumerator.messageForwarder;
+    }
 }
 
 - (nullable UITableView *)tableView {
@@ -1128,29 +1505,463 @@ typedef NS_ENUM(NSInteger, FSQCellRecordType) {
         [self setTableView:tableView];
         _headerFooterIdentifierCellClassMap = [NSMutableDictionary new];
     }
-    return self;
+    return self;
+}
+
+- (void)dealloc {
+    self.tableView.dataSource = nil;
+    if ([self.tableView respondsToSelector:@selector(setPrefetchDataSource:)]) {
+        self.tableView.prefetchDataSource = nil;
+    }
+    self.tableView.delegate = nil;
+    free(_offsetIndexSectionStarts);
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+}
+
+- (void)performBatchRecordModificationUpdates:(nullable void (^)(void))updates {
+    
+    if (updates) {
+        [self.tableView beginUpdates];
+        updates();
+        [self.tableView endUpdates];
+    }
+}
+
+- (BOOL)recordSupportsThreadSafeSizing:(FSQCellRecord *)record {
+    FSQCellManifestCellClassInfo *info = [self infoForCellClass:record.cellClass];
+    return (info && info->_threadSafeTableViewSizing);
+}
+
+- (CGSize)maximumSizeForPrecomputingRecord:(FSQCellRecord *)record atIndexPath:(nullable NSIndexPath *)indexPath {
+    return [self maxSizeForRecord:record atIndexPath:indexPath defaultWidth:CGRectGetWidth(self.tableView.frame) defaultHeight:CGFLOAT_MAX];
+}
+
+- (CGSize)threadSafeSizeForModel:(id)model cellClass:(Class)cellClass record:(FSQCellRecord *)record maximumSize:(CGSize)maximumSize indexPath:(NSIndexPath *)indexPath {
+    // Same format as the size cache entries made by heightForRowAtIndexPath:
+    return CGSizeMake(maximumSize.width, [cellClass manifest:self heightForModel:model maximumSize:maximumSize indexPath:indexPath record:record]);
+}
+
+- (NSArray<NSIndexPath *> *)indexPathsForVisibleRecords {
+    return [self.tableView indexPathsForVisibleRows] ?: @[];
+}
+
+#pragma mark - Estimated Heights and Offsets -
+
+- (BOOL)respondsToSelector:(SEL)aSelector {
+    // UITableView changes how it lays out rows if its delegate implements any of these at all,
+    // so they are hidden from the message forwarder unless estimated heights are turned on.
+    if (aSelector == @selector(tableView:estimatedHeightForRowAtIndexPath:)
+        || aSelector == @selector(tableView:estimatedHeightForHeaderInSection:)
+        || aSelector == @selector(tableView:estimatedHeightForFooterInSection:)) {
+        return _usesEstimatedHeights;
+    }
+    
+    return [super respondsToSelector:aSelector];
+}
+
+- (void)setUsesEstimatedHeights:(BOOL)usesEstimatedHeights {
+    if (_usesEstimatedHeights == usesEstimatedHeights) {
+        return;
+    }
+    _usesEstimatedHeights = usesEstimatedHeights;
+    
+    // The forwarders have cached whether the manifest responds to the estimated height methods
+    for (FSQCellManifestMessageForwarderEnumerator *enumerator in [self messageForwarderEnumerators]) {
+        [enumerator invalidateResponderCache];
+    }
+    
+    // UITableView caches which delegate methods are implemented when its delegate is set
+    UITableView *tableView = self.tableView;
+    id<UITableViewDelegate> tableViewDelegate = tableView.delegate;
+    if (tableViewDelegate) {
+        tableView.delegate = nil;
+        tableView.delegate = tableViewDelegate;
+    }
+}
+
+- (void)recordMeasuredHeight:(CGFloat)height forCellClass:(nullable Class)cellClass {
+    if (!cellClass) {
+        return;
+    }
+    
+    if (!_measuredHeightAveragesByClass) {
+        _measuredHeightAveragesByClass = [NSMapTable mapTableWithKeyOptions:(NSPointerFunctionsOpaqueMemory | NSPointerFunctionsOpaquePersonality)
+                                                               valueOptions:NSPointerFunctionsStrongMemory];
+    }
+    
+    FSQCellManifestHeightAverage *average = [_measuredHeightAveragesByClass objectForKey:cellClass];
+    if (!average) {
+        average = [FSQCellManifestHeightAverage new];
+        [_measuredHeightAveragesByClass setObject:average forKey:cellClass];
+    }
+    average->_totalHeight += height;
+    ++average->_count;
+}
+
+- (CGFloat)estimatedHeightForRecord:(nullable FSQCellRecord *)record fallbackHeight:(CGFloat)fallbackHeight {
+    CGSize cachedSize;
+    if (record && [self getCachedSize:&cachedSize forRecord:record]) {
+        return cachedSize.height;
+    }
+    
+    FSQCellManifestHeightAverage *average = (record.cellClass ? [_measuredHeightAveragesByClass objectForKey:record.cellClass] : nil);
+    if (average && average->_count > 0) {
+        return (CGFloat)(average->_totalHeight / average->_count);
+    }
+    
+    return (fallbackHeight > 0 ? fallbackHeight : kFSQDefaultEstimatedHeight);
+}
+
+- (CGFloat)estimatedHeightForRecordAtIndexPath:(NSIndexPath *)indexPath {
+    if (indexPath.row == kRowIndexForHeaderIndexPaths || indexPath.row == kRowIndexForFooterIndexPaths) {
+        BOOL isHeader = (indexPath.row == kRowIndexForHeaderIndexPaths);
+        FSQSectionRecord *sectionRecord = [self sectionRecordAtIndex:indexPath.section];
+        FSQCellRecord *record = (isHeader ? sectionRecord.header : sectionRecord.footer);
+        
+        // Same as the real height reported by heightForHeaderOrFooter:
+        FSQCellManifestCellClassInfo *info = [self infoForCellClass:record.cellClass];
+        if (!info || !info->_heightIMP) {
+            return 0;
+        }
+        
+        return [self estimatedHeightForRecord:record fallbackHeight:(isHeader ? self.tableView.estimatedSectionHeaderHeight : self.tableView.estimatedSectionFooterHeight)];
+    }
+    else {
+        return [self estimatedHeightForRecord:[self cellRecordAtIndexPath:indexPath] fallbackHeight:self.tableView.estimatedRowHeight];
+    }
+}
+
+- (CGFloat)tableView:(UITableView *)tableView estimatedHeightForRowAtIndexPath:(NSIndexPath *)indexPath {
+    if (tableView == self.tableView) {
+        return [self estimatedHeightForRecordAtIndexPath:indexPath];
+    }
+    else {
+        return kFSQDefaultEstimatedHeight;
+    }
+}
+
+- (CGFloat)tableView:(UITableView *)tableView estimatedHeightForHeaderInSection:(NSInteger)section {
+    if (tableView == self.tableView) {
+        return [self estimatedHeightForRecordAtIndexPath:[NSIndexPath indexPathForRow:kRowIndexForHeaderIndexPaths inSection:section]];
+    }
+    else {
+        return 0;
+    }
+}
+
+- (CGFloat)tableView:(UITableView *)tableView estimatedHeightForFooterInSection:(NSInteger)section {
+    if (tableView == self.tableView) {
+        return [self estimatedHeightForRecordAtIndexPath:[NSIndexPath indexPathForRow:kRowIndexForFooterIndexPaths inSection:section]];
+    }
+    else {
+        return 0;
+    }
+}
+
+- (void)recordsDidChange {
+    [super recordsDidChange];
+    
+    if (!_offsetIndexUpdatedInPlace) {
+        _offsetIndex = nil;
+    }
+    _offsetIndexUpdatedInPlace = NO;
+}
+
+- (void)cellRecordsDidInsertInRange:(NSRange)range inSection:(NSInteger)sectionIndex {
+    [super cellRecordsDidInsertInRange:range inSection:sectionIndex];
+    
+    if (!_offsetIndex || sectionIndex < 0 || (NSUInteger)sectionIndex >= _offsetIndexSectionCount) {
+        _offsetIndex = nil;
+        return;
+    }
+    
+    double *heights = malloc(MAX(range.length, 1) * sizeof(double));
+    for (NSUInteger cellIndex = range.location; cellIndex < NSMaxRange(range); ++cellIndex) {
+        heights[cellIndex - range.location] = [self estimatedHeightForRecordAtIndexPath:[NSIndexPath indexPathForRow:(NSInteger)cellIndex inSection:sectionIndex]];
+    }
+    [_offsetIndex insertHeights:heights count:range.length atIndex:(_offsetIndexSectionStarts[sectionIndex] + 1 + range.location)];
+    free(heights);
+    
+    for (NSUInteger laterSectionIndex = (NSUInteger)sectionIndex + 1; laterSectionIndex <= _offsetIndexSectionCount; ++laterSectionIndex) {
+        _offsetIndexSectionStarts[laterSectionIndex] += range.length;
+    }
+    
+    _offsetIndexUpdatedInPlace = YES;
+}
+
+- (void)cellRecordsDidRemoveAtIndexes:(NSIndexSet *)indexes inSection:(NSInteger)sectionIndex {
+    [super cellRecordsDidRemoveAtIndexes:indexes inSection:sectionIndex];
+    
+    if (!_offsetIndex || sectionIndex < 0 || (NSUInteger)sectionIndex >= _offsetIndexSectionCount) {
+        _offsetIndex = nil;
+        return;
+    }
+    
+    NSMutableIndexSet *itemIndexes = [indexes mutableCopy];
+    [itemIndexes shiftIndexesStartingAtIndex:0 by:(NSInteger)(_offsetIndexSectionStarts[sectionIndex] + 1)];
+    [_offsetIndex removeHeightsAtIndexes:itemIndexes];
+    
+    for (NSUInteger laterSectionIndex = (NSUInteger)sectionIndex + 1; laterSectionIndex <= _offsetIndexSectionCount; ++laterSectionIndex) {
+        _offsetIndexSectionStarts[laterSectionIndex] -= [indexes count];
+    }
+    
+    _offsetIndexUpdatedInPlace = YES;
+}
+
+- (void)recordSizesDidChange {
+    [super recordSizesDidChange];
+    _offsetIndex = nil;
+}
+
+- (void)invalidateSizesForReplacedCellRecords:(NSArray<FSQCellRecord *> *)records atIndexPaths:(NSArray<NSIndexPath *> *)indexPaths {
+    [super invalidateSizesForReplacedCellRecords:records atIndexPaths:indexPaths];
+    
+    // Replacing records leaves every section the same length, so an index that survived the height updates is current
+    _offsetIndexUpdatedInPlace = (_offsetIndex != nil);
+}
+
+- (void)recordSizesDidChangeAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths {
+    // Not calling super, which treats this as a bulk change and would throw the whole index away
+    if (!_offsetIndex) {
+        return;
+    }
+    
+    for (NSIndexPath *indexPath in indexPaths) {
+        NSUInteger itemIndex = [self offsetIndexItemIndexForIndexPath:indexPath];
+        if (itemIndex == NSNotFound) {
+            _offsetIndex = nil;
+            return;
+        }
+        [_offsetIndex setHeight:[self estimatedHeightForRecordAtIndexPath:indexPath] atIndex:itemIndex];
+    }
+}
+
+- (void)buildOffsetIndexIfNeeded {
+    if (_offsetIndex) {
+        return;
+    }
+    
+    NSArray<FSQSectionRecord *> *sectionRecords = self.sectionRecords;
+    NSUInteger sectionCount = [sectionRecords count];
+    
+    free(_offsetIndexSectionStarts);
+    _offsetIndexSectionStarts = malloc((sectionCount + 1) * sizeof(NSUInteger));
+    _offsetIndexSectionCount = sectionCount;
+    
+    NSUInteger itemCount = 0;
+    for (NSUInteger sectionIndex = 0; sectionIndex < sectionCount; ++sectionIndex) {
+        _offsetIndexSectionStarts[sectionIndex] = itemCount;
+        itemCount += [sectionRecords[sectionIndex] numberOfCellRecords] + 2;
+    }
+    _offsetIndexSectionStarts[sectionCount] = itemCount;
+    
+    double *heights = malloc(MAX(itemCount, 1) * sizeof(double));
+    for (NSUInteger sectionIndex = 0; sectionIndex < sectionCount; ++sectionIndex) {
+        NSUInteger itemIndex = _offsetIndexSectionStarts[sectionIndex];
+        heights[itemIndex++] = [self estimatedHeightForRecordAtIndexPath:[NSIndexPath indexPathForRow:kRowIndexForHeaderIndexPaths inSection:(NSInteger)sectionIndex]];
+        
+        // Rows of virtual sections whose records do not exist yet get the fallback estimate, rather than creating
+        // every page just to estimate them
+        FSQSectionRecord *sectionRecord = sectionRecords[sectionIndex];
+        NSUInteger cellCount = (NSUInteger)[sectionRecord numberOfCellRecords];
+        CGFloat fallbackRowHeight = self.tableView.estimatedRowHeight;
+        if ([sectionRecord isKindOfClass:[FSQVirtualSectionRecord class]]) {
+            double fallbackEstimate = [self estimatedHeightForRecord:nil fallbackHeight:fallbackRowHeight];
+            for (NSUInteger cellIndex = 0; cellIndex < cellCount; ++cellIndex) {
+                heights[itemIndex + cellIndex] = fallbackEstimate;
+            }
+        }
+        [sectionRecord enumerateMaterializedCellRecordsUsingBlock:^(FSQCellRecord *cellRecord, NSUInteger cellIndex, BOOL *stop) {
+            heights[itemIndex + cellIndex] = [self estimatedHeightForRecord:cellRecord fallbackHeight:fallbackRowHeight];
+        }];
+        itemIndex += cellCount;
+        
+        heights[itemIndex] = [self estimatedHeightForRecordAtIndexPath:[NSIndexPath indexPathForRow:kRowIndexForFooterIndexPaths inSection:(NSInteger)sectionIndex]];
+    }
+    
+    _offsetIndex = [[FSQCellManifestOffsetIndex alloc] initWithHeights:heights count:itemCount];
+    free(heights);
+}
+
+- (NSUInteger)offsetIndexItemIndexForIndexPath:(NSIndexPath *)indexPath {
+    NSInteger section = indexPath.section;
+    if (section < 0 || (NSUInteger)section >= _offsetIndexSectionCount) {
+        return NSNotFound;
+    }
+    
+    NSUInteger sectionStart = _offsetIndexSectionStarts[section];
+    NSUInteger sectionEnd = _offsetIndexSectionStarts[section + 1];
+    
+    if (indexPath.row == kRowIndexForHeaderIndexPaths) {
+        return sectionStart;
+    }
+    else if (indexPath.row == kRowIndexForFooterIndexPaths) {
+        return sectionEnd - 1;
+    }
+    else if (indexPath.row >= 0 && (NSUInteger)indexPath.row < sectionEnd - sectionStart - 2) {
+        return sectionStart + 1 + indexPath.row;
+    }
+    else {
+        return NSNotFound;
+    }
+}
+
+- (void)updateOffsetIndexWithHeight:(CGFloat)height atIndexPath:(NSIndexPath *)indexPath {
+    if (!_offsetIndex) {
+        return;
+    }
+    
+    NSUInteger itemIndex = [self offsetIndexItemIndexForIndexPath:indexPath];
+    if (itemIndex != NSNotFound) {
+        [_offsetIndex setHeight:height atIndex:itemIndex];
+    }
+}
+
+- (nullable NSIndexPath *)indexPathForContentOffset:(CGPoint)contentOffset {
+    [self buildOffsetIndexIfNeeded];
+    
+    double offset = contentOffset.y - CGRectGetHeight(self.tableView.tableHeaderView.frame);
+    NSUInteger itemIndex = [_offsetIndex indexForOffset:offset];
+    if (itemIndex == NSNotFound) {
+        return nil;
+    }
+    
+    // Binary search for the last section that starts at or before the item
+    NSUInteger low = 0;
+    NSUInteger high = _offsetIndexSectionCount;
+    while (high - low > 1) {
+        NSUInteger middle = low + (high - low) / 2;
+        if (_offsetIndexSectionStarts[middle] <= itemIndex) {
+            low = middle;
+        }
+        else {
+            high = middle;
+        }
+    }
+    
+    NSUInteger sectionStart = _offsetIndexSectionStarts[low];
+    NSUInteger sectionEnd = _offsetIndexSectionStarts[low + 1];
+    
+    if (itemIndex == sectionStart) {
+        return [NSIndexPath indexPathForRow:kRowIndexForHeaderIndexPaths inSection:(NSInteger)low];
+    }
+    else if (itemIndex == sectionEnd - 1) {
+        return [NSIndexPath indexPathForRow:kRowIndexForFooterIndexPaths inSection:(NSInteger)low];
+    }
+    else {
+        return [NSIndexPath indexPathForRow:(NSInteger)(itemIndex - sectionStart - 1) inSection:(NSInteger)low];
+    }
 }
 
-- (void)dealloc {
-    self.tableView.dataSource = nil;
-    self.tableView.delegate = nil;
+- (CGPoint)contentOffsetForIndexPath:(NSIndexPath *)indexPath {
+    [self buildOffsetIndexIfNeeded];
+    
+    NSUInteger itemIndex = [self offsetIndexItemIndexForIndexPath:indexPath];
+    if (itemIndex == NSNotFound) {
+        return CGPointZero;
+    }
+    
+    return CGPointMake(0, CGRectGetHeight(self.tableView.tableHeaderView.frame) + [_offsetIndex offsetOfIndex:itemIndex]);
 }
 
-- (NSInteger)rowOrItemIndexForIndexPath:(NSIndexPath *)indexPath {
-    return indexPath.row;
+- (void)performUpdatesMaintainingScrollPosition:(void (^)(void))updates {
+    UITableView *tableView = self.tableView;
+    NSIndexPath *anchorIndexPath = [[tableView indexPathsForVisibleRows] firstObject];
+    FSQCellRecord *anchorRecord = (anchorIndexPath ? [self cellRecordAtIndexPath:anchorIndexPath] : nil);
+    
+    if (!anchorRecord) {
+        updates();
+        return;
+    }
+    
+    // The table view's own row rects include every row it has actually measured, so they are exact for visible rows
+    CGFloat anchorDistance = tableView.contentOffset.y - CGRectGetMinY([tableView rectForRowAtIndexPath:anchorIndexPath]);
+    
+    updates();
+    
+    // The anchor row usually hasn't moved, so check there before looking it up
+    NSIndexPath *newAnchorIndexPath = nil;
+    if ([self cellRecordAtIndexPath:anchorIndexPath] == anchorRecord) {
+        newAnchorIndexPath = anchorIndexPath;
+    }
+    else {
+        newAnchorIndexPath = [self indexPathForCellRecord:anchorRecord];
+    }
+    
+    if (newAnchorIndexPath) {
+        CGPoint contentOffset = tableView.contentOffset;
+        contentOffset.y = CGRectGetMinY([tableView rectForRowAtIndexPath:newAnchorIndexPath]) + anchorDistance;
+        [tableView setContentOffset:contentOffset animated:NO];
+    }
 }
 
-- (NSIndexPath * )indexPathForRowOrItem:(NSInteger)rowOrItem inSection:(NSInteger)section {
-    return [NSIndexPath indexPathForRow:rowOrItem inSection:section];
+#pragma mark - Prewarming -
+
+- (void)prewarmViewForRecord:(FSQCellRecord *)record reuseIdentifier:(NSString *)reuseIdentifier limit:(NSUInteger)limit {
+    UITableView *tableView = self.tableView;
+    if (!tableView) {
+        return;
+    }
+    
+    // Prewarming again without displaying the cells from last time must not keep growing the pool
+    if ([_prewarmedCellsByIdentifier[reuseIdentifier] count] >= limit) {
+        return;
+    }
+    
+    [self registerReuseIdentifier:reuseIdentifier forRecord:record recordType:FSQCellRecordTypeBody];
+    
+    // Without an index path, UITableView builds a new cell from the registered class when its reuse queue is empty
+    UITableViewCell *cell = [tableView dequeueReusableCellWithIdentifier:reuseIdentifier];
+    if (!cell) {
+        return;
+    }
+    
+    if (!_prewarmedCellsByIdentifier) {
+        _prewarmedCellsByIdentifier = [NSMutableDictionary new];
+        
+        // The pool is only a head start, so it is the first thing to go when memory is low
+        [[NSNotificationCenter defaultCenter] addObserver:self
+                                                 selector:@selector(didReceiveMemoryWarning:)
+                                                     name:UIApplicationDidReceiveMemoryWarningNotification
+                                                   object:nil];
+    }
+    
+    NSMutableArray<UITableViewCell *> *cells = _prewarmedCellsByIdentifier[reuseIdentifier];
+    if (!cells) {
+        cells = [NSMutableArray new];
+        _prewarmedCellsByIdentifier[reuseIdentifier] = cells;
+    }
+    
+    [cells addObject:cell];
+    ++_prewarmedCellCount;
 }
 
-- (void)performBatchRecordModificationUpdates:(nullable void (^)(void))updates {
+- (nullable UITableViewCell *)takePrewarmedCellWithIdentifier:(NSString *)identifier {
+    NSMutableArray<UITableViewCell *> *cells = _prewarmedCellsByIdentifier[identifier];
+    UITableViewCell *cell = [cells lastObject];
     
-    if (updates) {
-        [self.tableView beginUpdates];
-        updates();
-        [self.tableView endUpdates];
+    if (cell) {
+        [cells removeLastObject];
+        --_prewarmedCellCount;
+    }
+    
+    return cell;
+}
+
+- (void)discardPrewarmedCells {
+    if (_prewarmedCellsByIdentifier) {
+        [[NSNotificationCenter defaultCenter] removeObserver:self
+                                                        name:UIApplicationDidReceiveMemoryWarningNotification
+                                                      object:nil];
     }
+    
+    _prewarmedCellsByIdentifier = nil;
+    _prewarmedCellCount = 0;
+}
+
+- (void)didReceiveMemoryWarning:(NSNotification *)notification {
+    [self cancelPrewarming];
+    [self discardPrewarmedCells];
 }
 
 #pragma mark - Insertion and Removal -
@@ -1181,6 +1992,18 @@ typedef NS_ENUM(NSInteger, FSQCellRecordType) {
     }];
 }
 
+- (nullable id)visibleCellAtIndexPath:(NSIndexPath *)indexPath {
+    return [self.tableView cellForRowAtIndexPath:indexPath];
+}
+
+- (void)reconfigureCellsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths resizing:(BOOL)resizing {
+    [super reconfigureCellsAtIndexPaths:indexPaths resizing:resizing managedViewUpdates:^(NSArray<NSIndexPath *> *indexPaths) {
+        // An empty update makes the table view ask for new row heights and animate to them, without touching its cells
+        [self.tableView beginUpdates];
+        [self.tableView endUpdates];
+    }];
+}
+
 - (void)setSectionRecords:(nullable NSArray<FSQSectionRecord *> *)sectionRecords selectionStrategy:(FSQViewReloadCellSelectionStrategy)selectionStrategy {
     
     switch (selectionStrategy) {
@@ -1234,6 +2057,49 @@ typedef NS_ENUM(NSInteger, FSQCellRecordType) {
     }
 }
 
+- (void)setSectionRecords:(nullable NSArray<FSQSectionRecord *> *)sectionRecords animated:(BOOL)animated {
+    if (animated) {
+        [self setSectionRecords:sectionRecords withAnimation:UITableViewRowAnimationAutomatic];
+    }
+    else {
+        [UIView performWithoutAnimation:^{
+            [self setSectionRecords:sectionRecords withAnimation:UITableViewRowAnimationNone];
+        }];
+    }
+}
+
+- (void)setSectionRecords:(nullable NSArray<FSQSectionRecord *> *)sectionRecords withAnimation:(UITableViewRowAnimation)animation {
+    [super applyChangesetToSectionRecords:sectionRecords
+                       managedViewUpdates:^(FSQCellManifestChangeset *changeset) {
+                           [self performBatchRecordModificationUpdates:^{
+                               UITableView *tableView = self.tableView;
+                               
+                               [tableView deleteSections:changeset.deletedSectionIndexes withRowAnimation:animation];
+                               [tableView insertSections:changeset.insertedSectionIndexes withRowAnimation:animation];
+                               [tableView reloadSections:changeset.reloadedSectionIndexes withRowAnimation:animation];
+                               
+                               NSArray<NSNumber *> *movedSectionInitialIndexes = changeset.movedSectionInitialIndexes;
+                               NSArray<NSNumber *> *movedSectionTargetIndexes = changeset.movedSectionTargetIndexes;
+                               for (NSUInteger i = 0; i < [movedSectionInitialIndexes count]; ++i) {
+                                   [tableView moveSection:[movedSectionInitialIndexes[i] integerValue]
+                                                toSection:[movedSectionTargetIndexes[i] integerValue]];
+                               }
+                               
+                               [changeset withRowChangesForBatchUpdates:^(NSArray<NSIndexPath *> *deletedIndexPaths, NSArray<NSIndexPath *> *insertedIndexPaths, NSArray<NSIndexPath *> *reloadedIndexPaths) {
+                                   [tableView deleteRowsAtIndexPaths:deletedIndexPaths withRowAnimation:animation];
+                                   [tableView insertRowsAtIndexPaths:insertedIndexPaths withRowAnimation:animation];
+                                   [tableView reloadRowsAtIndexPaths:reloadedIndexPaths withRowAnimation:animation];
+                               }];
+                               
+                               NSArray<NSIndexPath *> *movedInitialIndexPaths = changeset.movedInitialIndexPaths;
+                               NSArray<NSIndexPath *> *movedTargetIndexPaths = changeset.movedTargetIndexPaths;
+                               for (NSUInteger i = 0; i < [movedInitialIndexPaths count]; ++i) {
+                                   [tableView moveRowAtIndexPath:movedInitialIndexPaths[i] toIndexPath:movedTargetIndexPaths[i]];
+                               }
+                           }];
+                       }];
+}
+
 - (NSArray *)insertCellRecords:(NSArray *)cellRecordsToInsert atIndexPath:(NSIndexPath *)indexPath {
     return [self insertCellRecords:cellRecordsToInsert atIndexPath:indexPath withAnimation:UITableViewRowAnimationNone];
 }
@@ -1292,18 +2158,45 @@ typedef NS_ENUM(NSInteger, FSQCellRecordType) {
     return [super removeCellRecordsAtIndexPaths:indexPaths
                             removeEmptySections:shouldRemoveEmptySections
                              managedViewUpdates:^(NSArray *removedIndexPaths, NSIndexSet *removedSectionIndexes) {
-                                 if ([removedSectionIndexes count] > 0) {
-                                     [self.tableView beginUpdates];
-                                     [self.tableView deleteRowsAtIndexPaths:removedIndexPaths withRowAnimation:animation];
-                                     [self.tableView deleteSections:removedSectionIndexes withRowAnimation:animation];
-                                     [self.tableView endUpdates];
-                                 }
-                                 else {
-                                     [self.tableView deleteRowsAtIndexPaths:removedIndexPaths withRowAnimation:animation];
-                                 }
+                                 [self deleteRowsAtIndexPaths:removedIndexPaths sections:removedSectionIndexes withAnimation:animation];
                              }];
 }
 
+- (NSArray<NSIndexPath *> *)removeCellRecordsWithOptions:(NSEnumerationOptions)options
+                                             passingTest:(FSQCellRecordTestBlock)predicate
+                                     removeEmptySections:(BOOL)shouldRemoveEmptySections {
+    return [self removeCellRecordsWithOptions:options
+                                  passingTest:predicate
+                                withAnimation:UITableViewRowAnimationNone
+                          removeEmptySections:shouldRemoveEmptySections];
+}
+
+- (NSArray<NSIndexPath *> *)removeCellRecordsWithOptions:(NSEnumerationOptions)options
+                                             passingTest:(FSQCellRecordTestBlock)predicate
+                                           withAnimation:(UITableViewRowAnimation)animation
+                                     removeEmptySections:(BOOL)shouldRemoveEmptySections {
+    return [super removeCellRecordsWithOptions:options
+                                   passingTest:predicate
+                           removeEmptySections:shouldRemoveEmptySections
+                            managedViewUpdates:^(NSArray *removedIndexPaths, NSIndexSet *removedSectionIndexes) {
+                                [self deleteRowsAtIndexPaths:removedIndexPaths sections:removedSectionIndexes withAnimation:animation];
+                            }];
+}
+
+- (void)deleteRowsAtIndexPaths:(NSArray<NSIndexPath *> *)removedIndexPaths
+                      sections:(NSIndexSet *)removedSectionIndexes
+                 withAnimation:(UITableViewRowAnimation)animation {
+    if ([removedSectionIndexes count] > 0) {
+        [self.tableView beginUpdates];
+        [self.tableView deleteRowsAtIndexPaths:removedIndexPaths withRowAnimation:animation];
+        [self.tableView deleteSections:removedSectionIndexes withRowAnimation:animation];
+        [self.tableView endUpdates];
+    }
+    else {
+        [self.tableView deleteRowsAtIndexPaths:removedIndexPaths withRowAnimation:animation];
+    }
+}
+
 - (BOOL)removeSectionRecordsAtIndexes:(NSIndexSet *)indexes {
     return [self removeSectionRecordsAtIndexes:indexes withAnimation:UITableViewRowAnimationNone];
 }
@@ -1332,6 +2225,29 @@ typedef NS_ENUM(NSInteger, FSQCellRecordType) {
     
 }
 
+- (NSArray<NSIndexPath *> *)replaceCellRecordsWithOptions:(NSEnumerationOptions)options
+                                              passingTest:(FSQCellRecordTestBlock)predicate
+                                                withBlock:(FSQCellRecordReplacementBlock)replacement {
+    return [self replaceCellRecordsWithOptions:options
+                                   passingTest:predicate
+                                     withBlock:replacement
+                                 withAnimation:UITableViewRowAnimationNone];
+}
+
+- (NSArray<NSIndexPath *> *)replaceCellRecordsWithOptions:(NSEnumerationOptions)options
+                                              passingTest:(FSQCellRecordTestBlock)predicate
+                                                withBlock:(FSQCellRecordReplacementBlock)replacement
+                                            withAnimation:(UITableViewRowAnimation)animation {
+    return [super replaceCellRecordsWithOptions:options
+                                    passingTest:predicate
+                                      withBlock:replacement
+                             managedViewUpdates:^(NSArray *replacedIndexPaths) {
+                                 if ([replacedIndexPaths count] > 0) {
+                                     [self.tableView reloadRowsAtIndexPaths:replacedIndexPaths withRowAnimation:animation];
+                                 }
+                             }];
+}
+
 - (NSIndexSet *)replaceSectionRecordsAtIndexes:(NSArray *)indexes withSectionRecords:(NSArray *)newSectionRecords {
     return [self replaceSectionRecordsAtIndexes:indexes withSectionRecords:newSectionRecords withAnimation:UITableViewRowAnimationNone];
 }
@@ -1355,16 +2271,25 @@ typedef NS_ENUM(NSInteger, FSQCellRecordType) {
         FSQCellRecord *record = [self cellRecordAtIndexPath:indexPath];
         
         CGSize maxSize = [self maxSizeForRecord:record atIndexPath:indexPath defaultWidth:CGRectGetWidth(tableView.frame) defaultHeight:CGFLOAT_MAX];
+        FSQCellManifestCellClassInfo *info = [self infoForCellClass:record.cellClass];
         
-        if ([self.delegate respondsToSelector:@selector(sizeForCellAtIndexPath:withManifest:record:maximumSize:)]) {
-            return [self.delegate sizeForCellAtIndexPath:indexPath withManifest:self record:record maximumSize:maxSize].height;
-        }
-        else if ([record.cellClass conformsToProtocol:@protocol(FSQCellManifestTableViewCellProtocol)]) {
-            return [record.cellClass manifest:self heightForModel:record.model maximumSize:maxSize indexPath:indexPath record:record];
-        }
-        else {
-            return 0;
-        }
+        CGFloat height = [self sizeForRecord:record maximumSize:maxSize usingBlock:^CGSize{
+            CGSize size;
+            if ([self delegateRespondsToSelector:@selector(sizeForCellAtIndexPath:withManifest:record:maximumSize:)]) {
+                size = [self.delegate sizeForCellAtIndexPath:indexPath withManifest:self record:record maximumSize:maxSize];
+            }
+            else if (info && info->_heightIMP) {
+                size = CGSizeMake(maxSize.width, info->_heightIMP(record.cellClass, @selector(manifest:heightForModel:maximumSize:indexPath:record:), self, record.model, maxSize, indexPath, record));
+            }
+            else {
+                size = CGSizeZero;
+            }
+            [self recordMeasuredHeight:size.height forCellClass:record.cellClass];
+            return size;
+        }].height;
+        
+        [self updateOffsetIndexWithHeight:height atIndexPath:indexPath];
+        return height;
     }
     else {
         return 0;
@@ -1372,9 +2297,17 @@ typedef NS_ENUM(NSInteger, FSQCellRecordType) {
 }
 
 - (CGFloat)heightForHeaderOrFooter:(FSQCellRecord *)record indexPath:(NSIndexPath *)indexPath tableView:(UITableView *)tableView {
-    if ([record.cellClass conformsToProtocol:@protocol(FSQCellManifestTableViewCellProtocol)]) {
+    FSQCellManifestCellClassInfo *info = [self infoForCellClass:record.cellClass];
+    if (info && info->_heightIMP) {
         CGSize maxSize = [self maxSizeForRecord:record atIndexPath:nil defaultWidth:CGRectGetWidth(tableView.frame) defaultHeight:CGFLOAT_MAX];
-        return [record.cellClass manifest:self heightForModel:record.model maximumSize:maxSize indexPath:indexPath record:record];
+        CGFloat height = [self sizeForRecord:record maximumSize:maxSize usingBlock:^CGSize{
+            CGFloat measuredHeight = info->_heightIMP(record.cellClass, @selector(manifest:heightForModel:maximumSize:indexPath:record:), self, record.model, maxSize, indexPath, record);
+            [self recordMeasuredHeight:measuredHeight forCellClass:record.cellClass];
+            return CGSizeMake(maxSize.width, measuredHeight);
+        }].height;
+        
+        [self updateOffsetIndexWithHeight:height atIndexPath:indexPath];
+        return height;
     }
     else {
         return 0;
@@ -1407,14 +2340,17 @@ typedef NS_ENUM(NSInteger, FSQCellRecordType) {
         return nil;
     }
     
-    NSString *identifier = record.reuseIdentifier ?: NSStringFromClass(record.cellClass);
+    NSString *identifier = [self reuseIdentifierForRecord:record];
     
-    [self registerIdentifier:identifier forCellClass:record.cellClass recordType:recordType];
+    [self registerReuseIdentifier:identifier forRecord:record recordType:recordType];
     
+    CFTimeInterval dequeueStartTime = [self profilingStartTime];
     UITableViewHeaderFooterView *headerFooterView = [tableView dequeueReusableHeaderFooterViewWithIdentifier:identifier];
+    [self reportProfilingEvent:FSQCellManifestProfilingEventDequeue cellClass:record.cellClass startTime:dequeueStartTime];
     
-    if ([headerFooterView conformsToProtocol:@protocol(FSQCellManifestTableViewCellProtocol)]) {
-        [(id<FSQCellManifestCellProtocol>)headerFooterView manifest:self configureWithModel:record.model indexPath:indexPath record:record];
+    FSQCellManifestCellClassInfo *viewInfo = [self infoForCellClass:[headerFooterView class]];
+    if (viewInfo && viewInfo->_heightIMP) {
+        viewInfo->_configureIMP(headerFooterView, @selector(manifest:configureWithModel:indexPath:record:), self, record.model, indexPath, record);
     }
     
     [self configureView:headerFooterView withRecord:record recordType:recordType atIndexPath:indexPath];
@@ -1474,20 +2410,18 @@ typedef NS_ENUM(NSInteger, FSQCellRecordType) {
     if (tableView == self.tableView) {
         FSQCellRecord *record = [self cellRecordAtIndexPath:indexPath];
         
-        [self withEachPluginAndDelegate:^(id delegate) {
-            if ([delegate respondsToSelector:@selector(manifest:willSelectCellAtIndexPath:withRecord:)]) {
-                [delegate manifest:self willSelectCellAtIndexPath:indexPath withRecord:record];
-            }
+        [self withEachPluginAndDelegateRespondingToSelector:@selector(manifest:willSelectCellAtIndexPath:withRecord:) block:^(id delegate) {
+            [delegate manifest:self willSelectCellAtIndexPath:indexPath withRecord:record];
         }];
         
         if (record.onSelection) {
+            CFTimeInterval blockStartTime = [self profilingStartTime];
             record.onSelection(indexPath, self, record);
+            [self reportProfilingEvent:FSQCellManifestProfilingEventSelectionBlock cellClass:record.cellClass startTime:blockStartTime];
         }
         
-        [self withEachPluginAndDelegate:^(id delegate) {
-            if ([delegate respondsToSelector:@selector(manifest:didSelectCellAtIndexPath:withRecord:)]) {
-                [delegate manifest:self didSelectCellAtIndexPath:indexPath withRecord:record];
-            }
+        [self withEachPluginAndDelegateRespondingToSelector:@selector(manifest:didSelectCellAtIndexPath:withRecord:) block:^(id delegate) {
+            [delegate manifest:self didSelectCellAtIndexPath:indexPath withRecord:record];
         }];
     }
 }
@@ -1551,7 +2485,7 @@ typedef NS_ENUM(NSInteger, FSQCellRecordType) {
 - (UITableViewCell *)tableView:(UITableView *)tableView cellForRowAtIndexPath:(NSIndexPath *)indexPath {
     if (tableView == self.tableView) {
         FSQCellRecord *record = [self cellRecordAtIndexPath:indexPath];
-        NSString *identifier = record.reuseIdentifier ?: NSStringFromClass(record.cellClass);
+        NSString *identifier = [self reuseIdentifierForRecord:record];
         
         if (!record || !identifier || !record.cellClass) {
             NSString *delegateClassName = NSStringFromClass([self.delegate class]) ?: @"";
@@ -1593,9 +2527,19 @@ typedef NS_ENUM(NSInteger, FSQCellRecordType) {
 
         }
 
-        [self registerIdentifier:identifier forCellClass:record.cellClass recordType:FSQCellRecordTypeBody];
+        [self registerReuseIdentifier:identifier forRecord:record recordType:FSQCellRecordTypeBody];
+        
+        CFTimeInterval dequeueStartTime = [self profilingStartTime];
+        
+        // Prewarmed cells have never been displayed, and join UIKit's reuse queue like any other cell once they scroll
+        // off screen
+        UITableViewCell *cell = (_prewarmedCellCount > 0 ? [self takePrewarmedCellWithIdentifier:identifier] : nil);
+        if (!cell) {
+            cell = [tableView dequeueReusableCellWithIdentifier:identifier forIndexPath:indexPath];
+        }
+        
+        [self reportProfilingEvent:FSQCellManifestProfilingEventDequeue cellClass:record.cellClass startTime:dequeueStartTime];
         
-        UITableViewCell *cell = [tableView dequeueReusableCellWithIdentifier:identifier forIndexPath:indexPath];
         [self configureView:cell withRecord:record recordType:FSQCellRecordTypeBody atIndexPath:indexPath];
         return cell;
     }
@@ -1605,6 +2549,16 @@ typedef NS_ENUM(NSInteger, FSQCellRecordType) {
     }
 }
 
+#pragma mark - Table View Data Source Prefetching Methods -
+
+- (void)tableView:(UITableView *)tableView prefetchRowsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths {
+    [self prefetchRecordsAtIndexPaths:indexPaths];
+}
+
+- (void)tableView:(UITableView *)tableView cancelPrefetchingForRowsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths {
+    [self cancelPrefetchingRecordsAtIndexPaths:indexPaths];
+}
+
 @end
 
 #pragma mark End Table View Manifest -
@@ -1630,9 +2584,17 @@ typedef NS_ENUM(NSInteger, FSQCellRecordType) {
 
 - (void)setCollectionView:(nullable UICollectionView *)collectionView {
     self.collectionView.dataSource = nil;
+    if ([self.collectionView respondsToSelector:@selector(setPrefetchDataSource:)]) {
+        self.collectionView.prefetchDataSource = nil;
+    }
     
     [self setManagedView:collectionView];
     collectionView.dataSource = _collectionViewDatasourceForwarderEnumerator.messageForwarder;
+    
+    // Prefetching is only available on iOS 10 and later
+    if ([collectionView respondsToSelector:@selector(setPrefetchDataSource:)]) {
+        collectionView.prefetchDataSource = _collectionViewDatasourceForwarderEnumerator.messageForwarder;
+    }
 }
 
 - (nullable UICollectionView *)collectionView {
@@ -1651,21 +2613,50 @@ typedef NS_ENUM(NSInteger, FSQCellRecordType) {
 
 - (void)dealloc {
     self.collectionView.dataSource = nil;
+    if ([self.collectionView respondsToSelector:@selector(setPrefetchDataSource:)]) {
+        self.collectionView.prefetchDataSource = nil;
+    }
     self.collectionView.delegate = nil;
 }
 
-- (NSInteger)rowOrItemIndexForIndexPath:(NSIndexPath *)indexPath {
-    return indexPath.item;
+- (void)performBatchRecordModificationUpdates:(nullable void (^)(void))updates {
+    if (updates) {
+        [self.collectionView performBatchUpdates:updates completion:nil];
+    }
 }
 
-- (NSIndexPath *)indexPathForRowOrItem:(NSInteger)rowOrItem inSection:(NSInteger)section {
-    return [NSIndexPath indexPathForItem:rowOrItem inSection:section];
+- (BOOL)recordSupportsThreadSafeSizing:(FSQCellRecord *)record {
+    FSQCellManifestCellClassInfo *info = [self infoForCellClass:record.cellClass];
+    return (info && info->_threadSafeCollectionViewSizing);
 }
 
-- (void)performBatchRecordModificationUpdates:(nullable void (^)(void))updates {
-    if (updates) {
-        [self.collectionView performBatchUpdates:updates completion:nil];
+- (CGSize)maximumSizeForPrecomputingRecord:(FSQCellRecord *)record atIndexPath:(nullable NSIndexPath *)indexPath {
+    return [self maxSizeForRecord:record atIndexPath:indexPath defaultWidth:CGFLOAT_MAX defaultHeight:CGFLOAT_MAX];
+}
+
+- (CGSize)threadSafeSizeForModel:(id)model cellClass:(Class)cellClass record:(FSQCellRecord *)record maximumSize:(CGSize)maximumSize indexPath:(NSIndexPath *)indexPath {
+    return [cellClass manifest:self sizeForModel:model maximumSize:maximumSize indexPath:indexPath record:record];
+}
+
+- (NSArray<NSIndexPath *> *)indexPathsForVisibleRecords {
+    return [self.collectionView indexPathsForVisibleItems] ?: @[];
+}
+
+#pragma mark - Prewarming -
+
+- (void)prewarmViewForRecord:(FSQCellRecord *)record reuseIdentifier:(NSString *)reuseIdentifier limit:(NSUInteger)limit {
+    /*
+     UICollectionView only accepts cells from its own dequeue method, which needs an index path and hands out a cell
+     that must then be displayed. So the most that can be done ahead of time is paying each class's one-time costs
+     (class initialization, loading shared images and fonts) by building and throwing away a single instance.
+     */
+    FSQCellManifestCellClassInfo *info = [self infoForCellClass:record.cellClass];
+    if (!info || info->_prewarmed) {
+        return;
     }
+    
+    info->_prewarmed = YES;
+    (void)[[record.cellClass alloc] initWithFrame:CGRectZero];
 }
 
 #pragma mark - Insertion and Removal -
@@ -1688,6 +2679,25 @@ typedef NS_ENUM(NSInteger, FSQCellRecordType) {
     }];
 }
 
+- (nullable id)visibleCellAtIndexPath:(NSIndexPath *)indexPath {
+    return [self.collectionView cellForItemAtIndexPath:indexPath];
+}
+
+- (void)reconfigureCellsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths resizing:(BOOL)resizing {
+    [super reconfigureCellsAtIndexPaths:indexPaths resizing:resizing managedViewUpdates:^(NSArray<NSIndexPath *> *indexPaths) {
+        UICollectionViewLayout *layout = self.collectionView.collectionViewLayout;
+        UICollectionViewLayoutInvalidationContext *context = [[[layout class] invalidationContextClass] new];
+        [context invalidateItemsAtIndexPaths:indexPaths];
+        
+        if ([context isKindOfClass:[UICollectionViewFlowLayoutInvalidationContext class]]) {
+            // Flow layout only asks its delegate for item sizes again if told to
+            ((UICollectionViewFlowLayoutInvalidationContext *)context).invalidateFlowLayoutDelegateMetrics = YES;
+        }
+        
+        [layout invalidateLayoutWithContext:context];
+    }];
+}
+
 - (void)setSectionRecords:(nullable NSArray<FSQSectionRecord *> *)sectionRecords selectionStrategy:(FSQViewReloadCellSelectionStrategy)selectionStrategy {
     
     switch (selectionStrategy) {
@@ -1741,6 +2751,47 @@ typedef NS_ENUM(NSInteger, FSQCellRecordType) {
     }
 }
 
+- (void)setSectionRecords:(nullable NSArray<FSQSectionRecord *> *)sectionRecords animated:(BOOL)animated {
+    void (^setRecords)(void) = ^{
+        [super applyChangesetToSectionRecords:sectionRecords
+                           managedViewUpdates:^(FSQCellManifestChangeset *changeset) {
+                               [self performBatchRecordModificationUpdates:^{
+                                   UICollectionView *collectionView = self.collectionView;
+                                   
+                                   [collectionView deleteSections:changeset.deletedSectionIndexes];
+                                   [collectionView insertSections:changeset.insertedSectionIndexes];
+                                   [collectionView reloadSections:changeset.reloadedSectionIndexes];
+                                   
+                                   NSArray<NSNumber *> *movedSectionInitialIndexes = changeset.movedSectionInitialIndexes;
+                                   NSArray<NSNumber *> *movedSectionTargetIndexes = changeset.movedSectionTargetIndexes;
+                                   for (NSUInteger i = 0; i < [movedSectionInitialIndexes count]; ++i) {
+                                       [collectionView moveSection:[movedSectionInitialIndexes[i] integerValue]
+                                                         toSection:[movedSectionTargetIndexes[i] integerValue]];
+                                   }
+                                   
+                                   [changeset withRowChangesForBatchUpdates:^(NSArray<NSIndexPath *> *deletedIndexPaths, NSArray<NSIndexPath *> *insertedIndexPaths, NSArray<NSIndexPath *> *reloadedIndexPaths) {
+                                       [collectionView deleteItemsAtIndexPaths:deletedIndexPaths];
+                                       [collectionView insertItemsAtIndexPaths:insertedIndexPaths];
+                                       [collectionView reloadItemsAtIndexPaths:reloadedIndexPaths];
+                                   }];
+                                   
+                                   NSArray<NSIndexPath *> *movedInitialIndexPaths = changeset.movedInitialIndexPaths;
+                                   NSArray<NSIndexPath *> *movedTargetIndexPaths = changeset.movedTargetIndexPaths;
+                                   for (NSUInteger i = 0; i < [movedInitialIndexPaths count]; ++i) {
+                                       [collectionView moveItemAtIndexPath:movedInitialIndexPaths[i] toIndexPath:movedTargetIndexPaths[i]];
+                                   }
+                               }];
+                           }];
+    };
+    
+    if (animated) {
+        setRecords();
+    }
+    else {
+        [UIView performWithoutAnimation:setRecords];
+    }
+}
+
 - (NSArray *)insertCellRecords:(NSArray *)cellRecordsToInsert atIndexPath:(NSIndexPath *)indexPath {
     return [super insertCellRecords:cellRecordsToInsert
                         atIndexPath:indexPath
@@ -1782,18 +2833,33 @@ typedef NS_ENUM(NSInteger, FSQCellRecordType) {
     return [super removeCellRecordsAtIndexPaths:indexPaths
                             removeEmptySections:shouldRemoveEmptySections
                              managedViewUpdates:^(NSArray *removedIndexPaths, NSIndexSet *removedSectionIndexes) {
-                                 if ([removedSectionIndexes count] > 0) {
-                                     [self.collectionView performBatchUpdates:^{
-                                         [self.collectionView deleteItemsAtIndexPaths:removedIndexPaths];
-                                         [self.collectionView deleteSections:removedSectionIndexes];
-                                     } completion:nil];
-                                 }
-                                 else {
-                                     [self.collectionView deleteItemsAtIndexPaths:removedIndexPaths];
-                                 }
+                                 [self deleteItemsAtIndexPaths:removedIndexPaths sections:removedSectionIndexes];
                              }];
 }
 
+- (NSArray<NSIndexPath *> *)removeCellRecordsWithOptions:(NSEnumerationOptions)options
+                                             passingTest:(FSQCellRecordTestBlock)predicate
+                                     removeEmptySections:(BOOL)shouldRemoveEmptySections {
+    return [super removeCellRecordsWithOptions:options
+                                   passingTest:predicate
+                           removeEmptySections:shouldRemoveEmptySections
+                            managedViewUpdates:^(NSArray *removedIndexPaths, NSIndexSet *removedSectionIndexes) {
+                                [self deleteItemsAtIndexPaths:removedIndexPaths sections:removedSectionIndexes];
+                            }];
+}
+
+- (void)deleteItemsAtIndexPaths:(NSArray<NSIndexPath *> *)removedIndexPaths sections:(NSIndexSet *)removedSectionIndexes {
+    if ([removedSectionIndexes count] > 0) {
+        [self.collectionView performBatchUpdates:^{
+            [self.collectionView deleteItemsAtIndexPaths:removedIndexPaths];
+            [self.collectionView deleteSections:removedSectionIndexes];
+        } completion:nil];
+    }
+    else {
+        [self.collectionView deleteItemsAtIndexPaths:removedIndexPaths];
+    }
+}
+
 - (BOOL)removeSectionRecordsAtIndexes:(NSIndexSet *)indexes {
     return [super removeSectionRecordsAtIndexes:indexes
                              managedViewUpdates:^{
@@ -1812,6 +2878,19 @@ typedef NS_ENUM(NSInteger, FSQCellRecordType) {
     
 }
 
+- (NSArray<NSIndexPath *> *)replaceCellRecordsWithOptions:(NSEnumerationOptions)options
+                                              passingTest:(FSQCellRecordTestBlock)predicate
+                                                withBlock:(FSQCellRecordReplacementBlock)replacement {
+    return [super replaceCellRecordsWithOptions:options
+                                    passingTest:predicate
+                                      withBlock:replacement
+                             managedViewUpdates:^(NSArray *replacedIndexPaths) {
+                                 if ([replacedIndexPaths count] > 0) {
+                                     [self.collectionView reloadItemsAtIndexPaths:replacedIndexPaths];
+                                 }
+                             }];
+}
+
 - (NSIndexSet *)replaceSectionRecordsAtIndexes:(NSArray<NSNumber *> *)indexes withSectionRecords:(NSArray<FSQSectionRecord *> *)newSectionRecords {
     return [super replaceSectionRecordsAtIndexes:indexes
                               withSectionRecords:newSectionRecords
@@ -1853,16 +2932,18 @@ typedef NS_ENUM(NSInteger, FSQCellRecordType) {
             return nil;
         }
         
-        NSString *identifier = record.reuseIdentifier ?: NSStringFromClass(record.cellClass);
+        NSString *identifier = [self reuseIdentifierForRecord:record];
         
         if (!identifier || !record.cellClass) {
             NSAssert(0, @"Missing identifier or cell class in FSQCellManifest cellForItemAtIndexPath:");
             return nil;
         }
         
-        [self registerIdentifier:identifier forCellClass:record.cellClass recordType:FSQCellRecordTypeBody];
+        [self registerReuseIdentifier:identifier forRecord:record recordType:FSQCellRecordTypeBody];
         
+        CFTimeInterval dequeueStartTime = [self profilingStartTime];
         UICollectionViewCell *cell = [collectionView dequeueReusableCellWithReuseIdentifier:identifier forIndexPath:indexPath];
+        [self reportProfilingEvent:FSQCellManifestProfilingEventDequeue cellClass:record.cellClass startTime:dequeueStartTime];
         
         if (!cell) {
             @throw ([NSException exceptionWithName:kFSQIdentifierCellDequeueException
@@ -1896,7 +2977,7 @@ typedef NS_ENUM(NSInteger, FSQCellRecordType) {
         }
         
         if (record) {
-            NSString *identifier = record.reuseIdentifier ?: NSStringFromClass(record.cellClass);
+            NSString *identifier = [self reuseIdentifierForRecord:record];
             
             if (!identifier || !record.cellClass) {
                 @throw ([NSException exceptionWithName:kFSQIdentifierClassMismatchException
@@ -1905,9 +2986,11 @@ typedef NS_ENUM(NSInteger, FSQCellRecordType) {
                 return nil;
             }
             
-            [self registerIdentifier:identifier forCellClass:record.cellClass recordType:recordType];
+            [self registerReuseIdentifier:identifier forRecord:record recordType:recordType];
             
+            CFTimeInterval dequeueStartTime = [self profilingStartTime];
             UICollectionReusableView *view = [self.collectionView dequeueReusableSupplementaryViewOfKind:kind withReuseIdentifier:identifier forIndexPath:indexPath];
+            [self reportProfilingEvent:FSQCellManifestProfilingEventDequeue cellClass:record.cellClass startTime:dequeueStartTime];
             
             if (!view) {
                 @throw ([NSException exceptionWithName:kFSQIdentifierCellDequeueException
@@ -1979,23 +3062,67 @@ typedef NS_ENUM(NSInteger, FSQCellRecordType) {
     return result;
 }
 
-#pragma mark - Collection View Delegate Methods -
+#pragma mark - Sizing -
 
-- (CGSize)collectionView:(UICollectionView *)collectionView layout:(UICollectionViewLayout *)collectionViewLayout sizeForItemAtIndexPath:(NSIndexPath *)indexPath {
-    if (collectionView == self.collectionView) {
-        FSQCellRecord *record = [self cellRecordAtIndexPath:indexPath];
-        
-        CGSize maxSize = [self maxSizeForRecord:record atIndexPath:indexPath defaultWidth:CGFLOAT_MAX defaultHeight:CGFLOAT_MAX];
-        
-        if ([self.delegate respondsToSelector:@selector(sizeForCellAtIndexPath:withManifest:record:maximumSize:)]) {
+- (CGSize)sizeForItemAtIndexPath:(NSIndexPath *)indexPath {
+    FSQCellRecord *record = [self cellRecordAtIndexPath:indexPath];
+    
+    CGSize maxSize = [self maxSizeForRecord:record atIndexPath:indexPath defaultWidth:CGFLOAT_MAX defaultHeight:CGFLOAT_MAX];
+    FSQCellManifestCellClassInfo *info = [self infoForCellClass:record.cellClass];
+    
+    return [self sizeForRecord:record maximumSize:maxSize usingBlock:^CGSize{
+        if ([self delegateRespondsToSelector:@selector(sizeForCellAtIndexPath:withManifest:record:maximumSize:)]) {
             return [self.delegate sizeForCellAtIndexPath:indexPath withManifest:self record:record maximumSize:maxSize];
         }
-        else if ([record.cellClass conformsToProtocol:@protocol(FSQCellManifestCollectionViewCellProtocol)]) {
-            return [record.cellClass manifest:self sizeForModel:record.model maximumSize:maxSize indexPath:indexPath record:record];
+        else if (info && info->_sizeIMP) {
+            return info->_sizeIMP(record.cellClass, @selector(manifest:sizeForModel:maximumSize:indexPath:record:), self, record.model, maxSize, indexPath, record);
         }
         else {
             return CGSizeZero;
         }
+    }];
+}
+
+- (CGSize)sizeForHeaderInSection:(NSInteger)section referenceSize:(CGSize)referenceSize {
+    FSQCellRecord *record = [self sectionRecordAtIndex:section].header;
+    FSQCellManifestCellClassInfo *info = [self infoForCellClass:record.cellClass];
+    if (info && info->_sizeIMP) {
+        CGSize maxSize = [self maxSizeForRecord:record atIndexPath:nil defaultWidth:CGFLOAT_MAX defaultHeight:CGFLOAT_MAX];
+        return [self sizeForRecord:record maximumSize:maxSize usingBlock:^CGSize{
+            return info->_sizeIMP(record.cellClass, @selector(manifest:sizeForModel:maximumSize:indexPath:record:), self, record.model, maxSize, [NSIndexPath indexPathForItem:kRowIndexForHeaderIndexPaths inSection:section], record);
+        }];
+    }
+    
+    return referenceSize;
+}
+
+- (CGSize)sizeForFooterInSection:(NSInteger)section referenceSize:(CGSize)referenceSize {
+    FSQCellRecord *record = [self sectionRecordAtIndex:section].footer;
+    FSQCellManifestCellClassInfo *info = [self infoForCellClass:record.cellClass];
+    if (info && info->_sizeIMP) {
+        CGSize maxSize = [self maxSizeForRecord:record atIndexPath:nil defaultWidth:CGFLOAT_MAX defaultHeight:CGFLOAT_MAX];
+        return [self sizeForRecord:record maximumSize:maxSize usingBlock:^CGSize{
+            return info->_sizeIMP(record.cellClass, @selector(manifest:sizeForModel:maximumSize:indexPath:record:), self, record.model, maxSize, [NSIndexPath indexPathForItem:kRowIndexForFooterIndexPaths inSection:section], record);
+        }];
+    }
+    
+    return referenceSize;
+}
+
+- (UIEdgeInsets)insetForSectionAtIndex:(NSInteger)section defaultInset:(UIEdgeInsets)defaultInset {
+    FSQSectionRecord *record = [self sectionRecordAtIndex:section];
+    if (record.collectionViewSectionInsetPrivate) {
+        return record.collectionViewSectionInset;
+    }
+    
+    return defaultInset;
+}
+
+#pragma mark - Collection View Delegate Methods -
+
+- (CGSize)collectionView:(UICollectionView *)collectionView layout:(UICollectionViewLayout *)collectionViewLayout sizeForItemAtIndexPath:(NSIndexPath *)indexPath {
+    if (collectionView == self.collectionView) {
+        return [self sizeForItemAtIndexPath:indexPath];
     }
     else {
         return CGSizeZero;
@@ -2024,33 +3151,25 @@ typedef NS_ENUM(NSInteger, FSQCellRecordType) {
     if (collectionView == self.collectionView) {
         FSQCellRecord *record = [self cellRecordAtIndexPath:indexPath];
         
-        [self withEachPluginAndDelegate:^(id delegate) {
-            if ([delegate respondsToSelector:@selector(manifest:willSelectCellAtIndexPath:withRecord:)]) {
-                [delegate manifest:self willSelectCellAtIndexPath:indexPath withRecord:record];
-            }
+        [self withEachPluginAndDelegateRespondingToSelector:@selector(manifest:willSelectCellAtIndexPath:withRecord:) block:^(id delegate) {
+            [delegate manifest:self willSelectCellAtIndexPath:indexPath withRecord:record];
         }];
         
         if (record.onSelection) {
+            CFTimeInterval blockStartTime = [self profilingStartTime];
             record.onSelection(indexPath, self, record);
+            [self reportProfilingEvent:FSQCellManifestProfilingEventSelectionBlock cellClass:record.cellClass startTime:blockStartTime];
         }
         
-        [self withEachPluginAndDelegate:^(id delegate) {
-            if ([delegate respondsToSelector:@selector(manifest:didSelectCellAtIndexPath:withRecord:)]) {
-                [delegate manifest:self didSelectCellAtIndexPath:indexPath withRecord:record];
-            }
+        [self withEachPluginAndDelegateRespondingToSelector:@selector(manifest:didSelectCellAtIndexPath:withRecord:) block:^(id delegate) {
+            [delegate manifest:self didSelectCellAtIndexPath:indexPath withRecord:record];
         }];
     }
 }
 
 - (CGSize)collectionView:(UICollectionView *)collectionView layout:(UICollectionViewFlowLayout *)collectionViewLayout referenceSizeForHeaderInSection:(NSInteger)section {
     if (collectionView == self.collectionView) {
-        FSQCellRecord *record = [self sectionRecordAtIndex:section].header;
-        if ([record.cellClass conformsToProtocol:@protocol(FSQCellManifestCollectionViewCellProtocol)]) {
-            CGSize maxSize = [self maxSizeForRecord:record atIndexPath:nil defaultWidth:CGFLOAT_MAX defaultHeight:CGFLOAT_MAX];
-            return [record.cellClass manifest:self sizeForModel:record.model maximumSize:maxSize indexPath:[NSIndexPath indexPathForItem:kRowIndexForHeaderIndexPaths inSection:section] record:record];
-        }
-        
-        return CGSizeZero;
+        return [self sizeForHeaderInSection:section referenceSize:CGSizeZero];
     }
     
     return collectionViewLayout.headerReferenceSize;
@@ -2058,11 +3177,7 @@ typedef NS_ENUM(NSInteger, FSQCellRecordType) {
 
 - (CGSize)collectionView:(UICollectionView *)collectionView layout:(UICollectionViewFlowLayout *)collectionViewLayout referenceSizeForFooterInSection:(NSInteger)section {
     if (collectionView == self.collectionView) {
-        FSQCellRecord *record = [self sectionRecordAtIndex:section].footer;
-        if ([record.cellClass conformsToProtocol:@protocol(FSQCellManifestCollectionViewCellProtocol)]) {
-            CGSize maxSize = [self maxSizeForRecord:record atIndexPath:nil defaultWidth:CGFLOAT_MAX defaultHeight:CGFLOAT_MAX];
-            return [record.cellClass manifest:self sizeForModel:record.model maximumSize:maxSize indexPath:[NSIndexPath indexPathForItem:kRowIndexForFooterIndexPaths inSection:section] record:record];
-        }
+        return [self sizeForFooterInSection:section referenceSize:collectionViewLayout.footerReferenceSize];
     }
     
     return collectionViewLayout.footerReferenceSize;
@@ -2072,21 +3187,28 @@ typedef NS_ENUM(NSInteger, FSQCellRecordType) {
                         layout:(UICollectionViewLayout *)collectionViewLayout
         insetForSectionAtIndex:(NSInteger)section {
     
-    if (collectionView == self.collectionView) {
-        FSQSectionRecord *record = [self sectionRecordAtIndex:section];
-        if (record.collectionViewSectionInsetPrivate) {
-            return record.collectionViewSectionInset;
-        }
+    UIEdgeInsets defaultInset = UIEdgeInsetsZero;
+    if ([collectionViewLayout respondsToSelector:@selector(sectionInset)]) {
+        defaultInset = ((UICollectionViewFlowLayout *)collectionViewLayout).sectionInset;
     }
     
-    if ([collectionViewLayout respondsToSelector:@selector(sectionInset)]) {
-        return ((UICollectionViewFlowLayout *)collectionViewLayout).sectionInset;
+    if (collectionView == self.collectionView) {
+        return [self insetForSectionAtIndex:section defaultInset:defaultInset];
     }
     else {
-        return UIEdgeInsetsZero;
+        return defaultInset;
     }
 }
 
+#pragma mark - Collection View Data Source Prefetching Methods -
+
+- (void)collectionView:(UICollectionView *)collectionView prefetchItemsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths {
+    [self prefetchRecordsAtIndexPaths:indexPaths];
+}
+
+- (void)collectionView:(UICollectionView *)collectionView cancelPrefetchingForItemsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths {
+    [self cancelPrefetchingRecordsAtIndexPaths:indexPaths];
+}
 
 @end
 
@@ -2100,15 +3222,55 @@ typedef NS_ENUM(NSInteger, FSQCellRecordType) {
 @end
 #pragma clang diagnostic pop
 
+@implementation FSQCellManifestMessageForwarder
+
+- (nullable id)forwardingTargetForSelector:(SEL)aSelector {
+    FSQCellManifestMessageForwarderEnumerator *enumerator = (FSQCellManifestMessageForwarderEnumerator *)self.enumeratorGenerator;
+    return [enumerator soleResponderToSelector:aSelector];
+}
+
+- (BOOL)respondsToSelector:(SEL)aSelector {
+    FSQCellManifestMessageForwarderEnumerator *enumerator = (FSQCellManifestMessageForwarderEnumerator *)self.enumeratorGenerator;
+    return ([enumerator hasRespondersToSelector:aSelector] || [super respondsToSelector:aSelector]);
+}
+
+- (nullable NSMethodSignature *)methodSignatureForSelector:(SEL)aSelector {
+    FSQCellManifestMessageForwarderEnumerator *enumerator = (FSQCellManifestMessageForwarderEnumerator *)self.enumeratorGenerator;
+    
+    // Forwarded messages can be sent while another is being forwarded, so put back whatever was there before
+    SEL previousSelector = enumerator.forwardingSelector;
+    enumerator.forwardingSelector = aSelector;
+    NSMethodSignature *signature = [super methodSignatureForSelector:aSelector];
+    enumerator.forwardingSelector = previousSelector;
+    
+    return signature;
+}
+
+- (void)forwardInvocation:(NSInvocation *)invocation {
+    FSQCellManifestMessageForwarderEnumerator *enumerator = (FSQCellManifestMessageForwarderEnumerator *)self.enumeratorGenerator;
+    
+    SEL previousSelector = enumerator.forwardingSelector;
+    enumerator.forwardingSelector = invocation.selector;
+    [super forwardInvocation:invocation];
+    enumerator.forwardingSelector = previousSelector;
+}
+
+@end
+
 @implementation FSQCellManifestMessageForwarderEnumerator {
     NSMutableArray<id<FSQCellManifestPlugin>> *_manifestPlugins;
+    NSMapTable *_responderListsBySelector;
+    FSQCellManifestResponderList *_Nullable _currentResponders;
 }
 
 - (instancetype)init {
     if ((self = [super init])) {
-        _messageForwarder = [FSQMessageForwarderWithEnumerator new];
+        _messageForwarder = [FSQCellManifestMessageForwarder new];
         _messageForwarder.enumeratorGenerator = self;
         _manifestPlugins = [NSMutableArray new];
+        _responderListsBySelector = [[NSMapTable alloc] initWithKeyOptions:(NSPointerFunctionsOpaqueMemory | NSPointerFunctionsOpaquePersonality)
+                                                              valueOptions:NSPointerFunctionsStrongMemory
+                                                                  capacity:0];
     }
     return self;
 }
@@ -2116,18 +3278,99 @@ typedef NS_ENUM(NSInteger, FSQCellRecordType) {
 
 - (void)addPlugins:(nullable NSArray<id<FSQCellManifestPlugin>> *)newPlugins {
     [_manifestPlugins addObjectsFromArray:newPlugins];
+    [self invalidateResponderCache];
 }
 
 - (void)removePlugins:(nullable NSArray<id<FSQCellManifestPlugin>> *)pluginsToRemove {
     [_manifestPlugins removeObjectsInArray:pluginsToRemove];
+    [self invalidateResponderCache];
+}
+
+- (void)setManifest:(nullable FSQCellManifest *)manifest {
+    _manifest = manifest;
+    [self invalidateResponderCache];
+}
+
+- (void)setManifestDelegate:(nullable id)manifestDelegate {
+    _manifestDelegate = manifestDelegate;
+    [self invalidateResponderCache];
+}
+
+#pragma mark - Responder Cache
+
+- (void)invalidateResponderCache {
+    [_responderListsBySelector removeAllObjects];
+    _currentResponders = nil;
+}
+
+- (FSQCellManifestResponderList *)responderListForSelector:(SEL)selector {
+    FSQCellManifestResponderList *responders = (__bridge FSQCellManifestResponderList *)NSMapGet(_responderListsBySelector, (const void *)selector);
+    
+    if (!responders) {
+        NSMutableArray *respondingPlugins = [NSMutableArray new];
+        for (id plugin in _manifestPlugins) {
+            if ([plugin respondsToSelector:selector]) {
+                [respondingPlugins addObject:plugin];
+            }
+        }
+        
+        responders = [FSQCellManifestResponderList new];
+        responders->_plugins = [respondingPlugins copy];
+        responders->_manifestResponds = [_manifest respondsToSelector:selector];
+        responders->_delegateResponds = [_manifestDelegate respondsToSelector:selector];
+        NSMapInsertKnownAbsent(_responderListsBySelector, (const void *)selector, (__bridge void *)responders);
+    }
+    
+    return responders;
+}
+
+- (BOOL)hasRespondersToSelector:(SEL)selector {
+    FSQCellManifestResponderList *responders = [self responderListForSelector:selector];
+    return ((responders->_manifestResponds && _manifest)
+            || [responders->_plugins count] > 0
+            || (responders->_delegateResponds && _manifestDelegate));
+}
+
+- (nullable id)soleResponderToSelector:(SEL)selector {
+    FSQCellManifestResponderList *responders = [self responderListForSelector:selector];
+    
+    id manifest = (responders->_manifestResponds ? _manifest : nil);
+    id delegate = (responders->_delegateResponds ? _manifestDelegate : nil);
+    NSUInteger pluginCount = [responders->_plugins count];
+    
+    id soleResponder = nil;
+    if (manifest && pluginCount == 0 && !delegate) {
+        soleResponder = manifest;
+    }
+    else if (!manifest && pluginCount == 1 && !delegate) {
+        soleResponder = responders->_plugins[0];
+    }
+    else if (!manifest && pluginCount == 0 && delegate) {
+        soleResponder = delegate;
+    }
+    
+    // Forwardees can choose to ignore their own responses, which only the full forwarding path handles
+    if ([soleResponder conformsToProtocol:@protocol(FSQMessageForwardee)]) {
+        return nil;
+    }
+    
+    return soleResponder;
 }
 
+#pragma mark - Enumeration
+
 - (NSEnumerator *)childrenEnumeratorForMessageForwarder:(FSQMessageForwarder *)forwarder {
     _currentIndex = 0;
+    _currentResponders = (_forwardingSelector ? [self responderListForSelector:_forwardingSelector] : nil);
     return self;
 }
 
 - (nullable id)nextObject {
+    FSQCellManifestResponderList *responders = _currentResponders;
+    if (responders) {
+        return [self nextObjectRespondingFromList:responders];
+    }
+    
     NSInteger index = _currentIndex;
     
     if (_manifest) {
@@ -2154,6 +3397,30 @@ typedef NS_ENUM(NSInteger, FSQCellRecordType) {
     }
 }
 
+- (nullable id)nextObjectRespondingFromList:(FSQCellManifestResponderList *)responders {
+    NSUInteger pluginCount = [responders->_plugins count];
+    
+    // Same order as the full enumeration: manifest, then plugins, then delegate.
+    // Index 0 is the manifest, 1...pluginCount are the plugins, and pluginCount + 1 is the delegate.
+    while (_currentIndex <= pluginCount + 1) {
+        NSUInteger index = _currentIndex++;
+        
+        if (index == 0) {
+            if (responders->_manifestResponds && _manifest) {
+                return _manifest;
+            }
+        }
+        else if (index <= pluginCount) {
+            return responders->_plugins[index - 1];
+        }
+        else if (responders->_delegateResponds && _manifestDelegate) {
+            return _manifestDelegate;
+        }
+    }
+    
+    return nil;
+}
+
 - (NSArray *)allObjects {
     NSMutableArray *allObjects = [NSMutableArray new];
     
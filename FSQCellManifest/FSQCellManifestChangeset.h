@@ -0,0 +1,93 @@
+//
+//  FSQCellManifestChangeset.h
+//
+//  Copyright (c) 2015 Foursquare. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class FSQSectionRecord;
+
+/**
+ Describes the minimal set of section and cell changes needed to turn one array of section records into another.
+ 
+ Changesets are computed in linear time. Records are matched up by identity, not by full equality:
+ * Cell records are the same item if they have equal models (according to isEqual:) and the same cellClass.
+ Records without a model only match themselves.
+ * Section records are the same item if their headers (or, failing that, footers) have equal models and the same
+ cellClass. Sections with neither are matched up in order.
+ 
+ Cells are compared by their position relative to the other matched cells of their section, so inserting, deleting
+ or moving a section carries its cells along without moving each of them. The longest run of matched cells that keeps
+ its order stays in place, and only the other matched cells are moved, so moving one cell reports one move.
+ Matched sections whose attributes changed are reloaded if they are still at the same index. Matched cells whose
+ content changed (according to isEqualToCellRecord:) are reloaded if they stay in place and their section is not
+ moved. Anything else that changed is deleted and re-inserted.
+ 
+ All indexes use the same semantics as UITableView and UICollectionView batch updates: deleted, reloaded and initial
+ indexes refer to the original records, while inserted and target indexes refer to the new records.
+ */
+@interface FSQCellManifestChangeset : NSObject
+
+/**
+ Compute a changeset between two arrays of section records.
+ 
+ @param originalSectionRecords The current section records.
+ @param newSectionRecords      The section records that will replace them.
+ 
+ @return A new changeset describing the difference between the two arrays.
+ */
++ (instancetype)changesetFromSectionRecords:(nullable NSArray<FSQSectionRecord *> *)originalSectionRecords
+                           toSectionRecords:(nullable NSArray<FSQSectionRecord *> *)newSectionRecords;
+
+/**
+ The section records the changeset was computed from.
+ */
+@property (nonatomic, readonly) NSArray<FSQSectionRecord *> *originalSectionRecords;
+
+/**
+ The section records the changeset was computed to.
+ */
+@property (nonatomic, readonly) NSArray<FSQSectionRecord *> *sectionRecords;
+
+@property (nonatomic, readonly) NSIndexSet *deletedSectionIndexes;
+@property (nonatomic, readonly) NSIndexSet *insertedSectionIndexes;
+@property (nonatomic, readonly) NSIndexSet *reloadedSectionIndexes;
+
+/**
+ Moved sections. Each initial index is paired with the target index at the same position in movedSectionTargetIndexes.
+ */
+@property (nonatomic, readonly) NSArray<NSNumber *> *movedSectionInitialIndexes;
+@property (nonatomic, readonly) NSArray<NSNumber *> *movedSectionTargetIndexes;
+
+@property (nonatomic, readonly) NSArray<NSIndexPath *> *deletedIndexPaths;
+@property (nonatomic, readonly) NSArray<NSIndexPath *> *insertedIndexPaths;
+@property (nonatomic, readonly) NSArray<NSIndexPath *> *reloadedIndexPaths;
+
+/**
+ Where each reloaded cell ends up. Each target index path is paired with the index path at the same position in
+ reloadedIndexPaths, and differs from it when sections or cells before it are inserted or deleted.
+ 
+ UITableView and UICollectionView treat a reload as a deletion and insertion at the same index path, so the manifests
+ apply a reload whose target index path differs as a deletion of the original index path and an insertion at the
+ target index path.
+ */
+@property (nonatomic, readonly) NSArray<NSIndexPath *> *reloadedTargetIndexPaths;
+
+/**
+ Moved cells. Each initial index path is paired with the target index path at the same position in
+ movedTargetIndexPaths.
+ */
+@property (nonatomic, readonly) NSArray<NSIndexPath *> *movedInitialIndexPaths;
+@property (nonatomic, readonly) NSArray<NSIndexPath *> *movedTargetIndexPaths;
+
+/**
+ NO if the two arrays of section records are equivalent.
+ */
+@property (nonatomic, readonly) BOOL hasChanges;
+
+@end
+
+NS_ASSUME_NONNULL_END
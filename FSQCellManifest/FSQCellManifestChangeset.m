@@ -0,0 +1,566 @@
+//
+//  FSQCellManifestChangeset.m
+//
+//  Copyright (c) 2015 Foursquare. All rights reserved.
+//
+
+#import "FSQCellManifestChangeset.h"
+
+#import "FSQCellManifestIndexPaths.h"
+#import "FSQCellManifestPagedArray.h"
+#import "FSQCellRecord.h"
+#import "FSQSectionRecord.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+// These methods all already exist in their record classes but are not exposed.
+// They are for internal manifest use only and should not be used outside of the framework
+@interface FSQSectionRecord (FSQCellManifestChangesetPrivateMethods)
+
+- (nullable NSValue *)collectionViewSectionInsetPrivate;
+
+@end
+
+@interface FSQCellRecord (FSQCellManifestChangesetPrivateMethods)
+
+- (BOOL)hasModel;
+
+@end
+
+/**
+ Identity of a record for matching purposes. Two keys are equal if they have equal models and the same cell class.
+ */
+@interface FSQCellManifestChangesetKey : NSObject
+
+- (instancetype)initWithModel:(id)model cellClass:(nullable Class)cellClass;
+
+@end
+
+@implementation FSQCellManifestChangesetKey {
+    id _model;
+    Class _cellClass;
+    NSUInteger _hash;
+}
+
+- (instancetype)initWithModel:(id)model cellClass:(nullable Class)cellClass {
+    if ((self = [super init])) {
+        _model = model;
+        _cellClass = cellClass;
+        _hash = [model hash] ^ [cellClass hash];
+    }
+    return self;
+}
+
+- (NSUInteger)hash {
+    return _hash;
+}
+
+- (BOOL)isEqual:(id)object {
+    if (self == object) {
+        return YES;
+    }
+    
+    if (![object isKindOfClass:[FSQCellManifestChangesetKey class]]) {
+        return NO;
+    }
+    
+    FSQCellManifestChangesetKey *anotherKey = object;
+    return (_hash == anotherKey->_hash
+            && _cellClass == anotherKey->_cellClass
+            && [_model isEqual:anotherKey->_model]);
+}
+
+@end
+
+#pragma mark - Matching helpers
+
+static id FSQChangesetKeyForCellRecord(FSQCellRecord *record) {
+    if ([record hasModel]) {
+        return [[FSQCellManifestChangesetKey alloc] initWithModel:record.model cellClass:record.cellClass];
+    }
+    else {
+        // Records without a model can only be matched with themselves
+        return [NSValue valueWithNonretainedObject:record];
+    }
+}
+
+static NSArray *FSQChangesetKeysForCellRecords(NSArray<FSQCellRecord *> *cellRecords) {
+    NSMutableArray *keys = [[NSMutableArray alloc] initWithCapacity:[cellRecords count]];
+    for (FSQCellRecord *record in cellRecords) {
+        [keys addObject:FSQChangesetKeyForCellRecord(record)];
+    }
+    return keys;
+}
+
+/**
+ Records from the page cache are keyed by their index in it, so they only match the record at the same index of a
+ section sharing the cache, and none of them have to be created. Their indexes are added to lazyIndexes.
+ Inserted records are keyed as usual.
+ */
+static NSArray *FSQChangesetKeysForPagedCellRecords(FSQCellManifestPagedArray<FSQCellRecord *> *cellRecords, NSMutableIndexSet *lazyIndexes) {
+    NSMutableArray *keys = [[NSMutableArray alloc] initWithCapacity:[cellRecords count]];
+    [cellRecords enumerateRunsUsingBlock:^(NSRange range, NSArray<FSQCellRecord *> *_Nullable objects, NSUInteger pageCacheIndex, BOOL *stop) {
+        if (objects) {
+            for (FSQCellRecord *record in objects) {
+                [keys addObject:FSQChangesetKeyForCellRecord(record)];
+            }
+        }
+        else {
+            for (NSUInteger offset = 0; offset < range.length; ++offset) {
+                [keys addObject:@(pageCacheIndex + offset)];
+            }
+            [lazyIndexes addIndexesInRange:range];
+        }
+    }];
+    return keys;
+}
+
+static FSQCellManifestPagedArray<FSQCellRecord *> *_Nullable FSQChangesetLazyCellRecords(FSQSectionRecord *sectionRecord) {
+    NSArray<FSQCellRecord *> *cellRecords = sectionRecord.cellRecords;
+    if ([cellRecords isKindOfClass:[FSQCellManifestPagedArray class]]
+        && [(FSQCellManifestPagedArray *)cellRecords pageCache]) {
+        return (FSQCellManifestPagedArray<FSQCellRecord *> *)cellRecords;
+    }
+    else {
+        return nil;
+    }
+}
+
+/**
+ Lazy cell records can only be diffed without creating them against lazy records from the same page cache.
+ */
+static BOOL FSQChangesetCanDiffCellRecords(FSQSectionRecord *sectionRecord, FSQSectionRecord *anotherSectionRecord) {
+    FSQCellManifestPagedArray *lazyCellRecords = FSQChangesetLazyCellRecords(sectionRecord);
+    FSQCellManifestPagedArray *anotherLazyCellRecords = FSQChangesetLazyCellRecords(anotherSectionRecord);
+    return ((!lazyCellRecords && !anotherLazyCellRecords)
+            || lazyCellRecords.pageCache == anotherLazyCellRecords.pageCache);
+}
+
+static NSArray *FSQChangesetKeysForSectionRecords(NSArray<FSQSectionRecord *> *sectionRecords) {
+    NSMutableArray *keys = [[NSMutableArray alloc] initWithCapacity:[sectionRecords count]];
+    NSInteger unidentifiedSectionCount = 0;
+    for (FSQSectionRecord *sectionRecord in sectionRecords) {
+        if ([sectionRecord.header hasModel]) {
+            [keys addObject:FSQChangesetKeyForCellRecord(sectionRecord.header)];
+        }
+        else if ([sectionRecord.footer hasModel]) {
+            [keys addObject:FSQChangesetKeyForCellRecord(sectionRecord.footer)];
+        }
+        else {
+            // Sections with nothing to identify them are matched up in order
+            [keys addObject:@(unidentifiedSectionCount)];
+            ++unidentifiedSectionCount;
+        }
+    }
+    return keys;
+}
+
+static BOOL FSQChangesetCellRecordsAreEqual(FSQCellRecord *_Nullable record, FSQCellRecord *_Nullable anotherRecord) {
+    return ([record isEqualToCellRecord:anotherRecord] || (!record && !anotherRecord));
+}
+
+static BOOL FSQChangesetSectionAttributesAreEqual(FSQSectionRecord *sectionRecord, FSQSectionRecord *anotherSectionRecord) {
+    if (sectionRecord == anotherSectionRecord) {
+        return YES;
+    }
+    
+    NSValue *inset = [sectionRecord collectionViewSectionInsetPrivate];
+    NSValue *anotherInset = [anotherSectionRecord collectionViewSectionInsetPrivate];
+    
+    return (FSQChangesetCellRecordsAreEqual(sectionRecord.header, anotherSectionRecord.header)
+            && FSQChangesetCellRecordsAreEqual(sectionRecord.footer, anotherSectionRecord.footer)
+            && ([inset isEqualToValue:anotherInset] || (!inset && !anotherInset)));
+}
+
+static NSInteger *FSQChangesetIndexMap(NSMutableData *storage) {
+    NSInteger *map = storage.mutableBytes;
+    NSUInteger count = storage.length / sizeof(NSInteger);
+    for (NSUInteger i = 0; i < count; ++i) {
+        map[i] = NSNotFound;
+    }
+    return map;
+}
+
+/**
+ Pairs up equal keys between the two arrays, filling in the index maps. Unmatched indexes are left as NSNotFound.
+ 
+ When a key appears multiple times, occurrences are paired in order.
+ */
+static void FSQChangesetMatchKeys(NSArray *originalKeys, NSArray *newKeys, NSInteger *originalToNew, NSInteger *newToOriginal) {
+    NSMapTable<id, NSMutableArray<NSNumber *> *> *originalIndexesByKey = [NSMapTable strongToStrongObjectsMapTable];
+    
+    // Walk backwards so that the lowest index of each key ends up on top of its stack
+    for (NSInteger originalIndex = (NSInteger)[originalKeys count] - 1; originalIndex >= 0; --originalIndex) {
+        id key = originalKeys[originalIndex];
+        NSMutableArray<NSNumber *> *indexes = [originalIndexesByKey objectForKey:key];
+        if (!indexes) {
+            indexes = [NSMutableArray new];
+            [originalIndexesByKey setObject:indexes forKey:key];
+        }
+        [indexes addObject:@(originalIndex)];
+    }
+    
+    NSInteger newIndex = 0;
+    for (id key in newKeys) {
+        NSMutableArray<NSNumber *> *indexes = [originalIndexesByKey objectForKey:key];
+        NSNumber *originalIndex = [indexes lastObject];
+        if (originalIndex) {
+            [indexes removeLastObject];
+            originalToNew[[originalIndex integerValue]] = newIndex;
+            newToOriginal[newIndex] = [originalIndex integerValue];
+        }
+        ++newIndex;
+    }
+}
+
+/**
+ Fills in the number of unmatched indexes that come before each index.
+ */
+static void FSQChangesetCountUnmatched(const NSInteger *map, NSUInteger count, NSInteger *unmatchedBefore) {
+    NSInteger unmatched = 0;
+    for (NSUInteger i = 0; i < count; ++i) {
+        unmatchedBefore[i] = unmatched;
+        if (map[i] == NSNotFound) {
+            ++unmatched;
+        }
+    }
+}
+
+/**
+ Adds to stableIndexes the matched indexes that can stay where they are: the longest run of matched indexes whose
+ counterparts are in the same order. Every other matched index has to be moved.
+ 
+ This is a longest increasing subsequence, found in O(n log n) by keeping the smallest possible last counterpart of a
+ run of each length.
+ */
+static void FSQChangesetFindStableIndexes(const NSInteger *map, NSUInteger count, NSMutableIndexSet *stableIndexes) {
+    NSMutableData *runEndsStorage = [NSMutableData dataWithLength:count * sizeof(NSInteger)];
+    NSMutableData *predecessorsStorage = [NSMutableData dataWithLength:count * sizeof(NSInteger)];
+    NSInteger *runEnds = runEndsStorage.mutableBytes;
+    NSInteger *predecessors = predecessorsStorage.mutableBytes;
+    NSUInteger longestRun = 0;
+    
+    for (NSUInteger i = 0; i < count; ++i) {
+        NSInteger counterpart = map[i];
+        if (counterpart == NSNotFound) {
+            continue;
+        }
+        
+        // Find the shortest run that this index cannot extend
+        NSUInteger low = 0;
+        NSUInteger high = longestRun;
+        while (low < high) {
+            NSUInteger middle = low + (high - low) / 2;
+            if (map[runEnds[middle]] < counterpart) {
+                low = middle + 1;
+            }
+            else {
+                high = middle;
+            }
+        }
+        
+        predecessors[i] = (low > 0 ? runEnds[low - 1] : NSNotFound);
+        runEnds[low] = (NSInteger)i;
+        if (low == longestRun) {
+            ++longestRun;
+        }
+    }
+    
+    NSInteger index = (longestRun > 0 ? runEnds[longestRun - 1] : NSNotFound);
+    while (index != NSNotFound) {
+        [stableIndexes addIndex:(NSUInteger)index];
+        index = predecessors[index];
+    }
+}
+
+#pragma mark -
+
+@implementation FSQCellManifestChangeset {
+    NSMutableIndexSet *_deletedSectionIndexesMutable;
+    NSMutableIndexSet *_insertedSectionIndexesMutable;
+    NSMutableIndexSet *_reloadedSectionIndexesMutable;
+    NSMutableArray<NSNumber *> *_movedSectionInitialIndexesMutable;
+    NSMutableArray<NSNumber *> *_movedSectionTargetIndexesMutable;
+    NSMutableArray<NSIndexPath *> *_deletedIndexPathsMutable;
+    NSMutableArray<NSIndexPath *> *_insertedIndexPathsMutable;
+    NSMutableArray<NSIndexPath *> *_reloadedIndexPathsMutable;
+    NSMutableArray<NSIndexPath *> *_reloadedTargetIndexPathsMutable;
+    NSMutableArray<NSIndexPath *> *_movedInitialIndexPathsMutable;
+    NSMutableArray<NSIndexPath *> *_movedTargetIndexPathsMutable;
+    
+    // Distinct but equal records that stay in place, paired by position
+    NSMutableArray<FSQCellRecord *> *_unchangedOriginalRecords;
+    NSMutableArray<FSQCellRecord *> *_unchangedRecords;
+}
+
++ (instancetype)changesetFromSectionRecords:(nullable NSArray<FSQSectionRecord *> *)originalSectionRecords
+                           toSectionRecords:(nullable NSArray<FSQSectionRecord *> *)newSectionRecords {
+    return [[self alloc] initWithOriginalSectionRecords:originalSectionRecords sectionRecords:newSectionRecords];
+}
+
+- (instancetype)initWithOriginalSectionRecords:(nullable NSArray<FSQSectionRecord *> *)originalSectionRecords
+                                sectionRecords:(nullable NSArray<FSQSectionRecord *> *)sectionRecords {
+    if ((self = [super init])) {
+        _originalSectionRecords = [originalSectionRecords copy] ?: @[];
+        _sectionRecords = [sectionRecords copy] ?: @[];
+        
+        _deletedSectionIndexesMutable = [NSMutableIndexSet new];
+        _insertedSectionIndexesMutable = [NSMutableIndexSet new];
+        _reloadedSectionIndexesMutable = [NSMutableIndexSet new];
+        _movedSectionInitialIndexesMutable = [NSMutableArray new];
+        _movedSectionTargetIndexesMutable = [NSMutableArray new];
+        _deletedIndexPathsMutable = [NSMutableArray new];
+        _insertedIndexPathsMutable = [NSMutableArray new];
+        _reloadedIndexPathsMutable = [NSMutableArray new];
+        _reloadedTargetIndexPathsMutable = [NSMutableArray new];
+        _movedInitialIndexPathsMutable = [NSMutableArray new];
+        _movedTargetIndexPathsMutable = [NSMutableArray new];
+        _unchangedOriginalRecords = [NSMutableArray new];
+        _unchangedRecords = [NSMutableArray new];
+        
+        [self computeSectionChanges];
+        
+        _deletedSectionIndexes = [_deletedSectionIndexesMutable copy];
+        _insertedSectionIndexes = [_insertedSectionIndexesMutable copy];
+        _reloadedSectionIndexes = [_reloadedSectionIndexesMutable copy];
+        _movedSectionInitialIndexes = [_movedSectionInitialIndexesMutable copy];
+        _movedSectionTargetIndexes = [_movedSectionTargetIndexesMutable copy];
+        _deletedIndexPaths = [_deletedIndexPathsMutable copy];
+        _insertedIndexPaths = [_insertedIndexPathsMutable copy];
+        _reloadedIndexPaths = [_reloadedIndexPathsMutable copy];
+        _reloadedTargetIndexPaths = [_reloadedTargetIndexPathsMutable copy];
+        _movedInitialIndexPaths = [_movedInitialIndexPathsMutable copy];
+        _movedTargetIndexPaths = [_movedTargetIndexPathsMutable copy];
+        
+        _deletedSectionIndexesMutable = nil;
+        _insertedSectionIndexesMutable = nil;
+        _reloadedSectionIndexesMutable = nil;
+        _movedSectionInitialIndexesMutable = nil;
+        _movedSectionTargetIndexesMutable = nil;
+        _deletedIndexPathsMutable = nil;
+        _insertedIndexPathsMutable = nil;
+        _reloadedIndexPathsMutable = nil;
+        _reloadedTargetIndexPathsMutable = nil;
+        _movedInitialIndexPathsMutable = nil;
+        _movedTargetIndexPathsMutable = nil;
+    }
+    return self;
+}
+
+- (void)computeSectionChanges {
+    NSUInteger originalCount = [_originalSectionRecords count];
+    NSUInteger newCount = [_sectionRecords count];
+    
+    NSMutableData *originalToNewStorage = [NSMutableData dataWithLength:originalCount * sizeof(NSInteger)];
+    NSMutableData *newToOriginalStorage = [NSMutableData dataWithLength:newCount * sizeof(NSInteger)];
+    NSInteger *originalToNew = FSQChangesetIndexMap(originalToNewStorage);
+    NSInteger *newToOriginal = FSQChangesetIndexMap(newToOriginalStorage);
+    
+    FSQChangesetMatchKeys(FSQChangesetKeysForSectionRecords(_originalSectionRecords),
+                          FSQChangesetKeysForSectionRecords(_sectionRecords),
+                          originalToNew,
+                          newToOriginal);
+    
+    // Sections whose own attributes changed must be reloaded, which is only possible if they stay at the same index.
+    // So must virtual sections whose rows cannot be diffed without creating all of them.
+    NSMutableIndexSet *sectionsNeedingReload = [NSMutableIndexSet new];
+    for (NSUInteger originalIndex = 0; originalIndex < originalCount; ++originalIndex) {
+        NSInteger newIndex = originalToNew[originalIndex];
+        if (newIndex != NSNotFound
+            && (!FSQChangesetSectionAttributesAreEqual(_originalSectionRecords[originalIndex], _sectionRecords[newIndex])
+                || !FSQChangesetCanDiffCellRecords(_originalSectionRecords[originalIndex], _sectionRecords[newIndex]))) {
+            if ((NSUInteger)newIndex == originalIndex) {
+                [sectionsNeedingReload addIndex:originalIndex];
+            }
+            else {
+                originalToNew[originalIndex] = NSNotFound;
+                newToOriginal[newIndex] = NSNotFound;
+            }
+        }
+    }
+    
+    NSMutableData *deletedBeforeStorage = [NSMutableData dataWithLength:originalCount * sizeof(NSInteger)];
+    NSMutableData *insertedBeforeStorage = [NSMutableData dataWithLength:newCount * sizeof(NSInteger)];
+    NSInteger *deletedBefore = deletedBeforeStorage.mutableBytes;
+    NSInteger *insertedBefore = insertedBeforeStorage.mutableBytes;
+    FSQChangesetCountUnmatched(originalToNew, originalCount, deletedBefore);
+    FSQChangesetCountUnmatched(newToOriginal, newCount, insertedBefore);
+    
+    for (NSUInteger originalIndex = 0; originalIndex < originalCount; ++originalIndex) {
+        NSInteger newIndex = originalToNew[originalIndex];
+        
+        if (newIndex == NSNotFound) {
+            [_deletedSectionIndexesMutable addIndex:originalIndex];
+            continue;
+        }
+        
+        if ([sectionsNeedingReload containsIndex:originalIndex]) {
+            [_reloadedSectionIndexesMutable addIndex:originalIndex];
+            continue;
+        }
+        
+        BOOL moved = ((NSInteger)originalIndex - deletedBefore[originalIndex] != newIndex - insertedBefore[newIndex]);
+        if (moved) {
+            [_movedSectionInitialIndexesMutable addObject:@(originalIndex)];
+            [_movedSectionTargetIndexesMutable addObject:@(newIndex)];
+        }
+        
+        FSQSectionRecord *originalSectionRecord = _originalSectionRecords[originalIndex];
+        FSQSectionRecord *sectionRecord = _sectionRecords[newIndex];
+        [self addUnchangedRecord:sectionRecord.header originalRecord:originalSectionRecord.header];
+        [self addUnchangedRecord:sectionRecord.footer originalRecord:originalSectionRecord.footer];
+        
+        [self computeCellChangesFromSection:originalIndex toSection:newIndex sectionMoved:moved];
+    }
+    
+    for (NSUInteger newIndex = 0; newIndex < newCount; ++newIndex) {
+        if (newToOriginal[newIndex] == NSNotFound) {
+            [_insertedSectionIndexesMutable addIndex:newIndex];
+        }
+    }
+}
+
+- (void)computeCellChangesFromSection:(NSUInteger)originalSectionIndex toSection:(NSUInteger)newSectionIndex sectionMoved:(BOOL)sectionMoved {
+    NSArray<FSQCellRecord *> *originalCellRecords = _originalSectionRecords[originalSectionIndex].cellRecords;
+    NSArray<FSQCellRecord *> *newCellRecords = _sectionRecords[newSectionIndex].cellRecords;
+    
+    if (originalCellRecords == newCellRecords) {
+        return;
+    }
+    
+    NSUInteger originalCount = [originalCellRecords count];
+    NSUInteger newCount = [newCellRecords count];
+    
+    NSMutableData *originalToNewStorage = [NSMutableData dataWithLength:originalCount * sizeof(NSInteger)];
+    NSMutableData *newToOriginalStorage = [NSMutableData dataWithLength:newCount * sizeof(NSInteger)];
+    NSInteger *originalToNew = FSQChangesetIndexMap(originalToNewStorage);
+    NSInteger *newToOriginal = FSQChangesetIndexMap(newToOriginalStorage);
+    
+    // Lazy records matched by their page cache index are the same record, so they are never changed
+    NSMutableIndexSet *originalLazyIndexes = [NSMutableIndexSet new];
+    FSQCellManifestPagedArray<FSQCellRecord *> *originalLazyCellRecords = FSQChangesetLazyCellRecords(_originalSectionRecords[originalSectionIndex]);
+    FSQCellManifestPagedArray<FSQCellRecord *> *newLazyCellRecords = FSQChangesetLazyCellRecords(_sectionRecords[newSectionIndex]);
+    if (originalLazyCellRecords && newLazyCellRecords) {
+        FSQChangesetMatchKeys(FSQChangesetKeysForPagedCellRecords(originalLazyCellRecords, originalLazyIndexes),
+                              FSQChangesetKeysForPagedCellRecords(newLazyCellRecords, [NSMutableIndexSet new]),
+                              originalToNew,
+                              newToOriginal);
+    }
+    else {
+        FSQChangesetMatchKeys(FSQChangesetKeysForCellRecords(originalCellRecords),
+                              FSQChangesetKeysForCellRecords(newCellRecords),
+                              originalToNew,
+                              newToOriginal);
+    }
+    
+    // Rows only move relative to the other matched rows of their section, so the section's own insertion, deletion or
+    // move carries its rows along with it. The rows in the longest run that keeps its order stay where they are, and
+    // the rest are moved.
+    NSMutableIndexSet *stableCells = [NSMutableIndexSet new];
+    FSQChangesetFindStableIndexes(originalToNew, originalCount, stableCells);
+    
+    // Changed cells are reloaded if they stay where they are in a section that is not itself moved. Anything else that
+    // changed is deleted and re-inserted, which leaves the other rows' order alone.
+    for (NSUInteger originalIndex = 0; originalIndex < originalCount; ++originalIndex) {
+        NSInteger newIndex = originalToNew[originalIndex];
+        
+        if (newIndex == NSNotFound) {
+            [_deletedIndexPathsMutable addObject:FSQIndexPathMake(originalSectionIndex, originalIndex)];
+            continue;
+        }
+        
+        BOOL isLazy = [originalLazyIndexes containsIndex:originalIndex];
+        BOOL changed = (!isLazy && ![originalCellRecords[originalIndex] isEqualToCellRecord:newCellRecords[newIndex]]);
+        BOOL stable = [stableCells containsIndex:originalIndex];
+        
+        if (changed && (sectionMoved || !stable)) {
+            newToOriginal[newIndex] = NSNotFound;
+            originalToNew[originalIndex] = NSNotFound;
+            [_deletedIndexPathsMutable addObject:FSQIndexPathMake(originalSectionIndex, originalIndex)];
+        }
+        else if (changed) {
+            [_reloadedIndexPathsMutable addObject:FSQIndexPathMake(originalSectionIndex, originalIndex)];
+            [_reloadedTargetIndexPathsMutable addObject:FSQIndexPathMake(newSectionIndex, newIndex)];
+        }
+        else if (!stable) {
+            [_movedInitialIndexPathsMutable addObject:FSQIndexPathMake(originalSectionIndex, originalIndex)];
+            [_movedTargetIndexPathsMutable addObject:FSQIndexPathMake(newSectionIndex, newIndex)];
+        }
+        else if (!isLazy) {
+            [self addUnchangedRecord:newCellRecords[newIndex] originalRecord:originalCellRecords[originalIndex]];
+        }
+    }
+    
+    for (NSUInteger newIndex = 0; newIndex < newCount; ++newIndex) {
+        if (newToOriginal[newIndex] == NSNotFound) {
+            [_insertedIndexPathsMutable addObject:FSQIndexPathMake(newSectionIndex, newIndex)];
+        }
+    }
+}
+
+- (void)addUnchangedRecord:(nullable FSQCellRecord *)record originalRecord:(nullable FSQCellRecord *)originalRecord {
+    if (record && originalRecord && record != originalRecord) {
+        [_unchangedOriginalRecords addObject:originalRecord];
+        [_unchangedRecords addObject:record];
+    }
+}
+
+// Exposed for internal use of other FSQCellManifest files only.
+// Lets the manifest carry state keyed by record identity, such as cached sizes, over to equal replacement records.
+- (void)enumerateUnchangedRecordsUsingBlock:(void (^)(FSQCellRecord *originalRecord, FSQCellRecord *record))block {
+    [_unchangedOriginalRecords enumerateObjectsUsingBlock:^(FSQCellRecord *originalRecord, NSUInteger idx, BOOL *stop) {
+        block(originalRecord, self->_unchangedRecords[idx]);
+    }];
+}
+
+// Exposed for internal use of other FSQCellManifest files only.
+// UITableView and UICollectionView treat a reload as a delete and insert at the same index path, so a reloaded cell
+// whose index path changes is passed to the block as a deletion of its original index path and an insertion at its
+// target index path instead.
+- (void)withRowChangesForBatchUpdates:(void (^)(NSArray<NSIndexPath *> *deletedIndexPaths, NSArray<NSIndexPath *> *insertedIndexPaths, NSArray<NSIndexPath *> *reloadedIndexPaths))block {
+    NSIndexSet *shiftedReloads = [_reloadedIndexPaths indexesOfObjectsPassingTest:^BOOL(NSIndexPath *indexPath, NSUInteger reloadIndex, BOOL *stop) {
+        return ![indexPath isEqual:self->_reloadedTargetIndexPaths[reloadIndex]];
+    }];
+    
+    if ([shiftedReloads count] == 0) {
+        block(_deletedIndexPaths, _insertedIndexPaths, _reloadedIndexPaths);
+        return;
+    }
+    
+    NSMutableArray<NSIndexPath *> *deletedIndexPaths = [_deletedIndexPaths mutableCopy];
+    NSMutableArray<NSIndexPath *> *insertedIndexPaths = [_insertedIndexPaths mutableCopy];
+    NSMutableArray<NSIndexPath *> *reloadedIndexPaths = [_reloadedIndexPaths mutableCopy];
+    [deletedIndexPaths addObjectsFromArray:[_reloadedIndexPaths objectsAtIndexes:shiftedReloads]];
+    [insertedIndexPaths addObjectsFromArray:[_reloadedTargetIndexPaths objectsAtIndexes:shiftedReloads]];
+    [reloadedIndexPaths removeObjectsAtIndexes:shiftedReloads];
+    
+    block(deletedIndexPaths, insertedIndexPaths, reloadedIndexPaths);
+}
+
+- (BOOL)hasChanges {
+    return ([_deletedSectionIndexes count] > 0
+            || [_insertedSectionIndexes count] > 0
+            || [_reloadedSectionIndexes count] > 0
+            || [_movedSectionInitialIndexes count] > 0
+            || [_deletedIndexPaths count] > 0
+            || [_insertedIndexPaths count] > 0
+            || [_reloadedIndexPaths count] > 0
+            || [_movedInitialIndexPaths count] > 0);
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p; sections: -%@ +%@ ~%@ moved %@; cells: -%@ +%@ ~%@ moved %@>",
+            [self class], self,
+            @([_deletedSectionIndexes count]),
+            @([_insertedSectionIndexes count]),
+            @([_reloadedSectionIndexes count]),
+            @([_movedSectionInitialIndexes count]),
+            @([_deletedIndexPaths count]),
+            @([_insertedIndexPaths count]),
+            @([_reloadedIndexPaths count]),
+            @([_movedInitialIndexPaths count])];
+}
+
+@end
+
+NS_ASSUME_NONNULL_END
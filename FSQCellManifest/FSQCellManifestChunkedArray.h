@@ -0,0 +1,73 @@
+//
+//  FSQCellManifestChunkedArray.h
+//
+//  Copyright (c) 2015 Foursquare. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Immutable arrays that can make modified copies of themselves without copying all of their objects.
+ 
+ FSQSectionRecord uses these methods instead of copying its cell records into a mutable array whenever its storage
+ conforms to this protocol.
+ */
+@protocol FSQCellManifestPersistentArray <NSObject>
+
+/**
+ @return A new array containing objects inserted in order starting at index. Index may be equal to count.
+ */
+- (NSArray *)arrayByInsertingObjects:(NSArray *)objects atIndex:(NSUInteger)index;
+
+/**
+ @return A new array without the objects at indexes. All indexes must be less than count.
+ */
+- (NSArray *)arrayByRemovingObjectsAtIndexes:(NSIndexSet *)indexes;
+
+/**
+ @return A new array with the object at index replaced. Index must be less than count.
+ */
+- (NSArray *)arrayByReplacingObjectAtIndex:(NSUInteger)index withObject:(id)object;
+
+@end
+
+/**
+ An immutable NSArray stored as a balanced tree of small chunks.
+ 
+ Index lookups are O(log n). Inserting, removing or replacing objects returns a new array in O(log n) time per
+ contiguous run of changed objects, sharing every chunk that did not change with the original array.
+ Fast enumeration walks the chunks directly, so it is as cheap as enumerating an NSArray.
+ 
+ FSQSectionRecord switches to this storage for large sections so that incremental updates from the manifest
+ do not copy the entire array of cell records.
+ 
+ This is an internal class and should not be used outside of the framework.
+ */
+@interface FSQCellManifestChunkedArray<ObjectType> : NSArray<ObjectType> <FSQCellManifestPersistentArray>
+
+/**
+ Compares the arrays leaf by leaf. Parts of the two arrays that share a leaf (such as an array and a modified copy of
+ it) are skipped without comparing their objects.
+ */
+- (BOOL)isEqualToChunkedArray:(FSQCellManifestChunkedArray<ObjectType> *)otherArray;
+
+/**
+ @return A new array containing objects inserted in order starting at index. Index may be equal to count.
+ */
+- (FSQCellManifestChunkedArray<ObjectType> *)arrayByInsertingObjects:(NSArray<ObjectType> *)objects atIndex:(NSUInteger)index;
+
+/**
+ @return A new array without the objects at indexes. All indexes must be less than count.
+ */
+- (FSQCellManifestChunkedArray<ObjectType> *)arrayByRemovingObjectsAtIndexes:(NSIndexSet *)indexes;
+
+/**
+ @return A new array with the object at index replaced. Index must be less than count.
+ */
+- (FSQCellManifestChunkedArray<ObjectType> *)arrayByReplacingObjectAtIndex:(NSUInteger)index withObject:(ObjectType)object;
+
+@end
+
+NS_ASSUME_NONNULL_END
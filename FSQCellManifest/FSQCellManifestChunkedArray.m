@@ -0,0 +1,380 @@
+//
+//  FSQCellManifestChunkedArray.m
+//
+//  Copyright (c) 2015 Foursquare. All rights reserved.
+//
+
+#import "FSQCellManifestChunkedArray.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+static const NSUInteger kFSQChunkedArrayLeafCapacity = 64;
+static const NSUInteger kFSQChunkedArrayBranchCapacity = 32;
+
+/**
+ A node of the tree. Leaves hold objects, branches hold child nodes. All leaves are at the same depth.
+ Nodes are never modified after they are created, which is what allows arrays to share them.
+ */
+@interface FSQChunkedArrayNode : NSObject {
+    @public
+    NSUInteger _count;
+    NSArray *_Nullable _objects;
+    NSArray<FSQChunkedArrayNode *> *_Nullable _children;
+}
+@end
+
+@implementation FSQChunkedArrayNode
+@end
+
+static FSQChunkedArrayNode *FSQChunkedArrayLeaf(NSArray *objects) {
+    FSQChunkedArrayNode *node = [FSQChunkedArrayNode new];
+    node->_objects = [objects copy];
+    node->_count = [objects count];
+    return node;
+}
+
+static FSQChunkedArrayNode *FSQChunkedArrayBranch(NSArray<FSQChunkedArrayNode *> *children) {
+    FSQChunkedArrayNode *node = [FSQChunkedArrayNode new];
+    node->_children = [children copy];
+    for (FSQChunkedArrayNode *child in children) {
+        node->_count += child->_count;
+    }
+    return node;
+}
+
+/**
+ Splits items into as few evenly sized nodes as possible without exceeding capacity.
+ */
+static NSArray<FSQChunkedArrayNode *> *FSQChunkedArrayNodesFromItems(NSArray *items, BOOL makeLeaves) {
+    NSUInteger capacity = (makeLeaves ? kFSQChunkedArrayLeafCapacity : kFSQChunkedArrayBranchCapacity);
+    NSUInteger itemCount = [items count];
+    NSUInteger nodeCount = MAX((itemCount + capacity - 1) / capacity, (NSUInteger)1);
+    
+    NSMutableArray<FSQChunkedArrayNode *> *nodes = [[NSMutableArray alloc] initWithCapacity:nodeCount];
+    NSUInteger location = 0;
+    for (NSUInteger nodeIndex = 0; nodeIndex < nodeCount; ++nodeIndex) {
+        NSUInteger length = (itemCount - location) / (nodeCount - nodeIndex);
+        NSArray *nodeItems = [items subarrayWithRange:NSMakeRange(location, length)];
+        [nodes addObject:(makeLeaves ? FSQChunkedArrayLeaf(nodeItems) : FSQChunkedArrayBranch(nodeItems))];
+        location += length;
+    }
+    return nodes;
+}
+
+/**
+ Stacks nodes of equal depth under new branches until there is a single root.
+ */
+static FSQChunkedArrayNode *FSQChunkedArrayRootFromNodes(NSArray<FSQChunkedArrayNode *> *nodes) {
+    while ([nodes count] > 1) {
+        nodes = FSQChunkedArrayNodesFromItems(nodes, NO);
+    }
+    return [nodes firstObject] ?: FSQChunkedArrayLeaf(@[]);
+}
+
+/**
+ Finds the child of a branch containing index, and converts index to be relative to that child.
+ An index equal to the branch's count resolves to the end of its last child.
+ */
+static NSUInteger FSQChunkedArrayChildIndex(FSQChunkedArrayNode *branch, NSUInteger *index) {
+    NSUInteger childCount = [branch->_children count];
+    for (NSUInteger childIndex = 0; childIndex < childCount; ++childIndex) {
+        NSUInteger count = branch->_children[childIndex]->_count;
+        if (*index < count || childIndex == childCount - 1) {
+            return childIndex;
+        }
+        *index -= count;
+    }
+    return 0;
+}
+
+static NSArray<FSQChunkedArrayNode *> *FSQChunkedArrayInsert(FSQChunkedArrayNode *node, NSUInteger index, NSArray *objects) {
+    if (node->_objects) {
+        NSMutableArray *newObjects = [node->_objects mutableCopy];
+        [newObjects insertObjects:objects atIndexes:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(index, [objects count])]];
+        return FSQChunkedArrayNodesFromItems(newObjects, YES);
+    }
+    else {
+        NSUInteger childIndex = FSQChunkedArrayChildIndex(node, &index);
+        NSArray<FSQChunkedArrayNode *> *newChildNodes = FSQChunkedArrayInsert(node->_children[childIndex], index, objects);
+        
+        NSMutableArray<FSQChunkedArrayNode *> *newChildren = [node->_children mutableCopy];
+        [newChildren replaceObjectsInRange:NSMakeRange(childIndex, 1) withObjectsFromArray:newChildNodes];
+        return FSQChunkedArrayNodesFromItems(newChildren, NO);
+    }
+}
+
+static BOOL FSQChunkedArrayNodeIsUnderfull(FSQChunkedArrayNode *node) {
+    if (node->_objects) {
+        return ([node->_objects count] < kFSQChunkedArrayLeafCapacity / 2);
+    }
+    else {
+        return ([node->_children count] < kFSQChunkedArrayBranchCapacity / 2);
+    }
+}
+
+/**
+ Merges each underfull child with a sibling, or evens them out if they do not fit in one node, so that every node
+ except the root stays at least half full and repeated removals cannot leave a tree of nearly empty leaves.
+ */
+static void FSQChunkedArrayRebalanceChildren(NSMutableArray<FSQChunkedArrayNode *> *children) {
+    NSUInteger childIndex = 0;
+    while (childIndex < [children count] && [children count] > 1) {
+        if (!FSQChunkedArrayNodeIsUnderfull(children[childIndex])) {
+            ++childIndex;
+            continue;
+        }
+        
+        NSRange pairRange = NSMakeRange((childIndex + 1 < [children count] ? childIndex : childIndex - 1), 2);
+        FSQChunkedArrayNode *first = children[pairRange.location];
+        FSQChunkedArrayNode *second = children[pairRange.location + 1];
+        BOOL isLeaf = (first->_objects != nil);
+        NSArray *items = nil;
+        if (isLeaf) {
+            items = [first->_objects arrayByAddingObjectsFromArray:second->_objects];
+        }
+        else {
+            // An underfull branch can end in an underfull child, which now sits next to the other branch's children
+            NSMutableArray<FSQChunkedArrayNode *> *grandchildren = [first->_children mutableCopy];
+            [grandchildren addObjectsFromArray:second->_children];
+            FSQChunkedArrayRebalanceChildren(grandchildren);
+            items = grandchildren;
+        }
+        [children replaceObjectsInRange:pairRange withObjectsFromArray:FSQChunkedArrayNodesFromItems(items, isLeaf)];
+        
+        // A merged node can still be underfull if both siblings were, so check it again
+        childIndex = pairRange.location;
+    }
+}
+
+static FSQChunkedArrayNode *_Nullable FSQChunkedArrayRemove(FSQChunkedArrayNode *node, NSRange range) {
+    if (range.location == 0 && range.length >= node->_count) {
+        return nil;
+    }
+    
+    if (node->_objects) {
+        NSMutableArray *newObjects = [node->_objects mutableCopy];
+        [newObjects removeObjectsInRange:range];
+        return FSQChunkedArrayLeaf(newObjects);
+    }
+    else {
+        NSMutableArray<FSQChunkedArrayNode *> *newChildren = [NSMutableArray new];
+        NSUInteger childStart = 0;
+        for (FSQChunkedArrayNode *child in node->_children) {
+            NSRange childRange = NSIntersectionRange(range, NSMakeRange(childStart, child->_count));
+            if (childRange.length == 0) {
+                [newChildren addObject:child];
+            }
+            else {
+                FSQChunkedArrayNode *newChild = FSQChunkedArrayRemove(child, NSMakeRange(childRange.location - childStart, childRange.length));
+                if (newChild) {
+                    [newChildren addObject:newChild];
+                }
+            }
+            childStart += child->_count;
+        }
+        FSQChunkedArrayRebalanceChildren(newChildren);
+        return FSQChunkedArrayBranch(newChildren);
+    }
+}
+
+static FSQChunkedArrayNode *FSQChunkedArrayReplace(FSQChunkedArrayNode *node, NSUInteger index, id object) {
+    if (node->_objects) {
+        NSMutableArray *newObjects = [node->_objects mutableCopy];
+        newObjects[index] = object;
+        return FSQChunkedArrayLeaf(newObjects);
+    }
+    else {
+        NSUInteger childIndex = FSQChunkedArrayChildIndex(node, &index);
+        NSMutableArray<FSQChunkedArrayNode *> *newChildren = [node->_children mutableCopy];
+        newChildren[childIndex] = FSQChunkedArrayReplace(node->_children[childIndex], index, object);
+        return FSQChunkedArrayBranch(newChildren);
+    }
+}
+
+static FSQChunkedArrayNode *FSQChunkedArrayLeafContainingIndex(FSQChunkedArrayNode *node, NSUInteger *index) {
+    while (!node->_objects) {
+        node = node->_children[FSQChunkedArrayChildIndex(node, index)];
+    }
+    return node;
+}
+
+static void FSQChunkedArrayAppendLeaves(FSQChunkedArrayNode *node, NSMutableArray<FSQChunkedArrayNode *> *leaves) {
+    if (node->_objects) {
+        [leaves addObject:node];
+    }
+    else {
+        for (FSQChunkedArrayNode *child in node->_children) {
+            FSQChunkedArrayAppendLeaves(child, leaves);
+        }
+    }
+}
+
+@implementation FSQCellManifestChunkedArray {
+    FSQChunkedArrayNode *_root;
+}
+
+- (instancetype)init {
+    return [self initWithRoot:FSQChunkedArrayLeaf(@[])];
+}
+
+- (instancetype)initWithObjects:(const id _Nonnull [_Nullable])objects count:(NSUInteger)count {
+    NSArray *array = [[NSArray alloc] initWithObjects:objects count:count];
+    return [self initWithRoot:FSQChunkedArrayRootFromNodes(FSQChunkedArrayNodesFromItems(array, YES))];
+}
+
+- (instancetype)initWithArray:(NSArray *)array {
+    return [self initWithRoot:FSQChunkedArrayRootFromNodes(FSQChunkedArrayNodesFromItems(array, YES))];
+}
+
+- (instancetype)initWithRoot:(FSQChunkedArrayNode *)root {
+    if ((self = [super init])) {
+        _root = root;
+    }
+    return self;
+}
+
+- (NSUInteger)count {
+    return _root->_count;
+}
+
+- (id)objectAtIndex:(NSUInteger)index {
+    if (index >= _root->_count) {
+        @throw [NSException exceptionWithName:NSRangeException
+                                       reason:[NSString stringWithFormat:@"Index %lu beyond bounds of FSQCellManifestChunkedArray of count %lu", (unsigned long)index, (unsigned long)_root->_count]
+                                     userInfo:nil];
+    }
+    
+    FSQChunkedArrayNode *leaf = FSQChunkedArrayLeafContainingIndex(_root, &index);
+    return leaf->_objects[index];
+}
+
+- (void)getObjects:(id __unsafe_unretained [])objects range:(NSRange)range {
+    NSUInteger index = range.location;
+    NSUInteger copied = 0;
+    while (copied < range.length) {
+        NSUInteger leafIndex = index;
+        FSQChunkedArrayNode *leaf = FSQChunkedArrayLeafContainingIndex(_root, &leafIndex);
+        NSUInteger length = MIN(range.length - copied, leaf->_count - leafIndex);
+        [leaf->_objects getObjects:(objects + copied) range:NSMakeRange(leafIndex, length)];
+        copied += length;
+        index += length;
+    }
+}
+
+- (NSUInteger)countByEnumeratingWithState:(NSFastEnumerationState *)state objects:(id __unsafe_unretained [])buffer count:(NSUInteger)len {
+    NSUInteger index = state->state;
+    if (index >= _root->_count || len == 0) {
+        return 0;
+    }
+    
+    // Immutable, so the mutation pointer only needs to point at something that never changes
+    state->mutationsPtr = &state->extra[0];
+    
+    // Hand out at most one leaf per call so each call is a single O(log n) descent
+    NSUInteger leafIndex = index;
+    FSQChunkedArrayNode *leaf = FSQChunkedArrayLeafContainingIndex(_root, &leafIndex);
+    NSUInteger length = MIN(len, leaf->_count - leafIndex);
+    [leaf->_objects getObjects:buffer range:NSMakeRange(leafIndex, length)];
+    
+    state->itemsPtr = buffer;
+    state->state = index + length;
+    return length;
+}
+
+- (id)copyWithZone:(nullable NSZone *)zone {
+    return self;
+}
+
+- (Class)classForCoder {
+    return [NSArray class];
+}
+
+- (BOOL)isEqualToChunkedArray:(FSQCellManifestChunkedArray *)otherArray {
+    if (self == otherArray || _root == otherArray->_root) {
+        return YES;
+    }
+    
+    NSUInteger count = _root->_count;
+    if (count != otherArray->_root->_count) {
+        return NO;
+    }
+    
+    NSMutableArray<FSQChunkedArrayNode *> *leaves = [NSMutableArray new];
+    NSMutableArray<FSQChunkedArrayNode *> *otherLeaves = [NSMutableArray new];
+    FSQChunkedArrayAppendLeaves(_root, leaves);
+    FSQChunkedArrayAppendLeaves(otherArray->_root, otherLeaves);
+    
+    // Walk both leaf lists together, comparing the overlapping parts of each pair of leaves
+    NSUInteger leafIndex = 0;
+    NSUInteger otherLeafIndex = 0;
+    NSUInteger offset = 0;
+    NSUInteger otherOffset = 0;
+    NSUInteger index = 0;
+    while (index < count) {
+        FSQChunkedArrayNode *leaf = leaves[leafIndex];
+        FSQChunkedArrayNode *otherLeaf = otherLeaves[otherLeafIndex];
+        NSUInteger length = MIN(leaf->_count - offset, otherLeaf->_count - otherOffset);
+        
+        if (leaf->_objects != otherLeaf->_objects || offset != otherOffset) {
+            for (NSUInteger i = 0; i < length; ++i) {
+                id object = leaf->_objects[offset + i];
+                id otherObject = otherLeaf->_objects[otherOffset + i];
+                if (object != otherObject && ![object isEqual:otherObject]) {
+                    return NO;
+                }
+            }
+        }
+        
+        index += length;
+        offset += length;
+        otherOffset += length;
+        if (offset == leaf->_count) {
+            ++leafIndex;
+            offset = 0;
+        }
+        if (otherOffset == otherLeaf->_count) {
+            ++otherLeafIndex;
+            otherOffset = 0;
+        }
+    }
+    
+    return YES;
+}
+
+- (FSQCellManifestChunkedArray *)arrayByInsertingObjects:(NSArray *)objects atIndex:(NSUInteger)index {
+    NSParameterAssert(index <= _root->_count);
+    
+    if ([objects count] == 0) {
+        return self;
+    }
+    
+    return [[[self class] alloc] initWithRoot:FSQChunkedArrayRootFromNodes(FSQChunkedArrayInsert(_root, index, objects))];
+}
+
+- (FSQCellManifestChunkedArray *)arrayByRemovingObjectsAtIndexes:(NSIndexSet *)indexes {
+    NSParameterAssert([indexes count] == 0 || [indexes lastIndex] < _root->_count);
+    
+    __block FSQChunkedArrayNode *root = _root;
+    
+    // Back to front so earlier ranges are not shifted by later removals
+    [indexes enumerateRangesWithOptions:NSEnumerationReverse usingBlock:^(NSRange range, BOOL *stop) {
+        root = FSQChunkedArrayRemove(root, range) ?: FSQChunkedArrayLeaf(@[]);
+        
+        // Merging children can leave the root with a single child, which would add a level to every lookup
+        while (root->_children && [root->_children count] == 1) {
+            root = root->_children[0];
+        }
+    }];
+    
+    return (root == _root ? self : [[[self class] alloc] initWithRoot:root]);
+}
+
+- (FSQCellManifestChunkedArray *)arrayByReplacingObjectAtIndex:(NSUInteger)index withObject:(id)object {
+    NSParameterAssert(index < _root->_count);
+    
+    return [[[self class] alloc] initWithRoot:FSQChunkedArrayReplace(_root, index, object)];
+}
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,79 @@
+//
+//  FSQCellManifestCollectionViewLayout.h
+//
+//  Copyright (c) 2015 Foursquare. All rights reserved.
+//
+
+@import UIKit;
+
+#import "FSQCellManifestProtocols.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class FSQCollectionViewCellManifest;
+
+/**
+ A vertically scrolling collection view layout that gets its sizes straight from an FSQCollectionViewCellManifest
+ and keeps the layout of unchanged sections when the manifest's records change.
+ 
+ Each section is laid out like a vertical UICollectionViewFlowLayout: the header spans the full width, then the items
+ are placed left to right inside the section inset, wrapping onto a new row when the next item does not fit, and
+ then the footer. Rows are left aligned and their items are aligned to the top of the row. Item, header and footer
+ sizes and section insets are the ones the manifest gives UICollectionViewFlowLayout, so records size themselves the
+ same way with either layout. Setting this layout as a plugin turns on the manifest's cachesRecordSizes, and removing
+ it sets cachesRecordSizes back to what it was.
+ 
+ Every layout attribute is kept in one array sorted by its top edge, so layoutAttributesForElementsInRect: is a binary
+ search followed by a walk over just the elements that are in the rect.
+ 
+ The layout is notified of the manifest's record changes before the collection view is updated. When the collection
+ view asks for a new layout, the sections before the first one that changed are kept as they are, and only that
+ section and the ones after it are laid out again. The same goes for the sections of records passed to the manifest's
+ invalidateSizesForRecords:. Reloading the collection view, changing its width, or changing one of the properties below
+ lays out everything again.
+ 
+ To use it, create the collection view with this layout and add the layout to the manifest's plugins:
+     
+     FSQCellManifestCollectionViewLayout *layout = [FSQCellManifestCollectionViewLayout new];
+     UICollectionView *collectionView = [[UICollectionView alloc] initWithFrame:frame collectionViewLayout:layout];
+     manifest = [[FSQCollectionViewCellManifest alloc] initWithDelegate:self plugins:@[layout] collectionView:collectionView];
+ 
+ A layout can only be attached to one manifest at a time, and it lays out nothing until it is attached.
+ */
+@interface FSQCellManifestCollectionViewLayout : UICollectionViewLayout <FSQCellManifestPlugin, FSQCellManifestRecordModificationDelegate>
+
+/**
+ The manifest this layout is attached to as a plugin.
+ */
+@property (nonatomic, weak, readonly, nullable) FSQCollectionViewCellManifest *manifest;
+
+/**
+ The vertical space between rows of items in a section. Defaults to 0.
+ */
+@property (nonatomic) CGFloat minimumLineSpacing;
+
+/**
+ The minimum horizontal space between items in the same row. Defaults to 0.
+ */
+@property (nonatomic) CGFloat minimumInteritemSpacing;
+
+/**
+ The size used for header records whose cell class cannot measure them. Sections without a header record have no
+ header. Only the height is used. Defaults to CGSizeZero.
+ */
+@property (nonatomic) CGSize headerReferenceSize;
+
+/**
+ The size used for footer records whose cell class cannot measure them. Sections without a footer record have no
+ footer. Only the height is used. Defaults to CGSizeZero.
+ */
+@property (nonatomic) CGSize footerReferenceSize;
+
+/**
+ The inset used for sections that do not set collectionViewSectionInset. Defaults to UIEdgeInsetsZero.
+ */
+@property (nonatomic) UIEdgeInsets sectionInset;
+
+@end
+
+NS_ASSUME_NONNULL_END
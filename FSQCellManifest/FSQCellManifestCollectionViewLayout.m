@@ -0,0 +1,474 @@
+//
+//  FSQCellManifestCollectionViewLayout.m
+//
+//  Copyright (c) 2015 Foursquare. All rights reserved.
+//
+
+#import "FSQCellManifestCollectionViewLayout.h"
+
+#import "FSQCellManifest.h"
+#import "FSQCellManifestIndexPaths.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+// The layout of a single section. Its attributes are also stored in the layout's sorted element array, starting at
+// _firstElementIndex.
+@interface FSQCellManifestCollectionViewLayoutSection : NSObject {
+@public
+    CGFloat _maxY;
+    NSUInteger _firstElementIndex;
+    UICollectionViewLayoutAttributes *_Nullable _header;
+    UICollectionViewLayoutAttributes *_Nullable _footer;
+    NSArray<UICollectionViewLayoutAttributes *> *_items;
+}
+@end
+
+@implementation FSQCellManifestCollectionViewLayoutSection
+@end
+
+@implementation FSQCellManifestCollectionViewLayout {
+    NSMutableArray<FSQCellManifestCollectionViewLayoutSection *> *_sections;
+    // Every element in order of its top edge, and the largest bottom edge of each element and all those before it
+    NSMutableArray<UICollectionViewLayoutAttributes *> *_elements;
+    NSMutableData *_elementMaxYs;
+    CGFloat _contentWidth;
+    // NSIntegerMax when the layout is up to date
+    NSInteger _firstInvalidSectionIndex;
+    BOOL _hasPendingRecordChanges;
+    // The manifest's cachesRecordSizes from before this layout was attached, restored when it is removed
+    BOOL _manifestCachedRecordSizes;
+}
+
+- (instancetype)init {
+    if ((self = [super init])) {
+        [self commonInit];
+    }
+    return self;
+}
+
+- (nullable instancetype)initWithCoder:(NSCoder *)aDecoder {
+    if ((self = [super initWithCoder:aDecoder])) {
+        [self commonInit];
+    }
+    return self;
+}
+
+- (void)commonInit {
+    _sections = [NSMutableArray new];
+    _elements = [NSMutableArray new];
+    _elementMaxYs = [NSMutableData new];
+    _firstInvalidSectionIndex = 0;
+}
+
+#pragma mark - Properties
+
+- (void)setMinimumLineSpacing:(CGFloat)minimumLineSpacing {
+    if (_minimumLineSpacing != minimumLineSpacing) {
+        _minimumLineSpacing = minimumLineSpacing;
+        [self invalidateLayout];
+    }
+}
+
+- (void)setMinimumInteritemSpacing:(CGFloat)minimumInteritemSpacing {
+    if (_minimumInteritemSpacing != minimumInteritemSpacing) {
+        _minimumInteritemSpacing = minimumInteritemSpacing;
+        [self invalidateLayout];
+    }
+}
+
+- (void)setHeaderReferenceSize:(CGSize)headerReferenceSize {
+    if (!CGSizeEqualToSize(_headerReferenceSize, headerReferenceSize)) {
+        _headerReferenceSize = headerReferenceSize;
+        [self invalidateLayout];
+    }
+}
+
+- (void)setFooterReferenceSize:(CGSize)footerReferenceSize {
+    if (!CGSizeEqualToSize(_footerReferenceSize, footerReferenceSize)) {
+        _footerReferenceSize = footerReferenceSize;
+        [self invalidateLayout];
+    }
+}
+
+- (void)setSectionInset:(UIEdgeInsets)sectionInset {
+    if (!UIEdgeInsetsEqualToEdgeInsets(_sectionInset, sectionInset)) {
+        _sectionInset = sectionInset;
+        [self invalidateLayout];
+    }
+}
+
+#pragma mark - Invalidation
+
+- (void)invalidateSectionsFromIndex:(NSInteger)sectionIndex {
+    _firstInvalidSectionIndex = MIN(_firstInvalidSectionIndex, MAX(sectionIndex, 0));
+}
+
+- (void)invalidateSectionsFromIndexPaths:(NSArray<NSIndexPath *> *)indexPaths {
+    for (NSIndexPath *indexPath in indexPaths) {
+        [self invalidateSectionsFromIndex:FSQIndexPathSection(indexPath)];
+    }
+}
+
+- (void)recordsWillChangeFromSectionIndex:(NSInteger)sectionIndex {
+    [self invalidateSectionsFromIndex:sectionIndex];
+    _hasPendingRecordChanges = YES;
+}
+
+- (void)invalidateLayoutWithContext:(UICollectionViewLayoutInvalidationContext *)context {
+    if (context.invalidateEverything) {
+        [self invalidateSectionsFromIndex:0];
+    }
+    else if (context.invalidateDataSourceCounts && !_hasPendingRecordChanges) {
+        // The collection view was changed without going through the manifest, so there is no telling what changed
+        [self invalidateSectionsFromIndex:0];
+    }
+    
+    [self invalidateSectionsFromIndexPaths:context.invalidatedItemIndexPaths];
+    for (NSArray<NSIndexPath *> *indexPaths in [context.invalidatedSupplementaryIndexPaths objectEnumerator]) {
+        [self invalidateSectionsFromIndexPaths:indexPaths];
+    }
+    
+    [super invalidateLayoutWithContext:context];
+}
+
+- (BOOL)shouldInvalidateLayoutForBoundsChange:(CGRect)newBounds {
+    return (CGRectGetWidth(newBounds) != CGRectGetWidth(self.collectionView.bounds));
+}
+
+#pragma mark - Layout
+
+- (void)prepareLayout {
+    [super prepareLayout];
+    
+    _hasPendingRecordChanges = NO;
+    
+    UICollectionView *collectionView = self.collectionView;
+    FSQCollectionViewCellManifest *manifest = _manifest;
+    if (!collectionView || !manifest) {
+        [_sections removeAllObjects];
+        [_elements removeAllObjects];
+        _elementMaxYs.length = 0;
+        _firstInvalidSectionIndex = 0;
+        return;
+    }
+    
+    UIEdgeInsets contentInset = collectionView.contentInset;
+    CGFloat contentWidth = MAX(CGRectGetWidth(collectionView.bounds) - contentInset.left - contentInset.right, 0);
+    if (contentWidth != _contentWidth) {
+        _contentWidth = contentWidth;
+        [self invalidateSectionsFromIndex:0];
+    }
+    
+    NSInteger numberOfSections = [collectionView numberOfSections];
+    NSInteger firstSectionIndex = MIN(_firstInvalidSectionIndex, MIN((NSInteger)[_sections count], numberOfSections));
+    _firstInvalidSectionIndex = NSIntegerMax;
+    
+    if (firstSectionIndex == numberOfSections
+        && firstSectionIndex == [_sections count]) {
+        return;
+    }
+    
+    /**  Keep the sections before the first one that changed  **/
+    
+    NSUInteger firstElementIndex = (firstSectionIndex < [_sections count] ? _sections[firstSectionIndex]->_firstElementIndex : [_elements count]);
+    [_sections removeObjectsInRange:NSMakeRange(firstSectionIndex, [_sections count] - firstSectionIndex)];
+    [_elements removeObjectsInRange:NSMakeRange(firstElementIndex, [_elements count] - firstElementIndex)];
+    _elementMaxYs.length = firstElementIndex * sizeof(CGFloat);
+    
+    /**  Lay out the rest  **/
+    
+    CGFloat y = (firstSectionIndex > 0 ? _sections[firstSectionIndex - 1]->_maxY : 0);
+    for (NSInteger sectionIndex = firstSectionIndex; sectionIndex < numberOfSections; ++sectionIndex) {
+        FSQCellManifestCollectionViewLayoutSection *section = [self layoutSectionAtIndex:sectionIndex
+                                                                                    minY:y
+                                                                          collectionView:collectionView
+                                                                                manifest:manifest];
+        [_sections addObject:section];
+        y = section->_maxY;
+    }
+}
+
+- (FSQCellManifestCollectionViewLayoutSection *)layoutSectionAtIndex:(NSInteger)sectionIndex
+                                                                minY:(CGFloat)minY
+                                                      collectionView:(UICollectionView *)collectionView
+                                                            manifest:(FSQCollectionViewCellManifest *)manifest {
+    FSQCellManifestCollectionViewLayoutSection *section = [FSQCellManifestCollectionViewLayoutSection new];
+    section->_firstElementIndex = [_elements count];
+    
+    FSQSectionRecord *sectionRecord = [manifest sectionRecordAtIndex:sectionIndex];
+    Class attributesClass = [[self class] layoutAttributesClass];
+    CGFloat y = minY;
+    
+    /**  Header  **/
+    
+    // The manifest can only provide header and footer views for sections that have header and footer records
+    CGFloat headerHeight = (sectionRecord.header ? [manifest sizeForHeaderInSection:sectionIndex referenceSize:_headerReferenceSize].height : 0);
+    if (headerHeight > 0) {
+        UICollectionViewLayoutAttributes *header = [attributesClass layoutAttributesForSupplementaryViewOfKind:UICollectionElementKindSectionHeader
+                                                                                                 withIndexPath:FSQIndexPathMake(sectionIndex, 0)];
+        header.frame = CGRectMake(0, y, _contentWidth, headerHeight);
+        [self appendElement:header];
+        section->_header = header;
+        y += headerHeight;
+    }
+    
+    /**  Items  **/
+    
+    UIEdgeInsets inset = [manifest insetForSectionAtIndex:sectionIndex defaultInset:_sectionInset];
+    CGFloat rowMaxX = _contentWidth - inset.right;
+    CGFloat rowMinY = y + inset.top;
+    CGFloat rowHeight = 0;
+    CGFloat x = inset.left;
+    
+    NSInteger numberOfItems = [collectionView numberOfItemsInSection:sectionIndex];
+    NSMutableArray<UICollectionViewLayoutAttributes *> *items = [[NSMutableArray alloc] initWithCapacity:numberOfItems];
+    
+    for (NSInteger itemIndex = 0; itemIndex < numberOfItems; ++itemIndex) {
+        NSIndexPath *indexPath = FSQIndexPathMake(sectionIndex, itemIndex);
+        CGSize size = [manifest sizeForItemAtIndexPath:indexPath];
+        
+        // Start a new row if this item does not fit, unless it is the first item in its row
+        if (x > inset.left
+            && x + size.width > rowMaxX) {
+            rowMinY += rowHeight + _minimumLineSpacing;
+            rowHeight = 0;
+            x = inset.left;
+        }
+        
+        UICollectionViewLayoutAttributes *item = [attributesClass layoutAttributesForCellWithIndexPath:indexPath];
+        item.frame = CGRectMake(x, rowMinY, size.width, size.height);
+        [self appendElement:item];
+        [items addObject:item];
+        
+        x += size.width + _minimumInteritemSpacing;
+        rowHeight = MAX(rowHeight, size.height);
+    }
+    
+    section->_items = [items copy];
+    y = rowMinY + rowHeight + inset.bottom;
+    
+    /**  Footer  **/
+    
+    CGFloat footerHeight = (sectionRecord.footer ? [manifest sizeForFooterInSection:sectionIndex referenceSize:_footerReferenceSize].height : 0);
+    if (footerHeight > 0) {
+        UICollectionViewLayoutAttributes *footer = [attributesClass layoutAttributesForSupplementaryViewOfKind:UICollectionElementKindSectionFooter
+                                                                                                 withIndexPath:FSQIndexPathMake(sectionIndex, 0)];
+        footer.frame = CGRectMake(0, y, _contentWidth, footerHeight);
+        [self appendElement:footer];
+        section->_footer = footer;
+        y += footerHeight;
+    }
+    
+    section->_maxY = y;
+    return section;
+}
+
+- (void)appendElement:(UICollectionViewLayoutAttributes *)attributes {
+    CGFloat maxY = CGRectGetMaxY(attributes.frame);
+    NSUInteger count = [_elements count];
+    if (count > 0) {
+        maxY = MAX(maxY, ((const CGFloat *)_elementMaxYs.bytes)[count - 1]);
+    }
+    
+    [_elements addObject:attributes];
+    [_elementMaxYs appendBytes:&maxY length:sizeof(CGFloat)];
+}
+
+- (CGSize)collectionViewContentSize {
+    CGFloat height = ([_sections count] > 0 ? [_sections lastObject]->_maxY : 0);
+    return CGSizeMake(_contentWidth, height);
+}
+
+#pragma mark - Queries
+
+- (nullable NSArray<UICollectionViewLayoutAttributes *> *)layoutAttributesForElementsInRect:(CGRect)rect {
+    NSUInteger count = [_elements count];
+    if (count == 0) {
+        return @[];
+    }
+    
+    // Find the first element that reaches down into the rect. The running maximum of the elements' bottom edges
+    // never decreases, so it can be binary searched.
+    const CGFloat *elementMaxYs = _elementMaxYs.bytes;
+    CGFloat rectMinY = CGRectGetMinY(rect);
+    CGFloat rectMaxY = CGRectGetMaxY(rect);
+    NSUInteger low = 0;
+    NSUInteger high = count;
+    while (low < high) {
+        NSUInteger middle = low + (high - low) / 2;
+        if (elementMaxYs[middle] <= rectMinY) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+    
+    // Elements are sorted by their top edge, so stop at the first one below the rect
+    NSMutableArray<UICollectionViewLayoutAttributes *> *attributesInRect = [NSMutableArray new];
+    for (NSUInteger elementIndex = low; elementIndex < count; ++elementIndex) {
+        UICollectionViewLayoutAttributes *attributes = _elements[elementIndex];
+        CGRect frame = attributes.frame;
+        if (CGRectGetMinY(frame) >= rectMaxY) {
+            break;
+        }
+        if (CGRectIntersectsRect(frame, rect)) {
+            [attributesInRect addObject:attributes];
+        }
+    }
+    
+    return attributesInRect;
+}
+
+- (nullable UICollectionViewLayoutAttributes *)layoutAttributesForItemAtIndexPath:(NSIndexPath *)indexPath {
+    NSInteger sectionIndex = FSQIndexPathSection(indexPath);
+    NSInteger itemIndex = FSQIndexPathRowOrItem(indexPath);
+    if (sectionIndex < 0
+        || sectionIndex >= [_sections count]) {
+        return nil;
+    }
+    
+    NSArray<UICollectionViewLayoutAttributes *> *items = _sections[sectionIndex]->_items;
+    if (itemIndex < 0
+        || itemIndex >= [items count]) {
+        return nil;
+    }
+    
+    return items[itemIndex];
+}
+
+- (nullable UICollectionViewLayoutAttributes *)layoutAttributesForSupplementaryViewOfKind:(NSString *)elementKind atIndexPath:(NSIndexPath *)indexPath {
+    NSInteger sectionIndex = FSQIndexPathSection(indexPath);
+    if (sectionIndex < 0
+        || sectionIndex >= [_sections count]) {
+        return nil;
+    }
+    
+    FSQCellManifestCollectionViewLayoutSection *section = _sections[sectionIndex];
+    if ([elementKind isEqualToString:UICollectionElementKindSectionHeader]) {
+        return section->_header;
+    }
+    else if ([elementKind isEqualToString:UICollectionElementKindSectionFooter]) {
+        return section->_footer;
+    }
+    else {
+        return nil;
+    }
+}
+
+#pragma mark - FSQCellManifestPlugin
+
+- (void)wasAttachedToManifest:(FSQCellManifest *)manifest {
+    NSAssert([manifest isKindOfClass:[FSQCollectionViewCellManifest class]], @"FSQCellManifestCollectionViewLayout can only be attached to an FSQCollectionViewCellManifest");
+    NSAssert(!_manifest || _manifest == manifest, @"A collection view layout can only be attached to one manifest at a time");
+    
+    if (![manifest isKindOfClass:[FSQCollectionViewCellManifest class]]) {
+        return;
+    }
+    
+    if (_manifest != manifest) {
+        _manifest = (FSQCollectionViewCellManifest *)manifest;
+        _manifestCachedRecordSizes = manifest.cachesRecordSizes;
+    }
+    
+    // Sections after a change are laid out again from their records' sizes, so keep them around
+    manifest.cachesRecordSizes = YES;
+    
+    [self invalidateLayout];
+}
+
+- (void)wasRemovedFromManifest:(FSQCellManifest *)manifest {
+    if (_manifest != manifest) {
+        return;
+    }
+    
+    _manifest = nil;
+    manifest.cachesRecordSizes = _manifestCachedRecordSizes;
+    [self invalidateLayout];
+}
+
+- (void)manifest:(FSQCellManifest *)manifest didInvalidateSizesForRecordsAtIndexPaths:(nullable NSArray<NSIndexPath *> *)indexPaths {
+    if (_manifest != manifest) {
+        return;
+    }
+    
+    if (indexPaths) {
+        [self invalidateSectionsFromIndexPaths:indexPaths];
+    }
+    else {
+        [self invalidateSectionsFromIndex:0];
+    }
+    
+    // invalidateLayout would invalidate everything, which lays out every section again
+    [self invalidateLayoutWithContext:[[[self class] invalidationContextClass] new]];
+}
+
+#pragma mark - FSQCellManifestRecordModificationDelegate
+
+// These are all sent before the records and the collection view are updated, and record the first section whose
+// layout is affected. Index paths and indexes from before and after the change are both covered, since everything
+// before the lowest of them stays where it is.
+
+- (void)manifest:(FSQCellManifest *)manifest willReplaceSectionRecords:(NSArray<FSQSectionRecord *> *)currentSectionRecords withRecords:(NSArray<FSQSectionRecord *> *)newSectionRecords {
+    [self recordsWillChangeFromSectionIndex:0];
+}
+
+- (void)manifestWillReloadManagedView:(FSQCellManifest *)manifest {
+    [self recordsWillChangeFromSectionIndex:0];
+}
+
+- (void)manifest:(FSQCellManifest *)manifest willInsertCellRecords:(NSArray<FSQCellRecord *> *)cellRecords atIndexPath:(NSIndexPath *)indexPath {
+    [self recordsWillChangeFromSectionIndex:FSQIndexPathSection(indexPath)];
+}
+
+- (void)manifest:(FSQCellManifest *)manifest willMoveCellRecordAtIndexPath:(NSIndexPath *)initialIndexPath toIndexPath:(NSIndexPath *)targetIndexPath {
+    [self recordsWillChangeFromSectionIndex:MIN(FSQIndexPathSection(initialIndexPath), FSQIndexPathSection(targetIndexPath))];
+}
+
+- (void)manifest:(FSQCellManifest *)manifest willReplaceCellRecordsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths withRecords:(NSArray<FSQCellRecord *> *)cellRecords {
+    [self recordsWillChangeFromIndexPaths:indexPaths];
+}
+
+- (void)manifest:(FSQCellManifest *)manifest willRemoveCellRecordsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths removingEmptySections:(BOOL)willRemoveEmptySections {
+    [self recordsWillChangeFromIndexPaths:indexPaths];
+}
+
+- (void)manifest:(FSQCellManifest *)manifest willReloadCellsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths {
+    [self recordsWillChangeFromIndexPaths:indexPaths];
+}
+
+- (void)manifest:(FSQCellManifest *)manifest willInsertSectionRecords:(NSArray<FSQSectionRecord *> *)sectionRecords atIndex:(NSInteger)index {
+    [self recordsWillChangeFromSectionIndex:index];
+}
+
+- (void)manifest:(FSQCellManifest *)manifest willMoveSectionRecordAtIndex:(NSInteger)initialIndex toIndex:(NSInteger)targetIndex {
+    [self recordsWillChangeFromSectionIndex:MIN(initialIndex, targetIndex)];
+}
+
+- (void)manifest:(FSQCellManifest *)manifest willReplaceSectionRecordsAtIndexes:(NSArray<NSNumber *> *)indexes withRecords:(NSArray<FSQSectionRecord *> *)sectionRecords {
+    for (NSNumber *index in indexes) {
+        [self recordsWillChangeFromSectionIndex:[index integerValue]];
+    }
+}
+
+- (void)manifest:(FSQCellManifest *)manifest willRemoveSectionRecordsAtIndexes:(NSIndexSet *)indexes {
+    if ([indexes count] > 0) {
+        [self recordsWillChangeFromSectionIndex:[indexes firstIndex]];
+    }
+}
+
+- (void)manifest:(FSQCellManifest *)manifest willReloadSectionsAtIndexes:(NSIndexSet *)indexes {
+    if ([indexes count] > 0) {
+        [self recordsWillChangeFromSectionIndex:[indexes firstIndex]];
+    }
+}
+
+- (void)recordsWillChangeFromIndexPaths:(NSArray<NSIndexPath *> *)indexPaths {
+    for (NSIndexPath *indexPath in indexPaths) {
+        [self recordsWillChangeFromSectionIndex:FSQIndexPathSection(indexPath)];
+    }
+}
+
+@end
+
+NS_ASSUME_NONNULL_END
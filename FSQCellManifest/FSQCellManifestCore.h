@@ -0,0 +1,652 @@
+//
+//  FSQCellManifestCore.h
+//
+//  Copyright (c) 2015 Foursquare. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+#import "FSQCellManifestChangeset.h"
+#import "FSQCellRecord.h"
+#import "FSQSectionRecord.h"
+#import "FSQVirtualSectionRecord.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class FSQCellManifestCore;
+
+/**
+ You can pass one of the following selection strategies to the manifest when fully replacing the existing
+ set of section records. It is used to determine what it should do about any already selected cells.
+ 
+ If there are no selected cells when you set new section records, then the strategy is not used.
+ */
+typedef NS_ENUM(NSInteger, FSQViewReloadCellSelectionStrategy) {
+    
+    /**
+     All existing selected cells will be deselected.
+     */
+    FSQViewReloadCellSelectionStrategyDeselectAll,
+    
+    /**
+     The manifest will attempt to re-select the new cell records at the index paths that were previously selected.
+     Selection blocks and delegate callbacks will not be called.
+     */
+    FSQViewReloadCellSelectionStrategyMaintainSelectedIndexPaths,
+    
+    /**
+     The manifest will attempt to re-select the same cell records that were previously selected, even if they have
+     changed positions in the table. Records are compared using isEqualToCellRecord:
+     
+     Selection blocks and delegate callbacks will not be called.
+     
+     @note This strategy is more expensive than the other ones. It you need this, it is recommended you
+     use insert/move/replace/remove methods instead of replacing the entire array of section records when possible.
+     */
+    FSQViewReloadCellSelectionStrategyMaintainSelectedRecords,
+};
+
+/**
+ Methods about headers which include an indexPath will use this value for the row index.
+ 
+ You can use this to distinguish header index paths from footer or normal cell paths.
+ */
+extern const NSInteger kRowIndexForHeaderIndexPaths;
+
+/**
+ Methods about footers which include an indexPath will use this value for the row index.
+ 
+ You can use this to distinguish footer index paths from header or normal cell paths.
+ */
+extern const NSInteger kRowIndexForFooterIndexPaths;
+
+/**
+ This protocol contains callbacks that will inform the delegate when its records are inserted/moved/replaced/removed.
+ and when the managed view receives calls to change the records it is rendering.
+ 
+ A "will" call is _always_ followed by the correspding "did" call.
+ 
+ Each set of callbacks corresponds to a method on FSQCellManifestCore and only one set of will be sent per-manifest method.
+ E.g. even though `setSectionRecords` both replaces section records _and_ may reload the managed view, you will only
+ receive the [will/did]ReplaceSectionRecords callbacks.
+ */
+@protocol FSQCellManifestRecordModificationDelegate <NSObject>
+@optional
+- (void)manifest:(FSQCellManifestCore *)manifest willReplaceSectionRecords:(NSArray<FSQSectionRecord *> *)currentSectionRecords withRecords:(NSArray<FSQSectionRecord *> *)newSectionRecords;
+- (void)manifest:(FSQCellManifestCore *)manifest didReplaceSectionRecords:(NSArray<FSQSectionRecord *> *)oldSectionRecords withRecords:(NSArray<FSQSectionRecord *> *)currentSectionRecords;
+
+- (void)manifestWillReloadManagedView:(FSQCellManifestCore *)manifest;
+- (void)manifestDidReloadManagedView:(FSQCellManifestCore *)manifest;
+
+- (void)manifest:(FSQCellManifestCore *)manifest willInsertCellRecords:(NSArray<FSQCellRecord *> *)cellRecords atIndexPath:(NSIndexPath *)indexPath;
+- (void)manifest:(FSQCellManifestCore *)manifest didInsertCellRecords:(NSArray<FSQCellRecord *> *)cellRecords atIndexPaths:(NSArray<NSIndexPath *> *)indexPaths;
+
+- (void)manifest:(FSQCellManifestCore *)manifest willMoveCellRecordAtIndexPath:(NSIndexPath *)initialIndexPath toIndexPath:(NSIndexPath *)targetIndexPath;
+- (void)manifest:(FSQCellManifestCore *)manifest didMoveCellRecordAtIndexPath:(NSIndexPath *)initialIndexPath toIndexPath:(NSIndexPath *)targetIndexPath;
+
+- (void)manifest:(FSQCellManifestCore *)manifest willReplaceCellRecordsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths withRecords:(NSArray<FSQCellRecord *> *)cellRecords;
+- (void)manifest:(FSQCellManifestCore *)manifest didReplaceCellRecordsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths withRecords:(NSArray<FSQCellRecord *> *)newCellRecords replacedRecords:(NSArray<FSQCellRecord *> *)originalCellRecords;
+
+- (void)manifest:(FSQCellManifestCore *)manifest willRemoveCellRecordsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths removingEmptySections:(BOOL)willRemoveEmptySections;
+- (void)manifest:(FSQCellManifestCore *)manifest didRemoveCellRecordsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths removedEmptySectionsAtIndexes:(NSIndexSet *)removedSections;
+
+- (void)manifest:(FSQCellManifestCore *)manifest willReloadCellsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths;
+- (void)manifest:(FSQCellManifestCore *)manifest didReloadCellsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths;
+
+- (void)manifest:(FSQCellManifestCore *)manifest willInsertSectionRecords:(NSArray<FSQSectionRecord *> *)sectionRecords atIndex:(NSInteger)index;
+- (void)manifest:(FSQCellManifestCore *)manifest didInsertSectionRecords:(NSArray<FSQSectionRecord *> *)sectionRecords atIndexes:(NSIndexSet *)indexes;
+
+- (void)manifest:(FSQCellManifestCore *)manifest willMoveSectionRecordAtIndex:(NSInteger)initialIndex toIndex:(NSInteger)targetIndex;
+- (void)manifest:(FSQCellManifestCore *)manifest didMoveSectionRecordAtIndex:(NSInteger)initialIndex toIndex:(NSInteger)targetIndex;
+
+- (void)manifest:(FSQCellManifestCore *)manifest willReplaceSectionRecordsAtIndexes:(NSArray<NSNumber *> *)indexes withRecords:(NSArray<FSQSectionRecord *> *)sectionRecords;
+- (void)manifest:(FSQCellManifestCore *)manifest didReplaceSectionRecordsAtIndexes:(NSArray<NSNumber *> *)indexes withRecords:(NSArray<FSQSectionRecord *> *)newSectionRecords replacedRecords:(NSArray<FSQSectionRecord *> *)originalSectionRecords;
+
+- (void)manifest:(FSQCellManifestCore *)manifest willRemoveSectionRecordsAtIndexes:(NSIndexSet *)indexes;
+- (void)manifest:(FSQCellManifestCore *)manifest didRemoveSectionRecordsAtIndexes:(NSIndexSet *)indexes;
+
+- (void)manifest:(FSQCellManifestCore *)manifest willReloadSectionsAtIndexes:(NSIndexSet *)indexes;
+- (void)manifest:(FSQCellManifestCore *)manifest didReloadSectionsAtIndexes:(NSIndexSet *)indexes;
+
+/**
+ Sent once before and after the net changes of a transaction are applied.
+ 
+ If you implement either of these, you will not receive any of the other callbacks above for the changes made in
+ a transaction. Otherwise you receive the individual callbacks for each part of the transaction's changeset,
+ the same as for `setSectionRecords:animated:`.
+ 
+ @see beginTransaction
+ */
+- (void)manifest:(FSQCellManifestCore *)manifest willCommitTransactionWithChangeset:(FSQCellManifestChangeset *)changeset;
+- (void)manifest:(FSQCellManifestCore *)manifest didCommitTransactionWithChangeset:(FSQCellManifestChangeset *)changeset;
+
+@end
+
+/**
+ The record model of the manifest: its section records, and everything that inserts, moves, replaces or removes them.
+ 
+ This class only uses Foundation, so it can be built and tested on any platform Foundation runs on. It does not know
+ about any kind of view. FSQTableViewCellManifest and FSQCollectionViewCellManifest are subclasses that pass every
+ change on to their UITableView or UICollectionView, and add sizing, configuration, selection and the UIKit delegate
+ and data source methods on top.
+ 
+ On its own, a core manifest keeps its records and informs its delegate of changes to them. Methods that only affect
+ a managed view (such as reloadManagedView) inform the delegate and do nothing else.
+ */
+@interface FSQCellManifestCore : NSObject <NSFastEnumeration>
+
+/**
+ An optional delegate that can receive callbacks from the manifest. The callbacks will be received after any plugins.
+ 
+ The delegate can implement methods from any of the following protocols to get the corresponding callbacks:
+ * FSQCellManifestRecordModificationDelegate
+ * FSQCellManifestRecordSizingDelegate
+ * FSQCellManifestRecordConfigurationDelegate
+ * FSQCellManifestRecordSelectionDelegate
+ * FSQCellManifestRecordPrefetchingDelegate
+ * FSQCellManifestProfilingDelegate
+ * UIScrollViewDelegate
+ * UITableViewDelegate (only for FSQTableViewCellManifest)
+ * UITableViewDataSource (only for FSQTableViewCellManifest)
+ * UITableViewDataSourcePrefetching (only for FSQTableViewCellManifest)
+ * UICollectionViewDelegate (only for FSQCollectionViewCellManifest)
+ * UICollectionViewDelegateFlowLayout (only for FSQCollectionViewCellManifest)
+ * UICollectionViewDataSource (only for FSQCollectionViewCellManifest)
+ * UICollectionViewDataSourcePrefetching (only for FSQCollectionViewCellManifest)
+ 
+ If the methods have a return value and the message is not implemented by the manifest, the return value of the first
+ delegate or plugin to respond will be used. Delegates who wish to have their return values
+ override this behavior should implement FSQMessageForwardee's shouldUseResponseForInvocation:
+ */
+@property (nonatomic, weak, nullable) id delegate;
+
+/**
+ Creates a manifest without a managed view.
+ 
+ You normally will want to use the initializer for FSQTableViewCellManifest or FSQCollectionViewCellManifest
+ instead of this method.
+ 
+ @param delegate Optional delegate for the manifest.
+ 
+ @return A new FSQCellManifestCore instance.
+ */
+- (instancetype)initWithDelegate:(nullable id)delegate;
+
+/**
+ An array of FSQSectionRecord objects that represent the invididual sections in a table view or collection view.
+ Setting this property is equivalent to calling `setSectionRecords:selectionStrategy:`
+ with a selection strategy of FSQViewReloadCellSelectionStrategyDeselectAll.
+ */
+@property (nonatomic, null_resettable) NSArray<FSQSectionRecord *> *sectionRecords;
+
+/**
+ Controls whether the manifest methods that alter its records will automatically call through to the
+ appropriate methods on its managed table or collection view to render the update.
+ 
+ You can set this to NO if you intend to immediately update the managed view yourself after calling the
+ manifest's methods.
+ 
+ Defaults to YES.
+ 
+ @note Also see: performRecordModificationUpdatesWithoutUpdatingManagedView:
+ */
+@property (nonatomic, assign) BOOL automaticallyUpdateManagedView;
+
+/**
+ Controls whether the manifest keeps a reverse index from cell records and models to their index paths, so that
+ `indexPathForCellRecord:` and `indexPathsForModel:` take constant time instead of searching every section.
+ 
+ The index is built the first time it is needed. It is kept up to date by the manifest's insertion, removal, move and
+ replacement methods. Appending or removing records at the end of a section, replacing records, and changes to whole
+ sections are applied to the index directly. Inserting or removing records in the middle of a section shifts the rows
+ after them, so the rows of that section are found again the next time one of its records is looked up.
+ `setSectionRecords:` and `setSectionRecords:animated:` throw the index away, to be rebuilt the next time it is needed.
+ 
+ Changes made to section records directly, rather than through the manifest, are not seen by the index. Neither are
+ changes to the model of a record that is already in the manifest; replace the record instead.
+ 
+ Defaults to NO. The index holds one entry per cell record, so only turn this on if you look records up often.
+ */
+@property (nonatomic, assign) BOOL maintainsRecordIndex;
+
+/**
+ Allows you to do batch updates on the manifest's managed view.
+ 
+ If this is a table view manifest, your updates block will be wrapped in beginUpdates and endUpdates calls.
+ 
+ If this is a collection view manifest, your updates block will be passed to performBatchUpdates:completion:
+ */
+- (void)performBatchRecordModificationUpdates:(nullable void (^)(void))updates;
+
+/**
+ Allows you to do make record modification calls without the manifest calling through to its managed view
+ to render the updates.
+ 
+ If you use this method, you are responsible for updating the managed view properly.
+ 
+ @note If you change the value of the automaticallyUpdateManagedView property in the updates block, the behavior
+ of this method is undefined.
+ */
+- (void)performRecordModificationUpdatesWithoutUpdatingManagedView:(nullable void (^)(void))updates;
+
+/**
+ Replace the existing array of section records with the passed in array.
+ 
+ This method will automatically call reloadData on the table or collection view it is managing after applying
+ the new records. If you do not want this behavior, see `performRecordModificationUpdatesWithoutUpdatingManagedView`.
+ 
+ @param sectionRecords    An array of FSQSectionRecord objects. The array will be copied.
+ @param selectionStrategy A hint to the manifest on what to do with any existing selected rows.
+ */
+- (void)setSectionRecords:(nullable NSArray<FSQSectionRecord *> *)sectionRecords
+        selectionStrategy:(FSQViewReloadCellSelectionStrategy)selectionStrategy;
+
+/**
+ Replace the existing array of section records with the passed in array, updating the managed view with only the
+ sections and cells that actually changed.
+ 
+ Instead of calling reloadData, the manifest computes a FSQCellManifestChangeset between the current and new records
+ and applies its insertions, deletions, moves and reloads in a single batch update. Unchanged cells are not
+ dequeued or configured again, and the managed view keeps its scroll position and selected cells.
+ 
+ Plugins and delegates receive the individual insert/remove/move/replace callbacks for each part of the changeset
+ instead of the [will/did]ReplaceSectionRecords callbacks. All the "will" callbacks are sent before the records are
+ updated, and all the "did" callbacks after. Their index paths follow the same batch update semantics as the
+ changeset itself.
+ 
+ If the manifest does not currently have any section records, this is equivalent to `setSectionRecords:`.
+ 
+ @param sectionRecords An array of FSQSectionRecord objects. The array will be copied.
+ These should be new section records, not the existing ones modified in place.
+ @param animated       Whether the managed view should animate the changes.
+ 
+ @see FSQCellManifestChangeset
+ */
+- (void)setSectionRecords:(nullable NSArray<FSQSectionRecord *> *)sectionRecords
+                 animated:(BOOL)animated;
+
+/**
+ YES if a transaction has begun and has not been committed yet.
+ */
+@property (nonatomic, readonly, getter=isInTransaction) BOOL inTransaction;
+
+/**
+ Begin a transaction.
+ 
+ Record modifications made while a transaction is open (inserting, moving, replacing and removing records, or setting
+ new section records) are applied to the manifest's records right away, so later calls in the same transaction can
+ use the updated index paths. However the managed view is not updated and plugins and delegates are not informed.
+ 
+ When the transaction is committed, the manifest computes the net FSQCellManifestChangeset between the records it
+ started with and the current records. It then updates the managed view with a single batch update and informs
+ delegates once. Changes that cancel each other out, such as inserting a record and then removing it, never reach
+ the managed view at all.
+ 
+ Requests to reload the managed view, sections or cells during a transaction are deferred until it is committed,
+ and then apply to wherever those records ended up.
+ 
+ Transactions can be nested. Only committing the outermost transaction updates the managed view.
+ 
+ @note The managed view must not lay out or ask the manifest for data while a transaction is open, because the
+ records no longer match what it is displaying. Do not spin the run loop or force layout inside a transaction.
+ 
+ @see commitTransactionAnimated:
+ @see performTransaction:animated:
+ @see manifest:willCommitTransactionWithChangeset:
+ */
+- (void)beginTransaction;
+
+/**
+ Commit the current transaction. Every call to beginTransaction must be balanced by a call to this method.
+ 
+ @param animated Whether the managed view should animate the changes. Ignored for nested transactions.
+ */
+- (void)commitTransactionAnimated:(BOOL)animated;
+
+/**
+ Perform record modifications inside a transaction.
+ 
+ @param updates  A block that modifies the manifest's records.
+ @param animated Whether the managed view should animate the changes.
+ 
+ @see beginTransaction
+ */
+- (void)performTransaction:(void (^)(void))updates animated:(BOOL)animated;
+
+/**
+ Replace the existing array of section records with an array of frozen section records built elsewhere, usually on
+ a background queue (see FSQSectionRecord's freeze method).
+ 
+ This behaves like setSectionRecords:, and installs the records without copying or visiting any of their cell records.
+ 
+ The manifest never modifies a frozen section record. When you later use its insertion, removal, move or replacement
+ methods on one, the manifest first swaps in an unfrozen copy that shares the frozen section's records, and modifies
+ that instead. This means frozen records can still be read safely on other threads after they have been committed.
+ 
+ Must be called on the main thread.
+ 
+ @param sectionRecords An array of frozen FSQSectionRecord objects.
+ */
+- (void)commitFrozenSectionRecords:(nullable NSArray<FSQSectionRecord *> *)sectionRecords;
+
+/**
+ Replace the existing array of section records with an array of frozen section records, updating the managed view
+ with only the sections and cells that changed, like setSectionRecords:animated:.
+ 
+ If the manifest's current section records are all frozen as well, the FSQCellManifestChangeset between the two is
+ computed on a background queue, and only applied on the main thread afterwards. If the manifest's records were
+ changed in the meantime, the changeset is computed again on the main thread against the new records instead. If the
+ current records are not all frozen, or a transaction is open, the changeset is computed and applied right away.
+ 
+ Must be called on the main thread.
+ 
+ @param sectionRecords An array of frozen FSQSectionRecord objects.
+ @param animated       Whether the managed view should animate the changes.
+ @param completion     An optional block called on the main thread once the records have been committed.
+ */
+- (void)commitFrozenSectionRecords:(nullable NSArray<FSQSectionRecord *> *)sectionRecords
+                          animated:(BOOL)animated
+                        completion:(nullable void (^)(void))completion;
+
+/**
+ Accessor for getting individual section records.
+ 
+ @param index The index of the record you want.
+ 
+ @return The section record at that index, or nil if the index is out of bounds.
+ */
+- (nullable FSQSectionRecord *)sectionRecordAtIndex:(NSInteger)index;
+
+/**
+ Accessor for getting individual cell records.
+ 
+ @param indexPath The index path of the record you want.
+ 
+ @return The section record at that index, or nil if the index path is out of bounds.
+ */
+- (nullable FSQCellRecord *)cellRecordAtIndexPath:(NSIndexPath *)indexPath;
+
+/**
+ Find where a cell record currently is.
+ 
+ This is O(1) if maintainsRecordIndex is YES, and searches every section otherwise.
+ 
+ Records in FSQVirtualSectionRecord sections are never found, as searching them would create all of their records.
+ If the same record instance is in the manifest more than once, the result is undefined.
+ 
+ @param cellRecord The record to look for. Records are matched by identity, not by isEqual:.
+ 
+ @return The index path of the record, or nil if it is not in the manifest.
+ */
+- (nullable NSIndexPath *)indexPathForCellRecord:(FSQCellRecord *)cellRecord;
+
+/**
+ Find every cell record whose model is the given object.
+ 
+ This takes time proportional to the number of matching records if maintainsRecordIndex is YES, and searches every
+ section otherwise. Records in FSQVirtualSectionRecord sections are never found.
+ 
+ @param model The model to look for. Models are matched by identity, not by isEqual:.
+ 
+ @return The index paths of the matching records in ascending order. Empty if there are none.
+ */
+- (NSArray<NSIndexPath *> *)indexPathsForModel:(id)model;
+
+/**
+ Accessor for the getting the current number of sections.
+ 
+ @return Current number of section records managed by this manifest.
+ */
+- (NSInteger)numberOfSectionRecords;
+
+/**
+ Accessor for the getting the current number of cell records in a section.
+ 
+ @param index The index of the section you are interested in.
+ 
+ @return The number of cell records in the specified section.
+ */
+- (NSInteger)numberOfCellRecordsInSectionAtIndex:(NSInteger)index;
+
+/**
+ Insert new cell records in order starting at the given index path without animation.
+ 
+ This method will automatically call the appropriate methods on its table or collection view to show the new cells.
+ If you do not want this behavior, see `performRecordModificationUpdatesWithoutUpdatingManagedView`.
+ 
+ @param cellRecords An array of FSQCellRecord objects.
+ @param indexPath   The index path that the first new record should be inserted at.
+ The section index of this index path must  be less than numberOfSectionRecords (i.e. an existing section).
+ and the row or item index must be less than or equal to the number of cell records in that section.
+ 
+ @return An array of NSIndexPaths of the newly inserted cellRecords.
+ */
+- (NSArray<NSIndexPath *> *)insertCellRecords:(NSArray<FSQCellRecord *> *)cellRecords
+                                  atIndexPath:(NSIndexPath *)indexPath;
+
+/**
+ Insert new section records in order starting at the given index without animation.
+ 
+ This method will automatically call the appropriate methods on its table or collection view to show the new sections.
+ If you do not want this behavior, see `performRecordModificationUpdatesWithoutUpdatingManagedView`.
+ 
+ @param sectionRecords An array of FSQSectionRecord objects.
+ @param index          The index that the first new record should be inserted at.
+ This index must be less than or equal to the number of section records.
+ 
+ @return An index set containing the indexes of the newly inserted sectionRecords.
+ */
+- (NSIndexSet *)insertSectionRecords:(NSArray<FSQSectionRecord *> *)sectionRecords
+                             atIndex:(NSInteger)index;
+
+/**
+ Move a cell record at one index path to another.
+ 
+ This method will automatically call the appropriate methods on its table or collection view to show the move.
+ If you do not want this behavior, see `performRecordModificationUpdatesWithoutUpdatingManagedView`.
+ 
+ @param initialIndexPath The index path of the cell to move. This must be a valid existing index path.
+ @param targetIndexPath  The index path that the cell should end up at. The section index of the index path must
+ reference a valid existing section. The row or item index must be no greater than the number of cell records in
+ the section AFTER the record at initialIndexPath is removed.
+ 
+ @return YES if the records were successfully moved, NO if one or both of the index paths were invalid.
+ */
+- (BOOL)moveCellRecordAtIndexPath:(NSIndexPath *)initialIndexPath
+                      toIndexPath:(NSIndexPath *)targetIndexPath;
+
+/**
+ Move a section record at one index to another.
+ 
+ This method will automatically call the appropriate methods on its table or collection view to show the move.
+ If you do not want this behavior, see `performRecordModificationUpdatesWithoutUpdatingManagedView`.
+ 
+ @param initialIndex The index of the section to move. This must be a valid existing section index.
+ @param targetIndex  The index that the section should end up at. This must be a valid existing index.
+ 
+ @return YES if the records were successfully moved, NO if one or both of the indexes were invalid.
+ */
+- (BOOL)moveSectionRecordAtIndex:(NSInteger)initialIndex
+                         toIndex:(NSInteger)targetIndex;
+
+/**
+ Remove cell records at the specified index paths.
+ 
+ This method will automatically call the appropriate methods on its table or collection view to show the removals.
+ If you do not want this behavior, see `performRecordModificationUpdatesWithoutUpdatingManagedView`.
+ 
+ @param indexPaths                  An array of NSIndexPath objects of rows to remove.
+ Any invalid index paths will be ignored.
+ @param shouldRemoveEmptySections   If YES, when all cells in a section would be removed, than that section is
+ removed instead.
+ 
+ @return An array of NSIndexPath objects that were actually removed. It does not include any invalid index paths.
+ It also does not include any index paths in a section that was entirely removed if shouldRemoveEmptySections is YES.
+ */
+- (NSArray<NSIndexPath *> *)removeCellRecordsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths
+                                      removeEmptySections:(BOOL)shouldRemoveEmptySections;
+
+/**
+ Remove sections at the specified indexes.
+ 
+ This method will automatically call the appropriate methods on its table or collection view to show the removals.
+ If you do not want this behavior, see `performRecordModificationUpdatesWithoutUpdatingManagedView`.
+ 
+ @param indexes An set of indexes to remove. All indexes must be valid section indexes or none will be removed.
+ 
+ @return YES if sections were removed. NO if any of the indexes were invalid.
+ */
+- (BOOL)removeSectionRecordsAtIndexes:(NSIndexSet *)indexes;
+
+/**
+ Replace cell records with a different records.
+ 
+ This method will automatically call the appropriate methods on its table or collection view to show the replacement.
+ If you do not want this behavior, see `performRecordModificationUpdatesWithoutUpdatingManagedView`.
+ 
+ @param indexPaths     An array of NSIndexPaths to existing cell records to replace.
+ Any invalid index paths will not be replaced.
+ @param newCellRecords An array of cell records to replace the existing records with. The size of this array must
+ be equal to the size of indexPaths
+ 
+ The index paths are sorted and grouped by section, and each section is modified once however many of its records
+ are replaced. If the same index path is given more than once, the last record given for it is used. Delegates are
+ passed the replaced index paths in sorted order.
+ */
+- (void)replaceCellRecordsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths
+                       withCellRecords:(NSArray<FSQCellRecord *> *)newCellRecords;
+
+/**
+ Remove every cell record that passes a test.
+ 
+ The manifest's records are walked once, the removals are applied with a single modification of each affected
+ section, and the managed view and record modification delegates are updated once for all of them, exactly as if the
+ passing index paths had been given to removeCellRecordsAtIndexPaths:removeEmptySections:.
+ 
+ This method will automatically call the appropriate methods on its table or collection view to show the removals.
+ If you do not want this behavior, see `performRecordModificationUpdatesWithoutUpdatingManagedView`.
+ 
+ @param predicate                   The test to apply to each cell record. It must not modify the manifest.
+ @param shouldRemoveEmptySections   If YES, when all cells in a section would be removed, than that section is
+ removed instead.
+ 
+ @return An array of NSIndexPath objects that were actually removed. It does not include any index paths in a section
+ that was entirely removed if shouldRemoveEmptySections is YES.
+ */
+- (NSArray<NSIndexPath *> *)removeCellRecordsPassingTest:(FSQCellRecordTestBlock)predicate
+                                     removeEmptySections:(BOOL)shouldRemoveEmptySections;
+
+/**
+ Remove every cell record that passes a test, optionally testing several sections at once.
+ 
+ This method is identical to removeCellRecordsPassingTest:removeEmptySections: except for the options parameter.
+ 
+ @param options                     Pass NSEnumerationConcurrent to test each section on a different thread. The
+ records of a single section are always tested in order on the same thread. FSQVirtualSectionRecord sections are
+ always tested on the calling thread. Other options are ignored.
+ @param predicate                   The test to apply to each cell record. It must not modify the manifest, and must
+ be safe to call from several threads at once if options includes NSEnumerationConcurrent.
+ @param shouldRemoveEmptySections   If YES, when all cells in a section would be removed, than that section is
+ removed instead.
+ 
+ @return An array of NSIndexPath objects that were actually removed.
+ */
+- (NSArray<NSIndexPath *> *)removeCellRecordsWithOptions:(NSEnumerationOptions)options
+                                             passingTest:(FSQCellRecordTestBlock)predicate
+                                     removeEmptySections:(BOOL)shouldRemoveEmptySections;
+
+/**
+ Replace every cell record that passes a test with a new record.
+ 
+ The manifest's records are walked once, each affected section is modified once however many of its records are
+ replaced, and the managed view and record modification delegates are updated once for all of them, exactly as if
+ the passing index paths and new records had been given to replaceCellRecordsAtIndexPaths:withCellRecords:.
+ 
+ This method will automatically call the appropriate methods on its table or collection view to show the replacement.
+ If you do not want this behavior, see `performRecordModificationUpdatesWithoutUpdatingManagedView`.
+ 
+ @param predicate   The test to apply to each cell record. It must not modify the manifest.
+ @param replacement Called on the calling thread for each record that passed the test, after all records have been
+ tested, to create the record to replace it with. It must not modify the manifest.
+ 
+ @return An array of NSIndexPath objects that were replaced.
+ */
+- (NSArray<NSIndexPath *> *)replaceCellRecordsPassingTest:(FSQCellRecordTestBlock)predicate
+                                                withBlock:(FSQCellRecordReplacementBlock)replacement;
+
+/**
+ Replace every cell record that passes a test with a new record, optionally testing several sections at once.
+ 
+ This method is identical to replaceCellRecordsPassingTest:withBlock: except for the options parameter, which works
+ the same as in removeCellRecordsWithOptions:passingTest:removeEmptySections:. The replacement block is always
+ called on the calling thread.
+ */
+- (NSArray<NSIndexPath *> *)replaceCellRecordsWithOptions:(NSEnumerationOptions)options
+                                              passingTest:(FSQCellRecordTestBlock)predicate
+                                                withBlock:(FSQCellRecordReplacementBlock)replacement;
+
+/**
+ Replace section records with different records.
+ 
+ This method will automatically call the appropriate methods on its table or collection view to show the replacement.
+ If you do not want this behavior, see `performRecordModificationUpdatesWithoutUpdatingManagedView`.
+ 
+ @param indexes           An array of NSNumber-boxed NSIntegers of existing section record indexes to replace.
+ Any invalid indexes will not be replaced.
+ @param newSectionRecords An array of section records to replace the existing records with. The size of this array
+ must be equal to the number of indexes.
+ 
+ @return A set of indexes that were actually replaced, not including any invalid indexes.
+ */
+- (NSIndexSet *)replaceSectionRecordsAtIndexes:(NSArray<NSNumber *> *)indexes
+                            withSectionRecords:(NSArray<FSQSectionRecord *> *)newSectionRecords;
+
+/**
+ Does either tableView or collectionView reload data method as appropriate and informs manifest delegates and plugins.
+ 
+ Does not update any records.
+ 
+ You should use this method instead of calling reload on your managed view directly.
+ */
+- (void)reloadManagedView;
+
+/**
+ Calls appropriate method on managed view to reload the specified index paths and informs manifest
+ delegates and plugins.
+ 
+ Does not update any records.
+ 
+ You should use this method instead of calling reload on your managed view directly.
+ 
+ @param indexPaths Index paths of cells to reload.
+ */
+- (void)reloadCellsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths;
+
+/**
+ Calls appropriate method on managed view to reload the specified indexes and informs manifest delegates and plugins.
+ 
+ Does not update any records.
+ 
+ You should use this method instead of calling reload on your managed view directly.
+ 
+ @param indexes Indexes of sections to reload.
+ */
+- (void)reloadSectionsAtIndexes:(NSIndexSet *)indexes;
+
+/**
+ Will return you either indexPath.row or indexPath.item depending on whether this is a table or collection
+ view manifest.
+ 
+ Rows and items are both the second index of the index path, so this does not depend on UIKit.
+ */
+- (NSInteger)rowOrItemIndexForIndexPath:(NSIndexPath *)indexPath;
+
+/**
+ Creates an indexPath equal to the one indexPathForRow:inSection: or indexPathForItem:inSection: would create,
+ depending on whether this is a table or collection view manifest.
+ */
+- (NSIndexPath *)indexPathForRowOrItem:(NSInteger)rowOrItem inSection:(NSInteger)section;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,1858 @@
+//
+//  FSQCellManifestCore.m
+//
+//  Copyright (c) 2015 Foursquare. All rights reserved.
+//
+
+#import "FSQCellManifestCore.h"
+#import "FSQCellManifestCoreSubclass.h"
+
+#import "FSQCellManifestIndexPaths.h"
+#import "FSQCellManifestRecordIndex.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+#pragma mark - Begin Private Types and Constants
+
+const NSInteger kRowIndexForHeaderIndexPaths = -1;
+const NSInteger kRowIndexForFooterIndexPaths = -2;
+
+/**
+ The cell records to replace in a single section, so that the section only needs to be modified once.
+ _cellRecords holds the new records in the same order as _cellIndexes.
+ */
+@interface FSQCellManifestSectionReplacement : NSObject {
+    @public
+    NSInteger _sectionIndex;
+    NSIndexSet *_cellIndexes;
+    NSArray<FSQCellRecord *> *_cellRecords;
+}
+@end
+
+@implementation FSQCellManifestSectionReplacement
+@end
+
+/**
+ Cell indexes grouped by section, in a C array indexed by section so that callers can walk the sections in order
+ without boxing or sorting section numbers. Sections with no cell indexes have a nil entry.
+ */
+@interface FSQCellManifestCellIndexesBySection : NSObject {
+    @public
+    NSInteger _numberOfSections;
+    NSMutableIndexSet *__strong *_cellIndexes;
+}
+- (instancetype)initWithNumberOfSections:(NSInteger)numberOfSections;
+- (BOOL)isEmpty;
+- (NSArray<NSIndexPath *> *)indexPaths;
+@end
+
+@implementation FSQCellManifestCellIndexesBySection
+
+- (instancetype)initWithNumberOfSections:(NSInteger)numberOfSections {
+    if ((self = [super init])) {
+        _numberOfSections = MAX(numberOfSections, 0);
+        _cellIndexes = (NSMutableIndexSet *__strong *)calloc((size_t)MAX(_numberOfSections, 1), sizeof(NSMutableIndexSet *));
+    }
+    return self;
+}
+
+- (void)dealloc {
+    // ARC does not release objects held in malloc'd memory, so each entry has to be cleared first
+    for (NSInteger sectionIndex = 0; sectionIndex < _numberOfSections; ++sectionIndex) {
+        _cellIndexes[sectionIndex] = nil;
+    }
+    free(_cellIndexes);
+}
+
+- (BOOL)isEmpty {
+    for (NSInteger sectionIndex = 0; sectionIndex < _numberOfSections; ++sectionIndex) {
+        if ([_cellIndexes[sectionIndex] count] > 0) {
+            return NO;
+        }
+    }
+    return YES;
+}
+
+- (NSArray<NSIndexPath *> *)indexPaths {
+    NSMutableArray<NSIndexPath *> *indexPaths = [NSMutableArray new];
+    for (NSInteger sectionIndex = 0; sectionIndex < _numberOfSections; ++sectionIndex) {
+        [_cellIndexes[sectionIndex] enumerateIndexesUsingBlock:^(NSUInteger idx, BOOL *stop) {
+            [indexPaths addObject:FSQIndexPathMake(sectionIndex, idx)];
+        }];
+    }
+    return [indexPaths copy];
+}
+
+@end
+
+/**
+ A single index path passed to replaceCellRecordsAtIndexPaths:withCellRecords:, and the position of the index path and
+ its new record in the parameter arrays.
+ */
+typedef struct {
+    NSInteger section;
+    NSInteger rowOrItem;
+    NSUInteger parameterIndex;
+} FSQCellManifestReplacementRequest;
+
+static int FSQCellManifestCompareReplacementRequests(const void *first, const void *second) {
+    const FSQCellManifestReplacementRequest *a = first;
+    const FSQCellManifestReplacementRequest *b = second;
+    if (a->section != b->section) {
+        return (a->section < b->section) ? -1 : 1;
+    }
+    if (a->rowOrItem != b->rowOrItem) {
+        return (a->rowOrItem < b->rowOrItem) ? -1 : 1;
+    }
+    return (a->parameterIndex < b->parameterIndex) ? -1 : ((a->parameterIndex > b->parameterIndex) ? 1 : 0);
+}
+
+@implementation FSQCellManifestResponderList
+@end
+
+#pragma mark End Private Types and Constants -
+
+#pragma mark - Begin Core Manifest
+
+@implementation FSQCellManifestCore {
+    NSMapTable *_responderListsBySelector;
+    NSUInteger _transactionDepth;
+    BOOL _committingTransaction;
+    FSQCellManifestChangeset *_Nullable _committedChangeset;
+    NSArray<FSQSectionRecord *> *_Nullable _transactionOriginalSectionRecords;
+    NSHashTable<FSQSectionRecord *> *_Nullable _transactionReloadedSectionRecords;
+    NSHashTable<FSQCellRecord *> *_Nullable _transactionReloadedCellRecords;
+    NSHashTable<FSQCellRecord *> *_Nullable _transactionReconfiguredCellRecords;
+    BOOL _transactionReconfigurationResizes;
+    BOOL _transactionReloadsManagedView;
+    FSQCellManifestChangeset *_Nullable _precomputedChangeset;
+    FSQCellManifestRecordIndex *_Nullable _recordIndex;
+}
+
+- (instancetype)init {
+    return [self initWithDelegate:nil];
+}
+
+- (instancetype)initWithDelegate:(nullable id)delegate {
+    if ((self = [super init])) {
+        _sectionRecords = @[];
+        _responderListsBySelector = [[NSMapTable alloc] initWithKeyOptions:(NSPointerFunctionsOpaqueMemory | NSPointerFunctionsOpaquePersonality)
+                                                              valueOptions:NSPointerFunctionsStrongMemory
+                                                                  capacity:0];
+        _automaticallyUpdateManagedView = YES;
+        _delegate = delegate;
+    }
+    return self;
+}
+
+- (void)setDelegate:(nullable id)delegate {
+    if (_delegate == delegate) {
+        return;
+    }
+    _delegate = delegate;
+    
+    [self invalidateResponderLists];
+}
+
+- (nullable NSArray *)plugins {
+    // Subclasses can override
+    return nil;
+}
+
+- (BOOL)shouldUpdateManagedView {
+    return (_automaticallyUpdateManagedView && _transactionDepth == 0);
+}
+
+- (void)performBatchRecordModificationUpdates:(nullable void (^)(void))updates {
+    // Subclasses should override
+    if (updates) {
+        updates();
+    }
+}
+
+- (void)performRecordModificationUpdatesWithoutUpdatingManagedView:(nullable void (^)(void))updates {
+    if (updates) {
+        if (self.automaticallyUpdateManagedView) {
+            self.automaticallyUpdateManagedView = NO;
+            updates();
+            self.automaticallyUpdateManagedView = YES;
+        }
+        else {
+            updates();
+        }
+    }
+}
+
+- (nullable FSQSectionRecord *)sectionRecordAtIndex:(NSInteger)index {
+    if (index < [_sectionRecords count]
+        && index >= 0) {
+        return _sectionRecords[index];
+    }
+    else {
+        return nil;
+    }
+}
+
+- (nullable FSQCellRecord *)cellRecordAtIndexPath:(NSIndexPath *)indexPath {
+    return [[self sectionRecordAtIndex:FSQIndexPathSection(indexPath)] cellRecordAtIndex:FSQIndexPathRowOrItem(indexPath)];
+}
+
+- (NSInteger)numberOfSectionRecords {
+    return [_sectionRecords count];
+}
+
+- (NSInteger)numberOfCellRecordsInSectionAtIndex:(NSInteger)index {
+    return [[self sectionRecordAtIndex:index] numberOfCellRecords];
+}
+
+- (NSInteger)rowOrItemIndexForIndexPath:(NSIndexPath *)indexPath {
+    return FSQIndexPathRowOrItem(indexPath);
+}
+
+- (NSIndexPath *)indexPathForRowOrItem:(NSInteger)rowOrItem inSection:(NSInteger)section {
+    return FSQIndexPathMake(section, rowOrItem);
+}
+
+- (NSUInteger)countByEnumeratingWithState:(NSFastEnumerationState *)state objects:(id _Nonnull __unsafe_unretained [])buffer count:(NSUInteger)len {
+    return [_sectionRecords countByEnumeratingWithState:state objects:buffer count:len];
+}
+
+#pragma mark - Responder Lists
+
+// Callbacks are sent many times per cell, so rather than asking every plugin and the delegate whether they respond
+// each time, the manifest remembers who responds to each selector. Whether plugins and the delegate respond to a
+// selector is assumed not to change while they are attached.
+
+- (void)invalidateResponderLists {
+    [_responderListsBySelector removeAllObjects];
+}
+
+- (FSQCellManifestResponderList *)responderListForSelector:(SEL)selector {
+    FSQCellManifestResponderList *responders = (__bridge FSQCellManifestResponderList *)NSMapGet(_responderListsBySelector, (const void *)selector);
+    
+    if (!responders) {
+        NSMutableArray *respondingPlugins = [NSMutableArray new];
+        for (id plugin in [self plugins]) {
+            if ([plugin respondsToSelector:selector]) {
+                [respondingPlugins addObject:plugin];
+            }
+        }
+        
+        responders = [FSQCellManifestResponderList new];
+        responders->_plugins = [respondingPlugins copy];
+        responders->_delegateResponds = [_delegate respondsToSelector:selector];
+        NSMapInsertKnownAbsent(_responderListsBySelector, (const void *)selector, (__bridge void *)responders);
+    }
+    
+    return responders;
+}
+
+- (BOOL)delegateRespondsToSelector:(SEL)selector {
+    return ([self responderListForSelector:selector]->_delegateResponds && self.delegate != nil);
+}
+
+- (void)withEachPluginAndDelegateRespondingToSelector:(SEL)selector block:(void (^)(id delegate))block {
+    NSAssert(block, @"Missing block in withEachPluginAndDelegateRespondingToSelector:block:");
+    
+    FSQCellManifestResponderList *responders = [self responderListForSelector:selector];
+    
+    for (id plugin in responders->_plugins) {
+        block(plugin);
+    }
+    
+    if (responders->_delegateResponds) {
+        id delegate = self.delegate;
+        if (delegate) {
+            block(delegate);
+        }
+    }
+}
+
+- (void)withEachRecordModificationDelegateRespondingToSelector:(SEL)selector block:(void (^)(id delegate))block {
+    // Changes made inside a transaction are reported all at once when it is committed
+    if (_transactionDepth > 0) {
+        return;
+    }
+    
+    [self withEachPluginAndDelegateRespondingToSelector:selector block:block];
+}
+
+#pragma mark - Subclass Hooks
+
+- (void)recordsDidChange {
+    // Subclasses can override
+}
+
+- (void)cellRecordsDidInsertInRange:(NSRange)range inSection:(NSInteger)sectionIndex {
+    // Subclasses can override
+}
+
+- (void)cellRecordsDidRemoveAtIndexes:(NSIndexSet *)indexes inSection:(NSInteger)sectionIndex {
+    // Subclasses can override
+}
+
+- (void)invalidateAllRecordSizes {
+    // Subclasses can override
+}
+
+- (void)invalidateSizesForReplacedCellRecords:(NSArray<FSQCellRecord *> *)records atIndexPaths:(NSArray<NSIndexPath *> *)indexPaths {
+    // Subclasses can override
+}
+
+- (void)invalidateSizesForSectionRecords:(NSArray<FSQSectionRecord *> *)sectionRecords {
+    // Subclasses can override
+}
+
+- (void)invalidateSizesForReloadedSectionsAtIndexes:(NSIndexSet *)indexes {
+    // Subclasses can override
+}
+
+- (void)invalidateSizesForRecordsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths {
+    // Subclasses can override
+}
+
+- (void)updateCachedSizesForChangeset:(FSQCellManifestChangeset *)changeset {
+    // Subclasses can override
+}
+
+- (void)reconfigureCellRecords:(NSArray<FSQCellRecord *> *)cellRecords resizing:(BOOL)resizing {
+    // Subclasses can override
+}
+
+#pragma mark - Transactions
+
+- (BOOL)isInTransaction {
+    return (_transactionDepth > 0);
+}
+
+- (void)beginTransaction {
+    if (_transactionDepth++ > 0) {
+        return;
+    }
+    
+    // Records are modified in place during the transaction, so keep copies of the sections as they are now.
+    // The cell record arrays themselves are immutable and are shared, not copied.
+    NSMutableArray<FSQSectionRecord *> *originalSectionRecords = [[NSMutableArray alloc] initWithCapacity:[_sectionRecords count]];
+    for (FSQSectionRecord *sectionRecord in _sectionRecords) {
+        [originalSectionRecords addObject:[sectionRecord copyForSnapshot]];
+    }
+    _transactionOriginalSectionRecords = [originalSectionRecords copy];
+}
+
+- (void)commitTransactionAnimated:(BOOL)animated {
+    NSAssert(_transactionDepth > 0, @"commitTransactionAnimated: called without a matching beginTransaction");
+    
+    if (_transactionDepth == 0
+        || --_transactionDepth > 0) {
+        return;
+    }
+    
+    NSArray<FSQSectionRecord *> *transactionSectionRecords = _sectionRecords;
+    NSHashTable<FSQSectionRecord *> *reloadedSectionRecords = _transactionReloadedSectionRecords;
+    NSHashTable<FSQCellRecord *> *reloadedCellRecords = _transactionReloadedCellRecords;
+    NSHashTable<FSQCellRecord *> *reconfiguredCellRecords = _transactionReconfiguredCellRecords;
+    BOOL reconfigurationResizes = _transactionReconfigurationResizes;
+    BOOL reloadsManagedView = _transactionReloadsManagedView;
+    
+    // Put the original records back so the commit is diffed against what the managed view is actually displaying
+    _sectionRecords = _transactionOriginalSectionRecords ?: @[];
+    _transactionOriginalSectionRecords = nil;
+    _transactionReloadedSectionRecords = nil;
+    _transactionReloadedCellRecords = nil;
+    _transactionReconfiguredCellRecords = nil;
+    _transactionReconfigurationResizes = NO;
+    _transactionReloadsManagedView = NO;
+    
+    _committingTransaction = YES;
+    [self setSectionRecords:transactionSectionRecords animated:animated];
+    _committingTransaction = NO;
+    
+    // Anything the commit inserted or reloaded is already displayed from scratch
+    FSQCellManifestChangeset *changeset = _committedChangeset;
+    _committedChangeset = nil;
+    NSMutableIndexSet *freshSectionIndexes = [NSMutableIndexSet new];
+    [freshSectionIndexes addIndexes:changeset.insertedSectionIndexes];
+    [freshSectionIndexes addIndexes:changeset.reloadedSectionIndexes];
+    NSMutableSet<NSIndexPath *> *freshIndexPaths = [NSMutableSet setWithArray:changeset.insertedIndexPaths];
+    [freshIndexPaths addObjectsFromArray:changeset.reloadedTargetIndexPaths];
+    
+    /**  Apply deferred reloads  **/
+    
+    if (reloadsManagedView) {
+        [self reloadManagedView];
+        return;
+    }
+    
+    if ([reloadedSectionRecords count] > 0) {
+        NSMutableIndexSet *reloadedSectionIndexes = [NSMutableIndexSet new];
+        [_sectionRecords enumerateObjectsUsingBlock:^(FSQSectionRecord *sectionRecord, NSUInteger sectionIndex, BOOL *stop) {
+            if ([reloadedSectionRecords containsObject:sectionRecord]
+                && ![freshSectionIndexes containsIndex:sectionIndex]) {
+                [reloadedSectionIndexes addIndex:sectionIndex];
+            }
+        }];
+        
+        if ([reloadedSectionIndexes count] > 0) {
+            [self reloadSectionsAtIndexes:reloadedSectionIndexes];
+        }
+    }
+    
+    if ([reloadedCellRecords count] > 0) {
+        NSMutableArray<NSIndexPath *> *reloadedIndexPaths = [NSMutableArray new];
+        [_sectionRecords enumerateObjectsUsingBlock:^(FSQSectionRecord *sectionRecord, NSUInteger sectionIndex, BOOL *stop) {
+            if ([reloadedSectionRecords containsObject:sectionRecord]
+                || [freshSectionIndexes containsIndex:sectionIndex]) {
+                // Already reloaded along with its section
+                return;
+            }
+            
+            NSInteger cellIndex = 0;
+            for (FSQCellRecord *cellRecord in sectionRecord.cellRecords) {
+                if ([reloadedCellRecords containsObject:cellRecord]) {
+                    NSIndexPath *indexPath = FSQIndexPathMake(sectionIndex, cellIndex);
+                    if (![freshIndexPaths containsObject:indexPath]) {
+                        [reloadedIndexPaths addObject:indexPath];
+                    }
+                }
+                ++cellIndex;
+            }
+        }];
+        
+        if ([reloadedIndexPaths count] > 0) {
+            [self reloadCellsAtIndexPaths:reloadedIndexPaths];
+        }
+    }
+    
+    if ([reconfiguredCellRecords count] > 0) {
+        // Reloaded cells were configured from scratch already
+        for (FSQCellRecord *cellRecord in reloadedCellRecords) {
+            [reconfiguredCellRecords removeObject:cellRecord];
+        }
+        
+        if ([reconfiguredCellRecords count] > 0) {
+            [self reconfigureCellRecords:[reconfiguredCellRecords allObjects] resizing:reconfigurationResizes];
+        }
+    }
+}
+
+// Reload wherever these records end up once the transaction is committed
+- (void)deferReloadOfSectionRecords:(NSArray<FSQSectionRecord *> *)sectionRecords {
+    if (!_transactionReloadedSectionRecords) {
+        _transactionReloadedSectionRecords = [NSHashTable hashTableWithOptions:(NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality)];
+    }
+    for (FSQSectionRecord *sectionRecord in sectionRecords) {
+        [_transactionReloadedSectionRecords addObject:sectionRecord];
+    }
+}
+
+- (void)deferReloadOfCellRecords:(NSArray<FSQCellRecord *> *)cellRecords {
+    if (!_transactionReloadedCellRecords) {
+        _transactionReloadedCellRecords = [NSHashTable hashTableWithOptions:(NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality)];
+    }
+    for (FSQCellRecord *cellRecord in cellRecords) {
+        [_transactionReloadedCellRecords addObject:cellRecord];
+    }
+}
+
+- (void)deferReconfigurationOfCellRecords:(id<NSFastEnumeration>)cellRecords resizing:(BOOL)resizing {
+    if (!_transactionReconfiguredCellRecords) {
+        _transactionReconfiguredCellRecords = [NSHashTable hashTableWithOptions:(NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality)];
+    }
+    for (FSQCellRecord *cellRecord in cellRecords) {
+        [_transactionReconfiguredCellRecords addObject:cellRecord];
+    }
+    _transactionReconfigurationResizes = (_transactionReconfigurationResizes || resizing);
+}
+
+- (void)performTransaction:(void (^)(void))updates animated:(BOOL)animated {
+    NSParameterAssert(updates);
+    
+    [self beginTransaction];
+    if (updates) {
+        updates();
+    }
+    [self commitTransactionAnimated:animated];
+}
+
+#pragma mark - Frozen Records
+
+- (FSQSectionRecord *)modifiableSectionRecordAtIndex:(NSInteger)sectionIndex {
+    FSQSectionRecord *sectionRecord = _sectionRecords[sectionIndex];
+    if (![sectionRecord isFrozen]) {
+        return sectionRecord;
+    }
+    
+    // Frozen sections may be in use on other threads, so swap in an unfrozen copy to modify instead.
+    // The copy shares the frozen section's cell record array, header and footer, so this is O(number of sections).
+    FSQSectionRecord *modifiableSectionRecord = [sectionRecord copyForSnapshot];
+    
+    NSMutableArray<FSQSectionRecord *> *sectionRecords = [_sectionRecords mutableCopy];
+    sectionRecords[sectionIndex] = modifiableSectionRecord;
+    _sectionRecords = [sectionRecords copy];
+    
+    if ([_transactionReloadedSectionRecords containsObject:sectionRecord]) {
+        [_transactionReloadedSectionRecords addObject:modifiableSectionRecord];
+    }
+    
+    return modifiableSectionRecord;
+}
+
+- (BOOL)sectionRecordsAreFrozen:(NSArray<FSQSectionRecord *> *)sectionRecords {
+    for (FSQSectionRecord *sectionRecord in sectionRecords) {
+        if (![sectionRecord isFrozen]) {
+            return NO;
+        }
+    }
+    return YES;
+}
+
+- (void)commitFrozenSectionRecords:(nullable NSArray<FSQSectionRecord *> *)sectionRecords {
+    NSAssert([NSThread isMainThread], @"Frozen section records must be committed on the main thread");
+    NSAssert([self sectionRecordsAreFrozen:sectionRecords], @"commitFrozenSectionRecords: requires every section record to be frozen");
+    
+    [self setSectionRecords:sectionRecords];
+}
+
+- (void)commitFrozenSectionRecords:(nullable NSArray<FSQSectionRecord *> *)sectionRecords
+                          animated:(BOOL)animated
+                        completion:(nullable void (^)(void))completion {
+    NSAssert([NSThread isMainThread], @"Frozen section records must be committed on the main thread");
+    NSAssert([self sectionRecordsAreFrozen:sectionRecords], @"commitFrozenSectionRecords:animated:completion: requires every section record to be frozen");
+    
+    NSArray<FSQSectionRecord *> *newSectionRecords = [sectionRecords copy] ?: @[];
+    NSArray<FSQSectionRecord *> *originalSectionRecords = _sectionRecords;
+    
+    if ([originalSectionRecords count] == 0
+        || _transactionDepth > 0
+        || ![self sectionRecordsAreFrozen:originalSectionRecords]) {
+        // Either no diff is needed, or the current records may be modified in place while we diff them, so do it now
+        [self setSectionRecords:newSectionRecords animated:animated];
+        if (completion) {
+            completion();
+        }
+        return;
+    }
+    
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        FSQCellManifestChangeset *changeset = [FSQCellManifestChangeset changesetFromSectionRecords:originalSectionRecords
+                                                                                   toSectionRecords:newSectionRecords];
+        
+        dispatch_async(dispatch_get_main_queue(), ^{
+            // If the records changed in the meantime, the changeset is ignored and a new one is computed here instead
+            self->_precomputedChangeset = changeset;
+            [self setSectionRecords:newSectionRecords animated:animated];
+            self->_precomputedChangeset = nil;
+            
+            if (completion) {
+                completion();
+            }
+        });
+    });
+}
+
+#pragma mark - Record Index
+
+- (void)setMaintainsRecordIndex:(BOOL)maintainsRecordIndex {
+    if (_maintainsRecordIndex == maintainsRecordIndex) {
+        return;
+    }
+    _maintainsRecordIndex = maintainsRecordIndex;
+    
+    // The index is built the first time it is used
+    _recordIndex = (maintainsRecordIndex ? [FSQCellManifestRecordIndex new] : nil);
+}
+
+- (nullable NSIndexPath *)indexPathForCellRecord:(FSQCellRecord *)cellRecord {
+    if (_recordIndex) {
+        return [_recordIndex indexPathForCellRecord:cellRecord inSectionRecords:_sectionRecords];
+    }
+    
+    NSInteger sectionIndex = 0;
+    for (FSQSectionRecord *sectionRecord in _sectionRecords) {
+        // Searching a virtual section would create all of its records
+        if (![sectionRecord isKindOfClass:[FSQVirtualSectionRecord class]]) {
+            NSInteger cellIndex = 0;
+            for (FSQCellRecord *sectionCellRecord in sectionRecord.cellRecords) {
+                if (sectionCellRecord == cellRecord) {
+                    return FSQIndexPathMake(sectionIndex, cellIndex);
+                }
+                ++cellIndex;
+            }
+        }
+        ++sectionIndex;
+    }
+    
+    return nil;
+}
+
+- (NSArray<NSIndexPath *> *)indexPathsForModel:(id)model {
+    if (_recordIndex) {
+        return [_recordIndex indexPathsForModel:model inSectionRecords:_sectionRecords];
+    }
+    
+    NSMutableArray<NSIndexPath *> *indexPaths = [NSMutableArray new];
+    NSInteger sectionIndex = 0;
+    for (FSQSectionRecord *sectionRecord in _sectionRecords) {
+        if (![sectionRecord isKindOfClass:[FSQVirtualSectionRecord class]]) {
+            NSInteger cellIndex = 0;
+            for (FSQCellRecord *cellRecord in sectionRecord.cellRecords) {
+                if (cellRecord.model == model) {
+                    [indexPaths addObject:FSQIndexPathMake(sectionIndex, cellIndex)];
+                }
+                ++cellIndex;
+            }
+        }
+        ++sectionIndex;
+    }
+    
+    return [indexPaths copy];
+}
+
+#pragma mark - Insertion and Removal
+
+// The managedViewUpdates versions should not be directly overridden.
+// Subclasses should override public methods, then call through to these with managedViewUpdates set to
+// do any additional work they need to support their use case (ie table or collection updating)
+
+- (void)replaceSectionRecords:(nullable NSArray<FSQSectionRecord *> *)sectionRecords
+            selectionStrategy:(FSQViewReloadCellSelectionStrategy)selectionStrategy
+           managedViewUpdates:(nullable void(^)(NSArray<FSQSectionRecord *> *originalRecords))managedViewUpdates {
+    
+    NSArray *originalRecords = _sectionRecords;
+    
+    /**  Inform delegates  **/
+    
+    [self withEachRecordModificationDelegateRespondingToSelector:@selector(manifest:willReplaceSectionRecords:withRecords:) block:^(id delegate) {
+        [delegate manifest:self willReplaceSectionRecords:originalRecords withRecords:sectionRecords];
+    }];
+    
+    /**  Do work  **/
+    
+    [self invalidateAllRecordSizes];
+    
+    if (!sectionRecords) {
+        _sectionRecords = @[];
+    }
+    else {
+        _sectionRecords = [sectionRecords copy];
+    }
+    
+    [_recordIndex invalidate];
+    
+    [self recordsDidChange];
+    
+    if (managedViewUpdates && [self shouldUpdateManagedView]) {
+        managedViewUpdates(originalRecords);
+    }
+    
+    /**  Inform delegates  **/
+    
+    [self withEachRecordModificationDelegateRespondingToSelector:@selector(manifest:didReplaceSectionRecords:withRecords:) block:^(id delegate) {
+        [delegate manifest:self didReplaceSectionRecords:originalRecords withRecords:sectionRecords];
+    }];
+}
+
+- (void)setSectionRecords:(nullable NSArray<FSQSectionRecord *> *)sectionRecords selectionStrategy:(FSQViewReloadCellSelectionStrategy)selectionStrategy {
+    [self replaceSectionRecords:sectionRecords selectionStrategy:selectionStrategy managedViewUpdates:nil];
+}
+
+- (void)setSectionRecords:(nullable NSArray<FSQSectionRecord *> *)sectionRecords {
+    [self setSectionRecords:sectionRecords selectionStrategy:FSQViewReloadCellSelectionStrategyDeselectAll];
+}
+
+- (void)applyChangesetToSectionRecords:(nullable NSArray<FSQSectionRecord *> *)sectionRecords
+                    managedViewUpdates:(nullable void(^)(FSQCellManifestChangeset *changeset))managedViewUpdates {
+    
+    /**  Check parameters  **/
+    
+    if (_transactionDepth > 0) {
+        // The transaction's commit computes its own changeset from the records it started with
+        _sectionRecords = [sectionRecords copy] ?: @[];
+        [_recordIndex invalidate];
+        [self recordsDidChange];
+        return;
+    }
+    
+    if ([_sectionRecords count] == 0 && !_committingTransaction) {
+        // Nothing is being displayed yet, so a full reload is cheaper than inserting everything
+        [self setSectionRecords:sectionRecords selectionStrategy:FSQViewReloadCellSelectionStrategyDeselectAll];
+        return;
+    }
+    
+    // A changeset computed in the background by commitFrozenSectionRecords:animated:completion: can be used as long as
+    // it was computed from exactly the records we have now
+    FSQCellManifestChangeset *changeset = _precomputedChangeset;
+    _precomputedChangeset = nil;
+    
+    if (!changeset
+        || changeset.originalSectionRecords != _sectionRecords
+        || changeset.sectionRecords != sectionRecords) {
+        changeset = [FSQCellManifestChangeset changesetFromSectionRecords:_sectionRecords
+                                                         toSectionRecords:sectionRecords];
+    }
+    
+    if (_committingTransaction) {
+        _committedChangeset = changeset;
+    }
+    
+    if (![changeset hasChanges]) {
+        [self updateCachedSizesForChangeset:changeset];
+        _sectionRecords = changeset.sectionRecords;
+        [_recordIndex invalidate];
+        return;
+    }
+    
+    /**  Inform delegates  **/
+    
+    [self informDelegatesOfChangeset:changeset beforeApplying:YES];
+    
+    /**  Do work  **/
+    
+    [self updateCachedSizesForChangeset:changeset];
+    
+    _sectionRecords = changeset.sectionRecords;
+    
+    [_recordIndex invalidate];
+    
+    [self recordsDidChange];
+    
+    if (managedViewUpdates && [self shouldUpdateManagedView]) {
+        managedViewUpdates(changeset);
+    }
+    
+    /**  Inform delegates  **/
+    
+    [self informDelegatesOfChangeset:changeset beforeApplying:NO];
+}
+
+- (void)setSectionRecords:(nullable NSArray<FSQSectionRecord *> *)sectionRecords animated:(BOOL)animated {
+    [self applyChangesetToSectionRecords:sectionRecords managedViewUpdates:nil];
+}
+
+- (void)informDelegatesOfChangeset:(FSQCellManifestChangeset *)changeset beforeApplying:(BOOL)beforeApplying {
+    NSArray<FSQSectionRecord *> *originalSectionRecords = changeset.originalSectionRecords;
+    NSArray<FSQSectionRecord *> *newSectionRecords = changeset.sectionRecords;
+    
+    // When committing a transaction, delegates that handle the single aggregated callback do not get the individual ones
+    BOOL committingTransaction = _committingTransaction;
+    
+    if (committingTransaction) {
+        if (beforeApplying) {
+            [self withEachPluginAndDelegateRespondingToSelector:@selector(manifest:willCommitTransactionWithChangeset:) block:^(id delegate) {
+                [delegate manifest:self willCommitTransactionWithChangeset:changeset];
+            }];
+        }
+        else {
+            [self withEachPluginAndDelegateRespondingToSelector:@selector(manifest:didCommitTransactionWithChangeset:) block:^(id delegate) {
+                [delegate manifest:self didCommitTransactionWithChangeset:changeset];
+            }];
+        }
+    }
+    
+    FSQCellManifestResponderList *willCommitResponders = [self responderListForSelector:@selector(manifest:willCommitTransactionWithChangeset:)];
+    FSQCellManifestResponderList *didCommitResponders = [self responderListForSelector:@selector(manifest:didCommitTransactionWithChangeset:)];
+    
+    void (^withEachUnaggregatedDelegate)(SEL, void (^)(id delegate)) = ^(SEL selector, void (^block)(id delegate)) {
+        [self withEachPluginAndDelegateRespondingToSelector:selector block:^(id delegate) {
+            if (committingTransaction) {
+                BOOL handlesCommit = (delegate == self.delegate
+                                      ? (willCommitResponders->_delegateResponds || didCommitResponders->_delegateResponds)
+                                      : ([willCommitResponders->_plugins indexOfObjectIdenticalTo:delegate] != NSNotFound
+                                         || [didCommitResponders->_plugins indexOfObjectIdenticalTo:delegate] != NSNotFound));
+                if (handlesCommit) {
+                    return;
+                }
+            }
+            block(delegate);
+        }];
+    };
+    
+    NSArray<NSIndexPath *> *deletedIndexPaths = changeset.deletedIndexPaths;
+    if ([deletedIndexPaths count] > 0) {
+        withEachUnaggregatedDelegate((beforeApplying ? @selector(manifest:willRemoveCellRecordsAtIndexPaths:removingEmptySections:) : @selector(manifest:didRemoveCellRecordsAtIndexPaths:removedEmptySectionsAtIndexes:)), ^(id delegate) {
+            if (beforeApplying) {
+                [delegate manifest:self willRemoveCellRecordsAtIndexPaths:deletedIndexPaths removingEmptySections:NO];
+            }
+            else {
+                [delegate manifest:self didRemoveCellRecordsAtIndexPaths:deletedIndexPaths removedEmptySectionsAtIndexes:[NSIndexSet indexSet]];
+            }
+        });
+    }
+    
+    NSIndexSet *deletedSectionIndexes = changeset.deletedSectionIndexes;
+    if ([deletedSectionIndexes count] > 0) {
+        withEachUnaggregatedDelegate((beforeApplying ? @selector(manifest:willRemoveSectionRecordsAtIndexes:) : @selector(manifest:didRemoveSectionRecordsAtIndexes:)), ^(id delegate) {
+            if (beforeApplying) {
+                [delegate manifest:self willRemoveSectionRecordsAtIndexes:deletedSectionIndexes];
+            }
+            else {
+                [delegate manifest:self didRemoveSectionRecordsAtIndexes:deletedSectionIndexes];
+            }
+        });
+    }
+    
+    // Insertion callbacks take a starting index, so send one set per contiguous range
+    [changeset.insertedSectionIndexes enumerateRangesUsingBlock:^(NSRange range, BOOL *stop) {
+        NSArray<FSQSectionRecord *> *insertedSectionRecords = [newSectionRecords subarrayWithRange:range];
+        NSIndexSet *insertedIndexes = [NSIndexSet indexSetWithIndexesInRange:range];
+        withEachUnaggregatedDelegate((beforeApplying ? @selector(manifest:willInsertSectionRecords:atIndex:) : @selector(manifest:didInsertSectionRecords:atIndexes:)), ^(id delegate) {
+            if (beforeApplying) {
+                [delegate manifest:self willInsertSectionRecords:insertedSectionRecords atIndex:range.location];
+            }
+            else {
+                [delegate manifest:self didInsertSectionRecords:insertedSectionRecords atIndexes:insertedIndexes];
+            }
+        });
+    }];
+    
+    NSArray<NSIndexPath *> *insertedIndexPaths = changeset.insertedIndexPaths;
+    NSUInteger insertedIndexPathCount = [insertedIndexPaths count];
+    NSUInteger runStart = 0;
+    while (runStart < insertedIndexPathCount) {
+        NSIndexPath *firstIndexPath = insertedIndexPaths[runStart];
+        NSInteger sectionIndex = FSQIndexPathSection(firstIndexPath);
+        NSInteger firstCellIndex = FSQIndexPathRowOrItem(firstIndexPath);
+        
+        NSUInteger runEnd = runStart + 1;
+        while (runEnd < insertedIndexPathCount
+               && FSQIndexPathSection(insertedIndexPaths[runEnd]) == sectionIndex
+               && FSQIndexPathRowOrItem(insertedIndexPaths[runEnd]) == firstCellIndex + (NSInteger)(runEnd - runStart)) {
+            ++runEnd;
+        }
+        
+        NSRange runRange = NSMakeRange(runStart, runEnd - runStart);
+        NSArray<NSIndexPath *> *runIndexPaths = [insertedIndexPaths subarrayWithRange:runRange];
+        NSArray<FSQCellRecord *> *runCellRecords = [newSectionRecords[sectionIndex].cellRecords subarrayWithRange:NSMakeRange(firstCellIndex, runRange.length)];
+        
+        withEachUnaggregatedDelegate((beforeApplying ? @selector(manifest:willInsertCellRecords:atIndexPath:) : @selector(manifest:didInsertCellRecords:atIndexPaths:)), ^(id delegate) {
+            if (beforeApplying) {
+                [delegate manifest:self willInsertCellRecords:runCellRecords atIndexPath:firstIndexPath];
+            }
+            else {
+                [delegate manifest:self didInsertCellRecords:runCellRecords atIndexPaths:runIndexPaths];
+            }
+        });
+        
+        runStart = runEnd;
+    }
+    
+    NSArray<NSNumber *> *movedSectionTargetIndexes = changeset.movedSectionTargetIndexes;
+    [changeset.movedSectionInitialIndexes enumerateObjectsUsingBlock:^(NSNumber *initialIndexNumber, NSUInteger moveIndex, BOOL *stop) {
+        NSInteger initialIndex = [initialIndexNumber integerValue];
+        NSInteger targetIndex = [movedSectionTargetIndexes[moveIndex] integerValue];
+        withEachUnaggregatedDelegate((beforeApplying ? @selector(manifest:willMoveSectionRecordAtIndex:toIndex:) : @selector(manifest:didMoveSectionRecordAtIndex:toIndex:)), ^(id delegate) {
+            if (beforeApplying) {
+                [delegate manifest:self willMoveSectionRecordAtIndex:initialIndex toIndex:targetIndex];
+            }
+            else {
+                [delegate manifest:self didMoveSectionRecordAtIndex:initialIndex toIndex:targetIndex];
+            }
+        });
+    }];
+    
+    NSArray<NSIndexPath *> *movedTargetIndexPaths = changeset.movedTargetIndexPaths;
+    [changeset.movedInitialIndexPaths enumerateObjectsUsingBlock:^(NSIndexPath *initialIndexPath, NSUInteger moveIndex, BOOL *stop) {
+        NSIndexPath *targetIndexPath = movedTargetIndexPaths[moveIndex];
+        withEachUnaggregatedDelegate((beforeApplying ? @selector(manifest:willMoveCellRecordAtIndexPath:toIndexPath:) : @selector(manifest:didMoveCellRecordAtIndexPath:toIndexPath:)), ^(id delegate) {
+            if (beforeApplying) {
+                [delegate manifest:self willMoveCellRecordAtIndexPath:initialIndexPath toIndexPath:targetIndexPath];
+            }
+            else {
+                [delegate manifest:self didMoveCellRecordAtIndexPath:initialIndexPath toIndexPath:targetIndexPath];
+            }
+        });
+    }];
+    
+    // Reloaded sections are always at the same index before and after the update, but reloaded cells may be shifted
+    NSIndexSet *reloadedSectionIndexes = changeset.reloadedSectionIndexes;
+    if ([reloadedSectionIndexes count] > 0) {
+        NSMutableArray<NSNumber *> *reloadedIndexesMutable = [NSMutableArray new];
+        [reloadedSectionIndexes enumerateIndexesUsingBlock:^(NSUInteger idx, BOOL *stop) {
+            [reloadedIndexesMutable addObject:@(idx)];
+        }];
+        NSArray<NSNumber *> *reloadedIndexes = [reloadedIndexesMutable copy];
+        NSArray<FSQSectionRecord *> *replacedSectionRecords = [originalSectionRecords objectsAtIndexes:reloadedSectionIndexes];
+        NSArray<FSQSectionRecord *> *insertedSectionRecords = [newSectionRecords objectsAtIndexes:reloadedSectionIndexes];
+        
+        withEachUnaggregatedDelegate((beforeApplying ? @selector(manifest:willReplaceSectionRecordsAtIndexes:withRecords:) : @selector(manifest:didReplaceSectionRecordsAtIndexes:withRecords:replacedRecords:)), ^(id delegate) {
+            if (beforeApplying) {
+                [delegate manifest:self willReplaceSectionRecordsAtIndexes:reloadedIndexes withRecords:insertedSectionRecords];
+            }
+            else {
+                [delegate manifest:self didReplaceSectionRecordsAtIndexes:reloadedIndexes withRecords:insertedSectionRecords replacedRecords:replacedSectionRecords];
+            }
+        });
+    }
+    
+    NSArray<NSIndexPath *> *reloadedIndexPaths = changeset.reloadedIndexPaths;
+    if ([reloadedIndexPaths count] > 0) {
+        NSArray<NSIndexPath *> *reloadedTargetIndexPaths = changeset.reloadedTargetIndexPaths;
+        NSMutableArray<FSQCellRecord *> *replacedCellRecordsMutable = [NSMutableArray new];
+        NSMutableArray<FSQCellRecord *> *insertedCellRecordsMutable = [NSMutableArray new];
+        [reloadedIndexPaths enumerateObjectsUsingBlock:^(NSIndexPath *indexPath, NSUInteger reloadIndex, BOOL *stop) {
+            NSIndexPath *targetIndexPath = reloadedTargetIndexPaths[reloadIndex];
+            [replacedCellRecordsMutable addObject:originalSectionRecords[FSQIndexPathSection(indexPath)].cellRecords[FSQIndexPathRowOrItem(indexPath)]];
+            [insertedCellRecordsMutable addObject:newSectionRecords[FSQIndexPathSection(targetIndexPath)].cellRecords[FSQIndexPathRowOrItem(targetIndexPath)]];
+        }];
+        NSArray<FSQCellRecord *> *replacedCellRecords = [replacedCellRecordsMutable copy];
+        NSArray<FSQCellRecord *> *insertedCellRecords = [insertedCellRecordsMutable copy];
+        
+        withEachUnaggregatedDelegate((beforeApplying ? @selector(manifest:willReplaceCellRecordsAtIndexPaths:withRecords:) : @selector(manifest:didReplaceCellRecordsAtIndexPaths:withRecords:replacedRecords:)), ^(id delegate) {
+            if (beforeApplying) {
+                [delegate manifest:self willReplaceCellRecordsAtIndexPaths:reloadedIndexPaths withRecords:insertedCellRecords];
+            }
+            else {
+                [delegate manifest:self didReplaceCellRecordsAtIndexPaths:reloadedTargetIndexPaths withRecords:insertedCellRecords replacedRecords:replacedCellRecords];
+            }
+        });
+    }
+}
+
+- (nullable NSArray *)insertCellRecords:(NSArray *)cellRecordsToInsert
+                            atIndexPath:(NSIndexPath *)indexPath
+                     managedViewUpdates:(nullable void(^)(NSArray *insertedIndexPaths))managedViewUpdates {
+    
+    /**  Check parameters  **/
+    
+    if ([cellRecordsToInsert count] <= 0) {
+        return nil;
+    }
+    
+    NSInteger sectionIndex = FSQIndexPathSection(indexPath);
+    FSQSectionRecord *sectionRecord = [self sectionRecordAtIndex:sectionIndex];
+    if (!sectionRecord) {
+        return nil;
+    }
+    
+    NSInteger row = FSQIndexPathRowOrItem(indexPath);
+    NSInteger numberOfCellRecords = [sectionRecord numberOfCellRecords];
+    
+    if (row > numberOfCellRecords || row < 0) {
+        return nil;
+    }
+    
+    /**  Inform delegates  **/
+    
+    [self withEachRecordModificationDelegateRespondingToSelector:@selector(manifest:willInsertCellRecords:atIndexPath:) block:^(id delegate) {
+        [delegate manifest:self willInsertCellRecords:cellRecordsToInsert atIndexPath:indexPath];
+    }];
+    
+    /**  Do work  **/
+    
+    NSIndexSet *insertedIndexes = [NSIndexSet indexSetWithIndexesInRange:NSMakeRange(row, [cellRecordsToInsert count])];
+    sectionRecord = [self modifiableSectionRecordAtIndex:sectionIndex];
+    [sectionRecord insertCellRecords:cellRecordsToInsert atIndex:row];
+    [_recordIndex didInsertCellRecords:cellRecordsToInsert atIndexPath:indexPath];
+    NSMutableArray *insertedIndexPathsMutable = [NSMutableArray new];
+    [insertedIndexes enumerateIndexesUsingBlock:^(NSUInteger idx, BOOL *stop) {
+        [insertedIndexPathsMutable addObject:FSQIndexPathMake(sectionIndex, idx)];
+    }];
+    
+    NSArray *insertedIndexPaths = [insertedIndexPathsMutable copy];
+    
+    [self cellRecordsDidInsertInRange:NSMakeRange(row, [cellRecordsToInsert count]) inSection:sectionIndex];
+    [self recordsDidChange];
+    
+    if (managedViewUpdates && [self shouldUpdateManagedView]) {
+        managedViewUpdates(insertedIndexPaths);
+    }
+    
+    /**  Inform delegates  **/
+    
+    [self withEachRecordModificationDelegateRespondingToSelector:@selector(manifest:didInsertCellRecords:atIndexPaths:) block:^(id delegate) {
+        [delegate manifest:self didInsertCellRecords:cellRecordsToInsert atIndexPaths:insertedIndexPaths];
+    }];
+    
+    return insertedIndexPaths;
+    
+}
+
+- (NSArray *)insertCellRecords:(NSArray *)cellRecordsToInsert
+                   atIndexPath:(NSIndexPath *)indexPath {
+    return [self insertCellRecords:cellRecordsToInsert atIndexPath:indexPath managedViewUpdates:nil];
+}
+
+- (nullable NSIndexSet *)insertSectionRecords:(NSArray *)sectionRecordsToInsert
+                                      atIndex:(NSInteger)index
+                           managedViewUpdates:(nullable void(^)(NSIndexSet *insertedIndexes))managedViewUpdates {
+    
+    /**  Check parameters  **/
+    
+    NSInteger numberOfSectionRecords = [self numberOfSectionRecords];
+    if ([sectionRecordsToInsert count] <= 0 || index > numberOfSectionRecords || index < 0) {
+        return nil;
+    }
+    
+    /**  Inform delegates  **/
+    
+    [self withEachRecordModificationDelegateRespondingToSelector:@selector(manifest:willInsertSectionRecords:atIndex:) block:^(id delegate) {
+        [delegate manifest:self willInsertSectionRecords:sectionRecordsToInsert atIndex:index];
+    }];
+    
+    /**  Do work  **/
+    
+    NSIndexSet *insertedIndexes = [NSIndexSet indexSetWithIndexesInRange:NSMakeRange(index, [sectionRecordsToInsert count])];
+    
+    NSMutableArray *updatedSectionRecords = [_sectionRecords mutableCopy];
+    [updatedSectionRecords insertObjects:sectionRecordsToInsert atIndexes:insertedIndexes];
+    
+    // Don't use setSectionRecords as that will trigger a view reload and all sorts of delegate callbacks
+    _sectionRecords = [updatedSectionRecords copy];
+    [_recordIndex didInsertSectionRecords:sectionRecordsToInsert atIndexes:insertedIndexes];
+    
+    [self recordsDidChange];
+    
+    if (managedViewUpdates && [self shouldUpdateManagedView]) {
+        managedViewUpdates(insertedIndexes);
+    }
+    
+    /**  Inform delegates  **/
+    
+    [self withEachRecordModificationDelegateRespondingToSelector:@selector(manifest:didInsertSectionRecords:atIndexes:) block:^(id delegate) {
+        [delegate manifest:self didInsertSectionRecords:sectionRecordsToInsert atIndexes:insertedIndexes];
+    }];
+    
+    return insertedIndexes;
+}
+
+- (NSIndexSet *)insertSectionRecords:(NSArray *)sectionRecordsToInsert atIndex:(NSInteger)index {
+    return [self insertSectionRecords:sectionRecordsToInsert atIndex:index managedViewUpdates:nil];
+}
+
+- (BOOL)moveCellRecordAtIndexPath:(NSIndexPath *)initialIndexPath
+                      toIndexPath:(NSIndexPath *)targetIndexPath
+               managedViewUpdates:(nullable void(^)(void))managedViewUpdates {
+    
+    /**  Check parameters  **/
+    
+    NSInteger initialSectionIndex = FSQIndexPathSection(initialIndexPath);
+    NSInteger targetSectionIndex = FSQIndexPathSection(targetIndexPath);
+    
+    if (initialSectionIndex >= [self numberOfSectionRecords]
+        || targetSectionIndex >= [self numberOfSectionRecords]
+        || initialSectionIndex < 0
+        || targetSectionIndex < 0
+        ) {
+        return NO;
+    }
+    
+    FSQSectionRecord *initialSectionRecord = [self sectionRecordAtIndex:initialSectionIndex];
+    FSQSectionRecord *targetSectionRecord = [self sectionRecordAtIndex:targetSectionIndex];
+    NSInteger intitialCellIndex = FSQIndexPathRowOrItem(initialIndexPath);
+    NSInteger targetCellIndex = FSQIndexPathRowOrItem(targetIndexPath);
+    NSInteger numberofTargetSectionRecordsAfterMove;
+    
+    if (initialSectionIndex == targetSectionIndex) {
+        numberofTargetSectionRecordsAfterMove = [targetSectionRecord numberOfCellRecords];
+    }
+    else {
+        numberofTargetSectionRecordsAfterMove = [targetSectionRecord numberOfCellRecords] + 1;
+    }
+    
+    if (!(intitialCellIndex < [initialSectionRecord numberOfCellRecords])
+        || targetCellIndex > numberofTargetSectionRecordsAfterMove) {
+        return NO;
+    }
+    
+    /**  Inform delegates  **/
+    
+    [self withEachRecordModificationDelegateRespondingToSelector:@selector(manifest:willMoveCellRecordAtIndexPath:toIndexPath:) block:^(id delegate) {
+        [delegate manifest:self willMoveCellRecordAtIndexPath:initialIndexPath toIndexPath:targetIndexPath];
+    }];
+    
+    /**  Do work  **/
+    
+    initialSectionRecord = [self modifiableSectionRecordAtIndex:initialSectionIndex];
+    targetSectionRecord = [self modifiableSectionRecordAtIndex:targetSectionIndex];
+    
+    FSQCellRecord *record = [initialSectionRecord cellRecordAtIndex:intitialCellIndex];
+    
+    // Invalidated while the record is still at its initial index path, so that subclasses know where it was
+    [self invalidateSizesForRecordsAtIndexPaths:@[initialIndexPath]];
+    
+    [initialSectionRecord removeCellRecordsAtIndexes:[NSIndexSet indexSetWithIndex:intitialCellIndex]];
+    
+    // Record will always exist because we check numberOfCellRecords above and return NO if there are not enough.
+    // But if you do not include this check, the Xcode analyzer warns about possible nil insertion.
+    if (record) {
+        [_recordIndex didRemoveCellRecords:@[record] atIndexes:[NSIndexSet indexSetWithIndex:intitialCellIndex] inSection:initialSectionIndex];
+        [self cellRecordsDidRemoveAtIndexes:[NSIndexSet indexSetWithIndex:intitialCellIndex] inSection:initialSectionIndex];
+        [targetSectionRecord insertCellRecords:@[record] atIndex:targetCellIndex];
+        [_recordIndex didInsertCellRecords:@[record] atIndexPath:FSQIndexPathMake(targetSectionIndex, targetCellIndex)];
+        [self cellRecordsDidInsertInRange:NSMakeRange(targetCellIndex, 1) inSection:targetSectionIndex];
+    }
+    
+    [self recordsDidChange];
+    
+    if (managedViewUpdates && [self shouldUpdateManagedView]) {
+        managedViewUpdates();
+    }
+    
+    /**  Inform delegates  **/
+    
+    [self withEachRecordModificationDelegateRespondingToSelector:@selector(manifest:didMoveCellRecordAtIndexPath:toIndexPath:) block:^(id delegate) {
+        [delegate manifest:self didMoveCellRecordAtIndexPath:initialIndexPath toIndexPath:targetIndexPath];
+    }];
+    
+    return YES;
+}
+
+- (BOOL)moveCellRecordAtIndexPath:(NSIndexPath *)initialIndexPath toIndexPath:(NSIndexPath *)targetIndexPath {
+    return [self moveCellRecordAtIndexPath:initialIndexPath toIndexPath:targetIndexPath managedViewUpdates:nil];
+}
+
+- (BOOL)moveSectionRecordAtIndex:(NSInteger)initialIndex
+                         toIndex:(NSInteger)targetIndex
+              managedViewUpdates:(nullable void(^)(void))managedViewUpdates {
+    
+    /**  Check parameters  **/
+    
+    if (initialIndex >= [self numberOfSectionRecords]
+        || targetIndex >= [self numberOfSectionRecords]
+        || initialIndex < 0
+        || targetIndex < 0) {
+        return NO;
+    }
+    
+    /**  Inform delegates  **/
+    
+    [self withEachRecordModificationDelegateRespondingToSelector:@selector(manifest:willMoveSectionRecordAtIndex:toIndex:) block:^(id delegate) {
+        [delegate manifest:self willMoveSectionRecordAtIndex:initialIndex toIndex:targetIndex];
+    }];
+    
+    /**  Do work  **/
+    
+    NSMutableArray *mutableSectionRecords = [_sectionRecords mutableCopy];
+    FSQSectionRecord *record = [mutableSectionRecords objectAtIndex:initialIndex];
+    [mutableSectionRecords removeObjectAtIndex:initialIndex];
+    [mutableSectionRecords insertObject:record atIndex:targetIndex];
+    
+    // Don't use setSectionRecords as that will trigger a view reload
+    _sectionRecords = [mutableSectionRecords copy];
+    [_recordIndex didMoveSectionRecordAtIndex:initialIndex toIndex:targetIndex];
+    
+    [self recordsDidChange];
+    
+    if (managedViewUpdates && [self shouldUpdateManagedView]) {
+        managedViewUpdates();
+    }
+    
+    /**  Inform delegates  **/
+    
+    [self withEachRecordModificationDelegateRespondingToSelector:@selector(manifest:didMoveSectionRecordAtIndex:toIndex:) block:^(id delegate) {
+        [delegate manifest:self didMoveSectionRecordAtIndex:initialIndex toIndex:targetIndex];
+    }];
+    
+    return YES;
+}
+
+- (BOOL)moveSectionRecordAtIndex:(NSInteger)initialIndex toIndex:(NSInteger)targetIndex {
+    return [self moveSectionRecordAtIndex:initialIndex toIndex:targetIndex managedViewUpdates:nil];
+}
+
+- (nullable NSArray *)removeCellRecordsAtIndexPaths:(NSArray *)indexPaths
+                                removeEmptySections:(BOOL)shouldRemoveEmptySections
+                                 managedViewUpdates:(nullable void(^)(NSArray *removedIndexPaths, NSIndexSet *removedSectionIndexes))managedViewUpdates {
+    
+    /**  Check parameters  **/
+    
+    if ([indexPaths count] <= 0) {
+        return nil;
+    }
+    
+    /**  Inform delegates  **/
+    
+    [self withEachRecordModificationDelegateRespondingToSelector:@selector(manifest:willRemoveCellRecordsAtIndexPaths:removingEmptySections:) block:^(id delegate) {
+        [delegate manifest:self willRemoveCellRecordsAtIndexPaths:indexPaths removingEmptySections:shouldRemoveEmptySections];
+    }];
+    
+    /**  Do work  **/
+    
+    [self invalidateSizesForRecordsAtIndexPaths:indexPaths];
+    
+    NSInteger numberOfSections = [self numberOfSectionRecords];
+    FSQCellManifestCellIndexesBySection *cellIndexesToRemoveBySection = [[FSQCellManifestCellIndexesBySection alloc] initWithNumberOfSections:numberOfSections];
+    
+    // Store index data in a more useful structure
+    for (NSIndexPath *indexPath in indexPaths) {
+        NSInteger sectionIndex = FSQIndexPathSection(indexPath);
+        if (sectionIndex < numberOfSections && sectionIndex >= 0) {
+            NSInteger cellIndexToRemove = FSQIndexPathRowOrItem(indexPath);
+            if (cellIndexToRemove < [self numberOfCellRecordsInSectionAtIndex:sectionIndex]
+                && cellIndexToRemove >= 0) {
+                NSMutableIndexSet *cellIndexesToRemoveForSection = cellIndexesToRemoveBySection->_cellIndexes[sectionIndex];
+                if (!cellIndexesToRemoveForSection) {
+                    cellIndexesToRemoveForSection = [NSMutableIndexSet new];
+                    cellIndexesToRemoveBySection->_cellIndexes[sectionIndex] = cellIndexesToRemoveForSection;
+                }
+                
+                [cellIndexesToRemoveForSection addIndex:cellIndexToRemove];
+            }
+        }
+    }
+    
+    return [self removeCellRecordsAtIndexesBySection:cellIndexesToRemoveBySection
+                                 removeEmptySections:shouldRemoveEmptySections
+                                  managedViewUpdates:managedViewUpdates];
+}
+
+// Does the work of removing cell records once they have been validated and grouped by section,
+// and informs delegates afterwards. Callers are responsible for the "will" delegate callbacks.
+- (NSArray *)removeCellRecordsAtIndexesBySection:(FSQCellManifestCellIndexesBySection *)cellIndexesToRemoveBySection
+                             removeEmptySections:(BOOL)shouldRemoveEmptySections
+                              managedViewUpdates:(nullable void(^)(NSArray *removedIndexPaths, NSIndexSet *removedSectionIndexes))managedViewUpdates {
+    
+    NSMutableArray *removedCellIndexPathsMutable = [NSMutableArray new];
+    
+    NSMutableIndexSet *sectionIndexesToRemoveMutable = nil;
+    if (shouldRemoveEmptySections) {
+        sectionIndexesToRemoveMutable = [NSMutableIndexSet new];
+    }
+    
+    for (NSInteger sectionIndex = 0; sectionIndex < cellIndexesToRemoveBySection->_numberOfSections; ++sectionIndex) {
+        NSIndexSet *cellIndexesToRemove = cellIndexesToRemoveBySection->_cellIndexes[sectionIndex];
+        if ([cellIndexesToRemove count] == 0) {
+            continue;
+        }
+        
+        FSQSectionRecord *sectionRecord = [self sectionRecordAtIndex:sectionIndex];
+        
+        NSArray<FSQCellRecord *> *removedCellRecords = nil;
+        
+        // If all cells in this section are to be removed
+        if ([cellIndexesToRemove containsIndexesInRange:NSMakeRange(0, [sectionRecord numberOfCellRecords])]) {
+            if (sectionIndexesToRemoveMutable) {
+                [sectionIndexesToRemoveMutable addIndex:sectionIndex];
+                continue;
+            }
+            else {
+                removedCellRecords = (_recordIndex ? sectionRecord.cellRecords : nil);
+                [[self modifiableSectionRecordAtIndex:sectionIndex] setCellRecords:nil];
+            }
+        }
+        else {
+            removedCellRecords = (_recordIndex ? [sectionRecord.cellRecords objectsAtIndexes:cellIndexesToRemove] : nil);
+            [[self modifiableSectionRecordAtIndex:sectionIndex] removeCellRecordsAtIndexes:cellIndexesToRemove];
+        }
+        
+        if (removedCellRecords) {
+            [_recordIndex didRemoveCellRecords:removedCellRecords atIndexes:cellIndexesToRemove inSection:sectionIndex];
+        }
+        
+        [cellIndexesToRemove enumerateIndexesUsingBlock:^(NSUInteger idx, BOOL *stop) {
+            [removedCellIndexPathsMutable addObject:FSQIndexPathMake(sectionIndex, idx)];
+        }];
+    }
+    // NOTE: We have to make sure sectionIndexesToRemove is not nil
+    // because we must let sectionIndexesToRemove pass nil check so
+    // that managedViewUpdates will be executed, otherwise UI won't be updated
+    NSIndexSet *sectionIndexesToRemove = [sectionIndexesToRemoveMutable copy] ?: [NSIndexSet new];
+    NSArray *removedCellIndexPaths = [removedCellIndexPathsMutable copy];
+    
+    if (sectionIndexesToRemove) {
+        [self removeSectionRecordsAtIndexes:sectionIndexesToRemove shouldInformDelegates:NO managedViewUpdates:nil];
+        
+        if ([sectionIndexesToRemove count] == 0) {
+            for (NSInteger sectionIndex = 0; sectionIndex < cellIndexesToRemoveBySection->_numberOfSections; ++sectionIndex) {
+                NSIndexSet *cellIndexesToRemove = cellIndexesToRemoveBySection->_cellIndexes[sectionIndex];
+                if ([cellIndexesToRemove count] > 0) {
+                    [self cellRecordsDidRemoveAtIndexes:cellIndexesToRemove inSection:sectionIndex];
+                }
+            }
+        }
+        [self recordsDidChange];
+        
+        if (managedViewUpdates && [self shouldUpdateManagedView]) {
+            managedViewUpdates(removedCellIndexPaths, sectionIndexesToRemove);
+        }
+    }
+    
+    /**  Inform delegates  **/
+    
+    [self withEachRecordModificationDelegateRespondingToSelector:@selector(manifest:didRemoveCellRecordsAtIndexPaths:removedEmptySectionsAtIndexes:) block:^(id delegate) {
+        [delegate manifest:self didRemoveCellRecordsAtIndexPaths:removedCellIndexPaths removedEmptySectionsAtIndexes:sectionIndexesToRemove];
+    }];
+    
+    return [removedCellIndexPaths copy];
+}
+
+- (NSArray *)removeCellRecordsAtIndexPaths:(NSArray *)indexPaths
+                       removeEmptySections:(BOOL)shouldRemoveEmptySections {
+    return [self removeCellRecordsAtIndexPaths:indexPaths removeEmptySections:shouldRemoveEmptySections managedViewUpdates:nil];
+    
+}
+
+- (FSQCellManifestCellIndexesBySection *)cellIndexesBySectionWithOptions:(NSEnumerationOptions)options
+                                                            passingTest:(FSQCellRecordTestBlock)predicate {
+    NSArray<FSQSectionRecord *> *sectionRecords = _sectionRecords;
+    
+    FSQCellManifestCellIndexesBySection *passingIndexesBySection = [[FSQCellManifestCellIndexesBySection alloc] initWithNumberOfSections:(NSInteger)[sectionRecords count]];
+    NSMutableIndexSet *__strong *passingIndexesForSection = passingIndexesBySection->_cellIndexes;
+    
+    void (^testSectionRecord)(FSQSectionRecord *, NSUInteger, BOOL *) = ^(FSQSectionRecord *sectionRecord, NSUInteger sectionIndex, BOOL *stop) {
+        NSMutableIndexSet *passingIndexes = nil;
+        NSInteger cellIndex = 0;
+        for (FSQCellRecord *cellRecord in sectionRecord) {
+            if (predicate(cellRecord, FSQIndexPathMake(sectionIndex, cellIndex))) {
+                if (!passingIndexes) {
+                    passingIndexes = [NSMutableIndexSet new];
+                }
+                [passingIndexes addIndex:cellIndex];
+            }
+            ++cellIndex;
+        }
+        passingIndexesForSection[sectionIndex] = passingIndexes;
+    };
+    
+    if (options & NSEnumerationConcurrent) {
+        // Each section is tested on a single thread and only writes its own entry.
+        // Virtual sections create their records on the main thread, so they are tested afterwards on this one.
+        Class virtualSectionRecordClass = [FSQVirtualSectionRecord class];
+        [sectionRecords enumerateObjectsWithOptions:NSEnumerationConcurrent usingBlock:^(FSQSectionRecord *sectionRecord, NSUInteger sectionIndex, BOOL *stop) {
+            if (![sectionRecord isKindOfClass:virtualSectionRecordClass]) {
+                testSectionRecord(sectionRecord, sectionIndex, stop);
+            }
+        }];
+        [sectionRecords enumerateObjectsUsingBlock:^(FSQSectionRecord *sectionRecord, NSUInteger sectionIndex, BOOL *stop) {
+            if ([sectionRecord isKindOfClass:virtualSectionRecordClass]) {
+                testSectionRecord(sectionRecord, sectionIndex, stop);
+            }
+        }];
+    }
+    else {
+        [sectionRecords enumerateObjectsUsingBlock:testSectionRecord];
+    }
+    
+    return passingIndexesBySection;
+}
+
+- (NSArray<NSIndexPath *> *)removeCellRecordsWithOptions:(NSEnumerationOptions)options
+                                             passingTest:(FSQCellRecordTestBlock)predicate
+                                     removeEmptySections:(BOOL)shouldRemoveEmptySections
+                                      managedViewUpdates:(nullable void(^)(NSArray *removedIndexPaths, NSIndexSet *removedSectionIndexes))managedViewUpdates {
+    NSParameterAssert(predicate);
+    
+    /**  Check parameters  **/
+    
+    FSQCellManifestCellIndexesBySection *cellIndexesToRemoveBySection = [self cellIndexesBySectionWithOptions:options passingTest:predicate];
+    if ([cellIndexesToRemoveBySection isEmpty]) {
+        return @[];
+    }
+    
+    NSArray<NSIndexPath *> *indexPaths = [cellIndexesToRemoveBySection indexPaths];
+    
+    /**  Inform delegates  **/
+    
+    [self withEachRecordModificationDelegateRespondingToSelector:@selector(manifest:willRemoveCellRecordsAtIndexPaths:removingEmptySections:) block:^(id delegate) {
+        [delegate manifest:self willRemoveCellRecordsAtIndexPaths:indexPaths removingEmptySections:shouldRemoveEmptySections];
+    }];
+    
+    /**  Do work  **/
+    
+    [self invalidateSizesForRecordsAtIndexPaths:indexPaths];
+    
+    return [self removeCellRecordsAtIndexesBySection:cellIndexesToRemoveBySection
+                                 removeEmptySections:shouldRemoveEmptySections
+                                  managedViewUpdates:managedViewUpdates];
+}
+
+- (NSArray<NSIndexPath *> *)removeCellRecordsWithOptions:(NSEnumerationOptions)options
+                                             passingTest:(FSQCellRecordTestBlock)predicate
+                                     removeEmptySections:(BOOL)shouldRemoveEmptySections {
+    return [self removeCellRecordsWithOptions:options passingTest:predicate removeEmptySections:shouldRemoveEmptySections managedViewUpdates:nil];
+}
+
+- (NSArray<NSIndexPath *> *)removeCellRecordsPassingTest:(FSQCellRecordTestBlock)predicate
+                                     removeEmptySections:(BOOL)shouldRemoveEmptySections {
+    return [self removeCellRecordsWithOptions:0 passingTest:predicate removeEmptySections:shouldRemoveEmptySections];
+}
+
+- (BOOL)removeSectionRecordsAtIndexes:(NSIndexSet *)indexes
+                   managedViewUpdates:(nullable void(^)(void))managedViewUpdates {
+    return [self removeSectionRecordsAtIndexes:indexes shouldInformDelegates:YES managedViewUpdates:managedViewUpdates];
+}
+
+- (BOOL)removeSectionRecordsAtIndexes:(NSIndexSet *)indexes
+                shouldInformDelegates:(BOOL)shouldInformDelegates
+                   managedViewUpdates:(nullable void(^)(void))managedViewUpdates {
+    
+    /**  Check parameters  **/
+    
+    NSInteger numberOfSections = [self numberOfSectionRecords];
+    
+    if (numberOfSections <= 0
+        || [indexes count] <= 0
+        || [indexes lastIndex] >= numberOfSections) {
+        return NO;
+    }
+    
+    /**  Inform delegates  **/
+    if (shouldInformDelegates) {
+        [self withEachRecordModificationDelegateRespondingToSelector:@selector(manifest:willRemoveSectionRecordsAtIndexes:) block:^(id delegate) {
+            [delegate manifest:self willRemoveSectionRecordsAtIndexes:indexes];
+        }];
+    }
+    
+    /**  Do work  **/
+    
+    NSArray<FSQSectionRecord *> *removedSectionRecords = [_sectionRecords objectsAtIndexes:indexes];
+    
+    [self invalidateSizesForSectionRecords:removedSectionRecords];
+    
+    NSMutableArray *mutableSectionRecords = [_sectionRecords mutableCopy];
+    [mutableSectionRecords removeObjectsAtIndexes:indexes];
+    _sectionRecords = [mutableSectionRecords copy];
+    [_recordIndex didRemoveSectionRecords:removedSectionRecords atIndexes:indexes];
+    
+    [self recordsDidChange];
+    
+    if (managedViewUpdates && [self shouldUpdateManagedView]) {
+        managedViewUpdates();
+    }
+    
+    /**  Inform delegates  **/
+    if (shouldInformDelegates) {
+        [self withEachRecordModificationDelegateRespondingToSelector:@selector(manifest:didRemoveSectionRecordsAtIndexes:) block:^(id delegate) {
+            [delegate manifest:self didRemoveSectionRecordsAtIndexes:indexes];
+        }];
+    }
+    
+    return YES;
+}
+
+- (BOOL)removeSectionRecordsAtIndexes:(NSIndexSet *)indexes {
+    return [self removeSectionRecordsAtIndexes:indexes managedViewUpdates:nil];
+}
+
+- (void)replaceCellRecordsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths
+                       withCellRecords:(NSArray<FSQCellRecord *> *)newCellRecords
+                    managedViewUpdates:(nullable void(^)(NSArray<NSIndexPath *> *replacedIndexPaths))managedViewUpdates {
+    /**  Check parameters  **/
+    
+    if (!indexPaths
+        || !newCellRecords
+        || [indexPaths count] == 0
+        || [indexPaths count] != [newCellRecords count]) {
+        return;
+    }
+    
+    // Sort the requests by index path, so that each section's replacements can be gathered up and applied at once.
+    // Ties are broken by parameter position so that if an index path is given more than once, the last record wins.
+    NSUInteger requestCount = [indexPaths count];
+    NSMutableData *requestStorage = [NSMutableData dataWithLength:requestCount * sizeof(FSQCellManifestReplacementRequest)];
+    FSQCellManifestReplacementRequest *requests = requestStorage.mutableBytes;
+    [indexPaths enumerateObjectsUsingBlock:^(NSIndexPath *indexPath, NSUInteger parameterIndex, BOOL *stop) {
+        requests[parameterIndex] = (FSQCellManifestReplacementRequest){
+            .section = FSQIndexPathSection(indexPath),
+            .rowOrItem = FSQIndexPathRowOrItem(indexPath),
+            .parameterIndex = parameterIndex,
+        };
+    }];
+    
+    qsort(requests, requestCount, sizeof(FSQCellManifestReplacementRequest), FSQCellManifestCompareReplacementRequests);
+    
+    // Invalid index paths are skipped. Each section's record count is only looked up once.
+    NSInteger numberOfSections = [_sectionRecords count];
+    NSMutableArray<FSQCellManifestSectionReplacement *> *sectionReplacements = [NSMutableArray new];
+    NSUInteger requestIndex = 0;
+    while (requestIndex < requestCount) {
+        NSInteger sectionIndex = requests[requestIndex].section;
+        
+        if (sectionIndex < 0
+            || sectionIndex >= numberOfSections) {
+            while (requestIndex < requestCount && requests[requestIndex].section == sectionIndex) {
+                ++requestIndex;
+            }
+            continue;
+        }
+        
+        NSInteger numberOfCellRecords = [_sectionRecords[sectionIndex] numberOfCellRecords];
+        NSMutableIndexSet *cellIndexes = [NSMutableIndexSet new];
+        NSMutableArray<FSQCellRecord *> *sectionCellRecords = [NSMutableArray new];
+        NSInteger previousCellIndex = -1;
+        
+        for (; requestIndex < requestCount && requests[requestIndex].section == sectionIndex; ++requestIndex) {
+            NSInteger cellIndex = requests[requestIndex].rowOrItem;
+            if (cellIndex < 0
+                || cellIndex >= numberOfCellRecords) {
+                continue;
+            }
+            
+            FSQCellRecord *newCellRecord = newCellRecords[requests[requestIndex].parameterIndex];
+            if (cellIndex == previousCellIndex) {
+                sectionCellRecords[[sectionCellRecords count] - 1] = newCellRecord;
+            }
+            else {
+                [cellIndexes addIndex:cellIndex];
+                [sectionCellRecords addObject:newCellRecord];
+                previousCellIndex = cellIndex;
+            }
+        }
+        
+        if ([cellIndexes count] > 0) {
+            FSQCellManifestSectionReplacement *sectionReplacement = [FSQCellManifestSectionReplacement new];
+            sectionReplacement->_sectionIndex = sectionIndex;
+            sectionReplacement->_cellIndexes = [cellIndexes copy];
+            sectionReplacement->_cellRecords = [sectionCellRecords copy];
+            [sectionReplacements addObject:sectionReplacement];
+        }
+    }
+    
+    [self applySectionReplacements:sectionReplacements managedViewUpdates:managedViewUpdates];
+}
+
+- (void)replaceCellRecordsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths withCellRecords:(NSArray<FSQCellRecord *> *)newCellRecords {
+    [self replaceCellRecordsAtIndexPaths:indexPaths withCellRecords:newCellRecords managedViewUpdates:nil];
+}
+
+// Replaces cell records one section at a time, informing delegates before and after.
+// The replacements must already be validated and sorted by section index.
+- (NSArray<NSIndexPath *> *)applySectionReplacements:(NSArray<FSQCellManifestSectionReplacement *> *)sectionReplacements
+                                  managedViewUpdates:(nullable void(^)(NSArray<NSIndexPath *> *replacedIndexPaths))managedViewUpdates {
+    
+    NSMutableArray<NSIndexPath *> *replacedIndexPathsMutable = [NSMutableArray new];
+    NSMutableArray<FSQCellRecord *> *replacedCellRecordsMutable = [NSMutableArray new];
+    NSMutableArray<FSQCellRecord *> *insertedCellRecordsMutable = [NSMutableArray new];
+    
+    for (FSQCellManifestSectionReplacement *sectionReplacement in sectionReplacements) {
+        NSInteger sectionIndex = sectionReplacement->_sectionIndex;
+        FSQSectionRecord *sectionRecord = _sectionRecords[sectionIndex];
+        [sectionReplacement->_cellIndexes enumerateIndexesUsingBlock:^(NSUInteger idx, BOOL *stop) {
+            [replacedIndexPathsMutable addObject:FSQIndexPathMake(sectionIndex, idx)];
+            [replacedCellRecordsMutable addObject:[sectionRecord cellRecordAtIndex:idx]];
+        }];
+        [insertedCellRecordsMutable addObjectsFromArray:sectionReplacement->_cellRecords];
+    }
+    
+    NSArray<NSIndexPath *> *replacedIndexPaths = [replacedIndexPathsMutable copy];
+    NSArray<FSQCellRecord *> *replacedCellRecords = [replacedCellRecordsMutable copy];
+    NSArray<FSQCellRecord *> *insertedCellRecords = [insertedCellRecordsMutable copy];
+    
+    /**  Inform delegates  **/
+    
+    [self withEachRecordModificationDelegateRespondingToSelector:@selector(manifest:willReplaceCellRecordsAtIndexPaths:withRecords:) block:^(id delegate) {
+        [delegate manifest:self willReplaceCellRecordsAtIndexPaths:replacedIndexPaths withRecords:insertedCellRecords];
+    }];
+    
+    /**  Do work  **/
+    
+    for (FSQCellManifestSectionReplacement *sectionReplacement in sectionReplacements) {
+        NSInteger sectionIndex = sectionReplacement->_sectionIndex;
+        NSArray<FSQCellRecord *> *oldCellRecords = (_recordIndex ? [_sectionRecords[sectionIndex].cellRecords objectsAtIndexes:sectionReplacement->_cellIndexes] : nil);
+        
+        [[self modifiableSectionRecordAtIndex:sectionIndex] replaceCellRecordsAtIndexes:sectionReplacement->_cellIndexes
+                                                                        withCellRecords:sectionReplacement->_cellRecords];
+        
+        if (oldCellRecords) {
+            [_recordIndex didReplaceCellRecords:oldCellRecords
+                                withCellRecords:sectionReplacement->_cellRecords
+                                      atIndexes:sectionReplacement->_cellIndexes
+                                      inSection:sectionIndex];
+        }
+    }
+    
+    [self invalidateSizesForReplacedCellRecords:replacedCellRecords atIndexPaths:replacedIndexPaths];
+    
+    if (_transactionDepth > 0) {
+        // The commit only diffs the records, and would miss a replacement that is equal to the original record
+        // (for example, one whose model was modified in place)
+        [self deferReloadOfCellRecords:insertedCellRecords];
+    }
+    
+    [self recordsDidChange];
+    
+    if (managedViewUpdates && [self shouldUpdateManagedView]) {
+        managedViewUpdates(replacedIndexPaths);
+    }
+    
+    /**  Inform delegates  **/
+    
+    [self withEachRecordModificationDelegateRespondingToSelector:@selector(manifest:didReplaceCellRecordsAtIndexPaths:withRecords:replacedRecords:) block:^(id delegate) {
+        [delegate manifest:self didReplaceCellRecordsAtIndexPaths:replacedIndexPaths withRecords:insertedCellRecords replacedRecords:replacedCellRecords];
+    }];
+    
+    return replacedIndexPaths;
+}
+
+- (NSArray<NSIndexPath *> *)replaceCellRecordsWithOptions:(NSEnumerationOptions)options
+                                              passingTest:(FSQCellRecordTestBlock)predicate
+                                                withBlock:(FSQCellRecordReplacementBlock)replacement
+                                       managedViewUpdates:(nullable void(^)(NSArray<NSIndexPath *> *replacedIndexPaths))managedViewUpdates {
+    NSParameterAssert(predicate);
+    NSParameterAssert(replacement);
+    
+    /**  Check parameters  **/
+    
+    FSQCellManifestCellIndexesBySection *cellIndexesToReplaceBySection = [self cellIndexesBySectionWithOptions:options passingTest:predicate];
+    if ([cellIndexesToReplaceBySection isEmpty]) {
+        return @[];
+    }
+    
+    NSMutableArray<FSQCellManifestSectionReplacement *> *sectionReplacements = [NSMutableArray new];
+    for (NSInteger sectionIndex = 0; sectionIndex < cellIndexesToReplaceBySection->_numberOfSections; ++sectionIndex) {
+        NSIndexSet *cellIndexes = cellIndexesToReplaceBySection->_cellIndexes[sectionIndex];
+        if ([cellIndexes count] == 0) {
+            continue;
+        }
+        
+        FSQSectionRecord *sectionRecord = _sectionRecords[sectionIndex];
+        
+        NSMutableArray<FSQCellRecord *> *newCellRecords = [[NSMutableArray alloc] initWithCapacity:[cellIndexes count]];
+        [cellIndexes enumerateIndexesUsingBlock:^(NSUInteger idx, BOOL *stop) {
+            FSQCellRecord *newCellRecord = replacement([sectionRecord cellRecordAtIndex:idx], FSQIndexPathMake(sectionIndex, idx));
+            NSAssert(newCellRecord, @"The block passed to replaceCellRecordsPassingTest:withBlock: must return a cell record");
+            [newCellRecords addObject:newCellRecord];
+        }];
+        
+        FSQCellManifestSectionReplacement *sectionReplacement = [FSQCellManifestSectionReplacement new];
+        sectionReplacement->_sectionIndex = sectionIndex;
+        sectionReplacement->_cellIndexes = cellIndexes;
+        sectionReplacement->_cellRecords = [newCellRecords copy];
+        [sectionReplacements addObject:sectionReplacement];
+    }
+    
+    return [self applySectionReplacements:sectionReplacements managedViewUpdates:managedViewUpdates];
+}
+
+- (NSArray<NSIndexPath *> *)replaceCellRecordsWithOptions:(NSEnumerationOptions)options
+                                              passingTest:(FSQCellRecordTestBlock)predicate
+                                                withBlock:(FSQCellRecordReplacementBlock)replacement {
+    return [self replaceCellRecordsWithOptions:options passingTest:predicate withBlock:replacement managedViewUpdates:nil];
+}
+
+- (NSArray<NSIndexPath *> *)replaceCellRecordsPassingTest:(FSQCellRecordTestBlock)predicate
+                                                withBlock:(FSQCellRecordReplacementBlock)replacement {
+    return [self replaceCellRecordsWithOptions:0 passingTest:predicate withBlock:replacement];
+}
+
+- (nullable NSIndexSet *)replaceSectionRecordsAtIndexes:(NSArray<NSNumber *> *)indexes
+                                     withSectionRecords:(NSArray<FSQSectionRecord *> *)newSectionRecords
+                                     managedViewUpdates:(nullable void(^)(NSIndexSet *replacedIndexes))managedViewUpdates {
+    
+    /**  Check parameters  **/
+    
+    if (!indexes
+        || !newSectionRecords
+        || [indexes count] == 0
+        || [indexes count] != [newSectionRecords count]) {
+        return nil;
+    }
+    
+    /**  Inform delegates  **/
+    
+    [self withEachRecordModificationDelegateRespondingToSelector:@selector(manifest:willReplaceSectionRecordsAtIndexes:withRecords:) block:^(id delegate) {
+        [delegate manifest:self willReplaceSectionRecordsAtIndexes:indexes withRecords:newSectionRecords];
+    }];
+    
+    /**  Do work  **/
+    
+    NSMutableArray<NSNumber *> *replacedIndexesMutable = [NSMutableArray new];
+    NSMutableIndexSet *replacedIndexSetMutable = [NSMutableIndexSet new];
+    NSMutableArray<FSQSectionRecord *> *replacedSectionRecordsMutable = [NSMutableArray new];
+    NSMutableArray<FSQSectionRecord *> *insertedSectionRecordsMutable = [NSMutableArray new];
+    
+    NSMutableArray<FSQSectionRecord *> *sectionRecordsMutable = [_sectionRecords mutableCopy];
+    
+    [indexes enumerateObjectsUsingBlock:^(NSNumber *sectionIndexNumber, NSUInteger parameterIndex, BOOL *stop) {
+        NSInteger sectionIndex = [sectionIndexNumber integerValue];
+        
+        if (sectionIndex >= [self numberOfSectionRecords]
+            || sectionIndex < 0) {
+            return;
+        }
+        
+        [replacedIndexesMutable addObject:sectionIndexNumber];
+        [replacedIndexSetMutable addIndex:sectionIndex];
+        [replacedSectionRecordsMutable addObject:sectionRecordsMutable[sectionIndex]];
+        [insertedSectionRecordsMutable addObject:newSectionRecords[parameterIndex]];
+        
+        [self->_recordIndex didReplaceSectionRecord:sectionRecordsMutable[sectionIndex] withSectionRecord:newSectionRecords[parameterIndex] atIndex:sectionIndex];
+        sectionRecordsMutable[sectionIndex] = newSectionRecords[parameterIndex];
+    }];
+    
+    _sectionRecords = [sectionRecordsMutable copy];
+    
+    NSArray<NSNumber *> *replacedIndexes = [replacedIndexesMutable copy];
+    NSIndexSet *replacedIndexSet = [replacedIndexSetMutable copy];
+    NSArray<FSQSectionRecord *> *replacedSectionRecords = [replacedSectionRecordsMutable copy];
+    NSArray<FSQSectionRecord *> *insertedSectionRecords = [insertedSectionRecordsMutable copy];
+    
+    [self invalidateSizesForSectionRecords:replacedSectionRecords];
+    
+    if (_transactionDepth > 0) {
+        // The commit only diffs the records, and would miss a replacement that is equal to the original section
+        [self deferReloadOfSectionRecords:insertedSectionRecords];
+    }
+    
+    [self recordsDidChange];
+    
+    if (managedViewUpdates && [self shouldUpdateManagedView]) {
+        managedViewUpdates(replacedIndexSet);
+    }
+    
+    /**  Inform delegates  **/
+    
+    [self withEachRecordModificationDelegateRespondingToSelector:@selector(manifest:didReplaceSectionRecordsAtIndexes:withRecords:replacedRecords:) block:^(id delegate) {
+        [delegate manifest:self didReplaceSectionRecordsAtIndexes:replacedIndexes withRecords:insertedSectionRecords replacedRecords:replacedSectionRecords];
+    }];
+    
+    return replacedIndexSet;
+}
+
+- (NSIndexSet *)replaceSectionRecordsAtIndexes:(NSArray<NSNumber *> *)indexes withSectionRecords:(NSArray *)newSectionRecords {
+    return [self replaceSectionRecordsAtIndexes:indexes withSectionRecords:newSectionRecords managedViewUpdates:nil];
+}
+
+- (void)reloadManagedViewWithUpdates:(nullable void(^)(void))managedViewUpdates {
+    
+    /**  Check parameters  **/
+    
+    if (_transactionDepth > 0) {
+        _transactionReloadsManagedView = YES;
+        return;
+    }
+    
+    /**  Inform delegates  **/
+    
+    [self withEachPluginAndDelegateRespondingToSelector:@selector(manifestWillReloadManagedView:) block:^(id delegate) {
+        [delegate manifestWillReloadManagedView:self];
+    }];
+    
+    /**  Do work  **/
+    
+    [self invalidateAllRecordSizes];
+    
+    if (managedViewUpdates) {
+        managedViewUpdates();
+    }
+    
+    /**  Inform delegates  **/
+    
+    [self withEachPluginAndDelegateRespondingToSelector:@selector(manifestDidReloadManagedView:) block:^(id delegate) {
+        [delegate manifestDidReloadManagedView:self];
+    }];
+}
+
+- (void)reloadManagedView {
+    [self reloadManagedViewWithUpdates:nil];
+}
+
+- (void)reloadSectionsAtIndexes:(NSIndexSet *)indexes managedViewUpdates:(nullable void(^)(NSIndexSet *indexes))managedViewUpdates {
+    
+    /**  Check parameters  **/
+    
+    if (_transactionDepth > 0) {
+        NSMutableArray<FSQSectionRecord *> *sectionRecords = [NSMutableArray new];
+        [indexes enumerateIndexesUsingBlock:^(NSUInteger idx, BOOL *stop) {
+            FSQSectionRecord *sectionRecord = [self sectionRecordAtIndex:idx];
+            if (sectionRecord) {
+                [sectionRecords addObject:sectionRecord];
+            }
+        }];
+        [self deferReloadOfSectionRecords:sectionRecords];
+        return;
+    }
+    
+    /**  Inform delegates  **/
+    
+    [self withEachPluginAndDelegateRespondingToSelector:@selector(manifest:willReloadSectionsAtIndexes:) block:^(id delegate) {
+        [delegate manifest:self willReloadSectionsAtIndexes:indexes];
+    }];
+    
+    /**  Do work  **/
+    
+    [self invalidateSizesForReloadedSectionsAtIndexes:indexes];
+    
+    if (managedViewUpdates) {
+        managedViewUpdates(indexes);
+    }
+    
+    /**  Inform delegates  **/
+    
+    [self withEachPluginAndDelegateRespondingToSelector:@selector(manifest:didReloadSectionsAtIndexes:) block:^(id delegate) {
+        [delegate manifest:self didReloadSectionsAtIndexes:indexes];
+    }];
+}
+
+- (void)reloadSectionsAtIndexes:(NSIndexSet *)indexes {
+    [self reloadSectionsAtIndexes:indexes managedViewUpdates:nil];
+}
+
+- (void)reloadCellsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths managedViewUpdates:(nullable void(^)(NSArray *indexPaths))managedViewUpdates {
+    
+    /**  Check parameters  **/
+    
+    if (_transactionDepth > 0) {
+        NSMutableArray<FSQCellRecord *> *cellRecords = [NSMutableArray new];
+        for (NSIndexPath *indexPath in indexPaths) {
+            FSQCellRecord *cellRecord = [self cellRecordAtIndexPath:indexPath];
+            if (cellRecord) {
+                [cellRecords addObject:cellRecord];
+            }
+        }
+        [self deferReloadOfCellRecords:cellRecords];
+        return;
+    }
+    
+    /**  Inform delegates  **/
+    
+    [self withEachPluginAndDelegateRespondingToSelector:@selector(manifest:willReloadCellsAtIndexPaths:) block:^(id delegate) {
+        [delegate manifest:self willReloadCellsAtIndexPaths:indexPaths];
+    }];
+    
+    /**  Do work  **/
+    
+    [self invalidateSizesForRecordsAtIndexPaths:indexPaths];
+    
+    if (managedViewUpdates) {
+        managedViewUpdates(indexPaths);
+    }
+    
+    /**  Inform delegates  **/
+    
+    [self withEachPluginAndDelegateRespondingToSelector:@selector(manifest:didReloadCellsAtIndexPaths:) block:^(id delegate) {
+        [delegate manifest:self didReloadCellsAtIndexPaths:indexPaths];
+    }];
+}
+
+- (void)reloadCellsAtIndexPaths:(NSArray *)indexPaths {
+    [self reloadCellsAtIndexPaths:indexPaths managedViewUpdates:nil];
+}
+
+- (NSSet *)matchingIndexPathsForCurrentlySelectedIndexPaths:(NSArray<NSIndexPath *> *)currentlySelectedIndexPaths
+                                          newSectionRecords:(NSArray<FSQSectionRecord *> *)newSectionRecords {
+    
+    NSMutableSet *newIndexPathsToSelect = [NSMutableSet new];
+    
+    if ([currentlySelectedIndexPaths count] == 0) {
+        return newIndexPathsToSelect;
+    }
+    
+    // FSQCellRecord's hash includes its model's hash, so each new record is only compared with the selected records
+    // that have an equal model instead of the whole selection
+    NSMutableSet *currentlySelectedRecords = [[NSMutableSet alloc] initWithCapacity:[currentlySelectedIndexPaths count]];
+    
+    for (NSIndexPath *selectedPath in currentlySelectedIndexPaths) {
+        [currentlySelectedRecords addObject:[self cellRecordAtIndexPath:selectedPath]];
+    }
+    
+    NSInteger sectionIndex = 0;
+    for (FSQSectionRecord *newSectionRecord in newSectionRecords) {
+        NSInteger cellIndex = 0;
+        for (FSQCellRecord *newCellRecord in newSectionRecord) {
+            if ([currentlySelectedRecords containsObject:newCellRecord]) {
+                [newIndexPathsToSelect addObject:FSQIndexPathMake(sectionIndex, cellIndex)];
+            }
+            ++cellIndex;
+        }
+        ++sectionIndex;
+    }
+    
+    return newIndexPathsToSelect;
+}
+
+@end
+
+#pragma mark End Core Manifest -
+
+NS_ASSUME_NONNULL_END
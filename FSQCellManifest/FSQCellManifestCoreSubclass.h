@@ -0,0 +1,169 @@
+//
+//  FSQCellManifestCoreSubclass.h
+//
+//  Copyright (c) 2015 Foursquare. All rights reserved.
+//
+
+#import "FSQCellManifestCore.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/*
+ The parts of FSQCellManifestCore that are only meant for its subclasses, such as FSQCellManifest.
+
+ These are internal methods and should not be used outside of the framework.
+ */
+
+/**
+ The plugins that respond to a single delegate selector, in order, and whether the delegate responds to it too.
+ The delegate itself is not stored because the manifest only holds it weakly.
+ Message forwarder enumerators also record whether the manifest itself responds.
+ */
+@interface FSQCellManifestResponderList : NSObject {
+    @public
+    NSArray *_plugins;
+    BOOL _delegateResponds;
+    BOOL _manifestResponds;
+}
+@end
+
+@interface FSQCellManifestCore (FSQCellManifestSubclassMethods)
+
+/**
+ The objects that receive delegate callbacks before the delegate does. The core manifest has none.
+ */
+- (nullable NSArray *)plugins;
+
+// The managedViewUpdates versions should not be directly overridden.
+// Subclasses should override public methods, then call through to these with managedViewUpdates set to
+// do any additional work they need to support their use case (ie table or collection updating).
+// managedViewUpdates blocks are not called while shouldUpdateManagedView is NO.
+
+- (BOOL)shouldUpdateManagedView;
+
+- (void)replaceSectionRecords:(nullable NSArray<FSQSectionRecord *> *)sectionRecords
+            selectionStrategy:(FSQViewReloadCellSelectionStrategy)selectionStrategy
+           managedViewUpdates:(nullable void(^)(NSArray<FSQSectionRecord *> *originalRecords))managedViewUpdates;
+
+- (void)applyChangesetToSectionRecords:(nullable NSArray<FSQSectionRecord *> *)sectionRecords
+                    managedViewUpdates:(nullable void(^)(FSQCellManifestChangeset *changeset))managedViewUpdates;
+
+- (nullable NSArray *)insertCellRecords:(NSArray *)cellRecordsToInsert
+                            atIndexPath:(NSIndexPath *)indexPath
+                     managedViewUpdates:(nullable void(^)(NSArray *insertedIndexPaths))managedViewUpdates;
+
+- (nullable NSIndexSet *)insertSectionRecords:(NSArray *)sectionRecordsToInsert
+                                      atIndex:(NSInteger)index
+                           managedViewUpdates:(nullable void(^)(NSIndexSet *insertedIndexes))managedViewUpdates;
+
+- (BOOL)moveCellRecordAtIndexPath:(NSIndexPath *)initialIndexPath
+                      toIndexPath:(NSIndexPath *)targetIndexPath
+               managedViewUpdates:(nullable void(^)(void))managedViewUpdates;
+
+- (BOOL)moveSectionRecordAtIndex:(NSInteger)initialIndex
+                         toIndex:(NSInteger)targetIndex
+              managedViewUpdates:(nullable void(^)(void))managedViewUpdates;
+
+- (nullable NSArray *)removeCellRecordsAtIndexPaths:(NSArray *)indexPaths
+                                removeEmptySections:(BOOL)shouldRemoveEmptySections
+                                 managedViewUpdates:(nullable void(^)(NSArray *removedIndexPaths, NSIndexSet *removedSectionIndexes))managedViewUpdates;
+
+- (NSArray<NSIndexPath *> *)removeCellRecordsWithOptions:(NSEnumerationOptions)options
+                                             passingTest:(FSQCellRecordTestBlock)predicate
+                                     removeEmptySections:(BOOL)shouldRemoveEmptySections
+                                      managedViewUpdates:(nullable void(^)(NSArray *removedIndexPaths, NSIndexSet *removedSectionIndexes))managedViewUpdates;
+
+- (BOOL)removeSectionRecordsAtIndexes:(NSIndexSet *)indexes
+                   managedViewUpdates:(nullable void(^)(void))managedViewUpdates;
+
+- (void)replaceCellRecordsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths
+                       withCellRecords:(NSArray<FSQCellRecord *> *)newCellRecords
+                    managedViewUpdates:(nullable void(^)(NSArray<NSIndexPath *> *replacedIndexPaths))managedViewUpdates;
+
+- (NSArray<NSIndexPath *> *)replaceCellRecordsWithOptions:(NSEnumerationOptions)options
+                                              passingTest:(FSQCellRecordTestBlock)predicate
+                                                withBlock:(FSQCellRecordReplacementBlock)replacement
+                                       managedViewUpdates:(nullable void(^)(NSArray<NSIndexPath *> *replacedIndexPaths))managedViewUpdates;
+
+- (nullable NSIndexSet *)replaceSectionRecordsAtIndexes:(NSArray<NSNumber *> *)indexes
+                                     withSectionRecords:(NSArray<FSQSectionRecord *> *)newSectionRecords
+                                     managedViewUpdates:(nullable void(^)(NSIndexSet *replacedIndexes))managedViewUpdates;
+
+- (void)reloadManagedViewWithUpdates:(nullable void(^)(void))managedViewUpdates;
+- (void)reloadSectionsAtIndexes:(NSIndexSet *)indexes managedViewUpdates:(nullable void(^)(NSIndexSet *indexes))managedViewUpdates;
+- (void)reloadCellsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths managedViewUpdates:(nullable void(^)(NSArray *indexPaths))managedViewUpdates;
+
+/**
+ @return The index paths in newSectionRecords of records equal to the ones currently at currentlySelectedIndexPaths.
+ */
+- (NSSet *)matchingIndexPathsForCurrentlySelectedIndexPaths:(NSArray<NSIndexPath *> *)currentlySelectedIndexPaths
+                                          newSectionRecords:(NSArray<FSQSectionRecord *> *)newSectionRecords;
+
+// Hooks called by the core manifest as its records change. The core implementations do nothing.
+
+// Called whenever the structure of the section records changes, before the managed view is updated.
+// Subclasses overriding this must call super.
+- (void)recordsDidChange NS_REQUIRES_SUPER;
+
+// Called right before recordsDidChange when the only structural change was cell records being inserted into or
+// removed from existing sections, so subclasses can update per-row state in place instead of rebuilding it.
+- (void)cellRecordsDidInsertInRange:(NSRange)range inSection:(NSInteger)sectionIndex;
+- (void)cellRecordsDidRemoveAtIndexes:(NSIndexSet *)indexes inSection:(NSInteger)sectionIndex;
+
+// Called for records that are removed or replaced, or that need to be measured again for any other reason.
+// Index paths are always those of the records before the change, except for replaced cell records, which are called
+// after the replacements are in place at the same index paths.
+// invalidateSizesForSectionRecords: is only called for sections leaving the manifest, whose layout changes are
+// already covered by recordsDidChange.
+- (void)invalidateAllRecordSizes;
+- (void)invalidateSizesForReplacedCellRecords:(NSArray<FSQCellRecord *> *)records atIndexPaths:(NSArray<NSIndexPath *> *)indexPaths;
+- (void)invalidateSizesForSectionRecords:(NSArray<FSQSectionRecord *> *)sectionRecords;
+- (void)invalidateSizesForReloadedSectionsAtIndexes:(NSIndexSet *)indexes;
+- (void)invalidateSizesForRecordsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths;
+
+// Called every time a changeset is applied, while the section records are still changeset.originalSectionRecords.
+- (void)updateCachedSizesForChangeset:(FSQCellManifestChangeset *)changeset;
+
+// Called when a transaction that reconfigured cell records is committed.
+- (void)reconfigureCellRecords:(NSArray<FSQCellRecord *> *)cellRecords resizing:(BOOL)resizing;
+
+// Responder lists. Callbacks are sent many times per cell, so rather than asking every plugin and the delegate whether
+// they respond each time, the manifest remembers who responds to each selector.
+
+- (void)invalidateResponderLists NS_REQUIRES_SUPER;
+- (FSQCellManifestResponderList *)responderListForSelector:(SEL)selector;
+- (BOOL)delegateRespondsToSelector:(SEL)selector;
+- (void)withEachPluginAndDelegateRespondingToSelector:(SEL)selector block:(void (^)(id delegate))block;
+- (void)withEachRecordModificationDelegateRespondingToSelector:(SEL)selector block:(void (^)(id delegate))block;
+
+// Reload or reconfigure wherever these records end up once the current transaction is committed.
+// Must only be called while inTransaction is YES.
+- (void)deferReloadOfSectionRecords:(NSArray<FSQSectionRecord *> *)sectionRecords;
+- (void)deferReloadOfCellRecords:(NSArray<FSQCellRecord *> *)cellRecords;
+- (void)deferReconfigurationOfCellRecords:(id<NSFastEnumeration>)cellRecords resizing:(BOOL)resizing;
+
+@end
+
+// These methods all already exist in FSQSectionRecord.m but are not exposed.
+// Define them here so that the manifests can know about them.
+// They are for internal manifest use only and should not be used outside of the framework
+@interface FSQSectionRecord (FSQCellManifestPrivateMethods)
+
+- (NSValue *)collectionViewSectionInsetPrivate;
+- (void)insertCellRecords:(NSArray<FSQCellRecord *> *)cellRecords atIndex:(NSUInteger)index;
+- (void)removeCellRecordsAtIndexes:(NSIndexSet *)indexes;
+- (void)replaceCellRecordsAtIndexes:(NSIndexSet *)indexes withCellRecords:(NSArray<FSQCellRecord *> *)cellRecords;
+- (FSQSectionRecord *)copyForSnapshot;
+- (void)enumerateMaterializedCellRecordsUsingBlock:(void (^)(FSQCellRecord *cellRecord, NSUInteger index, BOOL *stop))block;
+
+@end
+
+// These methods already exist in FSQCellManifestChangeset.m but are not exposed.
+@interface FSQCellManifestChangeset (FSQCellManifestPrivateMethods)
+
+- (void)enumerateUnchangedRecordsUsingBlock:(void (^)(FSQCellRecord *originalRecord, FSQCellRecord *record))block;
+- (void)withRowChangesForBatchUpdates:(void (^)(NSArray<NSIndexPath *> *deletedIndexPaths, NSArray<NSIndexPath *> *insertedIndexPaths, NSArray<NSIndexPath *> *reloadedIndexPaths))block;
+
+@end
+
+NS_ASSUME_NONNULL_END
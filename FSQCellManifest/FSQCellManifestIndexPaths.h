@@ -0,0 +1,35 @@
+//
+//  FSQCellManifestIndexPaths.h
+//
+//  Copyright (c) 2015 Foursquare. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/*
+ Index path math for the manifest's record bookkeeping, using only Foundation.
+ 
+ UIKit's section/row/item accessors are category methods that are only available alongside UIKit, and row and item
+ are both just the index at position 1. Going through these functions instead keeps the model layer of the manifest
+ (record lookup, changesets and mutation validation) free of UIKit, and means the core manifest does not need to ask
+ its table or collection view subclass how to read or build every index path it touches.
+ 
+ These are internal functions and should not be used outside of the framework.
+ */
+
+NS_INLINE NSInteger FSQIndexPathSection(NSIndexPath *indexPath) {
+    return (NSInteger)[indexPath indexAtPosition:0];
+}
+
+NS_INLINE NSInteger FSQIndexPathRowOrItem(NSIndexPath *indexPath) {
+    return (NSInteger)[indexPath indexAtPosition:1];
+}
+
+NS_INLINE NSIndexPath *FSQIndexPathMake(NSInteger section, NSInteger rowOrItem) {
+    NSUInteger indexes[] = {(NSUInteger)section, (NSUInteger)rowOrItem};
+    return [NSIndexPath indexPathWithIndexes:indexes length:2];
+}
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,81 @@
+//
+//  FSQCellManifestOffsetIndex.h
+//
+//  Copyright (c) 2015 Foursquare. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ A prefix sum index over a fixed number of item heights, implemented as a Fenwick (binary indexed) tree.
+ 
+ Changing a single height, finding the offset of an item, and finding the item at an offset are all O(log n).
+ Building the index is O(n), and so are inserting and removing items, which only move the existing heights instead of
+ asking for them again.
+ 
+ This is an internal class used by FSQTableViewCellManifest and should not be used outside of the framework.
+ */
+@interface FSQCellManifestOffsetIndex : NSObject
+
+/**
+ Create a new index.
+ 
+ @param heights An array of count item heights. It is copied.
+ @param count   The number of items in the index.
+ 
+ @return A new offset index.
+ */
+- (instancetype)initWithHeights:(const double *_Nullable)heights count:(NSUInteger)count NS_DESIGNATED_INITIALIZER;
+
+/**
+ The number of items in the index.
+ */
+@property (nonatomic, readonly) NSUInteger count;
+
+/**
+ The sum of every item's height.
+ */
+@property (nonatomic, readonly) double totalHeight;
+
+/**
+ @return The height of the item at index. Index must be less than count.
+ */
+- (double)heightAtIndex:(NSUInteger)index;
+
+/**
+ Change the height of the item at index. Index must be less than count.
+ */
+- (void)setHeight:(double)height atIndex:(NSUInteger)index;
+
+/**
+ Insert items before index. Index may be equal to count.
+ 
+ @param heights The heights of the new items.
+ @param count   The number of items to insert.
+ @param index   Where to insert the first new item.
+ */
+- (void)insertHeights:(const double *)heights count:(NSUInteger)count atIndex:(NSUInteger)index;
+
+/**
+ Remove the items at indexes. Every index must be less than count.
+ */
+- (void)removeHeightsAtIndexes:(NSIndexSet *)indexes;
+
+/**
+ @return The sum of the heights of all items before index. Index may be equal to count.
+ */
+- (double)offsetOfIndex:(NSUInteger)index;
+
+/**
+ Find the item that covers offset. Items with a height of zero never cover an offset.
+ 
+ @return The index of the item whose span contains offset, clamped to the first or last item if offset is out of
+ bounds. NSNotFound if the index is empty.
+ */
+- (NSUInteger)indexForOffset:(double)offset;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,154 @@
+//
+//  FSQCellManifestOffsetIndex.m
+//
+//  Copyright (c) 2015 Foursquare. All rights reserved.
+//
+
+#import "FSQCellManifestOffsetIndex.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@implementation FSQCellManifestOffsetIndex {
+    // _tree is one-based; _tree[i] holds the sum of the heights of items (i - lowbit(i), i]
+    double *_tree;
+    double *_heights;
+    NSUInteger _highestPowerOfTwo;
+}
+
+- (instancetype)init {
+    return [self initWithHeights:NULL count:0];
+}
+
+- (instancetype)initWithHeights:(const double *_Nullable)heights count:(NSUInteger)count {
+    if ((self = [super init])) {
+        _count = count;
+        _tree = calloc(count + 1, sizeof(double));
+        _heights = calloc(MAX(count, 1), sizeof(double));
+        
+        if (heights) {
+            memcpy(_heights, heights, count * sizeof(double));
+        }
+        
+        [self rebuildTree];
+    }
+    return self;
+}
+
+- (void)rebuildTree {
+    // Linear time construction: push each node's sum up to its parent once
+    memset(_tree, 0, (_count + 1) * sizeof(double));
+    _totalHeight = 0;
+    for (NSUInteger i = 1; i <= _count; ++i) {
+        _tree[i] += _heights[i - 1];
+        NSUInteger parent = i + (i & (~i + 1));
+        if (parent <= _count) {
+            _tree[parent] += _tree[i];
+        }
+        _totalHeight += _heights[i - 1];
+    }
+    
+    _highestPowerOfTwo = 1;
+    while ((_highestPowerOfTwo << 1) <= _count) {
+        _highestPowerOfTwo <<= 1;
+    }
+}
+
+- (void)dealloc {
+    free(_tree);
+    free(_heights);
+}
+
+- (double)heightAtIndex:(NSUInteger)index {
+    NSAssert(index < _count, @"Index %lu out of bounds in offset index of count %lu", (unsigned long)index, (unsigned long)_count);
+    return _heights[index];
+}
+
+- (void)setHeight:(double)height atIndex:(NSUInteger)index {
+    NSAssert(index < _count, @"Index %lu out of bounds in offset index of count %lu", (unsigned long)index, (unsigned long)_count);
+    
+    double delta = height - _heights[index];
+    if (delta == 0) {
+        return;
+    }
+    
+    _heights[index] = height;
+    _totalHeight += delta;
+    
+    for (NSUInteger i = index + 1; i <= _count; i += (i & (~i + 1))) {
+        _tree[i] += delta;
+    }
+}
+
+- (void)insertHeights:(const double *)heights count:(NSUInteger)count atIndex:(NSUInteger)index {
+    NSAssert(index <= _count, @"Index %lu out of bounds in offset index of count %lu", (unsigned long)index, (unsigned long)_count);
+    
+    if (count == 0) {
+        return;
+    }
+    
+    NSUInteger newCount = _count + count;
+    _heights = realloc(_heights, newCount * sizeof(double));
+    _tree = realloc(_tree, (newCount + 1) * sizeof(double));
+    memmove(_heights + index + count, _heights + index, (_count - index) * sizeof(double));
+    memcpy(_heights + index, heights, count * sizeof(double));
+    _count = newCount;
+    
+    [self rebuildTree];
+}
+
+- (void)removeHeightsAtIndexes:(NSIndexSet *)indexes {
+    NSAssert([indexes count] == 0 || [indexes lastIndex] < _count, @"Index %lu out of bounds in offset index of count %lu", (unsigned long)[indexes lastIndex], (unsigned long)_count);
+    
+    if ([indexes count] == 0) {
+        return;
+    }
+    
+    // Compact the remaining heights in one pass
+    __block NSUInteger writeIndex = [indexes firstIndex];
+    __block NSUInteger readIndex = [indexes firstIndex];
+    double *itemHeights = _heights;
+    [indexes enumerateRangesUsingBlock:^(NSRange range, BOOL *stop) {
+        NSUInteger keptCount = range.location - readIndex;
+        memmove(itemHeights + writeIndex, itemHeights + readIndex, keptCount * sizeof(double));
+        writeIndex += keptCount;
+        readIndex = NSMaxRange(range);
+    }];
+    memmove(itemHeights + writeIndex, itemHeights + readIndex, (_count - readIndex) * sizeof(double));
+    _count -= [indexes count];
+    
+    [self rebuildTree];
+}
+
+- (double)offsetOfIndex:(NSUInteger)index {
+    NSAssert(index <= _count, @"Index %lu out of bounds in offset index of count %lu", (unsigned long)index, (unsigned long)_count);
+    
+    double offset = 0;
+    for (NSUInteger i = MIN(index, _count); i > 0; i -= (i & (~i + 1))) {
+        offset += _tree[i];
+    }
+    return offset;
+}
+
+- (NSUInteger)indexForOffset:(double)offset {
+    if (_count == 0) {
+        return NSNotFound;
+    }
+    
+    // Find the largest number of leading items whose heights sum to no more than offset.
+    // The item right after them is the one that covers the offset.
+    NSUInteger position = 0;
+    double remaining = offset;
+    for (NSUInteger step = _highestPowerOfTwo; step > 0; step >>= 1) {
+        NSUInteger next = position + step;
+        if (next <= _count && _tree[next] <= remaining) {
+            position = next;
+            remaining -= _tree[next];
+        }
+    }
+    
+    return MIN(position, _count - 1);
+}
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,118 @@
+//
+//  FSQCellManifestPagedArray.h
+//
+//  Copyright (c) 2015 Foursquare. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+#import "FSQCellManifestChunkedArray.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ The objects of a lazily created array, created a page at a time by a page provider block and kept in a least
+ recently used cache.
+ 
+ At most materializedObjectLimit objects are kept (rounded up to a whole page, and never less than the most recently
+ used page). Pages that were discarded are created again by calling the page provider if they are needed later.
+ 
+ The cache keeps weak references to the objects of discarded pages. If some of them are still in use elsewhere when
+ their page is needed again, those same objects are returned and only the rest come from the page provider, so an
+ index keeps returning the same object for as long as anything holds on to it.
+ 
+ A page cache is shared by an FSQCellManifestPagedArray and every array derived from it, so modifying the array does
+ not throw away pages that were already created.
+ 
+ This is an internal class and should not be used outside of the framework. It is not thread safe.
+ */
+@interface FSQCellManifestPageCache : NSObject
+
+/**
+ @param count        The total number of objects the page provider can create.
+ @param pageSize     The number of objects to ask the page provider for at once. Must be greater than 0.
+ @param pageProvider A block returning exactly range.length objects for the indexes in range.
+ */
+- (instancetype)initWithCount:(NSUInteger)count pageSize:(NSUInteger)pageSize pageProvider:(NSArray *(^)(NSRange range))pageProvider NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+@property (nonatomic, readonly) NSUInteger count;
+@property (nonatomic, readonly) NSUInteger pageSize;
+@property (nonatomic) NSUInteger materializedObjectLimit;
+
+/**
+ The number of objects currently kept in the cache.
+ */
+@property (nonatomic, readonly) NSUInteger materializedObjectCount;
+
+/**
+ @param index An index less than count.
+ @param range If not NULL, set to the range of indexes covered by the returned page.
+ 
+ @return The page containing index, created by the page provider if it is not already cached.
+ */
+- (NSArray *)pageContainingIndex:(NSUInteger)index range:(nullable NSRangePointer)range;
+
+/**
+ Throws away every cached page. Objects that are still in use elsewhere are returned again when their page is needed.
+ */
+- (void)discardAllPages;
+
+/**
+ Calls block with the objects in range that currently exist, in order, without creating any pages. These are the
+ objects of cached pages plus the objects of discarded pages that are still in use elsewhere.
+ */
+- (void)enumerateMaterializedObjectsInRange:(NSRange)range usingBlock:(void (^)(id object, NSUInteger index, BOOL *stop))block;
+
+@end
+
+/**
+ An immutable NSArray whose objects are created on demand by an FSQCellManifestPageCache.
+ 
+ The array is stored as a list of segments. Each segment is either a range of the page cache's objects or an array of
+ objects that were inserted into the array. Index lookups are O(log s) for s segments, plus the cost of creating the
+ page if it is not cached. Inserting, removing or replacing objects returns a new array sharing the page cache in
+ O(s) time without creating any pages. Fast enumeration hands out at most one page or inserted segment per call.
+ 
+ FSQVirtualSectionRecord uses this as its cell records.
+ 
+ This is an internal class and should not be used outside of the framework. It is not thread safe.
+ */
+@interface FSQCellManifestPagedArray<ObjectType> : NSArray<ObjectType> <FSQCellManifestPersistentArray>
+
+/**
+ @return A new array containing all of pageCache's objects in order.
+ */
+- (instancetype)initWithPageCache:(FSQCellManifestPageCache *)pageCache;
+
+/**
+ The cache this array's lazy objects come from. Nil if the array was created from objects instead.
+ */
+@property (nonatomic, readonly, nullable) FSQCellManifestPageCache *pageCache;
+
+/**
+ Calls block with every object of the array that currently exists, in order, without creating any pages. This is
+ every inserted object, plus the page cache objects reported by enumerateMaterializedObjectsInRange:usingBlock:.
+ */
+- (void)enumerateMaterializedObjectsUsingBlock:(void (^)(ObjectType object, NSUInteger index, BOOL *stop))block;
+
+/**
+ Calls block with each run of the array in order, without creating any pages. objects is the run's objects if they
+ were inserted into the array, otherwise nil, and the run is the page cache's objects starting at pageCacheIndex.
+ */
+- (void)enumerateRunsUsingBlock:(void (^)(NSRange range, NSArray<ObjectType> *_Nullable objects, NSUInteger pageCacheIndex, BOOL *stop))block;
+
+/**
+ Compares the arrays without creating any pages. Objects from the page cache are only considered equal to the objects
+ at the same index of the same page cache. They are never equal to inserted objects, even ones that would compare
+ equal once created, so this can return NO for arrays that isEqualToArray: considers equal.
+ */
+- (BOOL)isEqualToPagedArray:(FSQCellManifestPagedArray<ObjectType> *)otherArray;
+
+- (FSQCellManifestPagedArray<ObjectType> *)arrayByInsertingObjects:(NSArray<ObjectType> *)objects atIndex:(NSUInteger)index;
+- (FSQCellManifestPagedArray<ObjectType> *)arrayByRemovingObjectsAtIndexes:(NSIndexSet *)indexes;
+- (FSQCellManifestPagedArray<ObjectType> *)arrayByReplacingObjectAtIndex:(NSUInteger)index withObject:(ObjectType)object;
+
+@end
+
+NS_ASSUME_NONNULL_END
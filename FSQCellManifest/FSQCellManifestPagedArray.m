@@ -0,0 +1,544 @@
+//
+//  FSQCellManifestPagedArray.m
+//
+//  Copyright (c) 2015 Foursquare. All rights reserved.
+//
+
+#import "FSQCellManifestPagedArray.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Adjacent segments of inserted objects are merged as long as the result is no larger than this
+static const NSUInteger kFSQPagedArrayMergedSegmentCapacity = 64;
+
+// Discarded pages whose objects have all been deallocated are pruned once there are at least this many
+static const NSUInteger kFSQPageCacheMinimumDiscardedPagePruneCount = 16;
+
+@implementation FSQCellManifestPageCache {
+    NSArray *(^_pageProvider)(NSRange range);
+    NSMutableDictionary<NSNumber *, NSArray *> *_pagesByIndex;
+    // Least recently used first
+    NSMutableArray<NSNumber *> *_pageIndexesByUse;
+    NSArray *_Nullable _lastPage;
+    NSUInteger _lastPageIndex;
+    // Weak references to the objects of discarded pages, so that objects still in use elsewhere are handed out again
+    // instead of being replaced by new ones from the page provider
+    NSMutableDictionary<NSNumber *, NSPointerArray *> *_discardedPagesByIndex;
+    NSUInteger _discardedPagePruneCount;
+}
+
+- (instancetype)initWithCount:(NSUInteger)count pageSize:(NSUInteger)pageSize pageProvider:(NSArray *(^)(NSRange range))pageProvider {
+    NSParameterAssert(pageSize > 0);
+    NSParameterAssert(pageProvider);
+    
+    if ((self = [super init])) {
+        _count = count;
+        _pageSize = MAX(pageSize, (NSUInteger)1);
+        _pageProvider = [pageProvider copy];
+        _materializedObjectLimit = NSUIntegerMax;
+        _pagesByIndex = [NSMutableDictionary new];
+        _pageIndexesByUse = [NSMutableArray new];
+        _discardedPagesByIndex = [NSMutableDictionary new];
+        _discardedPagePruneCount = kFSQPageCacheMinimumDiscardedPagePruneCount;
+    }
+    return self;
+}
+
+- (void)setMaterializedObjectLimit:(NSUInteger)materializedObjectLimit {
+    _materializedObjectLimit = materializedObjectLimit;
+    [self discardPagesOverLimit];
+}
+
+- (NSArray *)pageContainingIndex:(NSUInteger)index range:(nullable NSRangePointer)range {
+    NSParameterAssert(index < _count);
+    
+    NSUInteger pageIndex = index / _pageSize;
+    NSUInteger pageStart = pageIndex * _pageSize;
+    NSRange pageRange = NSMakeRange(pageStart, MIN(_pageSize, _count - pageStart));
+    if (range) {
+        *range = pageRange;
+    }
+    
+    // Consecutive lookups almost always land on the same page, which is already the most recently used one
+    if (_lastPage && pageIndex == _lastPageIndex) {
+        return _lastPage;
+    }
+    
+    NSNumber *key = @(pageIndex);
+    NSArray *page = _pagesByIndex[key];
+    if (page) {
+        [_pageIndexesByUse removeObject:key];
+    }
+    else {
+        page = [self createPageWithKey:key range:pageRange];
+        _pagesByIndex[key] = page;
+        _materializedObjectCount += pageRange.length;
+    }
+    
+    [_pageIndexesByUse addObject:key];
+    _lastPage = page;
+    _lastPageIndex = pageIndex;
+    
+    [self discardPagesOverLimit];
+    
+    return page;
+}
+
+- (NSArray *)createPageWithKey:(NSNumber *)key range:(NSRange)pageRange {
+    NSPointerArray *discardedPage = _discardedPagesByIndex[key];
+    if (discardedPage) {
+        [_discardedPagesByIndex removeObjectForKey:key];
+        
+        // allObjects leaves out the objects that have been deallocated
+        NSArray *survivingObjects = [discardedPage allObjects];
+        if ([survivingObjects count] == pageRange.length) {
+            return survivingObjects;
+        }
+    }
+    
+    NSArray *page = [_pageProvider(pageRange) copy];
+    if ([page count] != pageRange.length) {
+        @throw [NSException exceptionWithName:NSInternalInconsistencyException
+                                       reason:[NSString stringWithFormat:@"Page provider returned %lu objects for range %@", (unsigned long)[page count], NSStringFromRange(pageRange)]
+                                     userInfo:nil];
+    }
+    
+    if (discardedPage) {
+        // Objects that are still alive keep their identity, only the deallocated ones are replaced
+        NSMutableArray *mergedPage = [page mutableCopy];
+        for (NSUInteger offset = 0; offset < pageRange.length; ++offset) {
+            id survivingObject = (__bridge id)[discardedPage pointerAtIndex:offset];
+            if (survivingObject) {
+                mergedPage[offset] = survivingObject;
+            }
+        }
+        page = [mergedPage copy];
+    }
+    
+    return page;
+}
+
+- (void)discardPageWithKey:(NSNumber *)key {
+    NSArray *page = _pagesByIndex[key];
+    _materializedObjectCount -= [page count];
+    [_pagesByIndex removeObjectForKey:key];
+    
+    NSPointerArray *discardedPage = [NSPointerArray weakObjectsPointerArray];
+    for (id object in page) {
+        [discardedPage addPointer:(__bridge void *)object];
+    }
+    _discardedPagesByIndex[key] = discardedPage;
+}
+
+- (void)pruneDiscardedPagesIfNeeded {
+    if ([_discardedPagesByIndex count] < _discardedPagePruneCount) {
+        return;
+    }
+    
+    NSMutableArray<NSNumber *> *deadKeys = [NSMutableArray new];
+    [_discardedPagesByIndex enumerateKeysAndObjectsUsingBlock:^(NSNumber *key, NSPointerArray *discardedPage, BOOL *stop) {
+        if ([[discardedPage allObjects] count] == 0) {
+            [deadKeys addObject:key];
+        }
+    }];
+    [_discardedPagesByIndex removeObjectsForKeys:deadKeys];
+    
+    // Only prune again once the number of discarded pages has doubled, so pruning is amortized constant time
+    _discardedPagePruneCount = MAX(kFSQPageCacheMinimumDiscardedPagePruneCount, [_discardedPagesByIndex count] * 2);
+}
+
+- (void)discardPagesOverLimit {
+    // The most recently used page is always kept, so that it can still be returned
+    while (_materializedObjectCount > _materializedObjectLimit
+           && [_pageIndexesByUse count] > 1) {
+        [self discardPageWithKey:_pageIndexesByUse[0]];
+        [_pageIndexesByUse removeObjectAtIndex:0];
+    }
+    
+    [self pruneDiscardedPagesIfNeeded];
+}
+
+- (void)discardAllPages {
+    for (NSNumber *key in [_pagesByIndex allKeys]) {
+        [self discardPageWithKey:key];
+    }
+    [_pageIndexesByUse removeAllObjects];
+    _lastPage = nil;
+    
+    [self pruneDiscardedPagesIfNeeded];
+}
+
+- (void)enumerateMaterializedObjectsInRange:(NSRange)range usingBlock:(void (^)(id object, NSUInteger index, BOOL *stop))block {
+    if (range.length == 0) {
+        return;
+    }
+    
+    // Only the pages that were created are visited, in order, however large the range is
+    NSMutableSet<NSNumber *> *keys = [NSMutableSet setWithArray:[_pagesByIndex allKeys]];
+    [keys addObjectsFromArray:[_discardedPagesByIndex allKeys]];
+    NSArray<NSNumber *> *sortedKeys = [[keys allObjects] sortedArrayUsingSelector:@selector(compare:)];
+    
+    BOOL stop = NO;
+    for (NSNumber *key in sortedKeys) {
+        NSUInteger pageStart = [key unsignedIntegerValue] * _pageSize;
+        NSRange pageRange = NSMakeRange(pageStart, MIN(_pageSize, _count - pageStart));
+        NSRange overlap = NSIntersectionRange(range, pageRange);
+        if (overlap.length == 0) {
+            continue;
+        }
+        
+        NSArray *page = _pagesByIndex[key];
+        NSPointerArray *discardedPage = (page ? nil : _discardedPagesByIndex[key]);
+        for (NSUInteger index = overlap.location; index < NSMaxRange(overlap) && !stop; ++index) {
+            id object = (page ? page[index - pageStart] : (__bridge id)[discardedPage pointerAtIndex:(index - pageStart)]);
+            if (object) {
+                block(object, index, &stop);
+            }
+        }
+        
+        if (stop) {
+            break;
+        }
+    }
+}
+
+@end
+
+/**
+ A run of the array's objects. Either the page cache's objects from _location to _location + _length, or _objects.
+ Segments are never modified after they are created, which is what allows arrays to share them.
+ */
+@interface FSQPagedArraySegment : NSObject {
+    @public
+    NSUInteger _location;
+    NSUInteger _length;
+    NSArray *_Nullable _objects;
+}
+@end
+
+@implementation FSQPagedArraySegment
+@end
+
+static FSQPagedArraySegment *FSQPagedArrayLazySegment(NSUInteger location, NSUInteger length) {
+    FSQPagedArraySegment *segment = [FSQPagedArraySegment new];
+    segment->_location = location;
+    segment->_length = length;
+    return segment;
+}
+
+static FSQPagedArraySegment *FSQPagedArrayObjectSegment(NSArray *objects) {
+    FSQPagedArraySegment *segment = [FSQPagedArraySegment new];
+    segment->_objects = [objects copy];
+    segment->_length = [objects count];
+    return segment;
+}
+
+static FSQPagedArraySegment *FSQPagedArraySubsegment(FSQPagedArraySegment *segment, NSRange range) {
+    if (range.location == 0 && range.length == segment->_length) {
+        return segment;
+    }
+    else if (segment->_objects) {
+        return FSQPagedArrayObjectSegment([segment->_objects subarrayWithRange:range]);
+    }
+    else {
+        return FSQPagedArrayLazySegment(segment->_location + range.location, range.length);
+    }
+}
+
+/**
+ Appends segment, merging it into the last segment if both are contiguous runs of the page cache, or if both are
+ small runs of inserted objects.
+ */
+static void FSQPagedArrayAppendSegment(NSMutableArray<FSQPagedArraySegment *> *segments, FSQPagedArraySegment *segment) {
+    if (segment->_length == 0) {
+        return;
+    }
+    
+    FSQPagedArraySegment *lastSegment = [segments lastObject];
+    if (lastSegment
+        && !lastSegment->_objects
+        && !segment->_objects
+        && lastSegment->_location + lastSegment->_length == segment->_location) {
+        segments[[segments count] - 1] = FSQPagedArrayLazySegment(lastSegment->_location, lastSegment->_length + segment->_length);
+    }
+    else if (lastSegment
+             && lastSegment->_objects
+             && segment->_objects
+             && lastSegment->_length + segment->_length <= kFSQPagedArrayMergedSegmentCapacity) {
+        segments[[segments count] - 1] = FSQPagedArrayObjectSegment([lastSegment->_objects arrayByAddingObjectsFromArray:segment->_objects]);
+    }
+    else {
+        [segments addObject:segment];
+    }
+}
+
+/**
+ Binary search for the last segment that starts at or before index.
+ */
+static NSUInteger FSQPagedArraySegmentIndex(const NSUInteger *segmentStarts, NSUInteger segmentCount, NSUInteger index) {
+    NSUInteger low = 0;
+    NSUInteger high = segmentCount;
+    while (high - low > 1) {
+        NSUInteger middle = low + (high - low) / 2;
+        if (segmentStarts[middle] <= index) {
+            low = middle;
+        }
+        else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+@implementation FSQCellManifestPagedArray {
+    NSArray<FSQPagedArraySegment *> *_segments;
+    // _segmentStarts[i] is the index of the first object of _segments[i]
+    NSUInteger *_segmentStarts;
+    NSUInteger _count;
+}
+
+- (instancetype)init {
+    return [self initWithPageCache:nil segments:@[]];
+}
+
+- (instancetype)initWithObjects:(const id _Nonnull [_Nullable])objects count:(NSUInteger)count {
+    NSMutableArray<FSQPagedArraySegment *> *segments = [NSMutableArray new];
+    FSQPagedArrayAppendSegment(segments, FSQPagedArrayObjectSegment([[NSArray alloc] initWithObjects:objects count:count]));
+    return [self initWithPageCache:nil segments:segments];
+}
+
+- (instancetype)initWithPageCache:(FSQCellManifestPageCache *)pageCache {
+    NSArray<FSQPagedArraySegment *> *segments = (pageCache.count > 0 ? @[FSQPagedArrayLazySegment(0, pageCache.count)] : @[]);
+    return [self initWithPageCache:pageCache segments:segments];
+}
+
+- (instancetype)initWithPageCache:(nullable FSQCellManifestPageCache *)pageCache segments:(NSArray<FSQPagedArraySegment *> *)segments {
+    if ((self = [super init])) {
+        _pageCache = pageCache;
+        _segments = [segments copy];
+        
+        NSUInteger segmentCount = [_segments count];
+        _segmentStarts = malloc(MAX(segmentCount, (NSUInteger)1) * sizeof(NSUInteger));
+        for (NSUInteger segmentIndex = 0; segmentIndex < segmentCount; ++segmentIndex) {
+            _segmentStarts[segmentIndex] = _count;
+            _count += _segments[segmentIndex]->_length;
+        }
+    }
+    return self;
+}
+
+- (void)dealloc {
+    free(_segmentStarts);
+}
+
+- (NSUInteger)count {
+    return _count;
+}
+
+- (id)objectAtIndex:(NSUInteger)index {
+    if (index >= _count) {
+        @throw [NSException exceptionWithName:NSRangeException
+                                       reason:[NSString stringWithFormat:@"Index %lu beyond bounds of FSQCellManifestPagedArray of count %lu", (unsigned long)index, (unsigned long)_count]
+                                     userInfo:nil];
+    }
+    
+    NSUInteger segmentIndex = FSQPagedArraySegmentIndex(_segmentStarts, [_segments count], index);
+    FSQPagedArraySegment *segment = _segments[segmentIndex];
+    NSUInteger offset = index - _segmentStarts[segmentIndex];
+    
+    if (segment->_objects) {
+        return segment->_objects[offset];
+    }
+    else {
+        NSUInteger cacheIndex = segment->_location + offset;
+        NSRange pageRange;
+        NSArray *page = [_pageCache pageContainingIndex:cacheIndex range:&pageRange];
+        return page[cacheIndex - pageRange.location];
+    }
+}
+
+- (NSUInteger)countByEnumeratingWithState:(NSFastEnumerationState *)state objects:(id __unsafe_unretained [])buffer count:(NSUInteger)len {
+    NSUInteger index = state->state;
+    if (index >= _count || len == 0) {
+        return 0;
+    }
+    
+    // Immutable, so the mutation pointer only needs to point at something that never changes
+    state->mutationsPtr = &state->extra[0];
+    
+    NSUInteger segmentIndex = FSQPagedArraySegmentIndex(_segmentStarts, [_segments count], index);
+    FSQPagedArraySegment *segment = _segments[segmentIndex];
+    NSUInteger offset = index - _segmentStarts[segmentIndex];
+    NSUInteger length = MIN(len, segment->_length - offset);
+    
+    if (segment->_objects) {
+        [segment->_objects getObjects:buffer range:NSMakeRange(offset, length)];
+    }
+    else {
+        NSUInteger cacheIndex = segment->_location + offset;
+        NSRange pageRange;
+        
+        // The buffer does not retain its objects, so keep the page alive until the enumerating code's autorelease
+        // pool drains, even if later pages push it out of the cache
+        __autoreleasing NSArray *page = [_pageCache pageContainingIndex:cacheIndex range:&pageRange];
+        length = MIN(length, NSMaxRange(pageRange) - cacheIndex);
+        [page getObjects:buffer range:NSMakeRange(cacheIndex - pageRange.location, length)];
+    }
+    
+    state->itemsPtr = buffer;
+    state->state = index + length;
+    return length;
+}
+
+- (id)copyWithZone:(nullable NSZone *)zone {
+    return self;
+}
+
+- (Class)classForCoder {
+    return [NSArray class];
+}
+
+- (void)enumerateRunsUsingBlock:(void (^)(NSRange range, NSArray *_Nullable objects, NSUInteger pageCacheIndex, BOOL *stop))block {
+    BOOL stop = NO;
+    NSUInteger segmentCount = [_segments count];
+    for (NSUInteger segmentIndex = 0; segmentIndex < segmentCount && !stop; ++segmentIndex) {
+        FSQPagedArraySegment *segment = _segments[segmentIndex];
+        block(NSMakeRange(_segmentStarts[segmentIndex], segment->_length), segment->_objects, segment->_location, &stop);
+    }
+}
+
+- (void)enumerateMaterializedObjectsUsingBlock:(void (^)(id object, NSUInteger index, BOOL *stop))block {
+    __block BOOL stopped = NO;
+    [self enumerateRunsUsingBlock:^(NSRange range, NSArray *_Nullable objects, NSUInteger pageCacheIndex, BOOL *stopRuns) {
+        if (objects) {
+            [objects enumerateObjectsUsingBlock:^(id object, NSUInteger offset, BOOL *stopObjects) {
+                block(object, range.location + offset, &stopped);
+                *stopObjects = stopped;
+            }];
+        }
+        else {
+            [self->_pageCache enumerateMaterializedObjectsInRange:NSMakeRange(pageCacheIndex, range.length) usingBlock:^(id object, NSUInteger index, BOOL *stopObjects) {
+                block(object, range.location + (index - pageCacheIndex), &stopped);
+                *stopObjects = stopped;
+            }];
+        }
+        *stopRuns = stopped;
+    }];
+}
+
+- (BOOL)isEqualToPagedArray:(FSQCellManifestPagedArray *)otherArray {
+    if (self == otherArray) {
+        return YES;
+    }
+    
+    if (_count != otherArray->_count
+        || (_pageCache != otherArray->_pageCache && _pageCache && otherArray->_pageCache)) {
+        return NO;
+    }
+    
+    // Walk both segment lists together, comparing the overlapping parts of each pair of segments
+    NSUInteger segmentCount = [_segments count];
+    NSUInteger otherSegmentCount = [otherArray->_segments count];
+    NSUInteger segmentIndex = 0;
+    NSUInteger otherSegmentIndex = 0;
+    NSUInteger index = 0;
+    while (index < _count) {
+        if (segmentIndex >= segmentCount || otherSegmentIndex >= otherSegmentCount) {
+            return NO;
+        }
+        
+        FSQPagedArraySegment *segment = _segments[segmentIndex];
+        FSQPagedArraySegment *otherSegment = otherArray->_segments[otherSegmentIndex];
+        NSUInteger offset = index - _segmentStarts[segmentIndex];
+        NSUInteger otherOffset = index - otherArray->_segmentStarts[otherSegmentIndex];
+        NSUInteger length = MIN(segment->_length - offset, otherSegment->_length - otherOffset);
+        
+        if (segment->_objects && otherSegment->_objects) {
+            NSArray *objects = [segment->_objects subarrayWithRange:NSMakeRange(offset, length)];
+            NSArray *otherObjects = [otherSegment->_objects subarrayWithRange:NSMakeRange(otherOffset, length)];
+            if (![objects isEqualToArray:otherObjects]) {
+                return NO;
+            }
+        }
+        else if (segment->_objects || otherSegment->_objects
+                 || segment->_location + offset != otherSegment->_location + otherOffset) {
+            return NO;
+        }
+        
+        index += length;
+        if (offset + length == segment->_length) {
+            ++segmentIndex;
+        }
+        if (otherOffset + length == otherSegment->_length) {
+            ++otherSegmentIndex;
+        }
+    }
+    
+    return YES;
+}
+
+- (void)appendSegmentsInRange:(NSRange)range toSegments:(NSMutableArray<FSQPagedArraySegment *> *)segments {
+    if (range.length == 0) {
+        return;
+    }
+    
+    NSUInteger segmentCount = [_segments count];
+    for (NSUInteger segmentIndex = FSQPagedArraySegmentIndex(_segmentStarts, segmentCount, range.location); segmentIndex < segmentCount; ++segmentIndex) {
+        NSUInteger segmentStart = _segmentStarts[segmentIndex];
+        if (segmentStart >= NSMaxRange(range)) {
+            break;
+        }
+        
+        FSQPagedArraySegment *segment = _segments[segmentIndex];
+        NSRange overlap = NSIntersectionRange(range, NSMakeRange(segmentStart, segment->_length));
+        FSQPagedArrayAppendSegment(segments, FSQPagedArraySubsegment(segment, NSMakeRange(overlap.location - segmentStart, overlap.length)));
+    }
+}
+
+- (FSQCellManifestPagedArray *)arrayByInsertingObjects:(NSArray *)objects atIndex:(NSUInteger)index {
+    NSParameterAssert(index <= _count);
+    
+    if ([objects count] == 0) {
+        return self;
+    }
+    
+    NSMutableArray<FSQPagedArraySegment *> *segments = [NSMutableArray new];
+    [self appendSegmentsInRange:NSMakeRange(0, index) toSegments:segments];
+    FSQPagedArrayAppendSegment(segments, FSQPagedArrayObjectSegment(objects));
+    [self appendSegmentsInRange:NSMakeRange(index, _count - index) toSegments:segments];
+    
+    return [[[self class] alloc] initWithPageCache:_pageCache segments:segments];
+}
+
+- (FSQCellManifestPagedArray *)arrayByRemovingObjectsAtIndexes:(NSIndexSet *)indexes {
+    NSParameterAssert([indexes count] == 0 || [indexes lastIndex] < _count);
+    
+    if ([indexes count] == 0) {
+        return self;
+    }
+    
+    NSMutableIndexSet *keptIndexes = [NSMutableIndexSet indexSetWithIndexesInRange:NSMakeRange(0, _count)];
+    [keptIndexes removeIndexes:indexes];
+    
+    NSMutableArray<FSQPagedArraySegment *> *segments = [NSMutableArray new];
+    [keptIndexes enumerateRangesUsingBlock:^(NSRange range, BOOL *stop) {
+        [self appendSegmentsInRange:range toSegments:segments];
+    }];
+    
+    return [[[self class] alloc] initWithPageCache:_pageCache segments:segments];
+}
+
+- (FSQCellManifestPagedArray *)arrayByReplacingObjectAtIndex:(NSUInteger)index withObject:(id)object {
+    NSParameterAssert(index < _count);
+    
+    NSMutableArray<FSQPagedArraySegment *> *segments = [NSMutableArray new];
+    [self appendSegmentsInRange:NSMakeRange(0, index) toSegments:segments];
+    FSQPagedArrayAppendSegment(segments, FSQPagedArrayObjectSegment(@[object]));
+    [self appendSegmentsInRange:NSMakeRange(index + 1, _count - index - 1) toSegments:segments];
+    
+    return [[[self class] alloc] initWithPageCache:_pageCache segments:segments];
+}
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,105 @@
+//
+//  FSQCellManifestPaginationPlugin.h
+//
+//  Copyright (c) 2015 Foursquare. All rights reserved.
+//
+
+@import UIKit;
+
+#import "FSQCellManifestProtocols.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class FSQCellManifestPaginationPlugin;
+
+/**
+ Call this exactly once when a page has finished loading. It may be called from any thread.
+ 
+ @param cellRecords  The records of the new page, to be appended to the end of the plugin's section. Pass nil or an
+                     empty array if the load failed or returned nothing.
+ @param hasMorePages Pass NO once there is nothing left to load. If you pass YES, the plugin checks the threshold
+                     again as soon as the managed view has laid out the new records, and loads another page straight
+                     away if it is still crossed, even if this page was empty. If the load failed, only call
+                     completion once you are ready for the next attempt, or pass NO and call reset later.
+ */
+typedef void (^FSQCellManifestPaginationCompletion)(NSArray<FSQCellRecord *> *_Nullable cellRecords, BOOL hasMorePages);
+
+/**
+ Called on the main thread to start loading the next page. Call completion when it is done.
+ */
+typedef void (^FSQCellManifestPaginationLoader)(FSQCellManifestPaginationPlugin *plugin, FSQCellManifestPaginationCompletion completion);
+
+/**
+ A manifest plugin that implements "load more when near the bottom" for one section of the manifest.
+ 
+ Whenever the managed view scrolls or its records are replaced or reloaded, the plugin counts how many records are
+ left between the last visible row or item and the end of its section. Once that is no more than
+ remainingRecordThreshold, it calls its loader block. Only one load is in flight at a time, so crossing the threshold
+ again while a page is loading does nothing.
+ 
+ When a load completes, its records are appended to the end of the section with a single insertCellRecords:atIndexPath:
+ call. This costs time proportional to the size of the page rather than the size of the section, as the section
+ record does not copy its existing records (see FSQSectionRecord).
+ 
+ If the plugin's section has no records and nothing is visible, the first page is loaded straight away.
+ 
+ A pagination plugin can only be attached to one manifest at a time. It only reads and modifies the manifest on the
+ main thread.
+ */
+@interface FSQCellManifestPaginationPlugin : NSObject <FSQCellManifestPlugin, FSQCellManifestRecordModificationDelegate, UIScrollViewDelegate>
+
+/**
+ @param sectionIndex             The index of the section that pages are appended to.
+ @param remainingRecordThreshold How few records may be left below the visible ones before the next page is loaded.
+ @param loader                   The block that loads each page.
+ 
+ @return A new pagination plugin.
+ */
+- (instancetype)initWithSectionIndex:(NSInteger)sectionIndex
+            remainingRecordThreshold:(NSUInteger)remainingRecordThreshold
+                              loader:(FSQCellManifestPaginationLoader)loader NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ The index of the section that pages are appended to.
+ 
+ This is updated when sections are inserted, moved or removed through the manifest, including by
+ setSectionRecords:animated: and transactions. It is kept as it is when every section is replaced without animation.
+ If the section is removed this becomes NSNotFound, and nothing is loaded until it is set again.
+ */
+@property (nonatomic) NSInteger sectionIndex;
+
+/**
+ How few records may be left below the visible ones before the next page is loaded.
+ */
+@property (nonatomic) NSUInteger remainingRecordThreshold;
+
+/**
+ YES until a load completes with hasMorePages set to NO.
+ */
+@property (nonatomic, readonly) BOOL hasMorePages;
+
+/**
+ YES while the loader has been called and its completion has not.
+ */
+@property (nonatomic, readonly, getter=isLoading) BOOL loading;
+
+/**
+ Load the next page now if the threshold has been crossed and no page is already loading.
+ 
+ The plugin calls this itself when the managed view scrolls and when the manifest's records are replaced or
+ reloaded, so you should only need it after changing the section in some other way.
+ */
+- (void)loadNextPageIfNeeded;
+
+/**
+ Start over, for example after replacing the manifest's records with a fresh first page.
+ 
+ Sets hasMorePages back to YES. The results of a load that is still in flight are ignored when they arrive.
+ */
+- (void)reset;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,330 @@
+//
+//  FSQCellManifestPaginationPlugin.m
+//
+//  Copyright (c) 2015 Foursquare. All rights reserved.
+//
+
+#import "FSQCellManifestPaginationPlugin.h"
+
+#import "FSQCellManifest.h"
+#import "FSQCellManifestChangeset.h"
+#import "FSQCellManifestIndexPaths.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ The index a section ends up at after sections are deleted, inserted and moved, or NSNotFound if it is deleted.
+ 
+ As in a changeset, deleted and initial indexes are those from before the change, and inserted and target indexes
+ are those from after it.
+ */
+static NSInteger FSQPaginationSectionIndexAfterChanges(NSInteger sectionIndex,
+                                                      NSIndexSet *deletedIndexes,
+                                                      NSIndexSet *insertedIndexes,
+                                                      NSArray<NSNumber *> *movedInitialIndexes,
+                                                      NSArray<NSNumber *> *movedTargetIndexes) {
+    if (sectionIndex < 0 || sectionIndex == NSNotFound || [deletedIndexes containsIndex:(NSUInteger)sectionIndex]) {
+        return NSNotFound;
+    }
+    
+    NSUInteger moveIndex = [movedInitialIndexes indexOfObject:@(sectionIndex)];
+    if (moveIndex != NSNotFound) {
+        return [movedTargetIndexes[moveIndex] integerValue];
+    }
+    
+    // Every other section keeps its order relative to the sections that are not deleted, inserted or moved
+    NSRange sectionsBefore = NSMakeRange(0, (NSUInteger)sectionIndex);
+    NSUInteger rank = (NSUInteger)sectionIndex - [deletedIndexes countOfIndexesInRange:sectionsBefore];
+    NSMutableIndexSet *skippedTargetIndexes = [insertedIndexes mutableCopy];
+    for (NSUInteger i = 0; i < [movedInitialIndexes count]; ++i) {
+        if ([movedInitialIndexes[i] integerValue] < sectionIndex) {
+            --rank;
+        }
+        [skippedTargetIndexes addIndex:[movedTargetIndexes[i] unsignedIntegerValue]];
+    }
+    
+    NSUInteger newIndex = 0;
+    while (rank > 0 || [skippedTargetIndexes containsIndex:newIndex]) {
+        if (![skippedTargetIndexes containsIndex:newIndex]) {
+            --rank;
+        }
+        ++newIndex;
+    }
+    return (NSInteger)newIndex;
+}
+
+@implementation FSQCellManifestPaginationPlugin {
+    FSQCellManifestPaginationLoader _loader;
+    __weak FSQCellManifest *_manifest;
+    // Incremented by reset, so that loads started before it are ignored when they complete
+    NSUInteger _generation;
+    BOOL _thresholdCheckScheduled;
+    
+    // Section changes reported since the last will callback. All the did callbacks of setSectionRecords:animated:
+    // describe one change relative to the sections before and after it, so they are applied together, either before
+    // the next change starts or when the section index is next needed.
+    NSMutableIndexSet *_pendingDeletedSectionIndexes;
+    NSMutableIndexSet *_pendingInsertedSectionIndexes;
+    NSMutableArray<NSNumber *> *_pendingMovedSectionInitialIndexes;
+    NSMutableArray<NSNumber *> *_pendingMovedSectionTargetIndexes;
+}
+
+- (instancetype)initWithSectionIndex:(NSInteger)sectionIndex
+            remainingRecordThreshold:(NSUInteger)remainingRecordThreshold
+                              loader:(FSQCellManifestPaginationLoader)loader {
+    NSParameterAssert(loader);
+    
+    if ((self = [super init])) {
+        _sectionIndex = sectionIndex;
+        _remainingRecordThreshold = remainingRecordThreshold;
+        _loader = [loader copy];
+        _hasMorePages = YES;
+        _pendingDeletedSectionIndexes = [NSMutableIndexSet new];
+        _pendingInsertedSectionIndexes = [NSMutableIndexSet new];
+        _pendingMovedSectionInitialIndexes = [NSMutableArray new];
+        _pendingMovedSectionTargetIndexes = [NSMutableArray new];
+    }
+    return self;
+}
+
+- (NSInteger)sectionIndex {
+    [self applyPendingSectionChanges];
+    return _sectionIndex;
+}
+
+- (void)setSectionIndex:(NSInteger)sectionIndex {
+    [self discardPendingSectionChanges];
+    _sectionIndex = sectionIndex;
+    [self setNeedsThresholdCheck];
+}
+
+- (void)loadNextPageIfNeeded {
+    NSAssert([NSThread isMainThread], @"Pagination must be used from the main thread");
+    
+    FSQCellManifest *manifest = _manifest;
+    if (!manifest
+        || _loading
+        || !_hasMorePages
+        || ![self hasCrossedThresholdInManifest:manifest]) {
+        return;
+    }
+    
+    _loading = YES;
+    
+    NSUInteger generation = _generation;
+    __weak typeof(self) weakSelf = self;
+    _loader(self, ^(NSArray<FSQCellRecord *> *_Nullable cellRecords, BOOL hasMorePages) {
+        if ([NSThread isMainThread]) {
+            [weakSelf finishLoadWithGeneration:generation cellRecords:cellRecords hasMorePages:hasMorePages];
+        }
+        else {
+            dispatch_async(dispatch_get_main_queue(), ^{
+                [weakSelf finishLoadWithGeneration:generation cellRecords:cellRecords hasMorePages:hasMorePages];
+            });
+        }
+    });
+}
+
+- (BOOL)hasCrossedThresholdInManifest:(FSQCellManifest *)manifest {
+    [self applyPendingSectionChanges];
+    
+    if (_sectionIndex < 0
+        || _sectionIndex >= [manifest numberOfSectionRecords]) {
+        return NO;
+    }
+    
+    NSIndexPath *lastVisibleIndexPath = nil;
+    for (NSIndexPath *indexPath in [manifest indexPathsForVisibleRecords]) {
+        if (!lastVisibleIndexPath || [indexPath compare:lastVisibleIndexPath] == NSOrderedDescending) {
+            lastVisibleIndexPath = indexPath;
+        }
+    }
+    
+    if (!lastVisibleIndexPath) {
+        // Nothing is on screen. Only an empty section needs a page before it can show anything.
+        return ([manifest numberOfCellRecordsInSectionAtIndex:_sectionIndex] == 0);
+    }
+    
+    NSInteger lastVisibleSection = FSQIndexPathSection(lastVisibleIndexPath);
+    if (lastVisibleSection > _sectionIndex) {
+        return YES;
+    }
+    
+    // Records after the last visible one, up to the end of the plugin's section
+    NSInteger remainingRecordCount = -(FSQIndexPathRowOrItem(lastVisibleIndexPath) + 1);
+    for (NSInteger section = lastVisibleSection; section <= _sectionIndex; ++section) {
+        remainingRecordCount += [manifest numberOfCellRecordsInSectionAtIndex:section];
+    }
+    
+    return (remainingRecordCount <= (NSInteger)_remainingRecordThreshold);
+}
+
+- (void)finishLoadWithGeneration:(NSUInteger)generation cellRecords:(nullable NSArray<FSQCellRecord *> *)cellRecords hasMorePages:(BOOL)hasMorePages {
+    if (generation != _generation) {
+        return;
+    }
+    
+    _loading = NO;
+    _hasMorePages = hasMorePages;
+    
+    [self applyPendingSectionChanges];
+    
+    FSQCellManifest *manifest = _manifest;
+    if ([cellRecords count] > 0
+        && manifest
+        && _sectionIndex >= 0
+        && _sectionIndex < [manifest numberOfSectionRecords]) {
+        NSInteger index = [manifest numberOfCellRecordsInSectionAtIndex:_sectionIndex];
+        [manifest insertCellRecords:cellRecords atIndexPath:FSQIndexPathMake(_sectionIndex, index)];
+    }
+    
+    // A short or empty page can leave the visible records within the threshold
+    [self setNeedsThresholdCheck];
+}
+
+- (void)reset {
+    ++_generation;
+    _loading = NO;
+    _hasMorePages = YES;
+    
+    [self setNeedsThresholdCheck];
+}
+
+- (void)setNeedsThresholdCheck {
+    if (_thresholdCheckScheduled) {
+        return;
+    }
+    
+    _thresholdCheckScheduled = YES;
+    
+    // Give the managed view a chance to lay out its new records first, so that its visible rows are up to date
+    __weak typeof(self) weakSelf = self;
+    dispatch_async(dispatch_get_main_queue(), ^{
+        [weakSelf performThresholdCheck];
+    });
+}
+
+- (void)performThresholdCheck {
+    _thresholdCheckScheduled = NO;
+    [self loadNextPageIfNeeded];
+}
+
+#pragma mark - Section Index Tracking
+
+- (void)applyPendingSectionChanges {
+    if ([_pendingDeletedSectionIndexes count] == 0
+        && [_pendingInsertedSectionIndexes count] == 0
+        && [_pendingMovedSectionInitialIndexes count] == 0) {
+        return;
+    }
+    
+    _sectionIndex = FSQPaginationSectionIndexAfterChanges(_sectionIndex,
+                                                          _pendingDeletedSectionIndexes,
+                                                          _pendingInsertedSectionIndexes,
+                                                          _pendingMovedSectionInitialIndexes,
+                                                          _pendingMovedSectionTargetIndexes);
+    [self discardPendingSectionChanges];
+}
+
+- (void)discardPendingSectionChanges {
+    [_pendingDeletedSectionIndexes removeAllIndexes];
+    [_pendingInsertedSectionIndexes removeAllIndexes];
+    [_pendingMovedSectionInitialIndexes removeAllObjects];
+    [_pendingMovedSectionTargetIndexes removeAllObjects];
+}
+
+#pragma mark - FSQCellManifestPlugin
+
+- (void)wasAttachedToManifest:(FSQCellManifest *)manifest {
+    NSAssert(!_manifest || _manifest == manifest, @"A pagination plugin can only be attached to one manifest at a time");
+    
+    _manifest = manifest;
+    [self setNeedsThresholdCheck];
+}
+
+- (void)wasRemovedFromManifest:(FSQCellManifest *)manifest {
+    if (_manifest != manifest) {
+        return;
+    }
+    
+    _manifest = nil;
+    [self applyPendingSectionChanges];
+    ++_generation;
+    _loading = NO;
+}
+
+- (void)manifest:(FSQCellManifest *)manifest managedViewDidChange:(UIScrollView *)newManagedView oldView:(UIScrollView *)oldManagedView {
+    [self setNeedsThresholdCheck];
+}
+
+#pragma mark - FSQCellManifestRecordModificationDelegate
+
+// Replacing every section keeps the section index as it is
+
+- (void)manifest:(FSQCellManifest *)manifest willReplaceSectionRecords:(NSArray<FSQSectionRecord *> *)currentSectionRecords withRecords:(NSArray<FSQSectionRecord *> *)newSectionRecords {
+    [self applyPendingSectionChanges];
+}
+
+- (void)manifest:(FSQCellManifest *)manifest didReplaceSectionRecords:(NSArray<FSQSectionRecord *> *)oldSectionRecords withRecords:(NSArray<FSQSectionRecord *> *)currentSectionRecords {
+    [self setNeedsThresholdCheck];
+}
+
+- (void)manifestDidReloadManagedView:(FSQCellManifest *)manifest {
+    [self setNeedsThresholdCheck];
+}
+
+- (void)manifest:(FSQCellManifest *)manifest willInsertSectionRecords:(NSArray<FSQSectionRecord *> *)sectionRecords atIndex:(NSInteger)index {
+    [self applyPendingSectionChanges];
+}
+
+- (void)manifest:(FSQCellManifest *)manifest didInsertSectionRecords:(NSArray<FSQSectionRecord *> *)sectionRecords atIndexes:(NSIndexSet *)indexes {
+    [_pendingInsertedSectionIndexes addIndexes:indexes];
+}
+
+- (void)manifest:(FSQCellManifest *)manifest willRemoveSectionRecordsAtIndexes:(NSIndexSet *)indexes {
+    [self applyPendingSectionChanges];
+}
+
+- (void)manifest:(FSQCellManifest *)manifest didRemoveSectionRecordsAtIndexes:(NSIndexSet *)indexes {
+    [_pendingDeletedSectionIndexes addIndexes:indexes];
+}
+
+- (void)manifest:(FSQCellManifest *)manifest willRemoveCellRecordsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths removingEmptySections:(BOOL)willRemoveEmptySections {
+    [self applyPendingSectionChanges];
+}
+
+- (void)manifest:(FSQCellManifest *)manifest didRemoveCellRecordsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths removedEmptySectionsAtIndexes:(NSIndexSet *)removedSections {
+    [_pendingDeletedSectionIndexes addIndexes:removedSections];
+}
+
+- (void)manifest:(FSQCellManifest *)manifest willMoveSectionRecordAtIndex:(NSInteger)initialIndex toIndex:(NSInteger)targetIndex {
+    [self applyPendingSectionChanges];
+}
+
+- (void)manifest:(FSQCellManifest *)manifest didMoveSectionRecordAtIndex:(NSInteger)initialIndex toIndex:(NSInteger)targetIndex {
+    [_pendingMovedSectionInitialIndexes addObject:@(initialIndex)];
+    [_pendingMovedSectionTargetIndexes addObject:@(targetIndex)];
+}
+
+- (void)manifest:(FSQCellManifest *)manifest willCommitTransactionWithChangeset:(FSQCellManifestChangeset *)changeset {
+    [self applyPendingSectionChanges];
+}
+
+- (void)manifest:(FSQCellManifest *)manifest didCommitTransactionWithChangeset:(FSQCellManifestChangeset *)changeset {
+    _sectionIndex = FSQPaginationSectionIndexAfterChanges(_sectionIndex,
+                                                          changeset.deletedSectionIndexes,
+                                                          changeset.insertedSectionIndexes,
+                                                          changeset.movedSectionInitialIndexes,
+                                                          changeset.movedSectionTargetIndexes);
+    [self setNeedsThresholdCheck];
+}
+
+#pragma mark - UIScrollViewDelegate
+
+- (void)scrollViewDidScroll:(UIScrollView *)scrollView {
+    [self loadNextPageIfNeeded];
+}
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,70 @@
+//
+//  FSQCellManifestProfilerPlugin.h
+//
+//  Copyright (c) 2015 Foursquare. All rights reserved.
+//
+
+@import UIKit;
+
+#import "FSQCellManifestProtocols.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ A manifest plugin that records how long the manifest's hot paths take, so that you can tell whether slow scrolling
+ comes from sizing, dequeueing or configuring cells.
+ 
+ Every FSQCellManifestProfilingEvent reported by the manifests this plugin is attached to is added to a histogram
+ for the record's cell class, as well as to a histogram of totals for all cell classes. Histograms use logarithmic
+ buckets (four per doubling, from one microsecond to about 16 seconds), so percentiles are accurate to within about
+ 20% no matter how many events are recorded, and recording an event never allocates memory after the first event
+ for a cell class.
+ 
+ When no profiler plugin (or other FSQCellManifestProfilingDelegate) is attached, the manifest does not read the
+ clock at all.
+ 
+ This class is not thread safe. It should only be used from the main thread, which is where manifests report events.
+ */
+@interface FSQCellManifestProfilerPlugin : NSObject <FSQCellManifestPlugin, FSQCellManifestProfilingDelegate>
+
+/**
+ @param event     The event to look up.
+ @param cellClass The cell class to look up, or nil for the totals of all cell classes.
+ 
+ @return The number of times event was recorded.
+ */
+- (NSUInteger)countForEvent:(FSQCellManifestProfilingEvent)event cellClass:(nullable Class)cellClass;
+
+/**
+ @param percentile A percentile between 0 and 100.
+ @param event      The event to look up.
+ @param cellClass  The cell class to look up, or nil for the totals of all cell classes.
+ 
+ @return The duration in seconds that percentile of the recorded events took no longer than, rounded up to the
+ nearest histogram bucket. 0 if nothing has been recorded.
+ */
+- (CFTimeInterval)durationAtPercentile:(double)percentile forEvent:(FSQCellManifestProfilingEvent)event cellClass:(nullable Class)cellClass;
+
+/**
+ A snapshot of everything recorded so far.
+ 
+ The dictionary has a "total" key with the totals for all cell classes and a "cellClasses" key with a dictionary of
+ results for each cell class name. Each of those is a dictionary keyed by event name ("configure", "size", "dequeue",
+ "onConfigure" and "onSelection") containing the "count", and the "mean", "p50", "p95", "p99" and "max" durations in
+ milliseconds. Events that were never recorded are omitted.
+ */
+- (NSDictionary<NSString *, id> *)dictionaryRepresentation;
+
+/**
+ @return dictionaryRepresentation encoded as JSON.
+ */
+- (nullable NSData *)JSONRepresentation;
+
+/**
+ Throw away everything recorded so far.
+ */
+- (void)reset;
+
+@end
+
+NS_ASSUME_NONNULL_END
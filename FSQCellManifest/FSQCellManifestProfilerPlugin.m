@@ -0,0 +1,207 @@
+//
+//  FSQCellManifestProfilerPlugin.m
+//
+//  Copyright (c) 2015 Foursquare. All rights reserved.
+//
+
+#import "FSQCellManifestProfilerPlugin.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Bucket 0 holds everything under one microsecond. Bucket i > 0 holds durations from 2^((i - 1) / 4) up to 2^(i / 4)
+// microseconds, and the last bucket also holds everything longer than that.
+enum {
+    kFSQProfilerBucketsPerDoubling = 4,
+    kFSQProfilerBucketCount = 24 * kFSQProfilerBucketsPerDoubling + 1,
+};
+
+static const NSUInteger kFSQProfilerEventCount = FSQCellManifestProfilingEventSelectionBlock + 1;
+
+static NSString *FSQProfilerNameForEvent(FSQCellManifestProfilingEvent event) {
+    switch (event) {
+        case FSQCellManifestProfilingEventConfigure:
+            return @"configure";
+        case FSQCellManifestProfilingEventSize:
+            return @"size";
+        case FSQCellManifestProfilingEventDequeue:
+            return @"dequeue";
+        case FSQCellManifestProfilingEventConfigureBlock:
+            return @"onConfigure";
+        case FSQCellManifestProfilingEventSelectionBlock:
+            return @"onSelection";
+    }
+    return @"unknown";
+}
+
+/**
+ Log bucketed histogram of the durations of a single event.
+ */
+@interface FSQCellManifestProfilerHistogram : NSObject {
+    @public
+    NSUInteger _buckets[kFSQProfilerBucketCount];
+    NSUInteger _count;
+    CFTimeInterval _totalDuration;
+    CFTimeInterval _maximumDuration;
+}
+@end
+
+@implementation FSQCellManifestProfilerHistogram
+
+- (void)addDuration:(CFTimeInterval)duration {
+    double microseconds = duration * 1e6;
+    
+    NSUInteger bucket = 0;
+    if (microseconds >= 1) {
+        bucket = MIN((NSUInteger)(log2(microseconds) * kFSQProfilerBucketsPerDoubling) + 1, (NSUInteger)kFSQProfilerBucketCount - 1);
+    }
+    
+    ++_buckets[bucket];
+    ++_count;
+    _totalDuration += duration;
+    _maximumDuration = MAX(_maximumDuration, duration);
+}
+
+- (CFTimeInterval)durationAtPercentile:(double)percentile {
+    if (_count == 0) {
+        return 0;
+    }
+    
+    NSUInteger rank = (NSUInteger)ceil(MIN(MAX(percentile, 0), 100) / 100 * _count);
+    rank = MAX(rank, (NSUInteger)1);
+    
+    NSUInteger seen = 0;
+    for (NSUInteger bucket = 0; bucket < kFSQProfilerBucketCount; ++bucket) {
+        seen += _buckets[bucket];
+        if (seen >= rank) {
+            // The top of the bucket, but never more than the longest duration actually recorded
+            CFTimeInterval bucketLimit = exp2((double)bucket / kFSQProfilerBucketsPerDoubling) / 1e6;
+            return MIN(bucketLimit, _maximumDuration);
+        }
+    }
+    
+    return _maximumDuration;
+}
+
+- (NSDictionary<NSString *, NSNumber *> *)dictionaryRepresentation {
+    return @{
+             @"count" : @(_count),
+             @"mean" : @(_totalDuration / _count * 1000),
+             @"p50" : @([self durationAtPercentile:50] * 1000),
+             @"p95" : @([self durationAtPercentile:95] * 1000),
+             @"p99" : @([self durationAtPercentile:99] * 1000),
+             @"max" : @(_maximumDuration * 1000),
+             };
+}
+
+@end
+
+/**
+ One histogram for each FSQCellManifestProfilingEvent.
+ */
+@interface FSQCellManifestProfilerHistogramSet : NSObject {
+    @public
+    NSArray<FSQCellManifestProfilerHistogram *> *_histograms;
+}
+@end
+
+@implementation FSQCellManifestProfilerHistogramSet
+
+- (instancetype)init {
+    if ((self = [super init])) {
+        NSMutableArray<FSQCellManifestProfilerHistogram *> *histograms = [[NSMutableArray alloc] initWithCapacity:kFSQProfilerEventCount];
+        for (NSUInteger event = 0; event < kFSQProfilerEventCount; ++event) {
+            [histograms addObject:[FSQCellManifestProfilerHistogram new]];
+        }
+        _histograms = [histograms copy];
+    }
+    return self;
+}
+
+- (nullable FSQCellManifestProfilerHistogram *)histogramForEvent:(FSQCellManifestProfilingEvent)event {
+    if (event < 0 || (NSUInteger)event >= kFSQProfilerEventCount) {
+        return nil;
+    }
+    return _histograms[event];
+}
+
+- (NSDictionary<NSString *, NSDictionary *> *)dictionaryRepresentation {
+    NSMutableDictionary<NSString *, NSDictionary *> *dictionary = [NSMutableDictionary new];
+    for (NSUInteger event = 0; event < kFSQProfilerEventCount; ++event) {
+        FSQCellManifestProfilerHistogram *histogram = _histograms[event];
+        if (histogram->_count > 0) {
+            dictionary[FSQProfilerNameForEvent(event)] = [histogram dictionaryRepresentation];
+        }
+    }
+    return [dictionary copy];
+}
+
+@end
+
+@implementation FSQCellManifestProfilerPlugin {
+    // Keys are cell classes, or NSNull for events without a cell class
+    NSMapTable<id, FSQCellManifestProfilerHistogramSet *> *_histogramSetsByCellClass;
+    FSQCellManifestProfilerHistogramSet *_totalHistogramSet;
+}
+
+- (instancetype)init {
+    if ((self = [super init])) {
+        [self reset];
+    }
+    return self;
+}
+
+- (void)reset {
+    _histogramSetsByCellClass = [NSMapTable mapTableWithKeyOptions:(NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality)
+                                                      valueOptions:NSPointerFunctionsStrongMemory];
+    _totalHistogramSet = [FSQCellManifestProfilerHistogramSet new];
+}
+
+- (nullable FSQCellManifestProfilerHistogram *)histogramForEvent:(FSQCellManifestProfilingEvent)event cellClass:(nullable Class)cellClass {
+    FSQCellManifestProfilerHistogramSet *histogramSet = (cellClass ? [_histogramSetsByCellClass objectForKey:cellClass] : _totalHistogramSet);
+    return [histogramSet histogramForEvent:event];
+}
+
+- (NSUInteger)countForEvent:(FSQCellManifestProfilingEvent)event cellClass:(nullable Class)cellClass {
+    FSQCellManifestProfilerHistogram *histogram = [self histogramForEvent:event cellClass:cellClass];
+    return (histogram ? histogram->_count : 0);
+}
+
+- (CFTimeInterval)durationAtPercentile:(double)percentile forEvent:(FSQCellManifestProfilingEvent)event cellClass:(nullable Class)cellClass {
+    return [[self histogramForEvent:event cellClass:cellClass] durationAtPercentile:percentile];
+}
+
+- (NSDictionary<NSString *, id> *)dictionaryRepresentation {
+    NSMutableDictionary<NSString *, NSDictionary *> *cellClasses = [NSMutableDictionary new];
+    for (id cellClass in _histogramSetsByCellClass) {
+        NSString *name = (cellClass == [NSNull null] ? @"(none)" : NSStringFromClass(cellClass));
+        cellClasses[name] = [[_histogramSetsByCellClass objectForKey:cellClass] dictionaryRepresentation];
+    }
+    
+    return @{
+             @"total" : [_totalHistogramSet dictionaryRepresentation],
+             @"cellClasses" : [cellClasses copy],
+             };
+}
+
+- (nullable NSData *)JSONRepresentation {
+    return [NSJSONSerialization dataWithJSONObject:[self dictionaryRepresentation] options:NSJSONWritingPrettyPrinted error:NULL];
+}
+
+#pragma mark - FSQCellManifestProfilingDelegate
+
+- (void)manifest:(FSQCellManifest *)manifest didProfileEvent:(FSQCellManifestProfilingEvent)event cellClass:(nullable Class)cellClass duration:(CFTimeInterval)duration {
+    id key = (cellClass ?: [NSNull null]);
+    
+    FSQCellManifestProfilerHistogramSet *histogramSet = [_histogramSetsByCellClass objectForKey:key];
+    if (!histogramSet) {
+        histogramSet = [FSQCellManifestProfilerHistogramSet new];
+        [_histogramSetsByCellClass setObject:histogramSet forKey:key];
+    }
+    
+    [[histogramSet histogramForEvent:event] addDuration:duration];
+    [[_totalHistogramSet histogramForEvent:event] addDuration:duration];
+}
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -6,49 +6,11 @@
 
 #import <UIKit/UIKit.h>
 
-NS_ASSUME_NONNULL_BEGIN
-
-@class FSQCellRecord, FSQSectionRecord, FSQCellManifest, FSQTableViewCellManifest, FSQCollectionViewCellManifest;
+#import "FSQCellManifestCore.h"
 
-/**
- This block type is used for FSQCellRecord onConfigure blocks.
- 
- This block property is called when a cell is dequeued, after the cell's own configureWithModel: method is called,
- but before the manifest's plugin or delegate callbacks are called.
- 
- You can set this block on an FSQCellRecord to do extra customization of the cell after it gets dequeued.
- Make sure that any values you change here are reset in another configure method or block or incorrect
- data may be displayed due to cell reuse.
- 
- @param cell      The view that was dequeued.
- @param indexPath The index path this view will be displayed at.
- @param manifest  The manifest that dequeued this view.
- @param record    The record associated with this view.
- 
- @see onConfigure
- @see manifest:configureWithModel:indexPath:record:
- @see FSQCellManifestRecordConfigurationDelegate
- */
-typedef void (^FSQCellRecordConfigBlock)(id cell, NSIndexPath *indexPath, FSQCellManifest *manifest, FSQCellRecord *record);
+NS_ASSUME_NONNULL_BEGIN
 
-/**
- This block type is used for FSQCellRecord onSelection blocks.
- 
- This block property is called when a cell is selected in the table or collection view.
- 
- You can set this block on a FSQCellRecord to do an action when the cell is selected. Alternatively if many
- cells in the view do the same or similar code when selected, you may want to use
- FSQCellManifestRecordSelectionDelegate methods.
- 
- 
- @param indexPath The index path of the cell that was selected.
- @param manifest  The manifest managing the selected cell.
- @param record    The record associated with the selected cell.
- 
- @see onSelection
- @see FSQCellManifestRecordSelectionDelegate
- */
-typedef void (^FSQCellRecordSelectBlock)(NSIndexPath *indexPath, FSQCellManifest *manifest, FSQCellRecord *record);
+@class FSQCellRecord, FSQSectionRecord, FSQCellManifest, FSQTableViewCellManifest, FSQCollectionViewCellManifest, FSQCellManifestChangeset;
 
 @protocol FSQCellManifestCellProtocol <NSObject>
 /**
@@ -129,55 +91,63 @@ typedef void (^FSQCellRecordSelectBlock)(NSIndexPath *indexPath, FSQCellManifest
 @end
 
 /**
- This protocol contains callbacks that will inform the delegate when its records are inserted/moved/replaced/removed.
- and when the managed view receives calls to change the records it is rendering.
+ Adopt this protocol instead of FSQCellManifestTableViewCellProtocol to declare that your class's
+ manifest:heightForModel:maximumSize:indexPath:record: implementation is thread safe.
  
- A "will" call is _always_ followed by the correspding "did" call.
+ The manifest may then call it concurrently from background threads to precompute heights into its size cache.
+ Your implementation must not touch any views or other main-thread-only state, and must not modify the manifest or
+ the record. Use the model passed in rather than the record's, since the record's properties may be set on the main
+ thread while it is being measured. Text measurement with NSString and NSAttributedString's boundingRectWithSize:
+ methods is safe.
  
- Each set of callbacks corresponds to a method on FSQCellManifest and only one set of will be sent per-manifest method.
- E.g. even though `setSectionRecords` both replaces section records _and_ may reload the managed view, you will only
- receive the [will/did]ReplaceSectionRecords callbacks.
+ @see precomputeSizesWithCompletion:
+ @see precomputesSizesInBackground
  */
-@protocol FSQCellManifestRecordModificationDelegate <NSObject>
-@optional
-- (void)manifest:(FSQCellManifest *)manifest willReplaceSectionRecords:(NSArray<FSQSectionRecord *> *)currentSectionRecords withRecords:(NSArray<FSQSectionRecord *> *)newSectionRecords;
-- (void)manifest:(FSQCellManifest *)manifest didReplaceSectionRecords:(NSArray<FSQSectionRecord *> *)oldSectionRecords withRecords:(NSArray<FSQSectionRecord *> *)currentSectionRecords;
-
-- (void)manifestWillReloadManagedView:(FSQCellManifest *)manifest;
-- (void)manifestDidReloadManagedView:(FSQCellManifest *)manifest;
-
-- (void)manifest:(FSQCellManifest *)manifest willInsertCellRecords:(NSArray<FSQCellRecord *> *)cellRecords atIndexPath:(NSIndexPath *)indexPath;
-- (void)manifest:(FSQCellManifest *)manifest didInsertCellRecords:(NSArray<FSQCellRecord *> *)cellRecords atIndexPaths:(NSArray<NSIndexPath *> *)indexPaths;
-
-- (void)manifest:(FSQCellManifest *)manifest willMoveCellRecordAtIndexPath:(NSIndexPath *)initialIndexPath toIndexPath:(NSIndexPath *)targetIndexPath;
-- (void)manifest:(FSQCellManifest *)manifest didMoveCellRecordAtIndexPath:(NSIndexPath *)initialIndexPath toIndexPath:(NSIndexPath *)targetIndexPath;
-
-- (void)manifest:(FSQCellManifest *)manifest willReplaceCellRecordsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths withRecords:(NSArray<FSQCellRecord *> *)cellRecords;
-- (void)manifest:(FSQCellManifest *)manifest didReplaceCellRecordsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths withRecords:(NSArray<FSQCellRecord *> *)newCellRecords replacedRecords:(NSArray<FSQCellRecord *> *)originalCellRecords;
-
-- (void)manifest:(FSQCellManifest *)manifest willRemoveCellRecordsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths removingEmptySections:(BOOL)willRemoveEmptySections;
-- (void)manifest:(FSQCellManifest *)manifest didRemoveCellRecordsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths removedEmptySectionsAtIndexes:(NSIndexSet *)removedSections;
-
-- (void)manifest:(FSQCellManifest *)manifest willReloadCellsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths;
-- (void)manifest:(FSQCellManifest *)manifest didReloadCellsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths;
-
-- (void)manifest:(FSQCellManifest *)manifest willInsertSectionRecords:(NSArray<FSQSectionRecord *> *)sectionRecords atIndex:(NSInteger)index;
-- (void)manifest:(FSQCellManifest *)manifest didInsertSectionRecords:(NSArray<FSQSectionRecord *> *)sectionRecords atIndexes:(NSIndexSet *)indexes;
-
-- (void)manifest:(FSQCellManifest *)manifest willMoveSectionRecordAtIndex:(NSInteger)initialIndex toIndex:(NSInteger)targetIndex;
-- (void)manifest:(FSQCellManifest *)manifest didMoveSectionRecordAtIndex:(NSInteger)initialIndex toIndex:(NSInteger)targetIndex;
+@protocol FSQCellManifestThreadSafeTableViewCellProtocol <FSQCellManifestTableViewCellProtocol>
+@end
 
-- (void)manifest:(FSQCellManifest *)manifest willReplaceSectionRecordsAtIndexes:(NSArray<NSNumber *> *)indexes withRecords:(NSArray<FSQSectionRecord *> *)sectionRecords;
-- (void)manifest:(FSQCellManifest *)manifest didReplaceSectionRecordsAtIndexes:(NSArray<NSNumber *> *)indexes withRecords:(NSArray<FSQSectionRecord *> *)newSectionRecords replacedRecords:(NSArray<FSQSectionRecord *> *)originalSectionRecords;
+/**
+ Adopt this protocol instead of FSQCellManifestCollectionViewCellProtocol to declare that your class's
+ manifest:sizeForModel:maximumSize:indexPath:record: implementation is thread safe.
+ 
+ The manifest may then call it concurrently from background threads to precompute sizes into its size cache.
+ Your implementation must not touch any views or other main-thread-only state, and must not modify the manifest or
+ the record. Use the model passed in rather than the record's, since the record's properties may be set on the main
+ thread while it is being measured. Text measurement with NSString and NSAttributedString's boundingRectWithSize:
+ methods is safe.
+ 
+ @see precomputeSizesWithCompletion:
+ @see precomputesSizesInBackground
+ */
+@protocol FSQCellManifestThreadSafeCollectionViewCellProtocol <FSQCellManifestCollectionViewCellProtocol>
+@end
 
-- (void)manifest:(FSQCellManifest *)manifest willRemoveSectionRecordsAtIndexes:(NSIndexSet *)indexes;
-- (void)manifest:(FSQCellManifest *)manifest didRemoveSectionRecordsAtIndexes:(NSIndexSet *)indexes;
+/**
+ Adopt this protocol in your cell class to start loading what its cells will need before they are displayed.
+ 
+ When the table or collection view prefetches (iOS 10 and later), the manifest groups the records of each batch by
+ cell class and calls these methods once per class, so you can batch the work (e.g. one network request for all of
+ the batch's images). They are called before the records' onPrefetch and onCancelPrefetch blocks.
+ */
+@protocol FSQCellManifestPrefetchingCellProtocol <NSObject>
+@optional
 
-- (void)manifest:(FSQCellManifest *)manifest willReloadSectionsAtIndexes:(NSIndexSet *)indexes;
-- (void)manifest:(FSQCellManifest *)manifest didReloadSectionsAtIndexes:(NSIndexSet *)indexes;
+/**
+ @param manifest   The manifest managing the records.
+ @param records    The records of this class in the batch.
+ @param indexPaths The index paths of those records, in the same order.
+ */
++ (void)manifest:(FSQCellManifest *)manifest prefetchForRecords:(NSArray<FSQCellRecord *> *)records atIndexPaths:(NSArray<NSIndexPath *> *)indexPaths;
 
+/**
+ @param manifest   The manifest managing the records.
+ @param records    The records of this class that will no longer be displayed soon.
+ @param indexPaths The index paths of those records, in the same order.
+ */
++ (void)manifest:(FSQCellManifest *)manifest cancelPrefetchingForRecords:(NSArray<FSQCellRecord *> *)records atIndexPaths:(NSArray<NSIndexPath *> *)indexPaths;
 @end
 
+
 /**
  This protocol contains methods to override or supplement the behavior of record configuration
  */
@@ -344,6 +314,32 @@ typedef void (^FSQCellRecordSelectBlock)(NSIndexPath *indexPath, FSQCellManifest
       withRecord:(FSQCellRecord *)cellRecord;
 @end
 
+/**
+ This protocol contains callbacks for the table or collection view's prefetching (iOS 10 and later).
+ 
+ Each callback covers one whole batch from the managed view, and is sent after the cell classes' prefetching methods
+ and the records' onPrefetch or onCancelPrefetch blocks. Index paths that no longer have a record are left out.
+ */
+@protocol FSQCellManifestRecordPrefetchingDelegate <NSObject>
+@optional
+
+/**
+ @param manifest    The manifest managing the records.
+ @param indexPaths  The index paths of the cells that will probably be displayed soon.
+ @param cellRecords The records at those index paths, in the same order.
+ */
+- (void)manifest:(FSQCellManifest *)manifest prefetchCellsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths
+     withRecords:(NSArray<FSQCellRecord *> *)cellRecords;
+
+/**
+ @param manifest    The manifest managing the records.
+ @param indexPaths  The index paths of the cells that are no longer expected to be displayed soon.
+ @param cellRecords The records at those index paths, in the same order.
+ */
+- (void)manifest:(FSQCellManifest *)manifest cancelPrefetchingCellsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths
+     withRecords:(NSArray<FSQCellRecord *> *)cellRecords;
+@end
+
 /**
  This protocol contains methods to override size calculations for cells
  */
@@ -397,12 +393,75 @@ typedef void (^FSQCellRecordSelectBlock)(NSIndexPath *indexPath, FSQCellManifest
 - (CGSize)defaultMaximumCellSizeForManifest:(FSQCellManifest *)manifest;
 @end
 
+/**
+ The manifest operations that FSQCellManifestProfilingDelegate receives timings for.
+ */
+typedef NS_ENUM(NSInteger, FSQCellManifestProfilingEvent) {
+    
+    /**
+     Configuring a cell, header or footer view. This includes the view's own configure method, the record's
+     onConfigure block, and all plugin and delegate configuration callbacks.
+     */
+    FSQCellManifestProfilingEventConfigure,
+    
+    /**
+     Calculating the size of a cell, header or footer record. Sizes returned from the record size cache are not
+     reported.
+     */
+    FSQCellManifestProfilingEventSize,
+    
+    /**
+     Dequeueing a cell, header or footer view from the managed view.
+     */
+    FSQCellManifestProfilingEventDequeue,
+    
+    /**
+     Running a record's onConfigure block.
+     */
+    FSQCellManifestProfilingEventConfigureBlock,
+    
+    /**
+     Running a record's onSelection block.
+     */
+    FSQCellManifestProfilingEventSelectionBlock,
+};
+
+/**
+ This protocol contains a callback with timings for the manifest's most performance sensitive operations.
+ 
+ The manifest only reads the clock if a plugin or its delegate implements this protocol.
+ 
+ @see FSQCellManifestProfilerPlugin
+ */
+@protocol FSQCellManifestProfilingDelegate <NSObject>
+
+/**
+ Sent on the main thread after the manifest performs a timed operation.
+ 
+ @param manifest  The manifest that did the work.
+ @param event     What was timed.
+ @param cellClass The cellClass of the record involved, or nil if there was no record.
+ @param duration  How long the operation took, in seconds.
+ */
+- (void)manifest:(FSQCellManifest *)manifest didProfileEvent:(FSQCellManifestProfilingEvent)event cellClass:(nullable Class)cellClass duration:(CFTimeInterval)duration;
+@end
 
 @protocol FSQCellManifestPlugin <NSObject>
 @optional
 - (void)wasAttachedToManifest:(FSQCellManifest *)manifest;
 - (void)wasRemovedFromManifest:(FSQCellManifest *)manifest;
 - (void)manifest:(FSQCellManifest *)manifest managedViewDidChange:(UIScrollView *)newManagedView oldView:(UIScrollView *)oldManagedView;
+
+/**
+ Sent when invalidateSizesForRecords: or invalidateAllRecordSizes discards cached sizes, so plugins that keep their
+ own copies of record sizes can discard them too. Not sent for sizes discarded because their records changed, since
+ plugins are already told about those changes.
+ 
+ @param manifest   The manifest whose sizes were discarded.
+ @param indexPaths The index paths of the records, or nil if all sizes were discarded or the records could not all be
+                   located (see maintainsRecordIndex).
+ */
+- (void)manifest:(FSQCellManifest *)manifest didInvalidateSizesForRecordsAtIndexPaths:(nullable NSArray<NSIndexPath *> *)indexPaths;
 @end
 
 NS_ASSUME_NONNULL_END
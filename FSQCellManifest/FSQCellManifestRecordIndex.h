@@ -0,0 +1,68 @@
+//
+//  FSQCellManifestRecordIndex.h
+//
+//  Copyright (c) 2015 Foursquare. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@class FSQCellRecord;
+@class FSQSectionRecord;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ A reverse index from cell record identity and model identity to index path.
+ 
+ The index knows which section each record is in and, for each section, the row of each record. The manifest tells
+ it about every change it makes to its records, so lookups stay O(1) as records are inserted, removed and replaced.
+ 
+ Inserting or removing records at the end of a section, replacing records, and inserting, removing or moving whole
+ sections are applied to the index directly. Inserting or removing records anywhere else in a section shifts the rows
+ of the records after them, so that section's rows are rebuilt the next time one of its records is looked up.
+ After invalidate, the whole index is rebuilt the next time anything is looked up.
+ 
+ Records in FSQVirtualSectionRecord sections are not indexed, as indexing them would create every one of their pages.
+ 
+ Every update must be made after the section records passed to the next lookup have been changed to match.
+ 
+ This is an internal class used by FSQCellManifest and should not be used outside of the framework. It is not thread
+ safe.
+ */
+@interface FSQCellManifestRecordIndex : NSObject
+
+/**
+ Throw away the entire index, to be rebuilt from the section records on the next lookup.
+ */
+- (void)invalidate;
+
+/**
+ @return The index path of cellRecord, or nil if it is not in any indexed section.
+ */
+- (nullable NSIndexPath *)indexPathForCellRecord:(FSQCellRecord *)cellRecord inSectionRecords:(NSArray<FSQSectionRecord *> *)sectionRecords;
+
+/**
+ @return The index paths of every indexed record whose model is model (by identity), in ascending order.
+ */
+- (NSArray<NSIndexPath *> *)indexPathsForModel:(id)model inSectionRecords:(NSArray<FSQSectionRecord *> *)sectionRecords;
+
+- (void)didInsertCellRecords:(NSArray<FSQCellRecord *> *)cellRecords atIndexPath:(NSIndexPath *)indexPath;
+- (void)didRemoveCellRecords:(NSArray<FSQCellRecord *> *)cellRecords atIndexes:(NSIndexSet *)indexes inSection:(NSInteger)sectionIndex;
+
+/**
+ @param oldCellRecords The records that were replaced, in index order.
+ @param newCellRecords The records that replaced them, in the same order.
+ */
+- (void)didReplaceCellRecords:(NSArray<FSQCellRecord *> *)oldCellRecords
+              withCellRecords:(NSArray<FSQCellRecord *> *)newCellRecords
+                    atIndexes:(NSIndexSet *)indexes
+                    inSection:(NSInteger)sectionIndex;
+
+- (void)didInsertSectionRecords:(NSArray<FSQSectionRecord *> *)sectionRecords atIndexes:(NSIndexSet *)indexes;
+- (void)didRemoveSectionRecords:(NSArray<FSQSectionRecord *> *)sectionRecords atIndexes:(NSIndexSet *)indexes;
+- (void)didReplaceSectionRecord:(FSQSectionRecord *)oldSectionRecord withSectionRecord:(FSQSectionRecord *)newSectionRecord atIndex:(NSInteger)sectionIndex;
+- (void)didMoveSectionRecordAtIndex:(NSInteger)initialIndex toIndex:(NSInteger)targetIndex;
+
+@end
+
+NS_ASSUME_NONNULL_END
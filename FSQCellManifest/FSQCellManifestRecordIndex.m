@@ -0,0 +1,372 @@
+//
+//  FSQCellManifestRecordIndex.m
+//
+//  Copyright (c) 2015 Foursquare. All rights reserved.
+//
+
+#import "FSQCellManifestRecordIndex.h"
+
+#import "FSQCellManifestIndexPaths.h"
+#import "FSQCellRecord.h"
+#import "FSQVirtualSectionRecord.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+static NSMapTable *FSQCellManifestRecordIndexIdentityMapTable(void) {
+    return [NSMapTable mapTableWithKeyOptions:(NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality)
+                                 valueOptions:NSPointerFunctionsStrongMemory];
+}
+
+@interface FSQCellManifestRecordIndexSection : NSObject {
+@public
+    NSInteger _sectionIndex;
+    NSInteger _count;
+    BOOL _indexed;
+    // Nil when the rows are out of date and must be rebuilt before they are used
+    NSMapTable<FSQCellRecord *, NSNumber *> *_Nullable _rowsByRecord;
+}
+@end
+
+@implementation FSQCellManifestRecordIndexSection
+@end
+
+@implementation FSQCellManifestRecordIndex {
+    BOOL _valid;
+    NSMutableArray<FSQCellManifestRecordIndexSection *> *_sections;
+    NSMapTable<FSQCellRecord *, FSQCellManifestRecordIndexSection *> *_sectionsByRecord;
+    NSMapTable<id, NSHashTable<FSQCellRecord *> *> *_recordsByModel;
+}
+
+- (instancetype)init {
+    if ((self = [super init])) {
+        _sections = [NSMutableArray new];
+        _sectionsByRecord = FSQCellManifestRecordIndexIdentityMapTable();
+        _recordsByModel = FSQCellManifestRecordIndexIdentityMapTable();
+    }
+    return self;
+}
+
+- (void)invalidate {
+    if (!_valid) {
+        return;
+    }
+    
+    _valid = NO;
+    [_sections removeAllObjects];
+    [_sectionsByRecord removeAllObjects];
+    [_recordsByModel removeAllObjects];
+}
+
+#pragma mark - Building
+
+- (void)buildIfNeededFromSectionRecords:(NSArray<FSQSectionRecord *> *)sectionRecords {
+    if (_valid) {
+        return;
+    }
+    
+    _valid = YES;
+    
+    NSInteger sectionIndex = 0;
+    for (FSQSectionRecord *sectionRecord in sectionRecords) {
+        [_sections addObject:[self indexSectionForSectionRecord:sectionRecord atIndex:sectionIndex]];
+        ++sectionIndex;
+    }
+}
+
+- (FSQCellManifestRecordIndexSection *)indexSectionForSectionRecord:(FSQSectionRecord *)sectionRecord atIndex:(NSInteger)sectionIndex {
+    FSQCellManifestRecordIndexSection *section = [FSQCellManifestRecordIndexSection new];
+    section->_sectionIndex = sectionIndex;
+    section->_indexed = ![sectionRecord isKindOfClass:[FSQVirtualSectionRecord class]];
+    
+    if (section->_indexed) {
+        section->_rowsByRecord = FSQCellManifestRecordIndexIdentityMapTable();
+        
+        NSInteger row = 0;
+        for (FSQCellRecord *cellRecord in sectionRecord.cellRecords) {
+            [self addCellRecord:cellRecord toSection:section];
+            [section->_rowsByRecord setObject:@(row) forKey:cellRecord];
+            ++row;
+        }
+        section->_count = row;
+    }
+    
+    return section;
+}
+
+- (void)rebuildRowsOfSection:(FSQCellManifestRecordIndexSection *)section fromSectionRecords:(NSArray<FSQSectionRecord *> *)sectionRecords {
+    if (section->_sectionIndex >= [sectionRecords count]) {
+        [self invalidate];
+        return;
+    }
+    
+    section->_rowsByRecord = FSQCellManifestRecordIndexIdentityMapTable();
+    
+    NSInteger row = 0;
+    for (FSQCellRecord *cellRecord in sectionRecords[section->_sectionIndex].cellRecords) {
+        [section->_rowsByRecord setObject:@(row) forKey:cellRecord];
+        ++row;
+    }
+    section->_count = row;
+}
+
+- (void)renumberSectionsFromIndex:(NSUInteger)firstSectionIndex {
+    for (NSUInteger sectionIndex = firstSectionIndex; sectionIndex < [_sections count]; ++sectionIndex) {
+        _sections[sectionIndex]->_sectionIndex = sectionIndex;
+    }
+}
+
+- (void)addCellRecord:(FSQCellRecord *)cellRecord toSection:(FSQCellManifestRecordIndexSection *)section {
+    [_sectionsByRecord setObject:section forKey:cellRecord];
+    
+    id model = cellRecord.model;
+    if (model) {
+        NSHashTable<FSQCellRecord *> *cellRecords = [_recordsByModel objectForKey:model];
+        if (!cellRecords) {
+            cellRecords = [NSHashTable hashTableWithOptions:(NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality)];
+            [_recordsByModel setObject:cellRecords forKey:model];
+        }
+        [cellRecords addObject:cellRecord];
+    }
+}
+
+- (void)removeCellRecord:(FSQCellRecord *)cellRecord fromSection:(FSQCellManifestRecordIndexSection *)section {
+    if ([_sectionsByRecord objectForKey:cellRecord] != section) {
+        // Already indexed somewhere else
+        return;
+    }
+    
+    [_sectionsByRecord removeObjectForKey:cellRecord];
+    [section->_rowsByRecord removeObjectForKey:cellRecord];
+    
+    id model = cellRecord.model;
+    if (model) {
+        NSHashTable<FSQCellRecord *> *cellRecords = [_recordsByModel objectForKey:model];
+        [cellRecords removeObject:cellRecord];
+        if (cellRecords && [cellRecords count] == 0) {
+            [_recordsByModel removeObjectForKey:model];
+        }
+    }
+}
+
+- (nullable FSQCellManifestRecordIndexSection *)indexedSectionAtIndex:(NSInteger)sectionIndex {
+    if (sectionIndex < 0
+        || sectionIndex >= [_sections count]) {
+        // Out of step with the section records, so start over
+        [self invalidate];
+        return nil;
+    }
+    
+    FSQCellManifestRecordIndexSection *section = _sections[sectionIndex];
+    return (section->_indexed ? section : nil);
+}
+
+#pragma mark - Lookup
+
+- (nullable NSIndexPath *)indexPathForCellRecord:(FSQCellRecord *)cellRecord inSectionRecords:(NSArray<FSQSectionRecord *> *)sectionRecords {
+    [self buildIfNeededFromSectionRecords:sectionRecords];
+    
+    FSQCellManifestRecordIndexSection *section = [_sectionsByRecord objectForKey:cellRecord];
+    if (!section) {
+        return nil;
+    }
+    
+    if (!section->_rowsByRecord) {
+        [self rebuildRowsOfSection:section fromSectionRecords:sectionRecords];
+    }
+    
+    NSNumber *row = [section->_rowsByRecord objectForKey:cellRecord];
+    return (row ? FSQIndexPathMake(section->_sectionIndex, [row integerValue]) : nil);
+}
+
+- (NSArray<NSIndexPath *> *)indexPathsForModel:(id)model inSectionRecords:(NSArray<FSQSectionRecord *> *)sectionRecords {
+    [self buildIfNeededFromSectionRecords:sectionRecords];
+    
+    NSMutableArray<NSIndexPath *> *indexPaths = [NSMutableArray new];
+    for (FSQCellRecord *cellRecord in [_recordsByModel objectForKey:model]) {
+        if (cellRecord.model != model) {
+            // The record's model was changed after it was indexed
+            continue;
+        }
+        
+        NSIndexPath *indexPath = [self indexPathForCellRecord:cellRecord inSectionRecords:sectionRecords];
+        if (indexPath) {
+            [indexPaths addObject:indexPath];
+        }
+    }
+    
+    [indexPaths sortUsingSelector:@selector(compare:)];
+    return [indexPaths copy];
+}
+
+#pragma mark - Cell Record Updates
+
+- (void)didInsertCellRecords:(NSArray<FSQCellRecord *> *)cellRecords atIndexPath:(NSIndexPath *)indexPath {
+    if (!_valid) {
+        return;
+    }
+    
+    FSQCellManifestRecordIndexSection *section = [self indexedSectionAtIndex:FSQIndexPathSection(indexPath)];
+    if (!section) {
+        return;
+    }
+    
+    NSInteger row = FSQIndexPathRowOrItem(indexPath);
+    BOOL appending = (row == section->_count);
+    
+    for (FSQCellRecord *cellRecord in cellRecords) {
+        [self addCellRecord:cellRecord toSection:section];
+        if (appending) {
+            [section->_rowsByRecord setObject:@(row) forKey:cellRecord];
+        }
+        ++row;
+    }
+    
+    if (!appending) {
+        // Every record after the insertion point has a new row
+        section->_rowsByRecord = nil;
+    }
+    section->_count += [cellRecords count];
+}
+
+- (void)didRemoveCellRecords:(NSArray<FSQCellRecord *> *)cellRecords atIndexes:(NSIndexSet *)indexes inSection:(NSInteger)sectionIndex {
+    if (!_valid
+        || [indexes count] == 0) {
+        return;
+    }
+    
+    FSQCellManifestRecordIndexSection *section = [self indexedSectionAtIndex:sectionIndex];
+    if (!section) {
+        return;
+    }
+    
+    BOOL removingFromEnd = ((NSInteger)[indexes lastIndex] == section->_count - 1
+                            && [indexes lastIndex] - [indexes firstIndex] + 1 == [indexes count]);
+    
+    for (FSQCellRecord *cellRecord in cellRecords) {
+        [self removeCellRecord:cellRecord fromSection:section];
+    }
+    
+    if (!removingFromEnd) {
+        // Every record after the first removed one has a new row
+        section->_rowsByRecord = nil;
+    }
+    section->_count -= [indexes count];
+}
+
+- (void)didReplaceCellRecords:(NSArray<FSQCellRecord *> *)oldCellRecords
+              withCellRecords:(NSArray<FSQCellRecord *> *)newCellRecords
+                    atIndexes:(NSIndexSet *)indexes
+                    inSection:(NSInteger)sectionIndex {
+    if (!_valid) {
+        return;
+    }
+    
+    FSQCellManifestRecordIndexSection *section = [self indexedSectionAtIndex:sectionIndex];
+    if (!section) {
+        return;
+    }
+    
+    // Remove everything before adding anything, in case records are swapping places
+    for (FSQCellRecord *cellRecord in oldCellRecords) {
+        [self removeCellRecord:cellRecord fromSection:section];
+    }
+    
+    __block NSUInteger parameterIndex = 0;
+    [indexes enumerateIndexesUsingBlock:^(NSUInteger idx, BOOL *stop) {
+        FSQCellRecord *cellRecord = newCellRecords[parameterIndex++];
+        [self addCellRecord:cellRecord toSection:section];
+        [section->_rowsByRecord setObject:@(idx) forKey:cellRecord];
+    }];
+}
+
+#pragma mark - Section Record Updates
+
+- (void)didInsertSectionRecords:(NSArray<FSQSectionRecord *> *)sectionRecords atIndexes:(NSIndexSet *)indexes {
+    if (!_valid
+        || [indexes count] == 0) {
+        return;
+    }
+    
+    if ([indexes lastIndex] >= [_sections count] + [indexes count]) {
+        [self invalidate];
+        return;
+    }
+    
+    __block NSUInteger parameterIndex = 0;
+    [indexes enumerateIndexesUsingBlock:^(NSUInteger idx, BOOL *stop) {
+        [self->_sections insertObject:[self indexSectionForSectionRecord:sectionRecords[parameterIndex++] atIndex:idx] atIndex:idx];
+    }];
+    
+    [self renumberSectionsFromIndex:[indexes firstIndex]];
+}
+
+- (void)didRemoveSectionRecords:(NSArray<FSQSectionRecord *> *)sectionRecords atIndexes:(NSIndexSet *)indexes {
+    if (!_valid
+        || [indexes count] == 0) {
+        return;
+    }
+    
+    if ([indexes lastIndex] >= [_sections count]) {
+        [self invalidate];
+        return;
+    }
+    
+    __block NSUInteger parameterIndex = 0;
+    [indexes enumerateIndexesUsingBlock:^(NSUInteger idx, BOOL *stop) {
+        FSQCellManifestRecordIndexSection *section = self->_sections[idx];
+        FSQSectionRecord *sectionRecord = sectionRecords[parameterIndex++];
+        if (section->_indexed) {
+            for (FSQCellRecord *cellRecord in sectionRecord.cellRecords) {
+                [self removeCellRecord:cellRecord fromSection:section];
+            }
+        }
+    }];
+    
+    [_sections removeObjectsAtIndexes:indexes];
+    [self renumberSectionsFromIndex:[indexes firstIndex]];
+}
+
+- (void)didReplaceSectionRecord:(FSQSectionRecord *)oldSectionRecord withSectionRecord:(FSQSectionRecord *)newSectionRecord atIndex:(NSInteger)sectionIndex {
+    if (!_valid) {
+        return;
+    }
+    
+    if (sectionIndex < 0
+        || sectionIndex >= [_sections count]) {
+        [self invalidate];
+        return;
+    }
+    
+    FSQCellManifestRecordIndexSection *oldSection = _sections[sectionIndex];
+    if (oldSection->_indexed) {
+        for (FSQCellRecord *cellRecord in oldSectionRecord.cellRecords) {
+            [self removeCellRecord:cellRecord fromSection:oldSection];
+        }
+    }
+    
+    _sections[sectionIndex] = [self indexSectionForSectionRecord:newSectionRecord atIndex:sectionIndex];
+}
+
+- (void)didMoveSectionRecordAtIndex:(NSInteger)initialIndex toIndex:(NSInteger)targetIndex {
+    if (!_valid) {
+        return;
+    }
+    
+    if (initialIndex < 0
+        || targetIndex < 0
+        || initialIndex >= [_sections count]
+        || targetIndex >= [_sections count]) {
+        [self invalidate];
+        return;
+    }
+    
+    FSQCellManifestRecordIndexSection *section = _sections[initialIndex];
+    [_sections removeObjectAtIndex:initialIndex];
+    [_sections insertObject:section atIndex:targetIndex];
+    
+    [self renumberSectionsFromIndex:MIN(initialIndex, targetIndex)];
+}
+
+@end
+
+NS_ASSUME_NONNULL_END
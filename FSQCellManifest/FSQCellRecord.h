@@ -4,12 +4,89 @@
 //  Copyright (c) 2015 Foursquare. All rights reserved.
 //
 
-#import "FSQCellManifestProtocols.h"
+#import <Foundation/Foundation.h>
 
 NS_ASSUME_NONNULL_BEGIN
 
 @class FSQCellRecord, FSQCellManifest, FSQTableViewCellManifest, FSQCollectionViewCellManifest;
 
+/**
+ This block type is used for FSQCellRecord onConfigure blocks.
+ 
+ This block property is called when a cell is dequeued, after the cell's own configureWithModel: method is called,
+ but before the manifest's plugin or delegate callbacks are called.
+ 
+ You can set this block on an FSQCellRecord to do extra customization of the cell after it gets dequeued.
+ Make sure that any values you change here are reset in another configure method or block or incorrect
+ data may be displayed due to cell reuse.
+ 
+ @param cell      The view that was dequeued.
+ @param indexPath The index path this view will be displayed at.
+ @param manifest  The manifest that dequeued this view.
+ @param record    The record associated with this view.
+ 
+ @see onConfigure
+ @see manifest:configureWithModel:indexPath:record:
+ @see FSQCellManifestRecordConfigurationDelegate
+ */
+typedef void (^FSQCellRecordConfigBlock)(id cell, NSIndexPath *indexPath, FSQCellManifest *manifest, FSQCellRecord *record);
+
+/**
+ This block type is used for FSQCellRecord onSelection blocks.
+ 
+ This block property is called when a cell is selected in the table or collection view.
+ 
+ You can set this block on a FSQCellRecord to do an action when the cell is selected. Alternatively if many
+ cells in the view do the same or similar code when selected, you may want to use
+ FSQCellManifestRecordSelectionDelegate methods.
+ 
+ 
+ @param indexPath The index path of the cell that was selected.
+ @param manifest  The manifest managing the selected cell.
+ @param record    The record associated with the selected cell.
+ 
+ @see onSelection
+ @see FSQCellManifestRecordSelectionDelegate
+ */
+typedef void (^FSQCellRecordSelectBlock)(NSIndexPath *indexPath, FSQCellManifest *manifest, FSQCellRecord *record);
+
+/**
+ This block type is used for FSQCellRecord onPrefetch and onCancelPrefetch blocks.
+ 
+ These block properties are called when the table or collection view expects to display the record's cell soon, or
+ no longer does, so that you can start or stop loading anything the cell will need (e.g. images or network data).
+ They are only called on iOS 10 and later.
+ 
+ @param indexPath The index path the record was at when the prefetch was requested.
+ @param manifest  The manifest managing the record.
+ @param record    The record whose cell is about to be displayed.
+ 
+ @see onPrefetch
+ @see onCancelPrefetch
+ @see FSQCellManifestRecordPrefetchingDelegate
+ */
+typedef void (^FSQCellRecordPrefetchBlock)(NSIndexPath *indexPath, FSQCellManifest *manifest, FSQCellRecord *record);
+
+/**
+ This block type is used by the manifest's removeCellRecordsPassingTest: and replaceCellRecordsPassingTest: methods.
+ 
+ @param record    A cell record in the manifest.
+ @param indexPath The index path of the record.
+ 
+ @return YES if the record should be removed or replaced.
+ */
+typedef BOOL (^FSQCellRecordTestBlock)(FSQCellRecord *record, NSIndexPath *indexPath);
+
+/**
+ This block type is used by the manifest's replaceCellRecordsPassingTest: methods.
+ 
+ @param record    A cell record in the manifest that passed the test.
+ @param indexPath The index path of the record.
+ 
+ @return The record to replace it with.
+ */
+typedef FSQCellRecord *_Nonnull (^FSQCellRecordReplacementBlock)(FSQCellRecord *record, NSIndexPath *indexPath);
+
 @interface FSQCellRecord : NSObject
 
 /**
@@ -51,6 +128,24 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (nonatomic, copy, nullable) FSQCellRecordSelectBlock onSelection;
 
+/**
+ If set, this block will be called when the managed view expects to display this record's cell soon,
+ after the cell class's prefetching method is called (see FSQCellManifestPrefetchingCellProtocol),
+ and before the manifest delegate's prefetchCellsAtIndexPaths:withRecords: method is called.
+ 
+ Only called on iOS 10 and later.
+ */
+@property (nonatomic, copy, nullable) FSQCellRecordPrefetchBlock onPrefetch;
+
+/**
+ If set, this block will be called when the managed view no longer expects to display this record's cell soon,
+ after the cell class's cancel prefetching method is called (see FSQCellManifestPrefetchingCellProtocol),
+ and before the manifest delegate's cancelPrefetchingCellsAtIndexPaths:withRecords: method is called.
+ 
+ Only called on iOS 10 and later.
+ */
+@property (nonatomic, copy, nullable) FSQCellRecordPrefetchBlock onCancelPrefetch;
+
 /**
  Controls whether this row is allowed to be highlighted/selected.
  
@@ -92,6 +187,8 @@ NS_ASSUME_NONNULL_BEGIN
 /**
  This contents of this dictionary are not used internally by the manifest classes.
  You can use it to attach arbitrary data to the cell record for your own later use.
+ 
+ @warning Do not modify this dictionary once the record is frozen.
  */
 @property (nonatomic, readonly) NSMutableDictionary *userInfo;
 
@@ -105,6 +202,24 @@ NS_ASSUME_NONNULL_BEGIN
                   onConfigure:(nullable FSQCellRecordConfigBlock)onConfigure
                   onSelection:(nullable FSQCellRecordSelectBlock)onSelection;
 
+/**
+ YES once freeze has been called.
+ */
+@property (nonatomic, readonly, getter=isFrozen) BOOL frozen;
+
+/**
+ Makes this record immutable. Setting any of its properties afterwards raises an NSInternalInconsistencyException.
+ 
+ A frozen record can be read from any thread, so records can be created and frozen on a background queue and then
+ handed to the manifest on the main thread. The model, and anything else the record refers to, should not be
+ modified either once the record is frozen.
+ 
+ Freezing a record more than once does nothing.
+ 
+ @see FSQCellManifest's commitFrozenSectionRecords:
+ */
+- (void)freeze;
+
 /**
  Used to determine if two records are equivalent.
  
@@ -115,10 +230,18 @@ NS_ASSUME_NONNULL_BEGIN
  * They have the same reuseIdentifer or neither has a reuseIdentifier.
  * They both have an onConfigure block or both do not.
  * They both have an onSelection block or both do not.
+ * They both have an onPrefetch block or both do not.
+ * They both have an onCancelPrefetch block or both do not.
  * They have the same userInfo according to isEqualToDictionary:
  * Their allowsHighlighting value is the same.
  * Their allowsSelection value is the same.
  
+ Each record caches a fingerprint of everything above except the model and userInfo, which is recomputed after one of
+ its properties is set. Records whose fingerprints differ are known to be different without comparing their models.
+ 
+ The record's hash combines its model's hash with its cell class. As with any object in a set or dictionary, a model
+ must not be modified in a way that changes its hash while its record is being used as a key.
+ 
  @param anotherCellRecord Another FSQCellRecord to compare with.
  
  @return YES if the records appear to be equivalent. NO if they do not.
@@ -8,6 +8,16 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+/**
+ Implemented by the objects that section records cache their fingerprints in, so that a cell record can tell the
+ sections that used its fingerprint when it changes. Also declared in FSQSectionRecord.m.
+ */
+@protocol FSQCellRecordFingerprintDependent <NSObject>
+
+- (void)cellRecordFingerprintDidChange;
+
+@end
+
 /**
  This is an empty (placeholder) internal object to allow us to keep
  model as a nullable but not have to make model inside of the cell 
@@ -24,6 +34,11 @@ NS_ASSUME_NONNULL_BEGIN
 @implementation FSQCellRecord {
     NSNumber *_Nullable _allowsHighlighting;
     NSNumber *_Nullable _allowsSelection;
+    NSUInteger _fingerprint;
+    BOOL _fingerprintIsValid;
+    // Almost every record only ever has one dependent at a time, so only further ones need a table
+    __weak id<FSQCellRecordFingerprintDependent> _Nullable _fingerprintDependent;
+    NSHashTable<id<FSQCellRecordFingerprintDependent>> *_Nullable _additionalFingerprintDependents;
 }
 
 @synthesize userInfo = _userInfo;
@@ -41,6 +56,66 @@ NS_ASSUME_NONNULL_BEGIN
     return self;
 }
 
+- (void)freeze {
+    // Compute the fingerprint now, so that it is never lazily written while the record is being read on other threads
+    [self fingerprint];
+    _frozen = YES;
+}
+
+- (void)willModify {
+    if (_frozen) {
+        @throw ([NSException exceptionWithName:NSInternalInconsistencyException
+                                        reason:@"A frozen FSQCellRecord cannot be modified"
+                                      userInfo:nil]);
+    }
+    
+    if (_fingerprintIsValid) {
+        _fingerprintIsValid = NO;
+        
+        [_fingerprintDependent cellRecordFingerprintDidChange];
+        for (id<FSQCellRecordFingerprintDependent> dependent in _additionalFingerprintDependents) {
+            [dependent cellRecordFingerprintDidChange];
+        }
+        _fingerprintDependent = nil;
+        _additionalFingerprintDependents = nil;
+    }
+}
+
+- (void)setModel:(id)model {
+    [self willModify];
+    _model = model;
+}
+
+- (void)setCellClass:(Class)cellClass {
+    [self willModify];
+    _cellClass = cellClass;
+}
+
+- (void)setOnConfigure:(nullable FSQCellRecordConfigBlock)onConfigure {
+    [self willModify];
+    _onConfigure = [onConfigure copy];
+}
+
+- (void)setOnSelection:(nullable FSQCellRecordSelectBlock)onSelection {
+    [self willModify];
+    _onSelection = [onSelection copy];
+}
+
+- (void)setOnPrefetch:(nullable FSQCellRecordPrefetchBlock)onPrefetch {
+    [self willModify];
+    _onPrefetch = [onPrefetch copy];
+}
+
+- (void)setOnCancelPrefetch:(nullable FSQCellRecordPrefetchBlock)onCancelPrefetch {
+    [self willModify];
+    _onCancelPrefetch = [onCancelPrefetch copy];
+}
+
+- (void)setReuseIdentifier:(NSString *)reuseIdentifier {
+    [self willModify];
+    _reuseIdentifier = [reuseIdentifier copy];
+}
+
 - (NSString *)reuseIdentifier {
     if (!_reuseIdentifier && _cellClass) {
         return NSStringFromClass(_cellClass);
@@ -51,6 +126,7 @@ NS_ASSUME_NONNULL_BEGIN
 }
 
 - (void)setAllowsHighlighting:(BOOL)allowsHighlighting {
+    [self willModify];
     _allowsHighlighting = @(allowsHighlighting);
 }
 
@@ -63,11 +139,16 @@ NS_ASSUME_NONNULL_BEGIN
     }
 }
 
+- (nullable NSString *)explicitReuseIdentifier {
+    return _reuseIdentifier;
+}
+
 - (BOOL)allowsHighlightingWasSet {
     return (_allowsHighlighting != nil);
 }
 
 - (void)setAllowsSelection:(BOOL)allowsSelection {
+    [self willModify];
     _allowsSelection = @(allowsSelection);
 }
 
@@ -84,6 +165,10 @@ NS_ASSUME_NONNULL_BEGIN
     return (_allowsSelection != nil);
 }
 
+- (BOOL)hasModel {
+    return (_model && ![_model isKindOfClass:[FSQNullCellModel class]]);
+}
+
 - (BOOL)isEqual:(id)object {
     return [self isEqualToCellRecord:object];
 }
@@ -97,19 +182,80 @@ NS_ASSUME_NONNULL_BEGIN
         return NO;
     }
     
+    if ([self fingerprint] != [anotherCellRecord fingerprint]) {
+        return NO;
+    }
+    
     return (([self.model isEqual:anotherCellRecord.model] || (!self.model && !anotherCellRecord.model))
             && (self.cellClass == anotherCellRecord.cellClass || (!self.cellClass && !anotherCellRecord.cellClass))
             && ([self.reuseIdentifier isEqualToString:anotherCellRecord.reuseIdentifier] || (!self.reuseIdentifier && !anotherCellRecord.reuseIdentifier))
             && (!!self.onConfigure == !!anotherCellRecord.onConfigure)
             && (!!self.onSelection == !!anotherCellRecord.onSelection)
+            && (!!self.onPrefetch == !!anotherCellRecord.onPrefetch)
+            && (!!self.onCancelPrefetch == !!anotherCellRecord.onCancelPrefetch)
             && ([_userInfo isEqualToDictionary:anotherCellRecord->_userInfo] || (!_userInfo && !anotherCellRecord->_userInfo))
             && (self.allowsHighlighting == anotherCellRecord.allowsHighlighting)
-            && (self.allowsSelection == anotherCellRecord.allowsHighlighting)
+            && (self.allowsSelection == anotherCellRecord.allowsSelection)
             );
 }
 
+- (NSUInteger)hash {
+    // The model's hash is rotated so models and classes with similar hashes don't cancel out.
+    // It is not cached, since the model can be modified without the record knowing.
+    NSUInteger modelHash = [_model hash];
+    return ((modelHash << 7) | (modelHash >> ((sizeof(NSUInteger) * CHAR_BIT) - 7))) ^ [_cellClass hash];
+}
+
+#pragma mark - Fingerprints
+
+// These methods are exposed for internal use of other FSQCellManifest files only.
+// A fingerprint mixes together everything isEqualToCellRecord: compares except the model and userInfo, which can both
+// change without the record knowing. Equal records always have equal fingerprints, so records with different
+// fingerprints can be told apart without comparing their models. It is computed on first use and cached until a
+// property is set, at which point the record's dependents are told that it changed.
+
+- (void)addFingerprintDependent:(id<FSQCellRecordFingerprintDependent>)dependent {
+    if (_frozen) {
+        // The fingerprint can never change
+        return;
+    }
+    
+    id<FSQCellRecordFingerprintDependent> currentDependent = _fingerprintDependent;
+    if (!currentDependent || currentDependent == dependent) {
+        _fingerprintDependent = dependent;
+        return;
+    }
+    
+    if (!_additionalFingerprintDependents) {
+        _additionalFingerprintDependents = [NSHashTable weakObjectsHashTable];
+    }
+    [_additionalFingerprintDependents addObject:dependent];
+}
+
+- (NSUInteger)fingerprint {
+    if (!_fingerprintIsValid) {
+        NSUInteger fingerprint = [_cellClass hash];
+        fingerprint ^= [self.reuseIdentifier hash] * 31;
+        fingerprint ^= ((self.allowsHighlighting ? 0x1 : 0x0)
+                        | (self.allowsSelection ? 0x2 : 0x0)
+                        | (_onConfigure ? 0x4 : 0x0)
+                        | (_onSelection ? 0x8 : 0x0)
+                        | (_onPrefetch ? 0x10 : 0x0)
+                        | (_onCancelPrefetch ? 0x20 : 0x0));
+        
+        _fingerprint = fingerprint;
+        _fingerprintIsValid = YES;
+    }
+    
+    return _fingerprint;
+}
+
 - (NSMutableDictionary *)userInfo {
     if (!_userInfo) {
+        if (_frozen) {
+            // Lazily creating the dictionary would modify the record, which may be in use on another thread
+            return [[NSMutableDictionary alloc] init];
+        }
         _userInfo = [[NSMutableDictionary alloc] init];
     }
     
@@ -4,7 +4,11 @@
 //  Copyright (c) 2015 Foursquare. All rights reserved.
 //
 
+#if __has_include(<UIKit/UIKit.h>)
 #import <UIKit/UIKit.h>
+#else
+#import <Foundation/Foundation.h>
+#endif
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -50,11 +54,15 @@ NS_ASSUME_NONNULL_BEGIN
  
  If not set, collectionViewLayout.sectionInset will be used.
  */
+#if __has_include(<UIKit/UIKit.h>)
 @property (nonatomic) UIEdgeInsets collectionViewSectionInset;
+#endif
 
 /**
  This contents of this dictionary are not used internally by the manifest classes.
  You can use it to attach arbitrary data to the cell record for your own later use.
+ 
+ @warning Do not modify this dictionary once the record is frozen.
  */
 @property (nonatomic, readonly) NSMutableDictionary *userInfo;
 
@@ -83,6 +91,23 @@ NS_ASSUME_NONNULL_BEGIN
                              header:(nullable FSQCellRecord *)header
                              footer:(nullable FSQCellRecord *)footer;
 
+/**
+ YES once freeze has been called.
+ */
+@property (nonatomic, readonly, getter=isFrozen) BOOL frozen;
+
+/**
+ Makes this section record, its header and footer, and all of its cell records immutable. Setting any of their
+ properties afterwards raises an NSInternalInconsistencyException.
+ 
+ A frozen section record can be read from any thread, so sections can be built and frozen on a background queue and
+ then installed with FSQCellManifest's commitFrozenSectionRecords: on the main thread. The manifest never modifies
+ a frozen section record in place.
+ 
+ Freezing a section record more than once does nothing.
+ */
+- (void)freeze;
+
 /**
  Used to determine if two records are equivalent.
  
@@ -92,6 +117,14 @@ NS_ASSUME_NONNULL_BEGIN
  * They have the same collection view insets or both have none.
  * Their userInfo dictionaries are the same according to isEqualToDictionary:
  
+ Each section caches a fingerprint of its contents, computed from its cell records' fingerprints the first time it is
+ compared with a section that has different cell record storage. Sections whose fingerprints differ are known to be
+ different in constant time. The cached fingerprint is kept until the section is modified, or until one of its own
+ cell records is modified. Frozen sections never need to recompute it.
+ 
+ Sections whose fingerprints match still compare their cell records, but storage shared with a section the manifest
+ modified (see FSQCellManifestCore) is only compared where it differs.
+ 
  @param anotherSectionRecord Another FSQSectionRecord to compare with.
  
  @return YES if the records appear to be equivalent. NO if they do not.
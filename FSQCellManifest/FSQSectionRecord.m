@@ -6,12 +6,53 @@
 
 #import "FSQSectionRecord.h"
 
+#import "FSQCellManifestChunkedArray.h"
+#import "FSQCellManifestPagedArray.h"
 #import "FSQCellRecord.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
+// Sections with at least this many records switch to chunked storage the first time the manifest modifies them
+static const NSUInteger kFSQSectionRecordChunkedStorageThreshold = 512;
+
+// Also declared in FSQCellRecord.m
+@protocol FSQCellRecordFingerprintDependent <NSObject>
+
+- (void)cellRecordFingerprintDidChange;
+
+@end
+
+// These methods all already exist in FSQCellRecord.m but are not exposed.
+// They are for internal use only and should not be used outside of the framework
+@interface FSQCellRecord (FSQSectionRecordPrivateMethods)
+
+- (NSUInteger)fingerprint;
+- (void)addFingerprintDependent:(id<FSQCellRecordFingerprintDependent>)dependent;
+
+@end
+
+/**
+ A section's cached fingerprint. It is shared with the section's snapshots, which have the same records, and is
+ invalidated by any of those records when they are modified.
+ */
+@interface FSQSectionRecordFingerprint : NSObject <FSQCellRecordFingerprintDependent> {
+    @public
+    NSUInteger _value;
+    BOOL _isValid;
+}
+@end
+
+@implementation FSQSectionRecordFingerprint
+
+- (void)cellRecordFingerprintDidChange {
+    _isValid = NO;
+}
+
+@end
+
 @implementation FSQSectionRecord {
     NSValue *_Nullable _collectionViewSectionInsetPrivate;
+    FSQSectionRecordFingerprint *_Nullable _fingerprint;
 }
 
 @synthesize cellRecords = _cellRecords, userInfo = _userInfo;
@@ -45,7 +86,51 @@ NS_ASSUME_NONNULL_BEGIN
     return [_cellRecords countByEnumeratingWithState:state objects:buffer count:len];
 }
 
+- (void)freeze {
+    if (_frozen) {
+        return;
+    }
+    
+    [_header freeze];
+    [_footer freeze];
+    for (FSQCellRecord *cellRecord in _cellRecords) {
+        [cellRecord freeze];
+    }
+    
+    // Compute the fingerprint now, so that it is never lazily written while the record is being read on other threads
+    [self fingerprint];
+    _frozen = YES;
+}
+
+- (void)willModify {
+    if (_frozen) {
+        @throw ([NSException exceptionWithName:NSInternalInconsistencyException
+                                        reason:@"A frozen FSQSectionRecord cannot be modified"
+                                      userInfo:nil]);
+    }
+    
+    // Snapshots sharing the old fingerprint still have the old contents, so they keep it
+    _fingerprint = nil;
+}
+
+- (void)setHeader:(nullable FSQCellRecord *)header {
+    [self willModify];
+    _header = header;
+}
+
+- (void)setFooter:(nullable FSQCellRecord *)footer {
+    [self willModify];
+    _footer = footer;
+}
+
+- (void)setCellRecords:(nullable NSArray<FSQCellRecord *> *)cellRecords {
+    [self willModify];
+    _cellRecords = [cellRecords copy];
+}
+
+#if __has_include(<UIKit/UIKit.h>)
 - (void)setCollectionViewSectionInset:(UIEdgeInsets)collectionViewSectionInset {
+    [self willModify];
     _collectionViewSectionInsetPrivate = [NSValue valueWithUIEdgeInsets:collectionViewSectionInset];
 }
 
@@ -57,9 +142,14 @@ NS_ASSUME_NONNULL_BEGIN
         return UIEdgeInsetsZero;
     }
 }
+#endif
 
 - (NSMutableDictionary *)userInfo {
     if (!_userInfo) {
+        if (_frozen) {
+            // Lazily creating the dictionary would modify the record, which may be in use on another thread
+            return [[NSMutableDictionary alloc] init];
+        }
         _userInfo = [[NSMutableDictionary alloc] init];
     }
     
@@ -80,15 +170,53 @@ NS_ASSUME_NONNULL_BEGIN
         return NO;
     }
     
+    // Sections sharing the same storage are cheap to compare directly, and their fingerprints may not be computed yet
+    if (_cellRecords != anotherSectionRecord->_cellRecords
+        && [self fingerprint] != [anotherSectionRecord fingerprint]) {
+        return NO;
+    }
+    
+    // Everything else is cheaper to compare than the cell records, so it goes first
     return (
-            ([_cellRecords isEqualToArray:anotherSectionRecord->_cellRecords] || (!_cellRecords && !anotherSectionRecord->_cellRecords))
-            && ([self.header isEqualToCellRecord:anotherSectionRecord.header] || (!self.header && !anotherSectionRecord.header))
+            ([self.header isEqualToCellRecord:anotherSectionRecord.header] || (!self.header && !anotherSectionRecord.header))
             && ([self.footer isEqualToCellRecord:anotherSectionRecord.footer] || (!self.footer && !anotherSectionRecord.footer))
             && ([_collectionViewSectionInsetPrivate isEqualToValue:anotherSectionRecord->_collectionViewSectionInsetPrivate] || (!_collectionViewSectionInsetPrivate && !anotherSectionRecord->_collectionViewSectionInsetPrivate))
             && ([_userInfo isEqualToDictionary:anotherSectionRecord->_userInfo] || (!_userInfo && !anotherSectionRecord->_userInfo))
+            && [self cellRecordsAreEqualToCellRecordsOfSectionRecord:anotherSectionRecord]
             );
 }
 
+- (BOOL)cellRecordsAreEqualToCellRecordsOfSectionRecord:(FSQSectionRecord *)anotherSectionRecord {
+    NSArray<FSQCellRecord *> *cellRecords = _cellRecords;
+    NSArray<FSQCellRecord *> *anotherCellRecords = anotherSectionRecord->_cellRecords;
+    if (cellRecords == anotherCellRecords) {
+        return YES;
+    }
+    
+    // Lazy storage is compared without creating any of its records
+    BOOL isPaged = [cellRecords isKindOfClass:[FSQCellManifestPagedArray class]];
+    BOOL anotherIsPaged = [anotherCellRecords isKindOfClass:[FSQCellManifestPagedArray class]];
+    if (isPaged && anotherIsPaged) {
+        return [(FSQCellManifestPagedArray *)cellRecords isEqualToPagedArray:(FSQCellManifestPagedArray *)anotherCellRecords];
+    }
+    else if (isPaged || anotherIsPaged) {
+        return NO;
+    }
+    
+    // Storage modified by the manifest shares every chunk that did not change, and only the rest is compared
+    if ([cellRecords isKindOfClass:[FSQCellManifestChunkedArray class]]
+        && [anotherCellRecords isKindOfClass:[FSQCellManifestChunkedArray class]]) {
+        return [(FSQCellManifestChunkedArray *)cellRecords isEqualToChunkedArray:(FSQCellManifestChunkedArray *)anotherCellRecords];
+    }
+    
+    return ([cellRecords isEqualToArray:anotherCellRecords] || (!cellRecords && !anotherCellRecords));
+}
+
+- (NSUInteger)hash {
+    // Hashing every cell record would make this O(n), so only the count and the supplementary records are used.
+    return ([_cellRecords count] * 31) ^ [_header hash] ^ ([_footer hash] << 1);
+}
+
 - (NSArray<FSQCellRecord *> *)cellRecords {
     if (_cellRecords) {
         return _cellRecords;
@@ -103,6 +231,140 @@ NS_ASSUME_NONNULL_BEGIN
     return _collectionViewSectionInsetPrivate;
 }
 
+#pragma mark - Fingerprints
+
+// A section's fingerprint combines its cell records' fingerprints in order with those of its header and footer and
+// its insets. Equal sections always have equal fingerprints, so comparing two sections with different fingerprints
+// does not need to walk their cell records.
+// The cached fingerprint is thrown away when the section is modified, or when any of the records it was computed from
+// is modified. Each of those records holds a weak reference to it, so modifying a record only affects the sections
+// that contain it. Frozen records can never change, so they are not asked to keep a reference.
+// Lazy storage only contributes its count and page cache, which is all that equal lazy storage must have in common,
+// so that computing the fingerprint never creates any records.
+
+- (NSUInteger)fingerprint {
+    FSQSectionRecordFingerprint *cachedFingerprint = _fingerprint;
+    if (cachedFingerprint && cachedFingerprint->_isValid) {
+        return cachedFingerprint->_value;
+    }
+    
+    cachedFingerprint = [FSQSectionRecordFingerprint new];
+    
+    NSUInteger fingerprint = [_cellRecords count];
+    if ([_cellRecords isKindOfClass:[FSQCellManifestPagedArray class]]) {
+        fingerprint = (fingerprint * 31) + [[(FSQCellManifestPagedArray *)_cellRecords pageCache] hash];
+    }
+    else {
+        for (FSQCellRecord *cellRecord in _cellRecords) {
+            fingerprint = (fingerprint * 31) + [cellRecord fingerprint];
+            [cellRecord addFingerprintDependent:cachedFingerprint];
+        }
+    }
+    fingerprint ^= ([_header fingerprint] * 17) ^ ([_footer fingerprint] * 13);
+    [_header addFingerprintDependent:cachedFingerprint];
+    [_footer addFingerprintDependent:cachedFingerprint];
+    fingerprint ^= [_collectionViewSectionInsetPrivate hash];
+    
+    cachedFingerprint->_value = fingerprint;
+    cachedFingerprint->_isValid = YES;
+    _fingerprint = cachedFingerprint;
+    return fingerprint;
+}
+
+#pragma mark - Internal Mutation
+
+// These methods are exposed for internal use of other FSQCellManifest files only.
+// Small sections are copied and modified as regular arrays. Large sections use FSQCellManifestChunkedArray,
+// which only copies the chunks that actually change, so each modification is O(log n) instead of O(n).
+// Storage that already knows how to make modified copies of itself (such as the lazy storage of
+// FSQVirtualSectionRecord) is always modified that way, so it never has to be fully materialized.
+
+- (nullable NSArray<FSQCellRecord *><FSQCellManifestPersistentArray> *)persistentCellRecordsForCount:(NSUInteger)count {
+    if ([_cellRecords conformsToProtocol:@protocol(FSQCellManifestPersistentArray)]) {
+        return (NSArray<FSQCellRecord *><FSQCellManifestPersistentArray> *)_cellRecords;
+    }
+    else if (count >= kFSQSectionRecordChunkedStorageThreshold) {
+        return [[FSQCellManifestChunkedArray alloc] initWithArray:self.cellRecords];
+    }
+    else {
+        return nil;
+    }
+}
+
+- (void)insertCellRecords:(NSArray<FSQCellRecord *> *)cellRecords atIndex:(NSUInteger)index {
+    [self willModify];
+    
+    NSArray<FSQCellManifestPersistentArray> *persistentCellRecords = [self persistentCellRecordsForCount:([_cellRecords count] + [cellRecords count])];
+    if (persistentCellRecords) {
+        _cellRecords = [persistentCellRecords arrayByInsertingObjects:cellRecords atIndex:index];
+    }
+    else {
+        NSMutableArray<FSQCellRecord *> *mutableCellRecords = [self.cellRecords mutableCopy];
+        [mutableCellRecords insertObjects:cellRecords atIndexes:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(index, [cellRecords count])]];
+        _cellRecords = [mutableCellRecords copy];
+    }
+}
+
+- (void)removeCellRecordsAtIndexes:(NSIndexSet *)indexes {
+    [self willModify];
+    
+    NSArray<FSQCellManifestPersistentArray> *persistentCellRecords = [self persistentCellRecordsForCount:[_cellRecords count]];
+    if (persistentCellRecords) {
+        _cellRecords = [persistentCellRecords arrayByRemovingObjectsAtIndexes:indexes];
+    }
+    else {
+        NSMutableArray<FSQCellRecord *> *mutableCellRecords = [self.cellRecords mutableCopy];
+        [mutableCellRecords removeObjectsAtIndexes:indexes];
+        _cellRecords = [mutableCellRecords copy];
+    }
+}
+
+- (void)replaceCellRecordsAtIndexes:(NSIndexSet *)indexes withCellRecords:(NSArray<FSQCellRecord *> *)cellRecords {
+    NSParameterAssert([indexes count] == [cellRecords count]);
+    
+    [self willModify];
+    
+    NSArray<FSQCellManifestPersistentArray> *persistentCellRecords = [self persistentCellRecordsForCount:[_cellRecords count]];
+    __block NSUInteger replacementIndex = 0;
+    if (persistentCellRecords) {
+        __block NSArray<FSQCellManifestPersistentArray> *newCellRecords = persistentCellRecords;
+        [indexes enumerateIndexesUsingBlock:^(NSUInteger idx, BOOL *stop) {
+            // Persistent arrays return more persistent arrays
+            newCellRecords = (NSArray<FSQCellManifestPersistentArray> *)[newCellRecords arrayByReplacingObjectAtIndex:idx withObject:cellRecords[replacementIndex++]];
+        }];
+        _cellRecords = newCellRecords;
+    }
+    else {
+        // One copy however many records are replaced
+        NSMutableArray<FSQCellRecord *> *mutableCellRecords = [self.cellRecords mutableCopy];
+        [indexes enumerateIndexesUsingBlock:^(NSUInteger idx, BOOL *stop) {
+            mutableCellRecords[idx] = cellRecords[replacementIndex++];
+        }];
+        _cellRecords = [mutableCellRecords copy];
+    }
+}
+
+- (void)enumerateMaterializedCellRecordsUsingBlock:(void (^)(FSQCellRecord *cellRecord, NSUInteger index, BOOL *stop))block {
+    if ([_cellRecords isKindOfClass:[FSQCellManifestPagedArray class]]) {
+        [(FSQCellManifestPagedArray<FSQCellRecord *> *)_cellRecords enumerateMaterializedObjectsUsingBlock:block];
+    }
+    else {
+        [_cellRecords enumerateObjectsUsingBlock:block];
+    }
+}
+
+- (FSQSectionRecord *)copyForSnapshot {
+    // Cell record arrays are immutable, so the copy can share them.
+    // The userInfo dictionary is mutable, so sharing it would let changes to the live section leak into the snapshot.
+    FSQSectionRecord *copy = [[[self class] alloc] initWithCellRecords:_cellRecords header:self.header footer:self.footer];
+    copy->_collectionViewSectionInsetPrivate = _collectionViewSectionInsetPrivate;
+    copy->_userInfo = [_userInfo mutableCopy];
+    
+    // The copy has the same records, so it shares the fingerprint until one of them is modified
+    copy->_fingerprint = _fingerprint;
+    return copy;
+}
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -0,0 +1,86 @@
+//
+//  FSQVirtualSectionRecord.h
+//
+//  Copyright (c) 2015 Foursquare. All rights reserved.
+//
+
+#import "FSQSectionRecord.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ A section record whose cell records are created on demand a page at a time, instead of all up front.
+ 
+ numberOfCellRecords comes from the count passed in when the section is created. cellRecordAtIndex:, fast enumeration
+ and the cellRecords array only ask the page provider for the pages they actually touch, so a section with a very
+ large number of rows costs next to nothing until it is displayed.
+ 
+ Pages that were created are kept in a least recently used cache of about materializedCellRecordLimit records.
+ Records from a page that was thrown away are handed out again for as long as anything else (such as a visible cell)
+ still holds on to them, so a record keeps its identity while it is in use. Once they have all been deallocated, the
+ page is created again by calling the page provider, so it should always return records that are equal according to
+ isEqualToCellRecord: for the same index. Anything stored in the userInfo of a created record, and any size the
+ manifest cached for it, is lost once the record is deallocated.
+ 
+ The manifest's insertion, removal and replacement methods work as usual on a virtual section. Records you insert are
+ kept as they are and the rest of the section stays lazy. The manifest never goes through every page on its own:
+ size precomputation, prewarming and size invalidation only look at the records that currently exist, and the
+ estimated height of every other row is the fallback estimate.
+ 
+ Virtual sections are compared without creating any records. Lazy records are only equal to the records at the same
+ index of a section sharing the same page provider (such as the manifest's own snapshots and modified copies), so
+ setSectionRecords:animated: only diffs the rows of a virtual section against a modified copy of the same section,
+ and reloads it as a whole otherwise.
+ 
+ The count is fixed when the section is created, because it has to match what the managed view was told. To change
+ it, use the manifest's insertion and removal methods, or replace the section with a new one.
+ 
+ Virtual sections are not thread safe, and the page provider is only called on the main thread. For the same reason
+ they cannot be frozen, and freeze raises an NSInternalInconsistencyException.
+ 
+ @note Setting cellRecords replaces the lazy records with the given array, and the section behaves like a regular
+ FSQSectionRecord from then on.
+ */
+@interface FSQVirtualSectionRecord : FSQSectionRecord
+
+/**
+ @param count        The number of cell records in the section.
+ @param pageSize     How many records to ask the page provider for at once. Must be greater than 0.
+ @param pageProvider A block returning exactly range.length cell records for the indexes in range. The indexes are
+                     those of the section as it was created, and do not change when records are inserted or removed.
+ @param header       See header property description.
+ @param footer       See footer property description.
+ 
+ @return A new FSQVirtualSectionRecord.
+ */
+- (instancetype)initWithCount:(NSUInteger)count
+                     pageSize:(NSUInteger)pageSize
+                 pageProvider:(NSArray<FSQCellRecord *> *(^)(NSRange range))pageProvider
+                       header:(nullable FSQCellRecord *)header
+                       footer:(nullable FSQCellRecord *)footer;
+
+/**
+ The maximum number of created records to keep, rounded up to a whole page. The most recently used page is always
+ kept, even if it is larger than this.
+ 
+ This limit is shared with every snapshot and modified copy of the section made by the manifest.
+ 
+ Defaults to 1000. Always 0 once cellRecords has been set.
+ */
+@property (nonatomic) NSUInteger materializedCellRecordLimit;
+
+/**
+ The number of created records currently kept.
+ */
+@property (nonatomic, readonly) NSUInteger materializedCellRecordCount;
+
+/**
+ Throws away every created record that is not in use elsewhere. They will be created again as they are needed.
+ 
+ You may want to call this when receiving a memory warning.
+ */
+- (void)discardMaterializedCellRecords;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,63 @@
+//
+//  FSQVirtualSectionRecord.m
+//
+//  Copyright (c) 2015 Foursquare. All rights reserved.
+//
+
+#import "FSQVirtualSectionRecord.h"
+
+#import "FSQCellManifestPagedArray.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+static const NSUInteger kFSQVirtualSectionRecordDefaultMaterializedCellRecordLimit = 1000;
+
+@implementation FSQVirtualSectionRecord
+
+- (instancetype)initWithCount:(NSUInteger)count
+                     pageSize:(NSUInteger)pageSize
+                 pageProvider:(NSArray<FSQCellRecord *> *(^)(NSRange range))pageProvider
+                       header:(nullable FSQCellRecord *)header
+                       footer:(nullable FSQCellRecord *)footer {
+    FSQCellManifestPageCache *pageCache = [[FSQCellManifestPageCache alloc] initWithCount:count pageSize:pageSize pageProvider:pageProvider];
+    pageCache.materializedObjectLimit = kFSQVirtualSectionRecordDefaultMaterializedCellRecordLimit;
+    
+    // The paged array's copy is itself, so the superclass stores it as is
+    return [self initWithCellRecords:[[FSQCellManifestPagedArray alloc] initWithPageCache:pageCache] header:header footer:footer];
+}
+
+- (void)freeze {
+    @throw ([NSException exceptionWithName:NSInternalInconsistencyException
+                                    reason:@"FSQVirtualSectionRecord creates its cell records on the main thread and cannot be frozen"
+                                  userInfo:nil]);
+}
+
+- (nullable FSQCellManifestPageCache *)pageCache {
+    NSArray<FSQCellRecord *> *cellRecords = self.cellRecords;
+    if ([cellRecords isKindOfClass:[FSQCellManifestPagedArray class]]) {
+        return [(FSQCellManifestPagedArray *)cellRecords pageCache];
+    }
+    else {
+        return nil;
+    }
+}
+
+- (NSUInteger)materializedCellRecordLimit {
+    return [self pageCache].materializedObjectLimit;
+}
+
+- (void)setMaterializedCellRecordLimit:(NSUInteger)materializedCellRecordLimit {
+    [self pageCache].materializedObjectLimit = materializedCellRecordLimit;
+}
+
+- (NSUInteger)materializedCellRecordCount {
+    return [self pageCache].materializedObjectCount;
+}
+
+- (void)discardMaterializedCellRecords {
+    [[self pageCache] discardAllPages];
+}
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,99 @@
+//
+//  FSQBenchmarkAllocations.c
+//  FSQCellManifestBenchmarks
+//
+//  Copyright (c) 2015 Foursquare. All rights reserved.
+//
+
+#include "FSQBenchmarkAllocations.h"
+
+#include <stddef.h>
+#include <sys/resource.h>
+#include <time.h>
+
+static uint64_t FSQBenchmarkAllocations = 0;
+
+static inline void FSQBenchmarkCountAllocation(void) {
+    __atomic_fetch_add(&FSQBenchmarkAllocations, 1, __ATOMIC_RELAXED);
+}
+
+#if defined(__APPLE__)
+
+#include <malloc/malloc.h>
+
+// libmalloc's logging hook, which is what malloc stack logging uses. It is called after every allocation and before
+// every free in every malloc zone. The type values are from libmalloc's stack_logging.h.
+typedef void (FSQBenchmarkMallocLogger)(uint32_t type, uintptr_t arg1, uintptr_t arg2, uintptr_t arg3, uintptr_t result, uint32_t numberOfFramesToSkip);
+extern FSQBenchmarkMallocLogger *malloc_logger;
+
+static const uint32_t kFSQBenchmarkMallocLogTypeAllocate = 2;
+
+static void FSQBenchmarkLogMalloc(uint32_t type, uintptr_t arg1, uintptr_t arg2, uintptr_t arg3, uintptr_t result, uint32_t numberOfFramesToSkip) {
+    if (type & kFSQBenchmarkMallocLogTypeAllocate) {
+        FSQBenchmarkCountAllocation();
+    }
+}
+
+bool FSQBenchmarkStartCountingAllocations(void) {
+    malloc_logger = FSQBenchmarkLogMalloc;
+    return true;
+}
+
+#elif defined(__GLIBC__)
+
+// Defining these in the executable takes precedence over libc's own definitions for every library in the process,
+// including libobjc and Foundation. glibc exports the underlying implementations under these names.
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+void *malloc(size_t size) {
+    FSQBenchmarkCountAllocation();
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+    FSQBenchmarkCountAllocation();
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+    FSQBenchmarkCountAllocation();
+    return __libc_realloc(ptr, size);
+}
+
+bool FSQBenchmarkStartCountingAllocations(void) {
+    return true;
+}
+
+#else
+
+bool FSQBenchmarkStartCountingAllocations(void) {
+    return false;
+}
+
+#endif
+
+uint64_t FSQBenchmarkAllocationCount(void) {
+    return __atomic_load_n(&FSQBenchmarkAllocations, __ATOMIC_RELAXED);
+}
+
+uint64_t FSQBenchmarkPeakResidentBytes(void) {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+
+#if defined(__APPLE__)
+    // Darwin reports bytes, everyone else reports kilobytes
+    return (uint64_t)usage.ru_maxrss;
+#else
+    return (uint64_t)usage.ru_maxrss * 1024;
+#endif
+}
+
+uint64_t FSQBenchmarkNanoseconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
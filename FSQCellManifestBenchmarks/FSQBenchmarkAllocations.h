@@ -0,0 +1,39 @@
+//
+//  FSQBenchmarkAllocations.h
+//  FSQCellManifestBenchmarks
+//
+//  Copyright (c) 2015 Foursquare. All rights reserved.
+//
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ Heap allocation counting and peak memory for the benchmarks.
+ 
+ On Linux with glibc, the benchmark tool defines malloc, calloc and realloc itself and counts each call before passing
+ it on to glibc. On Darwin it installs a malloc logger, which libmalloc calls for every allocation in every zone.
+ Aligned allocations are not counted. Counting is not available on other platforms.
+ */
+
+/**
+ Must be called once before any allocations are counted.
+ 
+ @return false if allocations cannot be counted on this platform.
+ */
+bool FSQBenchmarkStartCountingAllocations(void);
+
+/**
+ The number of heap allocations made so far by every thread.
+ */
+uint64_t FSQBenchmarkAllocationCount(void);
+
+/**
+ The most memory the process has had resident at any one time, in bytes.
+ */
+uint64_t FSQBenchmarkPeakResidentBytes(void);
+
+/**
+ A monotonic clock, in nanoseconds.
+ */
+uint64_t FSQBenchmarkNanoseconds(void);
@@ -0,0 +1,58 @@
+//
+//  FSQBenchmarkCellManifest.h
+//  FSQCellManifestBenchmarks
+//
+//  Copyright (c) 2015 Foursquare. All rights reserved.
+//
+
+#import "FSQCellManifestCore.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class FSQCellManifestChangeset;
+
+/**
+ Stands in for a UITableView or UICollectionView in the benchmarks.
+ 
+ It does not display anything, it only records the updates the manifest asks it to apply. Like a real managed view it
+ asks the manifest for its section and row counts again whenever it is reloaded.
+ */
+@interface FSQBenchmarkManagedView : NSObject
+
+@property (nonatomic, readonly) NSUInteger numberOfReloads;
+@property (nonatomic, readonly) NSUInteger numberOfBatchUpdates;
+@property (nonatomic, readonly) NSUInteger numberOfUpdatedSections;
+@property (nonatomic, readonly) NSUInteger numberOfUpdatedRows;
+
+/**
+ The number of rows the view had the last time it was reloaded.
+ */
+@property (nonatomic, readonly) NSInteger numberOfDisplayedRows;
+
+/**
+ Used as the "currently selected" index paths when the manifest maintains selection across a reload.
+ */
+@property (nonatomic, copy) NSArray<NSIndexPath *> *selectedIndexPaths;
+
+- (void)reloadData;
+- (void)updateSections:(nullable NSIndexSet *)sectionIndexes rows:(nullable NSArray<NSIndexPath *> *)indexPaths;
+- (void)applyChangeset:(FSQCellManifestChangeset *)changeset;
+
+@end
+
+/**
+ A manifest that passes every change on to an FSQBenchmarkManagedView, the same way FSQTableViewCellManifest and
+ FSQCollectionViewCellManifest pass them on to their views.
+ */
+@interface FSQBenchmarkCellManifest : FSQCellManifestCore
+
+@property (nonatomic, readonly) FSQBenchmarkManagedView *managedView;
+
+/**
+ Objects that receive delegate callbacks before the delegate does, like FSQCellManifest's plugins.
+ */
+@property (nonatomic, copy, nullable) NSArray *benchmarkPlugins;
+
+@end
+
+NS_ASSUME_NONNULL_END
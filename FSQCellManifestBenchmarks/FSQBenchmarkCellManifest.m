@@ -0,0 +1,221 @@
+//
+//  FSQBenchmarkCellManifest.m
+//  FSQCellManifestBenchmarks
+//
+//  Copyright (c) 2015 Foursquare. All rights reserved.
+//
+
+#import "FSQBenchmarkCellManifest.h"
+
+#import "FSQCellManifestChangeset.h"
+#import "FSQCellManifestCoreSubclass.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface FSQBenchmarkManagedView ()
+@property (nonatomic, weak) FSQCellManifestCore *manifest;
+@end
+
+@implementation FSQBenchmarkManagedView
+
+- (instancetype)init {
+    if ((self = [super init])) {
+        _selectedIndexPaths = @[];
+    }
+    return self;
+}
+
+- (void)reloadData {
+    ++_numberOfReloads;
+    
+    // A real view asks its data source for every section's count when it reloads
+    FSQCellManifestCore *manifest = self.manifest;
+    NSInteger numberOfRows = 0;
+    NSInteger numberOfSections = [manifest numberOfSectionRecords];
+    for (NSInteger sectionIndex = 0; sectionIndex < numberOfSections; ++sectionIndex) {
+        numberOfRows += [manifest numberOfCellRecordsInSectionAtIndex:sectionIndex];
+    }
+    _numberOfDisplayedRows = numberOfRows;
+}
+
+- (void)updateSections:(nullable NSIndexSet *)sectionIndexes rows:(nullable NSArray<NSIndexPath *> *)indexPaths {
+    ++_numberOfBatchUpdates;
+    _numberOfUpdatedSections += [sectionIndexes count];
+    _numberOfUpdatedRows += [indexPaths count];
+}
+
+- (void)applyChangeset:(FSQCellManifestChangeset *)changeset {
+    ++_numberOfBatchUpdates;
+    _numberOfUpdatedSections += ([changeset.deletedSectionIndexes count]
+                                 + [changeset.insertedSectionIndexes count]
+                                 + [changeset.reloadedSectionIndexes count]
+                                 + [changeset.movedSectionInitialIndexes count]);
+    _numberOfUpdatedRows += ([changeset.deletedIndexPaths count]
+                             + [changeset.insertedIndexPaths count]
+                             + [changeset.reloadedIndexPaths count]
+                             + [changeset.movedInitialIndexPaths count]);
+}
+
+@end
+
+@implementation FSQBenchmarkCellManifest
+
+- (instancetype)initWithDelegate:(nullable id)delegate {
+    if ((self = [super initWithDelegate:delegate])) {
+        _managedView = [FSQBenchmarkManagedView new];
+        _managedView.manifest = self;
+    }
+    return self;
+}
+
+- (nullable NSArray *)plugins {
+    return _benchmarkPlugins;
+}
+
+- (void)setBenchmarkPlugins:(nullable NSArray *)benchmarkPlugins {
+    _benchmarkPlugins = [benchmarkPlugins copy];
+    [self invalidateResponderLists];
+}
+
+- (void)reloadManagedView {
+    [super reloadManagedViewWithUpdates:^{
+        [self.managedView reloadData];
+    }];
+}
+
+- (void)reloadSectionsAtIndexes:(NSIndexSet *)indexes {
+    [super reloadSectionsAtIndexes:indexes managedViewUpdates:^(NSIndexSet *indexes) {
+        [self.managedView updateSections:indexes rows:nil];
+    }];
+}
+
+- (void)reloadCellsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths {
+    [super reloadCellsAtIndexPaths:indexPaths managedViewUpdates:^(NSArray<NSIndexPath *> *indexPaths) {
+        [self.managedView updateSections:nil rows:indexPaths];
+    }];
+}
+
+- (void)setSectionRecords:(nullable NSArray<FSQSectionRecord *> *)sectionRecords selectionStrategy:(FSQViewReloadCellSelectionStrategy)selectionStrategy {
+    NSSet *newIndexPathsToSelect = nil;
+    if (selectionStrategy == FSQViewReloadCellSelectionStrategyMaintainSelectedRecords) {
+        // Must be done before the records are replaced so "currently" selected paths line up
+        newIndexPathsToSelect = [self matchingIndexPathsForCurrentlySelectedIndexPaths:self.managedView.selectedIndexPaths
+                                                                     newSectionRecords:sectionRecords ?: @[]];
+    }
+    
+    [super replaceSectionRecords:sectionRecords
+               selectionStrategy:selectionStrategy
+              managedViewUpdates:^(NSArray *originalRecords) {
+                  FSQBenchmarkManagedView *managedView = self.managedView;
+                  [managedView reloadData];
+                  
+                  switch (selectionStrategy) {
+                      case FSQViewReloadCellSelectionStrategyDeselectAll:
+                          managedView.selectedIndexPaths = @[];
+                          break;
+                      case FSQViewReloadCellSelectionStrategyMaintainSelectedIndexPaths:
+                          break;
+                      case FSQViewReloadCellSelectionStrategyMaintainSelectedRecords:
+                          managedView.selectedIndexPaths = [newIndexPathsToSelect allObjects];
+                          break;
+                  }
+              }];
+}
+
+- (void)setSectionRecords:(nullable NSArray<FSQSectionRecord *> *)sectionRecords animated:(BOOL)animated {
+    [super applyChangesetToSectionRecords:sectionRecords
+                       managedViewUpdates:^(FSQCellManifestChangeset *changeset) {
+                           [self.managedView applyChangeset:changeset];
+                       }];
+}
+
+- (NSArray *)insertCellRecords:(NSArray *)cellRecordsToInsert atIndexPath:(NSIndexPath *)indexPath {
+    return [super insertCellRecords:cellRecordsToInsert
+                        atIndexPath:indexPath
+                 managedViewUpdates:^(NSArray *insertedIndexPaths) {
+                     [self.managedView updateSections:nil rows:insertedIndexPaths];
+                 }];
+}
+
+- (NSIndexSet *)insertSectionRecords:(NSArray *)sectionRecords atIndex:(NSInteger)index {
+    return [super insertSectionRecords:sectionRecords
+                               atIndex:index
+                    managedViewUpdates:^(NSIndexSet *insertedIndexes) {
+                        [self.managedView updateSections:insertedIndexes rows:nil];
+                    }];
+}
+
+- (BOOL)moveCellRecordAtIndexPath:(NSIndexPath *)initialIndexPath toIndexPath:(NSIndexPath *)targetIndexPath {
+    return [super moveCellRecordAtIndexPath:initialIndexPath
+                                toIndexPath:targetIndexPath
+                         managedViewUpdates:^{
+                             [self.managedView updateSections:nil rows:@[initialIndexPath, targetIndexPath]];
+                         }];
+}
+
+- (BOOL)moveSectionRecordAtIndex:(NSInteger)initialIndex toIndex:(NSInteger)targetIndex {
+    return [super moveSectionRecordAtIndex:initialIndex
+                                   toIndex:targetIndex
+                        managedViewUpdates:^{
+                            NSMutableIndexSet *sectionIndexes = [NSMutableIndexSet indexSetWithIndex:(NSUInteger)initialIndex];
+                            [sectionIndexes addIndex:(NSUInteger)targetIndex];
+                            [self.managedView updateSections:sectionIndexes rows:nil];
+                        }];
+}
+
+- (NSArray *)removeCellRecordsAtIndexPaths:(NSArray *)indexPaths removeEmptySections:(BOOL)shouldRemoveEmptySections {
+    return [super removeCellRecordsAtIndexPaths:indexPaths
+                            removeEmptySections:shouldRemoveEmptySections
+                             managedViewUpdates:^(NSArray *removedIndexPaths, NSIndexSet *removedSectionIndexes) {
+                                 [self.managedView updateSections:removedSectionIndexes rows:removedIndexPaths];
+                             }];
+}
+
+- (NSArray<NSIndexPath *> *)removeCellRecordsWithOptions:(NSEnumerationOptions)options
+                                             passingTest:(FSQCellRecordTestBlock)predicate
+                                     removeEmptySections:(BOOL)shouldRemoveEmptySections {
+    return [super removeCellRecordsWithOptions:options
+                                   passingTest:predicate
+                           removeEmptySections:shouldRemoveEmptySections
+                            managedViewUpdates:^(NSArray *removedIndexPaths, NSIndexSet *removedSectionIndexes) {
+                                [self.managedView updateSections:removedSectionIndexes rows:removedIndexPaths];
+                            }];
+}
+
+- (BOOL)removeSectionRecordsAtIndexes:(NSIndexSet *)indexes {
+    return [super removeSectionRecordsAtIndexes:indexes
+                             managedViewUpdates:^{
+                                 [self.managedView updateSections:indexes rows:nil];
+                             }];
+}
+
+- (void)replaceCellRecordsAtIndexPaths:(NSArray *)indexPaths withCellRecords:(NSArray *)newCellRecords {
+    [super replaceCellRecordsAtIndexPaths:indexPaths
+                          withCellRecords:newCellRecords
+                       managedViewUpdates:^(NSArray *replacedIndexPaths) {
+                           [self.managedView updateSections:nil rows:replacedIndexPaths];
+                       }];
+}
+
+- (NSArray<NSIndexPath *> *)replaceCellRecordsWithOptions:(NSEnumerationOptions)options
+                                              passingTest:(FSQCellRecordTestBlock)predicate
+                                                withBlock:(FSQCellRecordReplacementBlock)replacement {
+    return [super replaceCellRecordsWithOptions:options
+                                    passingTest:predicate
+                                      withBlock:replacement
+                             managedViewUpdates:^(NSArray *replacedIndexPaths) {
+                                 [self.managedView updateSections:nil rows:replacedIndexPaths];
+                             }];
+}
+
+- (NSIndexSet *)replaceSectionRecordsAtIndexes:(NSArray *)indexes withSectionRecords:(NSArray *)newSectionRecords {
+    return [super replaceSectionRecordsAtIndexes:indexes
+                              withSectionRecords:newSectionRecords
+                              managedViewUpdates:^(NSIndexSet *replacedIndexes) {
+                                  [self.managedView updateSections:replacedIndexes rows:nil];
+                              }];
+}
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,461 @@
+//
+//  main.m
+//  FSQCellManifestBenchmarks
+//
+//  Copyright (c) 2015 Foursquare. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+#import "FSQBenchmarkAllocations.h"
+#import "FSQBenchmarkCellManifest.h"
+#import "FSQCellManifestCoreSubclass.h"
+#import "FSQCellManifestIndexPaths.h"
+#import "FSQCellRecord.h"
+#import "FSQSectionRecord.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/*
+ Benchmarks for the record model of the manifest, driven through an FSQBenchmarkCellManifest over synthetic feeds.
+ 
+ usage: fsqcm-bench [--records 10000,100000,1000000] [--section-size 1000] [--benchmark name,...]
+ 
+ Every benchmark is run at every record count in its own process, so that each result's peak memory belongs to that
+ benchmark alone, and the results are printed to standard output as JSON. Each result has:
+ * opsPerSecond: how many times the operation was done per second. Operations include building their own arguments
+   (new records and index paths), like a caller would.
+ * allocationsPerOp: heap allocations per operation, or null if they cannot be counted on this platform.
+ * peakResidentBytes: the most memory the process had resident, including the feeds themselves.
+ * managedView: the updates the stand-in managed view was asked to apply, including the initial load.
+ 
+ Feeds have numberOfRecords cell records split into sections of sectionSize. Sections of 512 or more records use
+ chunked storage. The second feed used by some benchmarks has new but equal records, except for 1% that have changed.
+ The delegate callback benchmarks do not depend on the feed.
+ 
+ Dequeuing, configuring and sizing cells needs UIKit and a real table or collection view, so those costs are not
+ measured here. Attach an FSQCellManifestProfilerPlugin to a manifest in an app and compare its JSONRepresentation
+ between releases instead.
+ */
+
+typedef struct {
+    NSUInteger iterations;
+    uint64_t nanoseconds;
+    uint64_t allocations;
+} FSQBenchmarkMeasurement;
+
+typedef FSQBenchmarkMeasurement (^FSQBenchmarkBlock)(FSQBenchmarkCellManifest *manifest, NSUInteger numberOfRecords, NSUInteger sectionSize);
+
+static const uint64_t kFSQBenchmarkTargetNanoseconds = 1000000000ull;
+static const NSUInteger kFSQBenchmarkNumberOfSelectedIndexPaths = 100;
+static const NSUInteger kFSQBenchmarkIndexPathPoolSize = 4096;
+
+static uint64_t FSQBenchmarkRandomState = 0x9E3779B97F4A7C15ull;
+
+// xorshift64*, so that every run does exactly the same operations
+static NSInteger FSQBenchmarkRandom(NSInteger upperBound) {
+    uint64_t x = FSQBenchmarkRandomState;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    FSQBenchmarkRandomState = x;
+    return (NSInteger)((x * 0x2545F4914F6CDD1Dull) % (uint64_t)upperBound);
+}
+
+static FSQCellRecord *FSQBenchmarkCellRecord(id model) {
+    return [[FSQCellRecord alloc] initWithModel:model cellClass:[NSObject class] onConfigure:nil onSelection:nil];
+}
+
+static NSArray<FSQSectionRecord *> *FSQBenchmarkFeed(NSUInteger numberOfRecords, NSUInteger sectionSize, BOOL changed) {
+    NSMutableArray<FSQSectionRecord *> *sectionRecords = [NSMutableArray new];
+    
+    for (NSUInteger sectionStart = 0; sectionStart < numberOfRecords; sectionStart += sectionSize) {
+        NSUInteger sectionEnd = MIN(sectionStart + sectionSize, numberOfRecords);
+        NSMutableArray<FSQCellRecord *> *cellRecords = [[NSMutableArray alloc] initWithCapacity:(sectionEnd - sectionStart)];
+        for (NSUInteger recordIndex = sectionStart; recordIndex < sectionEnd; ++recordIndex) {
+            BOOL recordChanged = (changed && recordIndex % 100 == 0);
+            [cellRecords addObject:FSQBenchmarkCellRecord(recordChanged ? @(-(NSInteger)recordIndex - 1) : @(recordIndex))];
+        }
+        [sectionRecords addObject:[[FSQSectionRecord alloc] initWithCellRecords:cellRecords header:nil footer:nil]];
+    }
+    
+    return sectionRecords;
+}
+
+// Stands in for a plugin or delegate that handles a callback sent many times a second, like scrollViewDidScroll:
+@interface FSQBenchmarkScrollResponder : NSObject
+@property (nonatomic, readonly) NSUInteger numberOfCallbacks;
+- (void)benchmarkManifestDidScroll:(FSQCellManifestCore *)manifest;
+@end
+
+@implementation FSQBenchmarkScrollResponder
+
+- (void)benchmarkManifestDidScroll:(FSQCellManifestCore *)manifest {
+    ++_numberOfCallbacks;
+}
+
+@end
+
+// Half of the plugins handle the callback, and so does the delegate
+static void FSQBenchmarkAttachScrollResponders(FSQBenchmarkCellManifest *manifest, FSQBenchmarkScrollResponder *delegate) {
+    manifest.benchmarkPlugins = @[
+                                  [NSObject new],
+                                  [FSQBenchmarkScrollResponder new],
+                                  [NSObject new],
+                                  [FSQBenchmarkScrollResponder new],
+                                  ];
+    manifest.delegate = delegate;
+}
+
+// An index path of an existing record, or if includingEnd is YES, possibly one past the end of its section
+static NSIndexPath *FSQBenchmarkRandomIndexPath(FSQCellManifestCore *manifest, BOOL includingEnd) {
+    NSInteger numberOfSections = [manifest numberOfSectionRecords];
+    while (YES) {
+        NSInteger sectionIndex = FSQBenchmarkRandom(numberOfSections);
+        NSInteger numberOfRows = [manifest numberOfCellRecordsInSectionAtIndex:sectionIndex] + (includingEnd ? 1 : 0);
+        if (numberOfRows > 0) {
+            return FSQIndexPathMake(sectionIndex, FSQBenchmarkRandom(numberOfRows));
+        }
+    }
+}
+
+static FSQBenchmarkMeasurement FSQBenchmarkMeasure(NSUInteger maximumIterations, void (^operation)(NSUInteger iteration)) {
+    FSQBenchmarkMeasurement measurement = {0, 0, 0};
+    NSUInteger batchSize = 1;
+    
+    uint64_t allocationsBefore = FSQBenchmarkAllocationCount();
+    uint64_t start = FSQBenchmarkNanoseconds();
+    
+    // Operations run in batches that double in size, so that cheap ones are not dominated by reading the clock
+    while (measurement.nanoseconds < kFSQBenchmarkTargetNanoseconds && measurement.iterations < maximumIterations) {
+        NSUInteger batchEnd = MIN(measurement.iterations + batchSize, maximumIterations);
+        @autoreleasepool {
+            for (NSUInteger iteration = measurement.iterations; iteration < batchEnd; ++iteration) {
+                operation(iteration);
+            }
+        }
+        measurement.iterations = batchEnd;
+        measurement.nanoseconds = FSQBenchmarkNanoseconds() - start;
+        batchSize *= 2;
+    }
+    
+    measurement.allocations = FSQBenchmarkAllocationCount() - allocationsBefore;
+    return measurement;
+}
+
+#pragma mark - Benchmarks
+
+static NSArray<NSString *> *FSQBenchmarkNames(void) {
+    return @[
+             @"setSectionRecords",
+             @"setSectionRecordsAnimated",
+             @"insertCellRecord",
+             @"moveCellRecord",
+             @"removeCellRecord",
+             @"replaceCellRecord",
+             @"replaceManyCellRecords",
+             @"replaceManyCellRecordsPassingTest",
+             @"cellRecordAtIndexPath",
+             @"fastEnumeration",
+             @"matchingIndexPathsForCurrentlySelectedIndexPaths",
+             @"delegateCallbackWithResponderLists",
+             @"delegateCallbackProbingResponders",
+             ];
+}
+
+static NSDictionary<NSString *, FSQBenchmarkBlock> *FSQBenchmarkBlocks(void) {
+    NSMutableDictionary<NSString *, FSQBenchmarkBlock> *benchmarks = [NSMutableDictionary new];
+    
+    benchmarks[@"setSectionRecords"] = ^FSQBenchmarkMeasurement(FSQBenchmarkCellManifest *manifest, NSUInteger numberOfRecords, NSUInteger sectionSize) {
+        NSArray<FSQSectionRecord *> *originalFeed = manifest.sectionRecords;
+        NSArray<FSQSectionRecord *> *changedFeed = FSQBenchmarkFeed(numberOfRecords, sectionSize, YES);
+        return FSQBenchmarkMeasure(NSUIntegerMax, ^(NSUInteger iteration) {
+            manifest.sectionRecords = (iteration % 2 == 0 ? changedFeed : originalFeed);
+        });
+    };
+    
+    benchmarks[@"setSectionRecordsAnimated"] = ^FSQBenchmarkMeasurement(FSQBenchmarkCellManifest *manifest, NSUInteger numberOfRecords, NSUInteger sectionSize) {
+        NSArray<FSQSectionRecord *> *originalFeed = manifest.sectionRecords;
+        NSArray<FSQSectionRecord *> *changedFeed = FSQBenchmarkFeed(numberOfRecords, sectionSize, YES);
+        return FSQBenchmarkMeasure(NSUIntegerMax, ^(NSUInteger iteration) {
+            [manifest setSectionRecords:(iteration % 2 == 0 ? changedFeed : originalFeed) animated:YES];
+        });
+    };
+    
+    benchmarks[@"insertCellRecord"] = ^FSQBenchmarkMeasurement(FSQBenchmarkCellManifest *manifest, NSUInteger numberOfRecords, NSUInteger sectionSize) {
+        return FSQBenchmarkMeasure(NSUIntegerMax, ^(NSUInteger iteration) {
+            [manifest insertCellRecords:@[FSQBenchmarkCellRecord(@(numberOfRecords + iteration))]
+                            atIndexPath:FSQBenchmarkRandomIndexPath(manifest, YES)];
+        });
+    };
+    
+    benchmarks[@"moveCellRecord"] = ^FSQBenchmarkMeasurement(FSQBenchmarkCellManifest *manifest, NSUInteger numberOfRecords, NSUInteger sectionSize) {
+        return FSQBenchmarkMeasure(NSUIntegerMax, ^(NSUInteger iteration) {
+            [manifest moveCellRecordAtIndexPath:FSQBenchmarkRandomIndexPath(manifest, NO)
+                                    toIndexPath:FSQBenchmarkRandomIndexPath(manifest, NO)];
+        });
+    };
+    
+    benchmarks[@"removeCellRecord"] = ^FSQBenchmarkMeasurement(FSQBenchmarkCellManifest *manifest, NSUInteger numberOfRecords, NSUInteger sectionSize) {
+        // Stop well before the feed runs out so that it stays about the same size
+        return FSQBenchmarkMeasure(numberOfRecords / 2, ^(NSUInteger iteration) {
+            [manifest removeCellRecordsAtIndexPaths:@[FSQBenchmarkRandomIndexPath(manifest, NO)] removeEmptySections:NO];
+        });
+    };
+    
+    benchmarks[@"replaceCellRecord"] = ^FSQBenchmarkMeasurement(FSQBenchmarkCellManifest *manifest, NSUInteger numberOfRecords, NSUInteger sectionSize) {
+        return FSQBenchmarkMeasure(NSUIntegerMax, ^(NSUInteger iteration) {
+            [manifest replaceCellRecordsAtIndexPaths:@[FSQBenchmarkRandomIndexPath(manifest, NO)]
+                                     withCellRecords:@[FSQBenchmarkCellRecord(@(numberOfRecords + iteration))]];
+        });
+    };
+    
+    // 1% of the records, spread evenly over every section
+    benchmarks[@"replaceManyCellRecords"] = ^FSQBenchmarkMeasurement(FSQBenchmarkCellManifest *manifest, NSUInteger numberOfRecords, NSUInteger sectionSize) {
+        NSMutableArray<NSIndexPath *> *indexPaths = [NSMutableArray new];
+        NSMutableArray<FSQCellRecord *> *evenCellRecords = [NSMutableArray new];
+        NSMutableArray<FSQCellRecord *> *oddCellRecords = [NSMutableArray new];
+        for (NSUInteger recordIndex = 0; recordIndex < numberOfRecords; recordIndex += 100) {
+            [indexPaths addObject:FSQIndexPathMake((NSInteger)(recordIndex / sectionSize), (NSInteger)(recordIndex % sectionSize))];
+            [evenCellRecords addObject:FSQBenchmarkCellRecord(@(numberOfRecords + recordIndex))];
+            [oddCellRecords addObject:FSQBenchmarkCellRecord(@(2 * numberOfRecords + recordIndex))];
+        }
+        
+        return FSQBenchmarkMeasure(NSUIntegerMax, ^(NSUInteger iteration) {
+            [manifest replaceCellRecordsAtIndexPaths:indexPaths withCellRecords:(iteration % 2 == 0 ? evenCellRecords : oddCellRecords)];
+        });
+    };
+    
+    benchmarks[@"replaceManyCellRecordsPassingTest"] = ^FSQBenchmarkMeasurement(FSQBenchmarkCellManifest *manifest, NSUInteger numberOfRecords, NSUInteger sectionSize) {
+        return FSQBenchmarkMeasure(NSUIntegerMax, ^(NSUInteger iteration) {
+            [manifest replaceCellRecordsPassingTest:^BOOL(FSQCellRecord *record, NSIndexPath *indexPath) {
+                return (FSQIndexPathRowOrItem(indexPath) % 100 == (NSInteger)(iteration % 100));
+            } withBlock:^FSQCellRecord *(FSQCellRecord *record, NSIndexPath *indexPath) {
+                return FSQBenchmarkCellRecord(record.model);
+            }];
+        });
+    };
+    
+    benchmarks[@"cellRecordAtIndexPath"] = ^FSQBenchmarkMeasurement(FSQBenchmarkCellManifest *manifest, NSUInteger numberOfRecords, NSUInteger sectionSize) {
+        NSMutableArray<NSIndexPath *> *indexPaths = [[NSMutableArray alloc] initWithCapacity:kFSQBenchmarkIndexPathPoolSize];
+        for (NSUInteger i = 0; i < kFSQBenchmarkIndexPathPoolSize; ++i) {
+            [indexPaths addObject:FSQBenchmarkRandomIndexPath(manifest, NO)];
+        }
+        
+        __block NSUInteger numberOfRecordsFound = 0;
+        FSQBenchmarkMeasurement measurement = FSQBenchmarkMeasure(NSUIntegerMax, ^(NSUInteger iteration) {
+            if ([manifest cellRecordAtIndexPath:indexPaths[iteration % kFSQBenchmarkIndexPathPoolSize]]) {
+                ++numberOfRecordsFound;
+            }
+        });
+        NSCAssert(numberOfRecordsFound == measurement.iterations, @"Looked up an index path without a record");
+        return measurement;
+    };
+    
+    benchmarks[@"fastEnumeration"] = ^FSQBenchmarkMeasurement(FSQBenchmarkCellManifest *manifest, NSUInteger numberOfRecords, NSUInteger sectionSize) {
+        __block NSUInteger numberOfRecordsFound = 0;
+        FSQBenchmarkMeasurement measurement = FSQBenchmarkMeasure(NSUIntegerMax, ^(NSUInteger iteration) {
+            for (FSQSectionRecord *sectionRecord in manifest) {
+                for (FSQCellRecord *cellRecord in sectionRecord) {
+                    if (cellRecord) {
+                        ++numberOfRecordsFound;
+                    }
+                }
+            }
+        });
+        NSCAssert(numberOfRecordsFound == measurement.iterations * numberOfRecords, @"Enumerated the wrong number of records");
+        return measurement;
+    };
+    
+    benchmarks[@"matchingIndexPathsForCurrentlySelectedIndexPaths"] = ^FSQBenchmarkMeasurement(FSQBenchmarkCellManifest *manifest, NSUInteger numberOfRecords, NSUInteger sectionSize) {
+        NSArray<FSQSectionRecord *> *changedFeed = FSQBenchmarkFeed(numberOfRecords, sectionSize, YES);
+        NSMutableArray<NSIndexPath *> *selectedIndexPaths = [NSMutableArray new];
+        for (NSUInteger i = 0; i < kFSQBenchmarkNumberOfSelectedIndexPaths; ++i) {
+            [selectedIndexPaths addObject:FSQBenchmarkRandomIndexPath(manifest, NO)];
+        }
+        
+        return FSQBenchmarkMeasure(NSUIntegerMax, ^(NSUInteger iteration) {
+            [manifest matchingIndexPathsForCurrentlySelectedIndexPaths:selectedIndexPaths newSectionRecords:changedFeed];
+        });
+    };
+    
+    // Callbacks go through the manifest's per-selector responder lists, which is also what the message forwarder
+    // enumerator walks for every forwarded UIScrollView, table and collection view message
+    benchmarks[@"delegateCallbackWithResponderLists"] = ^FSQBenchmarkMeasurement(FSQBenchmarkCellManifest *manifest, NSUInteger numberOfRecords, NSUInteger sectionSize) {
+        __attribute__((objc_precise_lifetime)) FSQBenchmarkScrollResponder *delegate = [FSQBenchmarkScrollResponder new];
+        FSQBenchmarkAttachScrollResponders(manifest, delegate);
+        
+        SEL selector = @selector(benchmarkManifestDidScroll:);
+        void (^callback)(id responder) = ^(id responder) {
+            [responder benchmarkManifestDidScroll:manifest];
+        };
+        return FSQBenchmarkMeasure(NSUIntegerMax, ^(NSUInteger iteration) {
+            [manifest withEachPluginAndDelegateRespondingToSelector:selector block:callback];
+        });
+    };
+    
+    // The same callbacks the way they were sent before responder lists, asking every plugin and the delegate whether
+    // they respond on every message
+    benchmarks[@"delegateCallbackProbingResponders"] = ^FSQBenchmarkMeasurement(FSQBenchmarkCellManifest *manifest, NSUInteger numberOfRecords, NSUInteger sectionSize) {
+        __attribute__((objc_precise_lifetime)) FSQBenchmarkScrollResponder *delegate = [FSQBenchmarkScrollResponder new];
+        FSQBenchmarkAttachScrollResponders(manifest, delegate);
+        
+        SEL selector = @selector(benchmarkManifestDidScroll:);
+        void (^callback)(id responder) = ^(id responder) {
+            [responder benchmarkManifestDidScroll:manifest];
+        };
+        return FSQBenchmarkMeasure(NSUIntegerMax, ^(NSUInteger iteration) {
+            for (id plugin in manifest.benchmarkPlugins) {
+                if ([plugin respondsToSelector:selector]) {
+                    callback(plugin);
+                }
+            }
+            
+            id manifestDelegate = manifest.delegate;
+            if ([manifestDelegate respondsToSelector:selector]) {
+                callback(manifestDelegate);
+            }
+        });
+    };
+    
+    return benchmarks;
+}
+
+static NSDictionary *_Nullable FSQBenchmarkRun(NSString *name, NSUInteger numberOfRecords, NSUInteger sectionSize, BOOL countsAllocations) {
+    FSQBenchmarkBlock benchmark = FSQBenchmarkBlocks()[name];
+    if (!benchmark) {
+        return nil;
+    }
+    
+    FSQBenchmarkCellManifest *manifest = [FSQBenchmarkCellManifest new];
+    manifest.sectionRecords = FSQBenchmarkFeed(numberOfRecords, sectionSize, NO);
+    
+    FSQBenchmarkMeasurement measurement = benchmark(manifest, numberOfRecords, sectionSize);
+    double seconds = (double)measurement.nanoseconds / 1e9;
+    FSQBenchmarkManagedView *managedView = manifest.managedView;
+    
+    return @{
+             @"benchmark" : name,
+             @"records" : @(numberOfRecords),
+             @"sectionSize" : @(sectionSize),
+             @"iterations" : @(measurement.iterations),
+             @"seconds" : @(seconds),
+             @"opsPerSecond" : @((double)measurement.iterations / seconds),
+             @"allocationsPerOp" : (countsAllocations ? @((double)measurement.allocations / (double)measurement.iterations) : [NSNull null]),
+             @"peakResidentBytes" : @(FSQBenchmarkPeakResidentBytes()),
+             @"managedView" : @{
+                     @"reloads" : @(managedView.numberOfReloads),
+                     @"batchUpdates" : @(managedView.numberOfBatchUpdates),
+                     @"updatedSections" : @(managedView.numberOfUpdatedSections),
+                     @"updatedRows" : @(managedView.numberOfUpdatedRows),
+                     },
+             };
+}
+
+#pragma mark - Driver
+
+static NSArray<NSNumber *> *FSQBenchmarkIntegerList(NSString *string) {
+    NSMutableArray<NSNumber *> *integers = [NSMutableArray new];
+    for (NSString *component in [string componentsSeparatedByString:@","]) {
+        NSInteger integer = [component integerValue];
+        if (integer > 0) {
+            [integers addObject:@(integer)];
+        }
+    }
+    return integers;
+}
+
+static void FSQBenchmarkPrintJSON(id object) {
+    NSData *data = [NSJSONSerialization dataWithJSONObject:object options:NSJSONWritingPrettyPrinted error:NULL];
+    fwrite([data bytes], 1, [data length], stdout);
+    fputc('\n', stdout);
+    fflush(stdout);
+}
+
+static NSDictionary *FSQBenchmarkRunInChildProcess(NSString *name, NSUInteger numberOfRecords, NSUInteger sectionSize) {
+    NSPipe *pipe = [NSPipe pipe];
+    NSTask *task = [NSTask new];
+    task.launchPath = [[NSBundle mainBundle] executablePath];
+    task.arguments = @[
+                       @"--run", name,
+                       @"--records", [@(numberOfRecords) stringValue],
+                       @"--section-size", [@(sectionSize) stringValue],
+                       ];
+    task.standardOutput = pipe;
+    [task launch];
+    
+    NSData *output = [[pipe fileHandleForReading] readDataToEndOfFile];
+    [task waitUntilExit];
+    
+    NSDictionary *result = nil;
+    if ([task terminationStatus] == 0) {
+        result = [NSJSONSerialization JSONObjectWithData:output options:0 error:NULL];
+    }
+    
+    return result ?: @{
+                       @"benchmark" : name,
+                       @"records" : @(numberOfRecords),
+                       @"sectionSize" : @(sectionSize),
+                       @"error" : [NSString stringWithFormat:@"exited with status %d", [task terminationStatus]],
+                       };
+}
+
+int main(int argc, const char *argv[]) {
+    @autoreleasepool {
+        BOOL countsAllocations = FSQBenchmarkStartCountingAllocations();
+        
+        NSString *runName = nil;
+        NSArray<NSNumber *> *recordCounts = @[@10000, @100000, @1000000];
+        NSUInteger sectionSize = 1000;
+        NSArray<NSString *> *names = FSQBenchmarkNames();
+        
+        NSArray<NSString *> *arguments = [[NSProcessInfo processInfo] arguments];
+        for (NSUInteger i = 1; i < [arguments count]; ++i) {
+            NSString *argument = arguments[i];
+            NSString *value = (i + 1 < [arguments count] ? arguments[i + 1] : nil);
+            
+            if ([argument isEqualToString:@"--run"] && value) {
+                runName = value;
+            }
+            else if ([argument isEqualToString:@"--records"] && value) {
+                recordCounts = FSQBenchmarkIntegerList(value);
+            }
+            else if ([argument isEqualToString:@"--section-size"] && value) {
+                sectionSize = (NSUInteger)MAX([value integerValue], 1);
+            }
+            else if ([argument isEqualToString:@"--benchmark"] && value) {
+                names = [value componentsSeparatedByString:@","];
+            }
+            else {
+                fprintf(stderr, "usage: %s [--records 10000,100000,1000000] [--section-size 1000] [--benchmark name,...]\n", argv[0]);
+                fprintf(stderr, "benchmarks: %s\n", [[FSQBenchmarkNames() componentsJoinedByString:@", "] UTF8String]);
+                return 1;
+            }
+            ++i;
+        }
+        
+        if (runName) {
+            // Child process, running one benchmark at one size
+            NSDictionary *result = FSQBenchmarkRun(runName, [[recordCounts firstObject] unsignedIntegerValue], sectionSize, countsAllocations);
+            if (!result) {
+                fprintf(stderr, "unknown benchmark %s\n", [runName UTF8String]);
+                return 1;
+            }
+            FSQBenchmarkPrintJSON(result);
+            return 0;
+        }
+        
+        NSMutableArray<NSDictionary *> *results = [NSMutableArray new];
+        for (NSNumber *numberOfRecords in recordCounts) {
+            for (NSString *name in names) {
+                fprintf(stderr, "%s (%lu records)\n", [name UTF8String], (unsigned long)[numberOfRecords unsignedIntegerValue]);
+                [results addObject:FSQBenchmarkRunInChildProcess(name, [numberOfRecords unsignedIntegerValue], sectionSize)];
+            }
+        }
+        
+        FSQBenchmarkPrintJSON(@{@"benchmarks" : results});
+    }
+    return 0;
+}
+
+NS_ASSUME_NONNULL_END